@@ -0,0 +1,470 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// GameTest-Bench: measures what the framework costs a frame.
+//
+// Micro benchmarks time the pass and fail paths of GMT_Update, GMT_Assert,
+// GMT_Track*, GMT_Pin* and GMT_SyncSignal at 1, 2, 4, ... worker threads.  Each
+// frame the main thread calls GMT_Update and the workers then make --calls calls
+// each; REPLAY phases replay the file the RECORD phase of the same case wrote.
+// The load benchmark records synthetic test files of 1 MB up to --max-mb and
+// times GMT_Init in REPLAY mode on them (loading whole and streaming), with the
+// peak heap the framework allocated meanwhile.
+//
+// Results are JSON Lines, one object per measurement, on stdout or --out:
+//   {"bench": "track", "phase": "replay_pass", "threads": 4, "calls": 400000, "ns_per_call": 41.2}
+//   {"bench": "load", "mb": 64, "stream": false, "file_bytes": 67174400, "ms": 93.1, "peak_heap_bytes": 2621440}
+// Log messages are discarded so that console output does not skew the numbers.
+// Win32 only, like the library and GameTest-Tool.
+
+#include <GameTest.h>
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#define BENCH_MAX_THREADS 64
+#define BENCH_LOAD_PAYLOAD (60 * 1024)  // Pinned bytes per frame of a synthetic file.
+
+static struct {
+  FILE* out;
+  char path[1024];  // Test file the micro benchmarks record and replay.
+  const char* dir;
+  int frames;
+  int calls;
+  int max_threads;
+  int max_mb;
+  bool micro;
+  bool load;
+} B;
+
+// ===== Platform =====
+
+static double bench_now_ns(void) {
+  static LARGE_INTEGER freq;
+  LARGE_INTEGER t;
+  if (freq.QuadPart == 0) QueryPerformanceFrequency(&freq);
+  QueryPerformanceCounter(&t);
+  return (double)t.QuadPart * 1e9 / (double)freq.QuadPart;
+}
+
+static long long bench_atomic_add(volatile long long* p, long long v) {
+  return InterlockedExchangeAdd64(p, v) + v;
+}
+
+typedef SYNCHRONIZATION_BARRIER bench_barrier;
+static void bench_barrier_init(bench_barrier* b, int count) { InitializeSynchronizationBarrier(b, count, -1); }
+static void bench_barrier_wait(bench_barrier* b) { EnterSynchronizationBarrier(b, 0); }
+static void bench_barrier_destroy(bench_barrier* b) { DeleteSynchronizationBarrier(b); }
+
+typedef HANDLE bench_thread;
+typedef DWORD(WINAPI* bench_thread_fn)(void*);
+#define BENCH_THREAD_RETURN DWORD WINAPI
+static bool bench_thread_start(bench_thread* t, bench_thread_fn fn, void* arg) {
+  *t = CreateThread(NULL, 0, fn, arg, 0, NULL);
+  return *t != NULL;
+}
+static void bench_thread_join(bench_thread t) {
+  WaitForSingleObject(t, INFINITE);
+  CloseHandle(t);
+}
+
+// ===== Framework callbacks =====
+
+// Every framework allocation carries its size so the heap in use can be tracked.
+typedef struct {
+  size_t size;
+  size_t pad;  // Keeps the user block 16-byte aligned.
+} BenchBlock;
+
+static volatile long long s_heap_now;
+static volatile long long s_heap_peak;
+
+static void bench_heap_add(long long delta) {
+  long long now = bench_atomic_add(&s_heap_now, delta);
+  while (now > s_heap_peak) {
+    long long peak = s_heap_peak;
+    if (InterlockedCompareExchange64(&s_heap_peak, now, peak) == peak) break;
+  }
+}
+
+static void* bench_alloc(size_t size, GMT_CodeLocation loc) {
+  (void)loc;
+  BenchBlock* b = (BenchBlock*)malloc(sizeof(BenchBlock) + size);
+  if (!b) return NULL;
+  b->size = size;
+  bench_heap_add((long long)size);
+  return b + 1;
+}
+
+static void bench_free(void* ptr, GMT_CodeLocation loc) {
+  (void)loc;
+  if (!ptr) return;
+  BenchBlock* b = (BenchBlock*)ptr - 1;
+  bench_heap_add(-(long long)b->size);
+  free(b);
+}
+
+static void* bench_realloc(void* ptr, size_t new_size, GMT_CodeLocation loc) {
+  if (!ptr) return bench_alloc(new_size, loc);
+  BenchBlock* b = (BenchBlock*)ptr - 1;
+  size_t old_size = b->size;
+  BenchBlock* grown = (BenchBlock*)realloc(b, sizeof(BenchBlock) + new_size);
+  if (!grown) return NULL;
+  grown->size = new_size;
+  bench_heap_add((long long)new_size - (long long)old_size);
+  return grown + 1;
+}
+
+static void bench_log(GMT_Severity severity, const char* msg, GMT_CodeLocation loc) {
+  (void)severity;
+  (void)msg;
+  (void)loc;
+}
+
+static void bench_fail(void) {}
+static GMT_FailCallback s_fail_callback = bench_fail;
+
+static GMT_Setup bench_setup(GMT_Mode mode, const char* path) {
+  GMT_Setup s;
+  memset(&s, 0, sizeof(s));
+  s.mode = mode;
+  s.test_path = path;
+  s.log_callback = bench_log;
+  s.alloc_callback = bench_alloc;
+  s.free_callback = bench_free;
+  s.realloc_callback = bench_realloc;
+  s.fail_callback = &s_fail_callback;
+  s.fail_assertion_trigger_count = INT_MAX;
+  s.replay_timing = GMT_ReplayTiming_FRAME;
+  s.input_injection = GMT_InputInjection_WINDOW_MESSAGES;  // Never touch the desktop's input queue.
+  return s;
+}
+
+// ===== Operations =====
+
+// One measured call.  `thread` is the worker index, `i` the call within the frame.
+typedef void (*BenchOp)(int thread, int i);
+
+static float s_floats[BENCH_MAX_THREADS][64];
+
+static void op_assert_pass(int thread, int i) {
+  GMT_Assert(thread >= 0 && i >= 0);
+}
+
+static void op_assert_fail(int thread, int i) {
+  GMT_Assert(thread < 0 || i < 0);
+}
+
+static void op_track(int thread, int i) {
+  GMT_TrackInt((unsigned int)thread + 1, i);
+}
+
+static void op_track_wrong(int thread, int i) {
+  GMT_TrackInt((unsigned int)thread + 1, i + 1);
+}
+
+static void op_track_array(int thread, int i) {
+  (void)i;
+  GMT_TrackFloatArray((unsigned int)thread + 1, s_floats[thread], 64);
+}
+
+static void op_track_array_wrong(int thread, int i) {
+  float wrong[64];
+  memcpy(wrong, s_floats[thread], sizeof(wrong));
+  wrong[i % 64] += 1.0f;
+  GMT_TrackFloatArray((unsigned int)thread + 1, wrong, 64);
+}
+
+static void op_pin(int thread, int i) {
+  int v = i;
+  GMT_PinInt((unsigned int)thread + 1, &v);
+}
+
+static void op_pin_missing(int thread, int i) {
+  int v = i;
+  GMT_PinInt((unsigned int)thread + 1001, &v);  // Never recorded.
+}
+
+static void op_signal(int thread, int i) {
+  (void)thread;
+  (void)i;
+  GMT_SyncSignal(1);  // One id for every call, so replay matches in any interleaving.
+}
+
+static void op_signal_wrong(int thread, int i) {
+  (void)thread;
+  (void)i;
+  GMT_SyncSignal(2);
+}
+
+typedef struct {
+  const char* name;
+  GMT_Mode mode;
+  BenchOp op;  // NULL times GMT_Update alone.
+} BenchPhase;
+
+typedef struct {
+  const char* name;
+  bool threaded;  // Run at every thread count, not just one.
+  BenchPhase phases[3];
+} BenchCase;
+
+// Within a case, REPLAY phases replay the file written by its RECORD phase.
+static const BenchCase s_cases[] = {
+    {"update", false, {{"record", GMT_Mode_RECORD, NULL}, {"replay", GMT_Mode_REPLAY, NULL}}},
+    {"assert", true, {{"pass", GMT_Mode_RECORD, op_assert_pass}, {"fail", GMT_Mode_RECORD, op_assert_fail}}},
+    {"track", true, {{"record", GMT_Mode_RECORD, op_track}, {"replay_pass", GMT_Mode_REPLAY, op_track}, {"replay_fail", GMT_Mode_REPLAY, op_track_wrong}}},
+    {"track_float_array_64", true, {{"record", GMT_Mode_RECORD, op_track_array}, {"replay_pass", GMT_Mode_REPLAY, op_track_array}, {"replay_fail", GMT_Mode_REPLAY, op_track_array_wrong}}},
+    {"pin", true, {{"record", GMT_Mode_RECORD, op_pin}, {"replay_pass", GMT_Mode_REPLAY, op_pin}, {"replay_fail", GMT_Mode_REPLAY, op_pin_missing}}},
+    {"sync_signal", true, {{"record", GMT_Mode_RECORD, op_signal}, {"replay_pass", GMT_Mode_REPLAY, op_signal}, {"replay_fail", GMT_Mode_REPLAY, op_signal_wrong}}},
+};
+
+// ===== Micro benchmarks =====
+
+typedef struct {
+  bench_barrier* barrier;
+  BenchOp op;
+  int index;
+  volatile long long* total_ns;
+} BenchWorker;
+
+static volatile bool s_workers_done;
+
+static BENCH_THREAD_RETURN bench_worker(void* arg) {
+  BenchWorker* w = (BenchWorker*)arg;
+  for (;;) {
+    bench_barrier_wait(w->barrier);  // Frame start, after GMT_Update.
+    if (s_workers_done) break;
+    double t0 = bench_now_ns();
+    for (int i = 0; i < B.calls; i++) w->op(w->index, i);
+    bench_atomic_add(w->total_ns, (long long)(bench_now_ns() - t0));
+    bench_barrier_wait(w->barrier);  // Frame end.
+  }
+  return 0;
+}
+
+static bool bench_run_phase(const BenchCase* c, const BenchPhase* p, int threads) {
+  GMT_Setup setup = bench_setup(p->mode, B.path);
+  if (!GMT_Init(&setup)) {
+    fprintf(stderr, "GameTest-Bench: GMT_Init failed for %s/%s.\n", c->name, p->name);
+    return false;
+  }
+
+  volatile long long total_ns = 0;
+  double update_ns = 0.0;
+  int workers = p->op ? threads : 0;
+  bench_barrier barrier;
+  bench_thread handles[BENCH_MAX_THREADS];
+  BenchWorker args[BENCH_MAX_THREADS];
+  s_workers_done = false;
+  if (workers > 0) bench_barrier_init(&barrier, workers + 1);
+  for (int t = 0; t < workers; t++) {
+    args[t].barrier = &barrier;
+    args[t].op = p->op;
+    args[t].index = t;
+    args[t].total_ns = &total_ns;
+    if (!bench_thread_start(&handles[t], bench_worker, &args[t])) {
+      fprintf(stderr, "GameTest-Bench: failed to start a worker thread.\n");
+      exit(1);
+    }
+  }
+
+  for (int f = 0; f < B.frames; f++) {
+    double t0 = bench_now_ns();
+    GMT_Update();
+    update_ns += bench_now_ns() - t0;
+    if (workers > 0) {
+      bench_barrier_wait(&barrier);
+      bench_barrier_wait(&barrier);
+    }
+  }
+
+  if (workers > 0) {
+    s_workers_done = true;
+    bench_barrier_wait(&barrier);
+    for (int t = 0; t < workers; t++) bench_thread_join(handles[t]);
+    bench_barrier_destroy(&barrier);
+  }
+  GMT_Quit();
+
+  if (p->op) {
+    long long calls = (long long)B.frames * B.calls * workers;
+    fprintf(B.out, "{\"bench\": \"%s\", \"phase\": \"%s\", \"threads\": %d, \"calls\": %lld, \"ns_per_call\": %.1f}\n",
+            c->name, p->name, workers, calls, (double)total_ns / (double)calls);
+  } else {
+    fprintf(B.out, "{\"bench\": \"%s\", \"phase\": \"%s\", \"threads\": 1, \"calls\": %d, \"ns_per_call\": %.1f}\n",
+            c->name, p->name, B.frames, update_ns / (double)B.frames);
+  }
+  fflush(B.out);
+  return true;
+}
+
+static void bench_micro(void) {
+  for (int t = 0; t < BENCH_MAX_THREADS; t++)
+    for (int k = 0; k < 64; k++) s_floats[t][k] = (float)(t * 64 + k) * 0.5f;
+
+  for (size_t k = 0; k < sizeof(s_cases) / sizeof(s_cases[0]); k++) {
+    const BenchCase* c = &s_cases[k];
+    for (int threads = 1; threads <= B.max_threads; threads *= 2) {
+      for (int p = 0; p < 3 && c->phases[p].name; p++) {
+        if (!bench_run_phase(c, &c->phases[p], threads)) return;
+      }
+      if (!c->threaded) break;
+    }
+  }
+  remove(B.path);
+}
+
+// ===== Load benchmark =====
+
+static long long bench_file_size(const char* path) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return -1;
+  _fseeki64(f, 0, SEEK_END);
+  long long size = _ftelli64(f);
+  fclose(f);
+  return size;
+}
+
+// Records a test file of about `mb` MB: one large pin and a few tracks per frame.
+static bool bench_write_file(const char* path, int mb) {
+  static unsigned char payload[BENCH_LOAD_PAYLOAD];
+  GMT_Setup setup = bench_setup(GMT_Mode_RECORD, path);
+  if (!GMT_Init(&setup)) return false;
+  long long frames = ((long long)mb * 1024 * 1024) / BENCH_LOAD_PAYLOAD;
+  unsigned int x = 12345u;
+  for (long long f = 0; f < frames; f++) {
+    GMT_Update();
+    for (size_t i = 0; i < sizeof(payload); i++) {
+      x = x * 1103515245u + 12345u;
+      payload[i] = (unsigned char)(x >> 24);
+    }
+    GMT_PinBytes(1, payload, sizeof(payload));
+    for (int k = 0; k < 16; k++) GMT_TrackInt(2, (int)(f * 16 + k));
+  }
+  GMT_Quit();
+  return true;
+}
+
+static void bench_load(void) {
+  char path[1024];
+  snprintf(path, sizeof(path), "%s/GameTest-Bench-load.gmt", B.dir);
+  for (int mb = 1; mb <= B.max_mb; mb *= 4) {
+    if (!bench_write_file(path, mb)) {
+      fprintf(stderr, "GameTest-Bench: failed to write %d MB test file.\n", mb);
+      return;
+    }
+    long long file_bytes = bench_file_size(path);
+    for (int stream = 0; stream < 2; stream++) {
+      GMT_Setup setup = bench_setup(GMT_Mode_REPLAY, path);
+      setup.stream_replay = stream != 0;
+      s_heap_peak = s_heap_now;
+      long long heap_before = s_heap_now;
+      double t0 = bench_now_ns();
+      bool ok = GMT_Init(&setup);
+      double ms = (bench_now_ns() - t0) / 1e6;
+      long long peak = s_heap_peak - heap_before;
+      if (ok) GMT_Quit();
+      fprintf(B.out, "{\"bench\": \"load\", \"mb\": %d, \"stream\": %s, \"ok\": %s, \"file_bytes\": %lld, \"ms\": %.2f, \"peak_heap_bytes\": %lld}\n",
+              mb, stream ? "true" : "false", ok ? "true" : "false", file_bytes, ms, peak);
+      fflush(B.out);
+    }
+  }
+  remove(path);
+}
+
+// ===== Main =====
+
+static const char* bench_arg(const char* arg, const char* name) {
+  size_t n = strlen(name);
+  return strncmp(arg, name, n) == 0 ? arg + n : NULL;
+}
+
+static void bench_usage(void) {
+  fprintf(stderr,
+          "Usage: GameTest-Bench [options]\n"
+          "  --out=<path>       Write results here instead of stdout.\n"
+          "  --dir=<path>       Directory for the temporary test files (default: .).\n"
+          "  --frames=<n>       Frames per micro benchmark phase (default: 100).\n"
+          "  --calls=<n>        Calls per worker thread per frame (default: 1000).\n"
+          "  --max-threads=<n>  Largest worker thread count; runs 1, 2, 4, ... (default: 8).\n"
+          "  --max-mb=<n>       Largest synthetic file for the load benchmark; runs 1, 4, 16, ... MB (default: 1024).\n"
+          "  --micro-only       Skip the load benchmark.\n"
+          "  --load-only        Skip the micro benchmarks.\n");
+}
+
+int main(int argc, char** argv) {
+  B.out = stdout;
+  B.dir = ".";
+  B.frames = 100;
+  B.calls = 1000;
+  B.max_threads = 8;
+  B.max_mb = 1024;
+  B.micro = true;
+  B.load = true;
+
+  const char* out_path = NULL;
+  for (int i = 1; i < argc; i++) {
+    const char* v;
+    if ((v = bench_arg(argv[i], "--out="))) out_path = v;
+    else if ((v = bench_arg(argv[i], "--dir=")))
+      B.dir = v;
+    else if ((v = bench_arg(argv[i], "--frames=")))
+      B.frames = atoi(v);
+    else if ((v = bench_arg(argv[i], "--calls=")))
+      B.calls = atoi(v);
+    else if ((v = bench_arg(argv[i], "--max-threads=")))
+      B.max_threads = atoi(v);
+    else if ((v = bench_arg(argv[i], "--max-mb=")))
+      B.max_mb = atoi(v);
+    else if (strcmp(argv[i], "--micro-only") == 0)
+      B.load = false;
+    else if (strcmp(argv[i], "--load-only") == 0)
+      B.micro = false;
+    else {
+      bench_usage();
+      return 2;
+    }
+  }
+  if (B.frames < 1 || B.calls < 1 || B.max_threads < 1 || B.max_threads > BENCH_MAX_THREADS || B.max_mb < 1) {
+    bench_usage();
+    return 2;
+  }
+  if (out_path && !(B.out = fopen(out_path, "w"))) {
+    fprintf(stderr, "GameTest-Bench: cannot open %s\n", out_path);
+    return 1;
+  }
+  snprintf(B.path, sizeof(B.path), "%s/GameTest-Bench.gmt", B.dir);
+
+  if (B.micro) bench_micro();
+  if (B.load) bench_load();
+
+  if (B.out != stdout) fclose(B.out);
+  return 0;
+}
@@ -242,6 +242,16 @@ static void key_callback(GLFWwindow* win, int key, int scancode, int action, int
   }
 }
 
+// True when running under GameTest (record or replay).
+static bool g_testing = false;
+
+// Frame clock.  Under GameTest, GMT_GetTime returns the time of the current
+// frame as recorded, so game_step runs on the same ticks in record and replay,
+// even when replaying by frame number faster than real time.
+static double game_time(void) {
+  return g_testing ? GMT_GetTime() : glfwGetTime();
+}
+
 int main(int argc, char** argv) {
   {
     // Initialize GameTest.
@@ -257,9 +267,44 @@ int main(int argc, char** argv) {
     GMT_ParseTestMode((const char**)argv, argc, &test_mode);
     GMT_ParseTestFilePath((const char**)argv, argc, test_name, sizeof(test_name));
 
+    // --replay-timing=frame replays by frame number instead of wall-clock time.
+    GMT_ReplayTiming replay_timing = GMT_ReplayTiming_WALL_CLOCK;
+    GMT_ParseReplayTiming((const char**)argv, argc, &replay_timing);
+
+    // --input-injection=messages replays without going through the OS input queue.
+    GMT_InputInjection input_injection = GMT_InputInjection_SEND_INPUT;
+    GMT_ParseInputInjection((const char**)argv, argc, &input_injection);
+
+    // --input-capture=hooks records keys from the input hooks instead of polling.
+    GMT_InputCapture input_capture = GMT_InputCapture_POLL;
+    GMT_ParseInputCapture((const char**)argv, argc, &input_capture);
+
+    // --input-sample-rate=<hz> samples mouse and gamepads between frames.
+    uint32_t input_sample_rate = 0;
+    GMT_ParseInputSampleRate((const char**)argv, argc, &input_sample_rate);
+
+    // --stream-replay decodes the test file while replaying, for long recordings.
+    bool stream_replay = false;
+    GMT_ParseStreamReplay((const char**)argv, argc, &stream_replay);
+
+    // --test-result=<path> writes a JSON result file (GameTest-Tool --results).
+    char result_path[256] = {0};
+    GMT_ParseResultPath((const char**)argv, argc, result_path, sizeof(result_path));
+
+    // --test-status=<name> publishes live progress (GameTest-Tool --progress / --stall).
+    char status_name[128] = {0};
+    GMT_ParseTestStatus((const char**)argv, argc, status_name, sizeof(status_name));
+
     GMT_Setup setup = {
         .mode = test_mode,
         .test_path = test_name,
+        .replay_timing = replay_timing,
+        .input_injection = input_injection,
+        .input_capture = input_capture,
+        .input_sample_rate = input_sample_rate,
+        .stream_replay = stream_replay,
+        .result_path = result_path[0] ? result_path : NULL,
+        .status_name = status_name[0] ? status_name : NULL,
         // Fail immediately on the first assertion failure so the test runner
         // gets a clear non-zero exit code without letting the game run further.
         .fail_assertion_trigger_count = 1,
@@ -267,6 +312,8 @@ int main(int argc, char** argv) {
 
     if (!GMT_Init(&setup)) {
       fprintf(stderr, "Failed to initialize GameTest\n");
+    } else {
+      g_testing = (test_mode != GMT_Mode_DISABLED);
     }
   }
 
@@ -316,8 +363,8 @@ int main(int argc, char** argv) {
 
   // Main loop
   {
-    double prev = glfwGetTime();
-    while (!glfwWindowShouldClose(win)) {
+    double prev = game_time();
+    while (!glfwWindowShouldClose(win) && !GMT_ShouldQuit()) {
       // Advance the GameTest frame counter and drive recording/replay.
       // Must be called once per frame, before polling input or running game logic,
       // so that injected input is visible to glfwPollEvents on this same frame.
@@ -325,7 +372,7 @@ int main(int argc, char** argv) {
 
       // Update and render the game
       glfwPollEvents();
-      double now = glfwGetTime(), dt = now - prev;
+      double now = game_time(), dt = now - prev;
       prev = now;
       for (G.tick_timer += dt; G.tick_timer >= G.tick_rate; G.tick_timer -= G.tick_rate)
         game_step();
@@ -344,7 +391,8 @@ int main(int argc, char** argv) {
     // In REPLAY mode: compares G.length against the stored snapshot and
     // triggers an assertion failure if they differ, catching any divergence
     // in game logic that caused a different score.
-    GMT_TrackIntString("score", G.length);
+    // Skipped when replay stopped early at its end frame (GMT_ShouldQuit).
+    if (!GMT_ShouldQuit()) GMT_TrackIntString("score", G.length);
     GMT_LogInfo("Final score: %d", G.length);
 
     glfwDestroyWindow(win);
@@ -24,10 +24,12 @@ SOFTWARE.
 
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdbool.h>
 #include <string.h>
+#include "GameTestInput.h"
 
 // ===== Usage Notes =====
 //
@@ -150,6 +152,32 @@ typedef enum GMT_Mode {
   GMT_Mode_REPLAY,        // Loads the test file and injects captured input each frame.
 } GMT_Mode;
 
+// How REPLAY decides when a recorded input is due.
+typedef enum GMT_ReplayTiming {
+  GMT_ReplayTiming_WALL_CLOCK = 0,  // When the replay clock reaches the input's recorded timestamp.
+  GMT_ReplayTiming_FRAME,           // On the frame it was recorded in; replays as fast as the game steps.
+} GMT_ReplayTiming;
+
+// How REPLAY delivers recorded input to the game.
+typedef enum GMT_InputInjection {
+  GMT_InputInjection_SEND_INPUT = 0,   // Through the OS input queue (SendInput); reaches any input API.
+  GMT_InputInjection_WINDOW_MESSAGES,  // Posted to the game's own windows; never touches the OS input queue.
+  GMT_InputInjection_VIRTUAL,          // Not injected; the game reads it with GMT_GetVirtualInput.  No hooks.
+} GMT_InputInjection;
+
+// How RECORD reads the keyboard and mouse button state each frame.
+typedef enum GMT_InputCapture {
+  GMT_InputCapture_POLL = 0,  // GetAsyncKeyState for every key; sees input however the game pumps messages.
+  GMT_InputCapture_HOOKS,     // A key bitmap kept by the low-level hooks; a few loads per frame.
+  GMT_InputCapture_VIRTUAL,   // Whatever the host passed to GMT_SetVirtualInput; the OS is not read.
+} GMT_InputCapture;
+
+// How log messages reach the log callback (or stdout/stderr).
+typedef enum GMT_LogMode {
+  GMT_LogMode_DEFERRED = 0,  // Queued in a lock-free ring; a background thread formats and writes them in batches.
+  GMT_LogMode_IMMEDIATE,     // Formatted, written and flushed on the calling thread; for crash debugging.
+} GMT_LogMode;
+
 // Maps a path to a redirected path so the framework can read/write test files without affecting game files.
 typedef struct GMT_DirectoryMapping {
   const char* path;
@@ -160,6 +188,13 @@ typedef struct GMT_DirectoryMapping {
 // external tooling that needs to know when the game reaches a sync point.
 typedef void (*GMT_SignalCallback)(GMT_Mode mode, int id, GMT_CodeLocation loc);
 
+// Saves or restores the game state stored in keyframes (GMT_Setup.keyframe_interval).
+// Called from GMT_Update.  RECORD: write at most `size` bytes of state to `data`
+// and return the number of bytes written (0 stores none).  REPLAY, when starting
+// at a keyframe: restore the game from the `size` bytes at `data`; the return
+// value is ignored.
+typedef size_t (*GMT_SnapshotCallback)(GMT_Mode mode, void* data, size_t size);
+
 // Called when the test fails. Default: prints the assertion report and calls exit(1).
 typedef void (*GMT_FailCallback)();
 
@@ -179,6 +214,101 @@ typedef struct GMT_Setup {
   // Fail the test after this many assertion failures to prevent infinite loops.
   // If <= 1, the test fails on the first failed assertion.
   int fail_assertion_trigger_count;
+  // RECORD only: compress the test file in blocks.  Replay detects compressed
+  // files automatically, so this has no effect in REPLAY mode.
+  bool compress_test_file;
+  // RECORD only: bytes buffered for the background writer thread; 0 uses 1 MB.
+  // Recording stalls (counted in the final report) only when this fills up.
+  size_t record_buffer_size;
+  // REPLAY only: GMT_ReplayTiming_FRAME drives injection by frame number instead
+  // of wall-clock time, so a headless replay is limited only by the game's own
+  // frame rate.  The game should then take its frame time from GMT_GetTime.
+  // Test files recorded before frame records existed fall back to the wall clock.
+  GMT_ReplayTiming replay_timing;
+  // REPLAY only: GMT_InputInjection_WINDOW_MESSAGES posts input messages to the
+  // game's own windows and feeds polled state through the input hooks only, so
+  // several replays can share a machine without fighting over the OS input queue.
+  // GMT_InputInjection_VIRTUAL injects nothing; see GMT_GetVirtualInput.
+  GMT_InputInjection input_injection;
+  // RECORD only: GMT_InputCapture_HOOKS reads keys and mouse buttons from the
+  // state the low-level input hooks keep, instead of polling every key.  The
+  // state only advances while the thread that called GMT_Init pumps messages.
+  // GMT_InputCapture_VIRTUAL records what the host passes to GMT_SetVirtualInput.
+  GMT_InputCapture input_capture;
+  // Samples per second of the input sampling thread; 0 (default) runs none.
+  // RECORD: the thread reads the mouse and the gamepads at this rate and each
+  // change becomes an input record with its own timestamp, so motion between
+  // frames is kept.  REPLAY under the wall clock with SendInput injection: the
+  // thread injects records as they come due instead of waiting for the next
+  // GMT_Update.  Values over 1000 are clamped.  Ignored with virtual capture,
+  // and with window-message or virtual injection.
+  uint32_t input_sample_rate;
+  // RECORD only: write a keyframe every this many frames; 0 writes none.  A
+  // keyframe holds the full input state, the sync-signal position and the game
+  // state saved by snapshot_callback, so replay can start from it.
+  uint32_t keyframe_interval;
+  GMT_SnapshotCallback* snapshot_callback;  // NULL stores no game state in keyframes.
+  // RECORD only: largest game state snapshot_callback may save; 0 uses 64 KB.
+  size_t snapshot_capacity;
+  // REPLAY only: start at the last keyframe at or before this frame instead of at
+  // the beginning of the file.  0 replays the whole file.
+  uint32_t replay_start_frame;
+  // REPLAY only: end the test once replay reaches this frame: from then on
+  // GMT_ShouldQuit returns true and the game should shut down as if the player
+  // had quit.  0 (default) lets the game run to its own end.
+  uint32_t replay_end_frame;
+  // REPLAY only: at every keyframe replay reaches after the one it started from,
+  // save the live game state with snapshot_callback (called with GMT_Mode_RECORD)
+  // and fail the test if it differs from the recorded one.  The frames only line
+  // up under GMT_ReplayTiming_FRAME.
+  bool verify_keyframes;
+  // REPLAY only: decode the test file while replaying instead of loading it whole,
+  // so memory stays at a few MB however long the recording is.  Pin/Track lookups
+  // then take the framework mutex.  Needs a file with frame records (version 3).
+  bool stream_replay;
+  // Largest payload one GMT_Pin* / GMT_Track* call may carry; 0 uses 64 KB and
+  // values over 16 MB are clamped.  Larger calls are ignored and logged.  Replay
+  // memory grows with the payload bytes actually recorded, not with this limit.
+  size_t max_payload_size;
+  // REPLAY only: directory where the first GMT_TrackDigest mismatch of the run
+  // writes the live buffer (digest_<key>_<frame>_<index>.bin) for offline
+  // diffing.  NULL writes nothing.
+  const char* digest_dump_dir;
+  // Time the framework's own work (update, input capture / injection, Track,
+  // Pin, logging) and add its per-frame p50 / p99 / max to the final report.
+  bool profile_overhead;
+  // Optional path of a Chrome trace_event JSON file (chrome://tracing, Perfetto)
+  // with a span per GMT_Update, input capture, injection batch and sync-signal
+  // wait, and the per-frame Track/Pin/Log cost as a counter.  Timestamps are the
+  // QueryPerformanceCounter clock in microseconds.  Implies profile_overhead.
+  const char* trace_path;
+  // GMT_LogMode_DEFERRED (default) hands messages to a background thread, so the
+  // log callback runs on that thread, in order, shortly after each call.  The
+  // format string must stay valid until then (a string literal); %s arguments
+  // are copied.  GMT_LogMode_IMMEDIATE keeps every message synchronous.
+  GMT_LogMode log_mode;
+  // DEFERRED only: bytes of the log ring; 0 uses 256 KB.
+  size_t log_ring_size;
+  // Optional path of a JSON result file (pass/fail, frames, failed assertions)
+  // written when the test fails and again by GMT_Quit.  NULL writes none.
+  const char* result_path;
+  // REPLAY only: name of the pipe GameTest-Tool --pool passes in --test-pool.
+  // The process then stays up after its first test and GMT_PoolNextTest loads
+  // the next one.  NULL (default) runs the single test in test_path.
+  const char* pool_name;
+  // Name of the shared memory GameTest-Tool passes in --test-status.  GMT_Update
+  // publishes the frame, replay progress, sync wait and assertion failures there
+  // for the tool's --progress display and --stall / --timeout limits.  NULL
+  // (default) publishes nothing.
+  const char* status_name;
+  // Bytes of the per-frame scratch arena that GMT_Update resets; 0 uses 64 KB.
+  // Scratch allocations that do not fit go to alloc_callback instead (counted
+  // in the final report).
+  size_t frame_arena_size;
+  // Back the framework's arenas (the frame arena, and the decoded replay data
+  // when the test file is loaded whole).  NULL uses alloc_callback / free_callback.
+  GMT_AllocCallback arena_alloc_callback;
+  GMT_FreeCallback arena_free_callback;
 } GMT_Setup;
 
 // Initializes the framework with the given setup.
@@ -206,17 +336,119 @@ GMT_API void GMT_Update_(void);
 // Also clears the failed-assertion list and resets Pin/Track sequential counters.
 GMT_API void GMT_Reset_(void);
 
+// GMT_Reset, but continues with the test file at test_path (copied; NULL keeps
+// the current one).  A new path also restarts the assertion counters.  Returns
+// false if the file could not be opened or loaded.
+GMT_API bool GMT_ResetTo_(const char* test_path);
+
+// Ends the current test and starts the next one from the GameTest-Tool pool:
+// reports the result, waits for the next test path and loads it (GMT_ResetTo).
+// Returns false when the pool is done, or when not running as a pool worker.
+// Wrap the per-test part of the game in do { ... } while (GMT_PoolNextTest()).
+GMT_API bool GMT_PoolNextTest_(void);
+
 // Immediately fails the current test and invokes the fail callback.
 GMT_API void GMT_Fail_(void);
 
+// True once replay has reached GMT_Setup.replay_end_frame.  Check it after
+// GMT_Update and shut the game down (ending with GMT_Quit) when it is set;
+// checks meant for the end of a full run, such as a final GMT_Track, should
+// be skipped then.  Always false otherwise.
+GMT_API bool GMT_ShouldQuit_(void);
+
+// Virtual clock: seconds since recording started, constant for the whole frame.
+// RECORD returns the time of the last GMT_Update and stores it in the test file;
+// REPLAY returns the recorded value under GMT_ReplayTiming_FRAME, otherwise the
+// replay clock.  Use it instead of wall time so game logic sees the same frame
+// times in record and replay.  Returns 0 when the framework is disabled.
+GMT_API double GMT_GetTime_(void);
+
 #ifndef GMT_DISABLE
-#  define GMT_Update() GMT_Update_()
-#  define GMT_Reset()  GMT_Reset_()
-#  define GMT_Fail()   GMT_Fail_()
+#  define GMT_Update()          GMT_Update_()
+#  define GMT_Reset()           GMT_Reset_()
+#  define GMT_ResetTo(path)     GMT_ResetTo_(path)
+#  define GMT_PoolNextTest()    GMT_PoolNextTest_()
+#  define GMT_Fail()            GMT_Fail_()
+#  define GMT_ShouldQuit()      GMT_ShouldQuit_()
+#  define GMT_GetTime()         GMT_GetTime_()
 #else
-#  define GMT_Update() ((void)0)
-#  define GMT_Reset()  ((void)0)
-#  define GMT_Fail()   ((void)0)
+#  define GMT_Update()          ((void)0)
+#  define GMT_Reset()           ((void)0)
+#  define GMT_ResetTo(path)     (false)
+#  define GMT_PoolNextTest()    (false)
+#  define GMT_Fail()            ((void)0)
+#  define GMT_ShouldQuit()      (false)
+#  define GMT_GetTime()         (0.0)
+#endif
+
+// ===== Virtual input =====
+
+// GMT_InputInjection_VIRTUAL (REPLAY): copies the input replayed for the current
+// frame into *out.  Keys, buttons, cursor and gamepads hold the state of the
+// last record due by this GMT_Update; wheel deltas and key repeats are summed
+// over the records due this frame and zero otherwise.  Returns false, leaving
+// *out untouched, outside virtual replay.
+GMT_API bool GMT_GetVirtualInput_(GMT_InputState* out);
+
+// GMT_InputCapture_VIRTUAL (RECORD): sets the input the next GMT_Update records.
+// Wheel deltas and key repeats count once, for that frame.  Ignored otherwise.
+GMT_API void GMT_SetVirtualInput_(const GMT_InputState* input);
+
+#ifndef GMT_DISABLE
+#  define GMT_GetVirtualInput(out)   GMT_GetVirtualInput_(out)
+#  define GMT_SetVirtualInput(input) GMT_SetVirtualInput_(input)
+#else
+#  define GMT_GetVirtualInput(out)   (false)
+#  define GMT_SetVirtualInput(input) ((void)0)
+#endif
+
+// ===== Contexts =====
+//
+// GMT_Init starts the process-wide default session.  A context is a further,
+// fully independent session: its own test file, record/replay state, clock,
+// Pin/Track counters, assertions, log queue and mutex.  Every GMT_ call made on
+// a thread acts on the context made current on that thread (the default session
+// when none is), so a headless host can replay many test files in parallel,
+// one per worker thread, in a single process:
+//
+//   GMT_Context* ctx = GMT_Context_Create(&setup);  // setup.mode = GMT_Mode_REPLAY
+//   GMT_Context_MakeCurrent(ctx);
+//   while (running) {
+//       GMT_Update();
+//       GMT_GetVirtualInput(&input);
+//       Simulate(&input);  // GMT_Track / GMT_Pin / GMT_Assert as usual
+//   }
+//   GMT_Context_MakeCurrent(NULL);
+//   GMT_Context_Destroy(ctx);
+//
+// Contexts never install hooks, inject OS input or change the working
+// directory: they always use GMT_InputInjection_VIRTUAL and
+// GMT_InputCapture_VIRTUAL.  Set fail_callback, since the default one aborts
+// the whole process.  Threads that make Pin/Track calls for a context must make
+// it current too.
+
+typedef struct GMT_Context GMT_Context;
+
+// Creates a context and starts its session, as GMT_Init does for the default
+// one.  Does not make it current.  Returns NULL (logged) on failure.
+GMT_API GMT_Context* GMT_Context_Create_(const GMT_Setup* setup);
+
+// Ends the context's session, as GMT_Quit does, and frees it.  No thread may
+// have it current or be inside a call on it.
+GMT_API void GMT_Context_Destroy_(GMT_Context* context);
+
+// Makes `context` current on the calling thread; NULL returns the thread to the
+// default session.  Returns the previously current context (NULL = default).
+GMT_API GMT_Context* GMT_Context_MakeCurrent_(GMT_Context* context);
+
+#ifndef GMT_DISABLE
+#  define GMT_Context_Create(setup)        GMT_Context_Create_(setup)
+#  define GMT_Context_Destroy(context)     GMT_Context_Destroy_(context)
+#  define GMT_Context_MakeCurrent(context) GMT_Context_MakeCurrent_(context)
+#else
+#  define GMT_Context_Create(setup)        ((GMT_Context*)NULL)
+#  define GMT_Context_Destroy(context)     ((void)0)
+#  define GMT_Context_MakeCurrent(context) ((GMT_Context*)NULL)
 #endif
 
 // ===== Assertions =====
@@ -228,20 +460,44 @@ GMT_API void GMT_Fail_(void);
 #  define GMT_DOUBLE_EPSILON 0.00000000001
 #endif
 
-GMT_API void GMT_Assert_(bool condition, const char* msg, GMT_CodeLocation loc);  // Internal, use macros below.
+// State of one assertion call site.  Every assert macro expands to its own
+// static instance, so a site is told apart by address instead of by hashing
+// its location, and the location is only looked at when the assertion fails.
+//
+// C forbids a modifiable static inside an inline function with external
+// linkage (C11 6.7.4p3), so an assert in a plain `inline` header function
+// draws a warning.  Define GMT_ASSERT_NO_STATIC_SITES before including this
+// header in such code: the macros then pass no site, and each call is counted
+// by its location instead, at the cost of building it on every call.
+typedef struct GMT_AssertSite {
+  volatile uint32_t generation;  // Last run that counted the site as seen (0 = never).
+} GMT_AssertSite;
+
+GMT_API void GMT_Assert_(GMT_AssertSite* site, bool condition, const char* msg, const char* file, int line, const char* function);  // Internal, use macros below.
 
 #ifndef GMT_DISABLE
 
+// Expands to one assertion with its own static call-site slot.
+#  ifndef GMT_ASSERT_NO_STATIC_SITES
+#    define GMT_ASSERT_SITE_(condition, msg)                                            \
+      do {                                                                              \
+        static GMT_AssertSite gmt_assert_site_;                                         \
+        GMT_Assert_(&gmt_assert_site_, (condition), msg, __FILE__, __LINE__, __func__); \
+      } while (0)
+#  else
+#    define GMT_ASSERT_SITE_(condition, msg) GMT_Assert_(NULL, (condition), msg, __FILE__, __LINE__, __func__)
+#  endif
+
 // Assert macros with a custom message:
-#  define GMT_AssertMsg(condition, msg)      GMT_Assert_(condition, msg, GMT_LOCATION())
-#  define GMT_AssertTrueMsg(condition, msg)  GMT_Assert_((condition), msg, GMT_LOCATION())
-#  define GMT_AssertFalseMsg(condition, msg) GMT_Assert_(!(condition), msg, GMT_LOCATION())
-#  define GMT_AssertEqualMsg(a, b, msg)      GMT_Assert_((a) == (b), msg, GMT_LOCATION())
-#  define GMT_AssertNotEqualMsg(a, b, msg)   GMT_Assert_((a) != (b), msg, GMT_LOCATION())
-#  define GMT_AssertZeroMsg(value, msg)      GMT_Assert_((value) == 0, msg, GMT_LOCATION())
-#  define GMT_AssertNonZeroMsg(value, msg)   GMT_Assert_((value) != 0, msg, GMT_LOCATION())
-#  define GMT_AssertNearFloatMsg(a, b, msg)  GMT_Assert_(fabsf((a) - (b)) < GMT_FLOAT_EPSILON, msg, GMT_LOCATION())
-#  define GMT_AssertNearDoubleMsg(a, b, msg) GMT_Assert_(fabs((a) - (b)) < GMT_DOUBLE_EPSILON, msg, GMT_LOCATION())
+#  define GMT_AssertMsg(condition, msg)      GMT_ASSERT_SITE_(condition, msg)
+#  define GMT_AssertTrueMsg(condition, msg)  GMT_ASSERT_SITE_((condition), msg)
+#  define GMT_AssertFalseMsg(condition, msg) GMT_ASSERT_SITE_(!(condition), msg)
+#  define GMT_AssertEqualMsg(a, b, msg)      GMT_ASSERT_SITE_((a) == (b), msg)
+#  define GMT_AssertNotEqualMsg(a, b, msg)   GMT_ASSERT_SITE_((a) != (b), msg)
+#  define GMT_AssertZeroMsg(value, msg)      GMT_ASSERT_SITE_((value) == 0, msg)
+#  define GMT_AssertNonZeroMsg(value, msg)   GMT_ASSERT_SITE_((value) != 0, msg)
+#  define GMT_AssertNearFloatMsg(a, b, msg)  GMT_ASSERT_SITE_(fabsf((a) - (b)) < GMT_FLOAT_EPSILON, msg)
+#  define GMT_AssertNearDoubleMsg(a, b, msg) GMT_ASSERT_SITE_(fabs((a) - (b)) < GMT_DOUBLE_EPSILON, msg)
 
 // Assert macros with a default message:
 #  define GMT_Assert(condition)      GMT_AssertMsg((condition), "Expected condition to be true: " #condition)
@@ -308,6 +564,39 @@ GMT_API bool GMT_ParseTestFilePath(const char** args, size_t arg_count, char* ou
 // Parses --test-mode=record|replay|disabled from args. Returns false if not found.
 GMT_API bool GMT_ParseTestMode(const char** args, size_t arg_count, GMT_Mode* out_mode);
 
+// Parses --replay-timing=wall|frame from args. Returns false if not found.
+GMT_API bool GMT_ParseReplayTiming(const char** args, size_t arg_count, GMT_ReplayTiming* out_timing);
+
+// Parses --input-injection=send-input|messages|virtual from args. Returns false if not found.
+GMT_API bool GMT_ParseInputInjection(const char** args, size_t arg_count, GMT_InputInjection* out_injection);
+
+// Parses --input-capture=poll|hooks|virtual from args. Returns false if not found.
+GMT_API bool GMT_ParseInputCapture(const char** args, size_t arg_count, GMT_InputCapture* out_capture);
+
+// Parses --input-sample-rate=<hz> from args. Returns false if not found or invalid.
+GMT_API bool GMT_ParseInputSampleRate(const char** args, size_t arg_count, uint32_t* out_rate);
+
+// Parses --replay-start-frame=<frame> from args. Returns false if not found or invalid.
+GMT_API bool GMT_ParseReplayStartFrame(const char** args, size_t arg_count, uint32_t* out_frame);
+
+// Parses --replay-end-frame=<frame> from args. Returns false if not found or invalid.
+GMT_API bool GMT_ParseReplayEndFrame(const char** args, size_t arg_count, uint32_t* out_frame);
+
+// Parses --verify-keyframes from args. Returns false if not found.
+GMT_API bool GMT_ParseVerifyKeyframes(const char** args, size_t arg_count, bool* out_verify);
+
+// Parses --stream-replay from args. Returns false if not found.
+GMT_API bool GMT_ParseStreamReplay(const char** args, size_t arg_count, bool* out_stream);
+
+// Parses --test-result=<path> from args. Returns false if not found.
+GMT_API bool GMT_ParseResultPath(const char** args, size_t arg_count, char* out_path, size_t out_path_size);
+
+// Parses --test-pool=<name> from args. Returns false if not found.
+GMT_API bool GMT_ParseTestPool(const char** args, size_t arg_count, char* out_name, size_t out_name_size);
+
+// Parses --test-status=<name> from args. Returns false if not found.
+GMT_API bool GMT_ParseTestStatus(const char** args, size_t arg_count, char* out_name, size_t out_name_size);
+
 // Parses --headless from args. Returns false if not found.
 GMT_API bool GMT_ParseHeadlessMode(const char** args, size_t arg_count, bool* out_headless);
 
@@ -323,6 +612,78 @@ GMT_API void GMT_PrintReport_(void);
 #  define GMT_PrintReport() ((void)0)
 #endif
 
+// ===== Test Files =====
+//
+// Offline inspection and rewriting of recorded test files, used by
+// GameTest-Tool stats / convert / compact / bisect.  These need no GMT_Init and
+// touch no session state, so different files can be processed on several
+// threads at once.
+
+// Record kinds counted by GMT_TestFileStats.
+typedef enum GMT_TestFileRecord {
+  GMT_TestFileRecord_INPUT = 0,    // TAG_INPUT: a full input snapshot.
+  GMT_TestFileRecord_INPUT_DELTA,  // TAG_INPUT_DELTA: an input snapshot stored as a change.
+  GMT_TestFileRecord_SIGNAL,
+  GMT_TestFileRecord_PIN,
+  GMT_TestFileRecord_TRACK,
+  GMT_TestFileRecord_FRAME,
+  GMT_TestFileRecord_KEYFRAME,
+  GMT_TestFileRecord_COUNT,
+} GMT_TestFileRecord;
+
+typedef struct GMT_TestFileRecordStats {
+  uint64_t count;
+  uint64_t bytes;  // Size in the record stream (tag included), before compression.
+} GMT_TestFileRecordStats;
+
+typedef struct GMT_TestFileStats {
+  uint32_t version;           // Format version from the file header.
+  bool compressed;            // The records are stored in TAG_BLOCKs.
+  bool has_summary;           // The file was closed normally by a version that writes one.
+  bool has_keyframe_index;
+  uint32_t frame_count;       // From the summary, else the last TAG_FRAME (0 before version 3).
+  double duration;            // From the summary, else the last recorded timestamp.
+  uint64_t file_size;         // Bytes on disk.
+  uint64_t stream_size;       // Bytes with every TAG_BLOCK expanded, header and TAG_END included.
+  uint64_t trailer_size;      // Summary and keyframe index, after TAG_END.
+  uint64_t redundant_inputs;  // Input records that repeat the previous state (no wheel or repeats).
+  GMT_TestFileRecordStats records[GMT_TestFileRecord_COUNT];
+} GMT_TestFileStats;
+
+// Whether GMT_RewriteTestFile stores the records in compressed TAG_BLOCKs.
+typedef enum GMT_TestFileCompression {
+  GMT_TestFileCompression_KEEP = 0,  // As the source file does.
+  GMT_TestFileCompression_ON,
+  GMT_TestFileCompression_OFF,
+} GMT_TestFileCompression;
+
+typedef struct GMT_TestFileRewrite {
+  GMT_TestFileCompression compression;
+  bool drop_redundant_inputs;  // Leave out the records counted in GMT_TestFileStats.redundant_inputs.
+} GMT_TestFileRewrite;
+
+// Short name of a record kind ("input", "pin", ...).
+GMT_API const char* GMT_TestFileRecordName(GMT_TestFileRecord kind);
+
+// Walks the test file at `path` and fills *out_stats.  Logs and returns false if
+// it cannot be read or is malformed.
+GMT_API bool GMT_ReadTestFileStats(const char* path, GMT_TestFileStats* out_stats);
+
+// Lists the frames of the keyframes in the test file at `path`, in order: the
+// first `max_frames` go to out_frames (which may be NULL) and *out_count receives
+// how many there are in all.  Logs and returns false if the file cannot be read
+// or is malformed.
+GMT_API bool GMT_ReadTestFileKeyframes(const char* path, uint32_t* out_frames, size_t max_frames, size_t* out_count);
+
+// Writes the test file at `path` to `out_path` (which must differ) in the newest
+// format the source can be expressed in: version 1 files become version 2 and
+// version 3 files version 4, inputs are re-encoded as TAG_INPUT_DELTA where that
+// is smaller, and the keyframe index and summary are rebuilt.  Files older than
+// version 1 keep their version and cannot be compressed.  `options` may be NULL
+// for the defaults.  When `out_stats` is not NULL it receives the stats of the
+// new file.  Logs and returns false on failure, leaving `out_path` incomplete.
+GMT_API bool GMT_RewriteTestFile(const char* path, const char* out_path, const GMT_TestFileRewrite* options, GMT_TestFileStats* out_stats);
+
 // ===== Signals & Sync =====
 
 // Marks a synchronization point for events that take variable time (e.g. loading screens, menu transitions).
@@ -411,6 +772,20 @@ GMT_API void GMT_PinBytes_(unsigned int key, void* data, size_t size, GMT_CodeLo
 #  define GMT_PinBytesAuto(data, size)        ((void)0)
 #endif
 
+// Pins `count` elements of `element_size` bytes as one entry: one record and one lookup
+// for the whole array.
+GMT_API void GMT_PinArray_(unsigned int key, void* data, size_t element_size, size_t count, GMT_CodeLocation loc);
+
+#ifndef GMT_DISABLE
+#  define GMT_PinArray(key, data, element_size, count)       GMT_PinArray_(key, data, element_size, count, GMT_LOCATION())
+#  define GMT_PinArrayString(str, data, element_size, count) GMT_PinArray_((unsigned int)GMT_HashString_(str), data, element_size, count, GMT_LOCATION())
+#  define GMT_PinArrayAuto(data, element_size, count)        GMT_PinArray_((unsigned int)GMT_HashCodeLocation_(GMT_LOCATION()), data, element_size, count, GMT_LOCATION())
+#else
+#  define GMT_PinArray(key, data, element_size, count)       ((void)0)
+#  define GMT_PinArrayString(str, data, element_size, count) ((void)0)
+#  define GMT_PinArrayAuto(data, element_size, count)        ((void)0)
+#endif
+
 // ===== Track =====
 
 // Tracks a variable and verifies it matches the recorded value during replay.
@@ -439,44 +814,106 @@ GMT_API void GMT_TrackDouble_(unsigned int key, double value, GMT_CodeLocation l
 GMT_API void GMT_TrackBool_(unsigned int key, bool value, GMT_CodeLocation loc);
 GMT_API void GMT_TrackBytes_(unsigned int key, const void* data, size_t size, GMT_CodeLocation loc);
 
+// Tracks a buffer by its 64-bit hash (and size) instead of its contents, so
+// several MB of simulation state can be checked every frame at 16 bytes per
+// call in the test file.  Replay reports a mismatch like the other Track calls
+// (the recorded and current hashes are logged, not the data) and, with
+// GMT_Setup.digest_dump_dir, writes the first mismatching buffer to disk.
+// Shares keys and sequential indices with the other Track calls.
+GMT_API void GMT_TrackDigest_(unsigned int key, const void* data, size_t size, GMT_CodeLocation loc);
+
 #ifndef GMT_DISABLE
-#  define GMT_TrackInt(key, value)              GMT_TrackInt_(key, value, GMT_LOCATION())
-#  define GMT_TrackIntString(str, value)        GMT_TrackInt_((unsigned int)GMT_HashString_(str), value, GMT_LOCATION())
-#  define GMT_TrackIntAuto(value)               GMT_TrackInt_((unsigned int)GMT_HashCodeLocation_(GMT_LOCATION()), value, GMT_LOCATION())
-#  define GMT_TrackUInt(key, value)             GMT_TrackUInt_(key, value, GMT_LOCATION())
-#  define GMT_TrackUIntString(str, value)       GMT_TrackUInt_((unsigned int)GMT_HashString_(str), value, GMT_LOCATION())
-#  define GMT_TrackUIntAuto(value)              GMT_TrackUInt_((unsigned int)GMT_HashCodeLocation_(GMT_LOCATION()), value, GMT_LOCATION())
-#  define GMT_TrackFloat(key, value)            GMT_TrackFloat_(key, value, GMT_LOCATION())
-#  define GMT_TrackFloatString(str, value)      GMT_TrackFloat_((unsigned int)GMT_HashString_(str), value, GMT_LOCATION())
-#  define GMT_TrackFloatAuto(value)             GMT_TrackFloat_((unsigned int)GMT_HashCodeLocation_(GMT_LOCATION()), value, GMT_LOCATION())
-#  define GMT_TrackDouble(key, value)           GMT_TrackDouble_(key, value, GMT_LOCATION())
-#  define GMT_TrackDoubleString(str, value)     GMT_TrackDouble_((unsigned int)GMT_HashString_(str), value, GMT_LOCATION())
-#  define GMT_TrackDoubleAuto(value)            GMT_TrackDouble_((unsigned int)GMT_HashCodeLocation_(GMT_LOCATION()), value, GMT_LOCATION())
-#  define GMT_TrackBool(key, value)             GMT_TrackBool_(key, value, GMT_LOCATION())
-#  define GMT_TrackBoolString(str, value)       GMT_TrackBool_((unsigned int)GMT_HashString_(str), value, GMT_LOCATION())
-#  define GMT_TrackBoolAuto(value)              GMT_TrackBool_((unsigned int)GMT_HashCodeLocation_(GMT_LOCATION()), value, GMT_LOCATION())
-#  define GMT_TrackBytes(key, data, size)       GMT_TrackBytes_(key, data, size, GMT_LOCATION())
-#  define GMT_TrackBytesString(str, data, size) GMT_TrackBytes_((unsigned int)GMT_HashString_(str), data, size, GMT_LOCATION())
-#  define GMT_TrackBytesAuto(data, size)        GMT_TrackBytes_((unsigned int)GMT_HashCodeLocation_(GMT_LOCATION()), data, size, GMT_LOCATION())
+#  define GMT_TrackInt(key, value)               GMT_TrackInt_(key, value, GMT_LOCATION())
+#  define GMT_TrackIntString(str, value)         GMT_TrackInt_((unsigned int)GMT_HashString_(str), value, GMT_LOCATION())
+#  define GMT_TrackIntAuto(value)                GMT_TrackInt_((unsigned int)GMT_HashCodeLocation_(GMT_LOCATION()), value, GMT_LOCATION())
+#  define GMT_TrackUInt(key, value)              GMT_TrackUInt_(key, value, GMT_LOCATION())
+#  define GMT_TrackUIntString(str, value)        GMT_TrackUInt_((unsigned int)GMT_HashString_(str), value, GMT_LOCATION())
+#  define GMT_TrackUIntAuto(value)               GMT_TrackUInt_((unsigned int)GMT_HashCodeLocation_(GMT_LOCATION()), value, GMT_LOCATION())
+#  define GMT_TrackFloat(key, value)             GMT_TrackFloat_(key, value, GMT_LOCATION())
+#  define GMT_TrackFloatString(str, value)       GMT_TrackFloat_((unsigned int)GMT_HashString_(str), value, GMT_LOCATION())
+#  define GMT_TrackFloatAuto(value)              GMT_TrackFloat_((unsigned int)GMT_HashCodeLocation_(GMT_LOCATION()), value, GMT_LOCATION())
+#  define GMT_TrackDouble(key, value)            GMT_TrackDouble_(key, value, GMT_LOCATION())
+#  define GMT_TrackDoubleString(str, value)      GMT_TrackDouble_((unsigned int)GMT_HashString_(str), value, GMT_LOCATION())
+#  define GMT_TrackDoubleAuto(value)             GMT_TrackDouble_((unsigned int)GMT_HashCodeLocation_(GMT_LOCATION()), value, GMT_LOCATION())
+#  define GMT_TrackBool(key, value)              GMT_TrackBool_(key, value, GMT_LOCATION())
+#  define GMT_TrackBoolString(str, value)        GMT_TrackBool_((unsigned int)GMT_HashString_(str), value, GMT_LOCATION())
+#  define GMT_TrackBoolAuto(value)               GMT_TrackBool_((unsigned int)GMT_HashCodeLocation_(GMT_LOCATION()), value, GMT_LOCATION())
+#  define GMT_TrackBytes(key, data, size)        GMT_TrackBytes_(key, data, size, GMT_LOCATION())
+#  define GMT_TrackBytesString(str, data, size)  GMT_TrackBytes_((unsigned int)GMT_HashString_(str), data, size, GMT_LOCATION())
+#  define GMT_TrackBytesAuto(data, size)         GMT_TrackBytes_((unsigned int)GMT_HashCodeLocation_(GMT_LOCATION()), data, size, GMT_LOCATION())
+#  define GMT_TrackDigest(key, data, size)       GMT_TrackDigest_(key, data, size, GMT_LOCATION())
+#  define GMT_TrackDigestString(str, data, size) GMT_TrackDigest_((unsigned int)GMT_HashString_(str), data, size, GMT_LOCATION())
+#  define GMT_TrackDigestAuto(data, size)        GMT_TrackDigest_((unsigned int)GMT_HashCodeLocation_(GMT_LOCATION()), data, size, GMT_LOCATION())
 #else
-#  define GMT_TrackInt(key, value)              ((void)0)
-#  define GMT_TrackIntString(str, value)        ((void)0)
-#  define GMT_TrackIntAuto(value)               ((void)0)
-#  define GMT_TrackUInt(key, value)             ((void)0)
-#  define GMT_TrackUIntString(str, value)       ((void)0)
-#  define GMT_TrackUIntAuto(value)              ((void)0)
-#  define GMT_TrackFloat(key, value)            ((void)0)
-#  define GMT_TrackFloatString(str, value)      ((void)0)
-#  define GMT_TrackFloatAuto(value)             ((void)0)
-#  define GMT_TrackDouble(key, value)           ((void)0)
-#  define GMT_TrackDoubleString(str, value)     ((void)0)
-#  define GMT_TrackDoubleAuto(value)            ((void)0)
-#  define GMT_TrackBool(key, value)             ((void)0)
-#  define GMT_TrackBoolString(str, value)       ((void)0)
-#  define GMT_TrackBoolAuto(value)              ((void)0)
-#  define GMT_TrackBytes(key, data, size)       ((void)0)
-#  define GMT_TrackBytesString(str, data, size) ((void)0)
-#  define GMT_TrackBytesAuto(data, size)        ((void)0)
+#  define GMT_TrackInt(key, value)               ((void)0)
+#  define GMT_TrackIntString(str, value)         ((void)0)
+#  define GMT_TrackIntAuto(value)                ((void)0)
+#  define GMT_TrackUInt(key, value)              ((void)0)
+#  define GMT_TrackUIntString(str, value)        ((void)0)
+#  define GMT_TrackUIntAuto(value)               ((void)0)
+#  define GMT_TrackFloat(key, value)             ((void)0)
+#  define GMT_TrackFloatString(str, value)       ((void)0)
+#  define GMT_TrackFloatAuto(value)              ((void)0)
+#  define GMT_TrackDouble(key, value)            ((void)0)
+#  define GMT_TrackDoubleString(str, value)      ((void)0)
+#  define GMT_TrackDoubleAuto(value)             ((void)0)
+#  define GMT_TrackBool(key, value)              ((void)0)
+#  define GMT_TrackBoolString(str, value)        ((void)0)
+#  define GMT_TrackBoolAuto(value)               ((void)0)
+#  define GMT_TrackBytes(key, data, size)        ((void)0)
+#  define GMT_TrackBytesString(str, data, size)  ((void)0)
+#  define GMT_TrackBytesAuto(data, size)         ((void)0)
+#  define GMT_TrackDigest(key, data, size)       ((void)0)
+#  define GMT_TrackDigestString(str, data, size) ((void)0)
+#  define GMT_TrackDigestAuto(data, size)        ((void)0)
+#endif
+
+// Batches: one record and one lookup for many values.  A replay mismatch logs the
+// first 8 differing values and fails one assertion for the whole call.
+
+// Tracks `count` floats, each compared within GMT_FLOAT_EPSILON.
+GMT_API void GMT_TrackFloatArray_(unsigned int key, const float* values, size_t count, GMT_CodeLocation loc);
+
+// Type of a struct member tracked by GMT_TrackStruct.
+typedef enum GMT_FieldType {
+  GMT_FieldType_INT = 0,  // int32_t, exact.
+  GMT_FieldType_UINT,     // uint32_t, exact.
+  GMT_FieldType_FLOAT,    // float, within GMT_FLOAT_EPSILON.
+  GMT_FieldType_DOUBLE,   // double, within GMT_DOUBLE_EPSILON.
+  GMT_FieldType_BOOL,     // bool, exact.
+  GMT_FieldType_BYTES,    // Any size, memcmp.
+} GMT_FieldType;
+
+// Describes one tracked member; build a table of them with GMT_FIELD.
+typedef struct GMT_Field {
+  const char* name;  // Shown in mismatch reports.
+  GMT_FieldType type;
+  size_t offset;  // Byte offset inside the struct.
+  size_t size;    // Byte size; must match the type except for GMT_FieldType_BYTES.
+} GMT_Field;
+
+#define GMT_FIELD(type, member, field_type) {#member, field_type, offsetof(type, member), sizeof(((type*)0)->member)}
+
+// Tracks the listed fields of `count` structs laid out `stride` bytes apart.
+// Only those fields are stored, so padding and untracked members are ignored.
+//   static const GMT_Field fields[] = {GMT_FIELD(Entity, x, GMT_FieldType_FLOAT), GMT_FIELD(Entity, hp, GMT_FieldType_INT)};
+//   GMT_TrackStructAuto(entities, sizeof(Entity), entity_count, fields, 2);
+GMT_API void GMT_TrackStruct_(unsigned int key, const void* elements, size_t stride, size_t count, const GMT_Field* fields, size_t field_count, GMT_CodeLocation loc);
+
+#ifndef GMT_DISABLE
+#  define GMT_TrackFloatArray(key, values, count)                                  GMT_TrackFloatArray_(key, values, count, GMT_LOCATION())
+#  define GMT_TrackFloatArrayString(str, values, count)                            GMT_TrackFloatArray_((unsigned int)GMT_HashString_(str), values, count, GMT_LOCATION())
+#  define GMT_TrackFloatArrayAuto(values, count)                                   GMT_TrackFloatArray_((unsigned int)GMT_HashCodeLocation_(GMT_LOCATION()), values, count, GMT_LOCATION())
+#  define GMT_TrackStruct(key, elements, stride, count, fields, field_count)       GMT_TrackStruct_(key, elements, stride, count, fields, field_count, GMT_LOCATION())
+#  define GMT_TrackStructString(str, elements, stride, count, fields, field_count) GMT_TrackStruct_((unsigned int)GMT_HashString_(str), elements, stride, count, fields, field_count, GMT_LOCATION())
+#  define GMT_TrackStructAuto(elements, stride, count, fields, field_count)        GMT_TrackStruct_((unsigned int)GMT_HashCodeLocation_(GMT_LOCATION()), elements, stride, count, fields, field_count, GMT_LOCATION())
+#else
+#  define GMT_TrackFloatArray(key, values, count)                                  ((void)0)
+#  define GMT_TrackFloatArrayString(str, values, count)                            ((void)0)
+#  define GMT_TrackFloatArrayAuto(values, count)                                   ((void)0)
+#  define GMT_TrackStruct(key, elements, stride, count, fields, field_count)       ((void)0)
+#  define GMT_TrackStructString(str, elements, stride, count, fields, field_count) ((void)0)
+#  define GMT_TrackStructAuto(elements, stride, count, fields, field_count)        ((void)0)
 #endif
 
 // ===== Details =====
@@ -533,6 +970,9 @@ GMT_API void GMT_TrackBytes_(unsigned int key, const void* data, size_t size, GM
 // the recording) and are delta-compressed: if the input state is identical to
 // the previous frame, no record is written. This means held keys do not inflate
 // the file — only transitions (press, release, position change, etc.) appear.
+// A record that is written stores only the fields that changed since the
+// previous one (changed-key bitmap, varint mouse and stick deltas). Setting
+// GMT_Setup.compress_test_file additionally compresses the file in blocks.
 //
 // Fast key taps that start and end between two GMT_Update() calls are caught
 // by the platform layer, which writes an extra input record on each key
@@ -551,11 +991,17 @@ GMT_API void GMT_TrackBytes_(unsigned int key, const void* data, size_t size, GM
 //       "batch limit (64) reached; input records deferred to next frame"
 //     Remedy: call GMT_Update() every frame without skipping.
 //
-//   Pin / Track payload cap (GMT_MAX_DATA_RECORD_PAYLOAD = 256 bytes)
-//     A single GMT_PinBytes / GMT_TrackBytes call may not exceed 256 bytes.
-//     Calls that exceed this limit are silently skipped and an error is logged.
-//     Remedy: split large structures into smaller pinned fields, or store a
-//     hash / checksum and pin that instead.
+//   Pin / Track payload cap (GMT_Setup.max_payload_size, 64 KB by default)
+//     A single GMT_Pin* / GMT_Track* call may not exceed max_payload_size bytes
+//     (at most 16 MB). Calls that exceed this limit are skipped and an error is
+//     logged. Remedy: raise max_payload_size, or store a hash / checksum of the
+//     structure and pin that instead.
+//
+//   Distinct keys per frame (4096 Pin keys and 4096 Track keys)
+//     Further keys in the same frame all get sequential index 0, so repeated
+//     calls with them no longer line up. A warning is logged once per run.
+//     Remedy: use the batch calls (GMT_TrackFloatArray, GMT_TrackStruct,
+//     GMT_PinArray) for large sets of values.
 //
 //   Gamepad slot cap (GMT_MAX_GAMEPADS = 4)
 //     Only the first 4 gamepad slots are captured. A 5th controller is never
@@ -0,0 +1,104 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Arena.h"
+#include <string.h>
+#include "Atomic.h"
+#include "Internal.h"
+
+static void* GMT__ArenaBackingAlloc(size_t size) {
+  GMT_AllocCallback cb = g_gmt.setup.arena_alloc_callback;
+  if (cb) return cb(size, GMT_LOCATION());
+  return GMT_Alloc(size);
+}
+
+static void GMT__ArenaBackingFree(void* ptr) {
+  GMT_FreeCallback cb = g_gmt.setup.arena_free_callback;
+  if (cb) {
+    cb(ptr, GMT_LOCATION());
+    return;
+  }
+  GMT_Free(ptr);
+}
+
+bool GMT_Arena_Init(GMT_Arena* a, size_t capacity) {
+  memset(a, 0, sizeof(*a));
+  if (capacity == 0) return true;
+  // Over-allocated so that base is aligned whatever the backing allocator returns.
+  a->block = GMT__ArenaBackingAlloc(capacity + GMT_ARENA_ALIGNMENT - 1);
+  if (!a->block) return false;
+  uintptr_t start = ((uintptr_t)a->block + (GMT_ARENA_ALIGNMENT - 1)) & ~(uintptr_t)(GMT_ARENA_ALIGNMENT - 1);
+  a->base = (uint8_t*)start;
+  a->capacity = capacity;
+  return true;
+}
+
+void GMT_Arena_Free(GMT_Arena* a) {
+  if (!a->block) return;
+  GMT__ArenaBackingFree(a->block);
+  a->block = NULL;
+  a->base = NULL;
+  a->used = 0;
+  a->live = 0;
+}
+
+void* GMT_Arena_Alloc(GMT_Arena* a, size_t size) {
+  if (!a->base) return NULL;
+  uint64_t need = (uint64_t)GMT_Arena_Footprint(size);
+  // Counted live before the bump so that a concurrent Reset either sees it
+  // or fails its own CAS on `used`.
+  GMT_Atomic_Add32(&a->live, 1);
+  for (;;) {
+    uint64_t used = GMT_Atomic_Load64(&a->used);
+    if (need > (uint64_t)a->capacity - used) break;
+    if (GMT_Atomic_CompareExchange64(&a->used, used, used + need)) {
+      GMT_Atomic_Add64(&a->alloc_count, 1);
+      uint64_t peak = GMT_Atomic_Load64(&a->peak);
+      while (used + need > peak && !GMT_Atomic_CompareExchange64(&a->peak, peak, used + need)) {
+        peak = GMT_Atomic_Load64(&a->peak);
+      }
+      return a->base + used;
+    }
+  }
+  GMT_Atomic_Add32(&a->live, (uint32_t)-1);
+  GMT_Atomic_Add64(&a->overflow_count, 1);
+  return NULL;
+}
+
+void GMT_Arena_Release(GMT_Arena* a) {
+  GMT_Atomic_Add32(&a->live, (uint32_t)-1);
+}
+
+void GMT_Arena_Reset(GMT_Arena* a) {
+  if (!a->base) return;
+  uint64_t used = GMT_Atomic_Load64(&a->used);
+  if (used == 0 || GMT_Atomic_Load32(&a->live) != 0) return;
+  // Fails if an allocation slipped in after the check; the next reset gets it.
+  GMT_Atomic_CompareExchange64(&a->used, used, 0);
+}
+
+bool GMT_Arena_Owns(const GMT_Arena* a, const void* ptr) {
+  const uint8_t* p = (const uint8_t*)ptr;
+  return a->base && p >= a->base && p < a->base + a->capacity;
+}
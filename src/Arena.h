@@ -0,0 +1,78 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Bump allocator over one block taken from GMT_Setup.arena_alloc_callback
+// (or the regular allocation callbacks).  Allocation is lock-free, so any
+// thread may allocate.  Memory is reclaimed only by Reset, which does nothing
+// while an allocation is still live (not yet passed to Release), so scratch
+// memory handed out on one thread survives a reset from another.  Free must
+// not run concurrently with anything else.
+
+#define GMT_ARENA_ALIGNMENT 16
+
+typedef struct GMT_Arena {
+  void* block;       // As returned by the backing allocator.
+  uint8_t* base;     // First aligned byte of block.
+  size_t capacity;   // Usable bytes from base.
+  volatile uint64_t used;  // Bump offset from base; advanced with a CAS.
+  volatile uint32_t live;  // Allocations not yet released.
+
+  // Statistics.  Kept by GMT_Arena_Free so the final report can show them.
+  volatile uint64_t peak;            // Largest `used` ever reached.
+  volatile uint64_t alloc_count;     // Allocations served from the arena.
+  volatile uint64_t overflow_count;  // Allocations that did not fit.
+} GMT_Arena;
+
+// Takes a block of `capacity` bytes for the arena.  Returns false (with *a
+// zeroed) if the backing allocation fails.
+bool GMT_Arena_Init(GMT_Arena* a, size_t capacity);
+
+// Returns the block to the backing allocator.  The statistics stay readable.
+void GMT_Arena_Free(GMT_Arena* a);
+
+// Returns `size` bytes aligned to GMT_ARENA_ALIGNMENT, or NULL if the arena
+// is not set up or too full (the latter counted in overflow_count).
+void* GMT_Arena_Alloc(GMT_Arena* a, size_t size);
+
+// Marks one allocation as no longer in use.  The memory itself stays
+// reserved until the next successful Reset.
+void GMT_Arena_Release(GMT_Arena* a);
+
+// Reclaims every allocation at once, unless one is still live.
+void GMT_Arena_Reset(GMT_Arena* a);
+
+// Returns true if ptr lies inside the arena's block.
+bool GMT_Arena_Owns(const GMT_Arena* a, const void* ptr);
+
+// Bytes an allocation of `size` takes up in an arena.
+static inline size_t GMT_Arena_Footprint(size_t size) {
+  if (size == 0) return GMT_ARENA_ALIGNMENT;
+  return (size + (GMT_ARENA_ALIGNMENT - 1)) & ~(size_t)(GMT_ARENA_ALIGNMENT - 1);
+}
@@ -25,38 +25,83 @@ SOFTWARE.
 #include "Internal.h"
 #include <string.h>
 
-// Insert a code-location hash into the seen-locations open-addressing hash set.
-// Must be called with the mutex held.
-static void GMT_TrackAssertionSite_(int hash) {
-  unsigned int idx = (unsigned int)((uint32_t)hash) % GMT_MAX_UNIQUE_ASSERTIONS;
-  for (size_t i = 0; i < GMT_MAX_UNIQUE_ASSERTIONS; ++i) {
-    unsigned int slot = (idx + (unsigned int)i) % GMT_MAX_UNIQUE_ASSERTIONS;
-    if (!g_gmt.seen_assertion_occupied[slot]) {
-      g_gmt.seen_assertion_hashes[slot] = hash;
-      g_gmt.seen_assertion_occupied[slot] = true;
-      g_gmt.unique_assertion_count++;
-      return;
+// Last generation handed out.  Each assertion run (GMT_Init, GMT_Context_Create,
+// GMT_ClearFailedAssertions) takes a new one for g_gmt.assert_generation (never
+// 0, the value of a site that has never run).  A site remembers the last run
+// that counted it, which is only a shortcut: the state's own table of sites
+// decides, so contexts running at the same time each count every site once.
+// The table holds site addresses, and location hashes tagged in the low bit
+// for checks that have no site of their own (GMT_Assert_Location).
+static volatile uint32_t g_gmt_assert_generation = 1;
+
+void GMT_Assert_ResetSites(void) {
+  uint32_t next = GMT_Atomic_Add32(&g_gmt_assert_generation, 1);
+  if (next == 0) next = GMT_Atomic_Add32(&g_gmt_assert_generation, 1);
+  g_gmt.assert_generation = next;
+  if (g_gmt.assert_sites) memset(g_gmt.assert_sites, 0, g_gmt.assert_site_capacity * sizeof(*g_gmt.assert_sites));
+  g_gmt.assert_site_count = 0;
+}
+
+void GMT_Assert_FreeSites(void) {
+  if (g_gmt.assert_sites) GMT_Free(g_gmt.assert_sites);
+  g_gmt.assert_sites = NULL;
+  g_gmt.assert_site_capacity = 0;
+  g_gmt.assert_site_count = 0;
+}
+
+static size_t GMT__SiteSlot(uintptr_t key, size_t capacity) {
+  uint64_t h = (uint64_t)key * 0x9E3779B97F4A7C15ull;
+  return (size_t)(h >> 32) & (capacity - 1);
+}
+
+// Adds the site key to the state's table; false if it was already there.
+// Called with the mutex held.  The table stays at most half full.
+static bool GMT__InsertSite(uintptr_t key) {
+  if ((g_gmt.assert_site_count + 1) * 2 > g_gmt.assert_site_capacity) {
+    size_t capacity = g_gmt.assert_site_capacity ? g_gmt.assert_site_capacity * 2 : 256;
+    uintptr_t* sites = (uintptr_t*)GMT_Alloc(capacity * sizeof(*sites));
+    if (!sites) {
+      // Without room to remember it, count the site; its generation keeps this
+      // run from counting it again unless another context runs it in between.
+      return true;
     }
-    if (g_gmt.seen_assertion_hashes[slot] == hash) {
-      return;  // Already tracked.
+    memset(sites, 0, capacity * sizeof(*sites));
+    for (size_t i = 0; i < g_gmt.assert_site_capacity; ++i) {
+      uintptr_t s = g_gmt.assert_sites[i];
+      if (!s) continue;
+      size_t j = GMT__SiteSlot(s, capacity);
+      while (sites[j]) j = (j + 1) & (capacity - 1);
+      sites[j] = s;
     }
+    if (g_gmt.assert_sites) GMT_Free(g_gmt.assert_sites);
+    g_gmt.assert_sites = sites;
+    g_gmt.assert_site_capacity = capacity;
+  }
+
+  size_t i = GMT__SiteSlot(key, g_gmt.assert_site_capacity);
+  while (g_gmt.assert_sites[i]) {
+    if (g_gmt.assert_sites[i] == key) return false;
+    i = (i + 1) & (g_gmt.assert_site_capacity - 1);
   }
-  // Set is full; saturate silently.
+  g_gmt.assert_sites[i] = key;
+  g_gmt.assert_site_count++;
+  return true;
 }
 
-void GMT_Assert_(bool condition, const char* msg, GMT_CodeLocation loc) {
-  if (!g_gmt.initialized || g_gmt.mode == GMT_Mode_DISABLED) return;
+// Strips the directory from __FILE__, as GMT_LOCATION does.
+static const char* GMT__BaseName(const char* path) {
+  const char* base = path;
+  for (const char* p = path; *p; ++p) {
+    if (*p == '\\' || *p == '/') base = p + 1;
+  }
+  return base;
+}
 
+// Records a failed assertion, then runs the trigger callback and fails the test
+// once the trigger count is reached.
+static void GMT__AssertFailed(const char* msg, GMT_CodeLocation loc) {
   GMT_Platform_MutexLock();
 
-  g_gmt.total_assertion_count++;
-  GMT_TrackAssertionSite_(GMT_HashCodeLocation_(loc));
-
-  if (condition) {
-    GMT_Platform_MutexUnlock();
-    return;
-  }
-
   g_gmt.assertion_fire_count++;
 
   // Store the failed assertion (bounded by GMT_MAX_FAILED_ASSERTIONS).
@@ -87,9 +132,9 @@ void GMT_Assert_(bool condition, const char* msg, GMT_CodeLocation loc) {
     // open a dialog (e.g. a custom assert popup) that needs real keyboard/mouse
     // input.  Re-enable afterwards only if replay is still running and the test
     // was not already failed by the callback itself.
-    GMT_Platform_SetReplayHooksActive(false);
+    if (!g_gmt.context) GMT_Platform_SetReplayHooksActive(false);
     trigger_cb(a);
-    if (g_gmt.mode == GMT_Mode_REPLAY && !g_gmt.test_failed) {
+    if (!g_gmt.context && g_gmt.mode == GMT_Mode_REPLAY && !g_gmt.test_failed) {
       GMT_Platform_SetReplayHooksActive(true);
     }
   }
@@ -101,6 +146,46 @@ void GMT_Assert_(bool condition, const char* msg, GMT_CodeLocation loc) {
   }
 }
 
+// Counts a check that has no GMT_AssertSite, keyed by its location.
+static void GMT__CountLocation(GMT_CodeLocation loc) {
+  GMT_Atomic_Add64(&g_gmt.total_assertion_count, 1);
+  uintptr_t key = ((uintptr_t)(uint32_t)GMT_HashCodeLocation_(loc) << 1) | 1;
+  GMT_Platform_MutexLock();
+  if (GMT__InsertSite(key)) GMT_Atomic_Add64(&g_gmt.unique_assertion_count, 1);
+  GMT_Platform_MutexUnlock();
+}
+
+void GMT_Assert_(GMT_AssertSite* site, bool condition, const char* msg, const char* file, int line, const char* function) {
+  if (!g_gmt.initialized || g_gmt.mode == GMT_Mode_DISABLED) return;
+
+  // GMT_ASSERT_NO_STATIC_SITES: no site, so the location is built on every call.
+  if (!site) {
+    GMT_CodeLocation loc = GMT_MakeLocation_(GMT__BaseName(file), line, function);
+    GMT__CountLocation(loc);
+    if (!condition) GMT__AssertFailed(msg, loc);
+    return;
+  }
+
+  // Passing asserts touch one counter, plus the site the first time it runs.
+  GMT_Atomic_Add64(&g_gmt.total_assertion_count, 1);
+  uint32_t generation = g_gmt.assert_generation;
+  if (GMT_Atomic_Load32(&site->generation) != generation) {
+    GMT_Platform_MutexLock();
+    if (GMT__InsertSite((uintptr_t)site)) GMT_Atomic_Add64(&g_gmt.unique_assertion_count, 1);
+    GMT_Atomic_Store32(&site->generation, generation);
+    GMT_Platform_MutexUnlock();
+  }
+
+  if (condition) return;
+  GMT__AssertFailed(msg, GMT_MakeLocation_(GMT__BaseName(file), line, function));
+}
+
+void GMT_Assert_Location(const char* msg, GMT_CodeLocation loc) {
+  if (!g_gmt.initialized || g_gmt.mode == GMT_Mode_DISABLED) return;
+  GMT__CountLocation(loc);
+  GMT__AssertFailed(msg, loc);
+}
+
 bool GMT_GetFailedAssertions_(GMT_Assertion* out_assertions, size_t max_assertions, size_t* out_count) {
   if (!out_count) return false;
   if (g_gmt.mode == GMT_Mode_DISABLED) {
@@ -126,8 +211,8 @@ void GMT_ClearFailedAssertions_(void) {
   GMT_Platform_MutexLock();
   g_gmt.failed_assertion_count = 0;
   g_gmt.assertion_fire_count = 0;
-  g_gmt.total_assertion_count = 0;
-  g_gmt.unique_assertion_count = 0;
-  memset(g_gmt.seen_assertion_occupied, 0, sizeof(g_gmt.seen_assertion_occupied));
+  GMT_Atomic_Store64(&g_gmt.total_assertion_count, 0);
+  GMT_Atomic_Store64(&g_gmt.unique_assertion_count, 0);
+  GMT_Assert_ResetSites();
   GMT_Platform_MutexUnlock();
 }
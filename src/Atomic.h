@@ -0,0 +1,99 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Minimal sequentially-consistent atomics on 32- and 64-bit integers, used for
+// state shared between the game threads and framework-owned threads.
+// MSVC maps to the Interlocked intrinsics; GCC/Clang to the __atomic builtins.
+
+#if defined(_MSC_VER)
+#  include <intrin.h>
+
+static inline uint32_t GMT_Atomic_Load32(volatile uint32_t* p) {
+  return (uint32_t)_InterlockedCompareExchange((volatile long*)p, 0, 0);
+}
+static inline void GMT_Atomic_Store32(volatile uint32_t* p, uint32_t v) {
+  _InterlockedExchange((volatile long*)p, (long)v);
+}
+static inline uint32_t GMT_Atomic_Add32(volatile uint32_t* p, uint32_t v) {  // Returns the new value.
+  return (uint32_t)_InterlockedExchangeAdd((volatile long*)p, (long)v) + v;
+}
+static inline bool GMT_Atomic_CompareExchange32(volatile uint32_t* p, uint32_t expected, uint32_t desired) {
+  return (uint32_t)_InterlockedCompareExchange((volatile long*)p, (long)desired, (long)expected) == expected;
+}
+static inline uint64_t GMT_Atomic_Load64(volatile uint64_t* p) {
+  return (uint64_t)_InterlockedCompareExchange64((volatile __int64*)p, 0, 0);
+}
+static inline void GMT_Atomic_Store64(volatile uint64_t* p, uint64_t v) {
+  __int64 old = *(volatile __int64*)p;
+  for (;;) {
+    __int64 seen = _InterlockedCompareExchange64((volatile __int64*)p, (__int64)v, old);
+    if (seen == old) return;
+    old = seen;
+  }
+}
+static inline bool GMT_Atomic_CompareExchange64(volatile uint64_t* p, uint64_t expected, uint64_t desired) {
+  return (uint64_t)_InterlockedCompareExchange64((volatile __int64*)p, (__int64)desired, (__int64)expected) == expected;
+}
+static inline uint64_t GMT_Atomic_Add64(volatile uint64_t* p, uint64_t v) {  // Returns the new value.
+  __int64 old = *(volatile __int64*)p;
+  for (;;) {
+    __int64 seen = _InterlockedCompareExchange64((volatile __int64*)p, old + (__int64)v, old);
+    if (seen == old) return (uint64_t)old + v;
+    old = seen;
+  }
+}
+
+#else
+
+static inline uint32_t GMT_Atomic_Load32(volatile uint32_t* p) {
+  return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+}
+static inline void GMT_Atomic_Store32(volatile uint32_t* p, uint32_t v) {
+  __atomic_store_n(p, v, __ATOMIC_SEQ_CST);
+}
+static inline uint32_t GMT_Atomic_Add32(volatile uint32_t* p, uint32_t v) {  // Returns the new value.
+  return __atomic_add_fetch(p, v, __ATOMIC_SEQ_CST);
+}
+static inline bool GMT_Atomic_CompareExchange32(volatile uint32_t* p, uint32_t expected, uint32_t desired) {
+  return __atomic_compare_exchange_n(p, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+static inline uint64_t GMT_Atomic_Load64(volatile uint64_t* p) {
+  return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+}
+static inline void GMT_Atomic_Store64(volatile uint64_t* p, uint64_t v) {
+  __atomic_store_n(p, v, __ATOMIC_SEQ_CST);
+}
+static inline bool GMT_Atomic_CompareExchange64(volatile uint64_t* p, uint64_t expected, uint64_t desired) {
+  return __atomic_compare_exchange_n(p, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+static inline uint64_t GMT_Atomic_Add64(volatile uint64_t* p, uint64_t v) {  // Returns the new value.
+  return __atomic_add_fetch(p, v, __ATOMIC_SEQ_CST);
+}
+
+#endif
@@ -0,0 +1,161 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Compress.h"
+#include <string.h>
+
+#define GMT__COMPRESS_HASH_BITS  12
+#define GMT__COMPRESS_MIN_MATCH  4
+#define GMT__COMPRESS_MAX_OFFSET 65535u
+// Matches never cover the last bytes of the input, which keeps the final
+// literals-only pair non-empty and the match loop free of end checks.
+#define GMT__COMPRESS_TAIL 5
+
+static uint32_t GMT__Read32(const uint8_t* p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static uint32_t GMT__HashSeq(uint32_t seq) {
+  return (seq * 2654435761u) >> (32 - GMT__COMPRESS_HASH_BITS);
+}
+
+// Writes a length extension for a nibble that saturated at 15.
+static uint8_t* GMT__PutLength(uint8_t* op, const uint8_t* oend, size_t len) {
+  while (len >= 255) {
+    if (op >= oend) return NULL;
+    *op++ = 255;
+    len -= 255;
+  }
+  if (op >= oend) return NULL;
+  *op++ = (uint8_t)len;
+  return op;
+}
+
+static bool GMT__GetLength(const uint8_t** ip, const uint8_t* iend, size_t* len) {
+  uint8_t b;
+  do {
+    if (*ip >= iend) return false;
+    b = *(*ip)++;
+    *len += b;
+  } while (b == 255);
+  return true;
+}
+
+// Emits one (literals, match) pair; match_len == 0 emits the final literals-only pair.
+static uint8_t* GMT__PutSequence(uint8_t* op, const uint8_t* oend, const uint8_t* lit, size_t lit_len,
+                                 size_t offset, size_t match_len) {
+  if (op >= oend) return NULL;
+  uint8_t* token = op++;
+  size_t ml = match_len ? match_len - GMT__COMPRESS_MIN_MATCH : 0;
+  *token = (uint8_t)(((lit_len >= 15 ? 15 : lit_len) << 4) | (ml >= 15 ? 15 : ml));
+
+  if (lit_len >= 15 && !(op = GMT__PutLength(op, oend, lit_len - 15))) return NULL;
+  if ((size_t)(oend - op) < lit_len) return NULL;
+  memcpy(op, lit, lit_len);
+  op += lit_len;
+  if (!match_len) return op;
+
+  if (oend - op < 2) return NULL;
+  *op++ = (uint8_t)(offset & 0xFFu);
+  *op++ = (uint8_t)(offset >> 8);
+  if (ml >= 15 && !(op = GMT__PutLength(op, oend, ml - 15))) return NULL;
+  return op;
+}
+
+size_t GMT_Compress(const uint8_t* src, size_t size, uint8_t* dst, size_t dst_capacity) {
+  uint32_t table[1u << GMT__COMPRESS_HASH_BITS];
+  memset(table, 0, sizeof(table));
+
+  const uint8_t* ip = src;
+  const uint8_t* anchor = src;
+  const uint8_t* end = src + size;
+  const uint8_t* match_limit = (size > GMT__COMPRESS_TAIL) ? end - GMT__COMPRESS_TAIL : src;
+  uint8_t* op = dst;
+  const uint8_t* oend = dst + dst_capacity;
+
+  while (ip + GMT__COMPRESS_MIN_MATCH <= match_limit) {
+    uint32_t seq = GMT__Read32(ip);
+    uint32_t h = GMT__HashSeq(seq);
+    const uint8_t* ref = src + table[h];
+    table[h] = (uint32_t)(ip - src);
+
+    if (ref >= ip || (size_t)(ip - ref) > GMT__COMPRESS_MAX_OFFSET || GMT__Read32(ref) != seq) {
+      ip++;
+      continue;
+    }
+
+    const uint8_t* mp = ip + GMT__COMPRESS_MIN_MATCH;
+    const uint8_t* rp = ref + GMT__COMPRESS_MIN_MATCH;
+    while (mp < match_limit && *mp == *rp) {
+      mp++;
+      rp++;
+    }
+
+    op = GMT__PutSequence(op, oend, anchor, (size_t)(ip - anchor), (size_t)(ip - ref), (size_t)(mp - ip));
+    if (!op) return 0;
+    ip = mp;
+    anchor = ip;
+  }
+
+  op = GMT__PutSequence(op, oend, anchor, (size_t)(end - anchor), 0, 0);
+  if (!op) return 0;
+  return (size_t)(op - dst);
+}
+
+bool GMT_Decompress(const uint8_t* src, size_t size, uint8_t* dst, size_t raw_size) {
+  const uint8_t* ip = src;
+  const uint8_t* iend = src + size;
+  uint8_t* op = dst;
+  uint8_t* oend = dst + raw_size;
+
+  while (ip < iend) {
+    uint8_t token = *ip++;
+
+    size_t lit_len = token >> 4;
+    if (lit_len == 15 && !GMT__GetLength(&ip, iend, &lit_len)) return false;
+    if ((size_t)(iend - ip) < lit_len || (size_t)(oend - op) < lit_len) return false;
+    memcpy(op, ip, lit_len);
+    ip += lit_len;
+    op += lit_len;
+    if (ip == iend) break;  // Final literals-only pair.
+
+    if (iend - ip < 2) return false;
+    size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > (size_t)(op - dst)) return false;
+
+    size_t match_len = token & 15u;
+    if (match_len == 15 && !GMT__GetLength(&ip, iend, &match_len)) return false;
+    match_len += GMT__COMPRESS_MIN_MATCH;
+    if ((size_t)(oend - op) < match_len) return false;
+
+    // Byte-wise copy: the source may overlap the bytes being written.
+    const uint8_t* mp = op - offset;
+    for (size_t i = 0; i < match_len; i++) op[i] = mp[i];
+    op += match_len;
+  }
+  return op == oend;
+}
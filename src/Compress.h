@@ -0,0 +1,49 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Small LZ77 byte compressor used for TAG_BLOCK records.
+//
+// The stream is a sequence of (literals, match) pairs.  Each pair starts with a
+// token byte: high nibble = literal count, low nibble = match length - 4.  A
+// nibble of 15 is followed by extension bytes that are added to it (255 means
+// another byte follows).  Then come the literals, a uint16 LE back-reference
+// offset (1..65535) and the match length extension.  The final pair carries
+// literals only.
+
+// Worst-case compressed size for `size` input bytes.
+#define GMT_COMPRESS_BOUND(size) ((size) + (size) / 255 + 16)
+
+// Compresses `size` bytes of src into dst (capacity `dst_capacity`).
+// Returns the compressed size, or 0 if it does not fit.
+size_t GMT_Compress(const uint8_t* src, size_t size, uint8_t* dst, size_t dst_capacity);
+
+// Decompresses `size` bytes of src into exactly `raw_size` bytes at dst.
+// Returns false if the stream is malformed or does not decode to `raw_size` bytes.
+bool GMT_Decompress(const uint8_t* src, size_t size, uint8_t* dst, size_t raw_size);
@@ -25,11 +25,20 @@ SOFTWARE.
 #include "Internal.h"
 #include "Record.h"
 #include <inttypes.h>
+#include <stdlib.h>
 #include <string.h>
 
 // ===== Global state =====
 
-GMT_State g_gmt;
+// The default state, started by GMT_Init.
+static GMT_State g_gmt_default;
+
+GMT_THREAD_LOCAL GMT_State* g_gmt_current = &g_gmt_default;
+
+// A context is a state of its own; the first member, so the two convert.
+struct GMT_Context {
+  GMT_State state;
+};
 
 // ===== Default fail callback =====
 
@@ -43,41 +52,74 @@ static void GMT_DefaultFail(void) {
 
 // ===== Init / Quit =====
 
-bool GMT_Init_(const GMT_Setup* setup) {
-  if (!setup) {
-    GMT_LogError("Cant call GMT_Init with a null setup pointer.");
-    return false;
-  }
-  if (g_gmt.initialized) {
-    GMT_LogWarning("Already initialized; call GMT_Quit() first.");
-    return false;
-  }
-
+// Starts a session on the current state: the default one, or a context's
+// (is_context) that leaves the process-wide hooks and input alone.
+static bool GMT__StartSession(const GMT_Setup* setup, bool is_context) {
   // Zero the state before populating it.
   memset(&g_gmt, 0, sizeof(g_gmt));
+  g_gmt.context = is_context;
+  GMT_Assert_ResetSites();
 
   // Shallow-copy the setup first so we know the mode before touching the platform.
   // The caller is responsible for keeping any strings and arrays alive.
   g_gmt.setup = *setup;
   g_gmt.mode = setup->mode;
+  if (is_context) {
+    g_gmt.setup.input_injection = GMT_InputInjection_VIRTUAL;
+    g_gmt.setup.input_capture = GMT_InputCapture_VIRTUAL;
+  }
 
   {
     const char* mode_str = (g_gmt.mode == GMT_Mode_RECORD)   ? "RECORD"
                            : (g_gmt.mode == GMT_Mode_REPLAY) ? "REPLAY"
                                                              : "DISABLED";
-    GMT_LogInfo("Running GameTest with the following setup:");
+    GMT_LogInfo("Running GameTest%s with the following setup:", is_context ? " (context)" : "");
     GMT_LogInfo("  Mode:                      %s", mode_str);
     GMT_LogInfo("  Test Path:                 %s", setup->test_path ? setup->test_path : "(null)");
     GMT_LogInfo("  Work Dir:                  %s", setup->work_dir ? setup->work_dir : "(null)");
     GMT_LogInfo("  Directory Mapping Count:   %zu", setup->directory_mapping_count);
     GMT_LogInfo("  Fail Assert Trigger Count: %d", setup->fail_assertion_trigger_count);
+    GMT_LogInfo("  Compress Test File:        %s", setup->compress_test_file ? "yes" : "no");
+    GMT_LogInfo("  Record Buffer Size:        %zu", setup->record_buffer_size);
+    GMT_LogInfo("  Replay Timing:             %s", setup->replay_timing == GMT_ReplayTiming_FRAME ? "frame" : "wall clock");
+    GMT_LogInfo("  Input Injection:           %s", g_gmt.setup.input_injection == GMT_InputInjection_WINDOW_MESSAGES ? "window messages"
+                                                   : g_gmt.setup.input_injection == GMT_InputInjection_VIRTUAL       ? "virtual"
+                                                                                                                     : "SendInput");
+    GMT_LogInfo("  Input Capture:             %s", g_gmt.setup.input_capture == GMT_InputCapture_HOOKS ? "hooks"
+                                                   : g_gmt.setup.input_capture == GMT_InputCapture_VIRTUAL ? "virtual"
+                                                                                                           : "poll");
+    GMT_LogInfo("  Input Sample Rate:         %u", (unsigned)setup->input_sample_rate);
+    GMT_LogInfo("  Keyframe Interval:         %u", (unsigned)setup->keyframe_interval);
+    GMT_LogInfo("  Snapshot Capacity:         %zu", setup->snapshot_capacity);
+    GMT_LogInfo("  Replay Start Frame:        %u", (unsigned)setup->replay_start_frame);
+    GMT_LogInfo("  Replay End Frame:          %u", (unsigned)setup->replay_end_frame);
+    GMT_LogInfo("  Verify Keyframes:          %s", setup->verify_keyframes ? "yes" : "no");
+    GMT_LogInfo("  Stream Replay:             %s", setup->stream_replay ? "yes" : "no");
+    GMT_LogInfo("  Max Payload Size:          %zu", setup->max_payload_size);
+    GMT_LogInfo("  Digest Dump Dir:           %s", setup->digest_dump_dir ? setup->digest_dump_dir : "(null)");
+    GMT_LogInfo("  Profile Overhead:          %s", setup->profile_overhead ? "yes" : "no");
+    GMT_LogInfo("  Trace Path:                %s", setup->trace_path ? setup->trace_path : "(null)");
+    GMT_LogInfo("  Result Path:               %s", setup->result_path ? setup->result_path : "(null)");
+    GMT_LogInfo("  Status Name:               %s", setup->status_name ? setup->status_name : "(null)");
+    GMT_LogInfo("  Log Mode:                  %s", setup->log_mode == GMT_LogMode_IMMEDIATE ? "immediate" : "deferred");
+    GMT_LogInfo("  Log Ring Size:             %zu", setup->log_ring_size);
     GMT_LogInfo("  Log Callback:              %s", setup->log_callback ? "set" : "null");
     GMT_LogInfo("  Alloc Callback:            %s", setup->alloc_callback ? "set" : "null");
     GMT_LogInfo("  Free Callback:             %s", setup->free_callback ? "set" : "null");
     GMT_LogInfo("  Realloc Callback:          %s", setup->realloc_callback ? "set" : "null");
+    GMT_LogInfo("  Frame Arena Size:          %zu", setup->frame_arena_size);
+    GMT_LogInfo("  Arena Alloc Callback:      %s", setup->arena_alloc_callback ? "set" : "null");
+    GMT_LogInfo("  Arena Free Callback:       %s", setup->arena_free_callback ? "set" : "null");
     GMT_LogInfo("  Signal Callback:           %s", setup->signal_callback ? "set" : "null");
     GMT_LogInfo("  Fail Callback:             %s", setup->fail_callback ? "set" : "null");
     GMT_LogInfo("  Assert Trigger Callback:   %s", setup->assertion_trigger_callback ? "set" : "null");
+    GMT_LogInfo("  Snapshot Callback:         %s", setup->snapshot_callback ? "set" : "null");
+  }
+
+  g_gmt.max_payload_size = setup->max_payload_size ? setup->max_payload_size : GMT_DEFAULT_DATA_RECORD_PAYLOAD;
+  if (g_gmt.max_payload_size > GMT_MAX_DATA_RECORD_PAYLOAD) {
+    GMT_LogWarning("max_payload_size %zu exceeds the %u byte limit; clamped.", g_gmt.max_payload_size, GMT_MAX_DATA_RECORD_PAYLOAD);
+    g_gmt.max_payload_size = GMT_MAX_DATA_RECORD_PAYLOAD;
   }
 
   // In DISABLED mode skip all platform hooks and timers.
@@ -86,12 +128,22 @@ bool GMT_Init_(const GMT_Setup* setup) {
     return true;
   }
 
+  g_gmt.mutex = GMT_Platform_CreateMutex();
+  if (!g_gmt.mutex) {
+    GMT_LogError("Failed to create the framework mutex");
+    memset(&g_gmt, 0, sizeof(g_gmt));
+    return false;
+  }
+  GMT_Platform_InitTimer();
+
   // Install platform input hooks (e.g. mouse wheel accumulator).
-  GMT_Platform_Init();
+  if (!is_context) GMT_Platform_Init();
 
   // Optional working directory.
   if (setup->work_dir && setup->work_dir[0] != '\0') {
-    GMT_Platform_SetWorkDir(setup->work_dir);
+    if (is_context) GMT_LogWarning("work_dir is process-wide; ignored for a context.");
+    else
+      GMT_Platform_SetWorkDir(setup->work_dir);
   }
 
   // Mode-specific initialisation.
@@ -99,6 +151,7 @@ bool GMT_Init_(const GMT_Setup* setup) {
     case GMT_Mode_RECORD:
       if (!GMT_Record_OpenForWrite()) {
         GMT_LogError("Failed to open test file for recording");
+        GMT_Platform_DestroyMutex(g_gmt.mutex);
         memset(&g_gmt, 0, sizeof(g_gmt));
         return false;
       }
@@ -108,50 +161,93 @@ bool GMT_Init_(const GMT_Setup* setup) {
     case GMT_Mode_REPLAY:
       if (!GMT_Record_LoadReplay()) {
         GMT_LogError("Failed to load test file for replay");
+        GMT_Platform_DestroyMutex(g_gmt.mutex);
         memset(&g_gmt, 0, sizeof(g_gmt));
         return false;
       }
       GMT_LogInfo("Test file loaded for replay");
-      {
+      if (g_gmt.replay_streaming) {
+        GMT_FileMetrics m = GMT_Record_GetReplayMetrics();
+        GMT_LogInfo("  Test file size:        %ld bytes (streamed)", m.file_size_bytes);
+        GMT_LogInfo("  Keyframes:             %zu", m.keyframe_count);
+        if (m.start_frame > 0) GMT_LogInfo("  Starting at frame:     %u (keyframe)", (unsigned)m.start_frame);
+      } else {
         GMT_FileMetrics m = GMT_Record_GetReplayMetrics();
-        GMT_LogInfo("  Replay input records:  %zu", m.input_count);
+        GMT_LogInfo("  Test file size:        %ld bytes (%s)",
+                    m.file_size_bytes,
+                    g_gmt.replay_file_mapped ? "memory-mapped" : "read into memory");
+        GMT_LogInfo("  Replay input records:  %zu (%zu delta-encoded)", m.input_count, m.input_delta_count);
         GMT_LogInfo("  Replay signal records: %zu", m.signal_count);
         GMT_LogInfo("  Replay pin records:    %zu", m.pin_count);
         GMT_LogInfo("  Replay track records:  %zu", m.track_count);
         GMT_LogInfo("  Recording length:      %.2f s", m.duration);
         GMT_LogInfo("  Input density:         %.2f records/s", m.input_density);
+        GMT_LogInfo("  Keyframes:             %zu", m.keyframe_count);
+        if (m.start_frame > 0) GMT_LogInfo("  Starting at frame:     %u (keyframe)", (unsigned)m.start_frame);
+      }
+
+      // A pool worker stays up for more tests; GMT_PoolNextTest fetches them.
+      if (setup->pool_name && setup->pool_name[0] != '\0') {
+        if (is_context) GMT_LogWarning("pool_name is per process; ignored for a context.");
+        else if (!GMT_Pool_Connect()) {
+          GMT_Record_FreeReplay();
+          GMT_Platform_DestroyMutex(g_gmt.mutex);
+          memset(&g_gmt, 0, sizeof(g_gmt));
+          return false;
+        }
       }
 
       // Install IAT hooks to intercept all Win32 input-polling functions.
-      GMT_Platform_InstallInputHooks();
-      GMT_LogInfo("Input hooks installed");
+      // Virtual input reaches the game through GMT_GetVirtualInput instead.
+      if (g_gmt.setup.input_injection != GMT_InputInjection_VIRTUAL) {
+        GMT_Platform_InstallInputHooks();
+        GMT_LogInfo("Input hooks installed");
+      }
       break;
   }
 
+  {
+    size_t size = setup->frame_arena_size ? setup->frame_arena_size : GMT_FRAME_ARENA_DEFAULT_SIZE;
+    if (!GMT_Arena_Init(&g_gmt.frame_arena, size)) {
+      GMT_LogWarning("Failed to allocate the frame arena; scratch allocations use the heap.");
+    }
+  }
+
+  GMT_Profile_Init();
+  GMT_Status_Open();
+
   g_gmt.initialized = true;
 
+  // From here on messages are queued for the log thread (if it starts).
+  if (setup->log_mode == GMT_LogMode_DEFERRED && !GMT_Log_StartDeferred()) {
+    GMT_LogWarning("Failed to start the log thread; logging immediately.");
+  }
+
   // Start the recording / replay clock.
   g_gmt.record_start_time = GMT_Platform_GetTime();
   g_gmt.replay_time_offset = 0.0;
   g_gmt.signal_wait_start = 0.0;
 
   // Activate replayed-state hooks now that the clock is running.
-  if (g_gmt.mode == GMT_Mode_REPLAY) {
+  if (g_gmt.mode == GMT_Mode_REPLAY && g_gmt.setup.input_injection != GMT_InputInjection_VIRTUAL) {
     GMT_Platform_SetReplayHooksActive(true);
   }
 
+  // Sampled events are stamped against the clock just started.
+  GMT_Record_StartSampling();
+
   return true;
 }
 
-void GMT_Quit_(void) {
-  if (!g_gmt.initialized) return;
+// Ends the current state's session and zeroes it.
+static void GMT__EndSession(void) {
   if (g_gmt.mode == GMT_Mode_DISABLED) {
     memset(&g_gmt, 0, sizeof(g_gmt));
     return;
   }
 
   // Deactivate hooks before tearing down.
-  GMT_Platform_SetReplayHooksActive(false);
+  if (!g_gmt.context) GMT_Platform_SetReplayHooksActive(false);
 
   // Finalise recording / replay.
   switch (g_gmt.mode) {
@@ -159,85 +255,278 @@ void GMT_Quit_(void) {
       GMT_FileMetrics m = GMT_Record_GetRecordMetrics();
       GMT_LogInfo("Closing recording file");
       GMT_LogInfo("  File size:     %ld bytes", m.file_size_bytes);
+      if (g_gmt.setup.compress_test_file) GMT_LogInfo("  Uncompressed:  %zu bytes", m.raw_size_bytes);
+      GMT_LogInfo("  Writer buffer: %zu bytes peak, %zu stalls", m.buffer_high_water, m.buffer_overflow_count);
       GMT_LogInfo("  Duration:      %.2f s", m.duration);
       GMT_LogInfo("  Frames:        %" PRIu64, m.frame_count);
-      GMT_LogInfo("  Input records:  %zu", m.input_count);
+      GMT_LogInfo("  Input records:  %zu (%zu delta-encoded)", m.input_count, m.input_delta_count);
+      if (g_gmt.input_sampler.slots) GMT_LogInfo("  Input events:   %zu written, %zu dropped", m.input_event_count, m.input_event_dropped);
       GMT_LogInfo("  Signal records: %zu", m.signal_count);
       GMT_LogInfo("  Pin records:    %zu", m.pin_count);
       GMT_LogInfo("  Track records:  %zu", m.track_count);
+      GMT_LogInfo("  Keyframes:      %zu", m.keyframe_count);
       GMT_LogInfo("  Input density:  %.2f records/s", m.input_density);
       GMT_Record_CloseWrite();
+      GMT_Record_StopSampling();
       break;
     }
-    case GMT_Mode_REPLAY:
+    case GMT_Mode_REPLAY: {
+      GMT_FileMetrics m = GMT_Record_GetReplayMetrics();
       GMT_LogInfo("Freeing replay");
+      if (g_gmt.replay_streaming) {
+        GMT_LogInfo("  Streamed records:  %zu input (%zu delta-encoded), %zu signal, %zu pin, %zu track",
+                    m.input_count, m.input_delta_count, m.signal_count, m.pin_count, m.track_count);
+      }
+      GMT_LogInfo("  Pin/Track lookups: %zu (%zu cursor hits, %zu hash probes)",
+                  m.lookup_count,
+                  m.lookup_cursor_hits,
+                  m.lookup_probes);
+      GMT_Record_StopSampling();
       GMT_Record_FreeReplay();
       break;
+    }
     default:
       break;
   }
 
+  GMT_Profile_Quit();
   GMT_PrintReport_();
-
-  GMT_Platform_Quit();
+  GMT_WriteResultFile();
+  GMT_Log_StopDeferred();
+
+  GMT_Pool_Disconnect();
+  GMT_Status_Close();
+  GMT_Arena_Free(&g_gmt.frame_arena);
+  GMT_Assert_FreeSites();
+  GMT_ThreadData_FreeAll();
+  if (!g_gmt.context) GMT_Platform_Quit();
+  GMT_Platform_DestroyMutex(g_gmt.mutex);
   memset(&g_gmt, 0, sizeof(g_gmt));
 }
 
+bool GMT_Init_(const GMT_Setup* setup) {
+  if (!setup) {
+    GMT_LogError("Cant call GMT_Init with a null setup pointer.");
+    return false;
+  }
+  if (g_gmt_current != &g_gmt_default) {
+    GMT_LogError("GMT_Init starts the default session; call GMT_Context_MakeCurrent(NULL) first.");
+    return false;
+  }
+  if (g_gmt.initialized) {
+    GMT_LogWarning("Already initialized; call GMT_Quit() first.");
+    return false;
+  }
+  return GMT__StartSession(setup, false);
+}
+
+void GMT_Quit_(void) {
+  if (g_gmt_current != &g_gmt_default) {
+    GMT_LogError("GMT_Quit ends the default session; call GMT_Context_Destroy for a context.");
+    return;
+  }
+  if (!g_gmt.initialized) return;
+  GMT__EndSession();
+}
+
+// ===== Contexts =====
+
+GMT_Context* GMT_Context_Create_(const GMT_Setup* setup) {
+  if (!setup) {
+    GMT_LogError("Cant call GMT_Context_Create with a null setup pointer.");
+    return NULL;
+  }
+
+  // The new state has no callbacks yet, so take the setup's directly.
+  GMT_Context* context = setup->alloc_callback ? (GMT_Context*)setup->alloc_callback(sizeof(GMT_Context), GMT_LOCATION())
+                                               : (GMT_Context*)malloc(sizeof(GMT_Context));
+  if (!context) {
+    GMT_LogError("GMT_Context_Create: allocation of %zu bytes failed.", sizeof(GMT_Context));
+    return NULL;
+  }
+
+  GMT_State* prev = g_gmt_current;
+  g_gmt_current = &context->state;
+  bool started = GMT__StartSession(setup, true);
+  g_gmt_current = prev;
+
+  if (!started) {
+    if (setup->free_callback) setup->free_callback(context, GMT_LOCATION());
+    else
+      free(context);
+    return NULL;
+  }
+  return context;
+}
+
+void GMT_Context_Destroy_(GMT_Context* context) {
+  if (!context) return;
+
+  // Read before the session ends: it zeroes the setup.
+  GMT_FreeCallback free_cb = context->state.setup.free_callback;
+
+  GMT_State* prev = g_gmt_current;
+  g_gmt_current = &context->state;
+  if (g_gmt.initialized) GMT__EndSession();
+  g_gmt_current = (prev == &context->state) ? &g_gmt_default : prev;
+
+  if (free_cb) free_cb(context, GMT_LOCATION());
+  else
+    free(context);
+}
+
+GMT_Context* GMT_Context_MakeCurrent_(GMT_Context* context) {
+  GMT_State* prev = g_gmt_current;
+  g_gmt_current = context ? &context->state : &g_gmt_default;
+  return (prev == &g_gmt_default) ? NULL : (GMT_Context*)prev;
+}
+
 // ===== Runtime =====
 
 void GMT_Update_(void) {
   if (!g_gmt.initialized) return;
   if (g_gmt.mode == GMT_Mode_DISABLED) return;
 
+  uint64_t profile_begin = GMT_Profile_Begin();
   GMT_Platform_MutexLock();
+  GMT_Profile_EndFrame();
 
   // Reset per-frame sequential key counters for Pin and Track.
   GMT_KeyCounter_Reset(&g_gmt.pin_counter);
   GMT_KeyCounter_Reset(&g_gmt.track_counter);
+  GMT_Arena_Reset(&g_gmt.frame_arena);
 
   switch (g_gmt.mode) {
     case GMT_Mode_RECORD:
+      // Sample the virtual clock for the frame about to run; TAG_FRAME stores it below.
+      g_gmt.frame_time = GMT_Platform_GetTime() - g_gmt.record_start_time;
+      // Frame boundary: move the Pin/Track records each thread staged into the file.
+      GMT_Record_MergeThreadRecords();
       GMT_Record_WriteInput();
       break;
     case GMT_Mode_REPLAY:
-      GMT_Record_InjectInput();
+      // Starting at a keyframe: its state stands in for every input before it.
+      if (g_gmt.replay_keyframe_pending) GMT_Record_ApplyKeyframe();
+      else
+        GMT_Record_InjectInput();
       break;
     default:
       break;
   }
 
-  g_gmt.frame_index++;
+  GMT_Atomic_Add64(&g_gmt.frame_index, 1);
+
+  bool state_diverged = false;
+  if (g_gmt.mode == GMT_Mode_RECORD) GMT_Record_WriteFrame();
+  else if (g_gmt.mode == GMT_Mode_REPLAY) {
+    GMT_Record_RefillReplayWindow();
+    GMT_Record_UpdateReplayClock();
+    if (g_gmt.setup.verify_keyframes) state_diverged = !GMT_Record_VerifyKeyframe();
+    if (!g_gmt.replay_end_reached && GMT_Record_AtEndFrame()) {
+      g_gmt.replay_end_reached = true;
+      GMT_LogInfo("Replay reached end frame %u; the game should quit.", (unsigned)g_gmt.setup.replay_end_frame);
+    }
+  }
+  GMT_Status_Update();
+
+  // A corrupt record met while streaming fails the test, as it fails a full load.
+  bool stream_failed = g_gmt.replay_stream.failed && !g_gmt.test_failed;
+
+  GMT_Profile_EndSpan(GMT_ProfileScope_UPDATE, profile_begin, "GMT_Update", NULL);
+  GMT_Platform_MutexUnlock();
+
+  if (stream_failed) {
+    GMT_LogError("GMT_Record: streamed test file is corrupt; replay cannot continue.");
+    GMT_Fail_();
+  }
+  if (state_diverged && !g_gmt.test_failed) GMT_Fail_();
+}
+
+bool GMT_ShouldQuit_(void) {
+  return g_gmt.initialized && g_gmt.replay_end_reached;
+}
+
+double GMT_GetTime_(void) {
+  if (!g_gmt.initialized || g_gmt.mode == GMT_Mode_DISABLED) return 0.0;
+
+  GMT_Platform_MutexLock();
+  double t = g_gmt.frame_time;
+  GMT_Platform_MutexUnlock();
+  return t;
+}
+
+bool GMT_GetVirtualInput_(GMT_InputState* out) {
+  if (!out || !g_gmt.initialized || g_gmt.mode != GMT_Mode_REPLAY) return false;
+  if (g_gmt.setup.input_injection != GMT_InputInjection_VIRTUAL) return false;
 
+  GMT_Platform_MutexLock();
+  *out = g_gmt.virtual_input;
+  GMT_Platform_MutexUnlock();
+  return true;
+}
+
+void GMT_SetVirtualInput_(const GMT_InputState* input) {
+  if (!input || !g_gmt.initialized || g_gmt.mode != GMT_Mode_RECORD) return;
+  if (g_gmt.setup.input_capture != GMT_InputCapture_VIRTUAL) return;
+
+  GMT_Platform_MutexLock();
+  g_gmt.virtual_input = *input;
   GMT_Platform_MutexUnlock();
 }
 
 void GMT_Reset_(void) {
-  if (!g_gmt.initialized) return;
-  if (g_gmt.mode == GMT_Mode_DISABLED) return;
+  GMT_ResetTo_(NULL);
+}
+
+bool GMT_ResetTo_(const char* test_path) {
+  if (!g_gmt.initialized) return false;
+  if (g_gmt.mode == GMT_Mode_DISABLED) return false;
+
+  size_t path_len = test_path ? strlen(test_path) : 0;
+  if (path_len >= sizeof(g_gmt.test_path)) {
+    GMT_LogError("GMT_ResetTo: test path is longer than %zu bytes: %s", sizeof(g_gmt.test_path) - 1, test_path);
+    return false;
+  }
 
   GMT_Platform_MutexLock();
   GMT_LogInfo("Resetting session (frame_index was %u).", g_gmt.frame_index);
 
   // Tear down the current recording / replay session.
+  bool ok = true;
   switch (g_gmt.mode) {
     case GMT_Mode_RECORD:
       // Close the current file (writes TAG_END) and start a new one.
       GMT_Record_CloseWrite();
+      if (test_path) {
+        memmove(g_gmt.test_path, test_path, path_len + 1);
+        g_gmt.setup.test_path = g_gmt.test_path;
+      }
       // Reopen; any existing data is overwritten.
-      GMT_Record_OpenForWrite();
-      GMT_LogInfo("Recording file reopened");
+      ok = GMT_Record_OpenForWrite();
+      if (ok) GMT_LogInfo("Recording file reopened");
+      else
+        GMT_LogError("Failed to open test file for recording: %s", g_gmt.setup.test_path);
       break;
 
     case GMT_Mode_REPLAY:
       GMT_Record_FreeReplay();
-      GMT_Record_LoadReplay();
-      GMT_LogInfo("Replay data reloaded");
+      if (test_path) {
+        memmove(g_gmt.test_path, test_path, path_len + 1);
+        g_gmt.setup.test_path = g_gmt.test_path;
+      }
+      ok = GMT_Record_LoadReplay();
+      if (ok) GMT_LogInfo("Replay data reloaded");
+      else
+        GMT_LogError("Failed to load test file for replay: %s", g_gmt.setup.test_path);
       break;
 
     default:
       break;
   }
 
+  // Another test: its assertion totals and unique sites start from zero.
+  if (test_path) GMT_ClearFailedAssertions_();
+
   // Reset runtime statistics.
   g_gmt.frame_index = 0;
   g_gmt.test_failed = false;
@@ -245,6 +534,10 @@ void GMT_Reset_(void) {
   g_gmt.assertion_fire_count = 0;
   g_gmt.waiting_for_signal = false;
   g_gmt.waiting_signal_id = 0;
+  g_gmt.replay_end_reached = false;
+  g_gmt.replay_check_cursor = 0;
+  GMT_Atomic_Store32(&g_gmt.digest_dumped, 0);
+  if (g_gmt.status) GMT_Atomic_Store32(&g_gmt.status->flags, 0);
   GMT_InputState_Clear(&g_gmt.replay_prev_input);
   GMT_KeyCounter_Reset(&g_gmt.pin_counter);
   GMT_KeyCounter_Reset(&g_gmt.track_counter);
@@ -253,8 +546,13 @@ void GMT_Reset_(void) {
   g_gmt.record_start_time = GMT_Platform_GetTime();
   g_gmt.replay_time_offset = 0.0;
   g_gmt.signal_wait_start = 0.0;
+  g_gmt.frame_time = 0.0;
+
+  // Events the sampler queued for the previous test are stamped against its clock.
+  GMT_InputSampler_Clear(&g_gmt.input_sampler);
 
   GMT_Platform_MutexUnlock();
+  return ok;
 }
 
 void GMT_Fail_(void) {
@@ -266,11 +564,26 @@ void GMT_Fail_(void) {
   GMT_LogError("Test marked as failed on frame %u.", g_gmt.frame_index);
   GMT_Platform_MutexUnlock();
 
+  // The default fail callback aborts, so the result file and the queued log
+  // messages are written now.
+  GMT_WriteResultFile();
+  GMT_Log_Flush();
+  GMT_Profile_FlushTrace();
+
+  // Flagged only now that the result is on disk: the tool may stop a failed
+  // process that does not exit by itself.  Under the mutex, as GMT_Update
+  // rewrites the flags.
+  if (g_gmt.status) {
+    GMT_Platform_MutexLock();
+    GMT_Atomic_Store32(&g_gmt.status->flags, g_gmt.status->flags | GMT_STATUS_FLAG_FAILED);
+    GMT_Platform_MutexUnlock();
+  }
+
   // Remove input-blocking hooks before invoking any callback that may open a
   // dialog.  During replay the LL hooks swallow all real keyboard and mouse
   // events; without this the user cannot interact with (or dismiss) error
   // dialogs such as the OS crash prompt from abort().
-  GMT_Platform_RemoveInputHooks();
+  if (!g_gmt.context) GMT_Platform_RemoveInputHooks();
 
   // Dereference pointer-to-function-pointer pattern used for overridable callbacks.
   if (g_gmt.setup.fail_callback && *g_gmt.setup.fail_callback) {
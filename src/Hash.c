@@ -0,0 +1,114 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Hash.h"
+#include <string.h>
+
+#define GMT__PRIME64_1 0x9E3779B185EBCA87ull
+#define GMT__PRIME64_2 0xC2B2AE3D27D4EB4Full
+#define GMT__PRIME64_3 0x165667B19E3779F9ull
+#define GMT__PRIME64_4 0x85EBCA77C2B2AE63ull
+#define GMT__PRIME64_5 0x27D4EB2F165667C5ull
+
+// Test files are little-endian, and so is every platform the library runs on.
+static uint64_t GMT__Read64(const uint8_t* p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static uint32_t GMT__Read32(const uint8_t* p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static uint64_t GMT__Rotl64(uint64_t v, unsigned int r) {
+  return (v << r) | (v >> (64 - r));
+}
+
+static uint64_t GMT__Round(uint64_t acc, uint64_t input) {
+  acc += input * GMT__PRIME64_2;
+  acc = GMT__Rotl64(acc, 31);
+  return acc * GMT__PRIME64_1;
+}
+
+static uint64_t GMT__MergeRound(uint64_t h, uint64_t acc) {
+  h ^= GMT__Round(0, acc);
+  return h * GMT__PRIME64_1 + GMT__PRIME64_4;
+}
+
+uint64_t GMT_Hash64(const void* data, size_t size, uint64_t seed) {
+  const uint8_t* p = (const uint8_t*)data;
+  const uint8_t* end = p + size;
+  uint64_t h;
+
+  if (size >= 32) {
+    uint64_t v1 = seed + GMT__PRIME64_1 + GMT__PRIME64_2;
+    uint64_t v2 = seed + GMT__PRIME64_2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - GMT__PRIME64_1;
+    const uint8_t* limit = end - 32;
+    do {
+      v1 = GMT__Round(v1, GMT__Read64(p));
+      v2 = GMT__Round(v2, GMT__Read64(p + 8));
+      v3 = GMT__Round(v3, GMT__Read64(p + 16));
+      v4 = GMT__Round(v4, GMT__Read64(p + 24));
+      p += 32;
+    } while (p <= limit);
+    h = GMT__Rotl64(v1, 1) + GMT__Rotl64(v2, 7) + GMT__Rotl64(v3, 12) + GMT__Rotl64(v4, 18);
+    h = GMT__MergeRound(h, v1);
+    h = GMT__MergeRound(h, v2);
+    h = GMT__MergeRound(h, v3);
+    h = GMT__MergeRound(h, v4);
+  } else {
+    h = seed + GMT__PRIME64_5;
+  }
+  h += (uint64_t)size;
+
+  // Tail: 8, then 4, then single bytes.
+  while (end - p >= 8) {
+    h ^= GMT__Round(0, GMT__Read64(p));
+    h = GMT__Rotl64(h, 27) * GMT__PRIME64_1 + GMT__PRIME64_4;
+    p += 8;
+  }
+  if (end - p >= 4) {
+    h ^= (uint64_t)GMT__Read32(p) * GMT__PRIME64_1;
+    h = GMT__Rotl64(h, 23) * GMT__PRIME64_2 + GMT__PRIME64_3;
+    p += 4;
+  }
+  while (p < end) {
+    h ^= (uint64_t)(*p) * GMT__PRIME64_5;
+    h = GMT__Rotl64(h, 11) * GMT__PRIME64_1;
+    p++;
+  }
+
+  // Avalanche.
+  h ^= h >> 33;
+  h *= GMT__PRIME64_2;
+  h ^= h >> 29;
+  h *= GMT__PRIME64_3;
+  h ^= h >> 32;
+  return h;
+}
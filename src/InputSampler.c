@@ -0,0 +1,167 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "InputSampler.h"
+#include "Atomic.h"
+#include "Internal.h"
+#include "Record.h"
+#include <string.h>
+
+// Queues the parts of a fresh sample that differ from the previous one.
+static void GMT__SampleTick(GMT_InputSampler* s) {
+  GMT_InputState cur = s->last;
+  GMT_Platform_SampleInput(&cur);
+  double now = GMT_Platform_GetTime();
+
+  GMT_InputEvent ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.time = now;
+  if (cur.mouse_x != s->last.mouse_x || cur.mouse_y != s->last.mouse_y || cur.mouse_buttons != s->last.mouse_buttons) {
+    ev.kind = GMT_InputEvent_MOUSE;
+    ev.value.mouse.x = cur.mouse_x;
+    ev.value.mouse.y = cur.mouse_y;
+    ev.value.mouse.buttons = cur.mouse_buttons;
+    GMT_InputSampler_Push(s, &ev);
+  }
+  for (int i = 0; i < GMT_MAX_GAMEPADS; ++i) {
+    if (memcmp(&cur.gamepads[i], &s->last.gamepads[i], sizeof(GMT_GamepadState)) == 0) continue;
+    memset(&ev.value, 0, sizeof(ev.value));
+    ev.kind = GMT_InputEvent_GAMEPAD;
+    ev.index = (uint8_t)i;
+    ev.value.gamepad = cur.gamepads[i];
+    GMT_InputSampler_Push(s, &ev);
+  }
+  s->last = cur;
+}
+
+static void GMT__SamplerThread(void* user) {
+  GMT_InputSampler* s = (GMT_InputSampler*)user;
+  GMT_Platform_SetFineTimer(true);
+  double next = GMT_Platform_GetTime();
+  while (!GMT_Atomic_Load32(&s->stop)) {
+    if (g_gmt.mode == GMT_Mode_RECORD) GMT__SampleTick(s);
+    else
+      GMT_Record_DeliverInput();
+
+    // Ticks stay on a fixed grid; ones missed while the thread was held up are skipped.
+    double now = GMT_Platform_GetTime();
+    next += s->period;
+    if (next < now) next = now;
+    GMT_Platform_WaitEvent(s->wake, (uint32_t)((next - now) * 1000.0 + 0.999));
+  }
+  GMT_Platform_SetFineTimer(false);
+}
+
+bool GMT_InputSampler_Start(GMT_InputSampler* s, bool queue, uint32_t rate_hz) {
+  memset(s, 0, sizeof(*s));
+  if (rate_hz > GMT_INPUT_SAMPLE_MAX_RATE) {
+    GMT_LogWarning("input_sample_rate %u exceeds %u Hz; clamped.", (unsigned)rate_hz, (unsigned)GMT_INPUT_SAMPLE_MAX_RATE);
+    rate_hz = GMT_INPUT_SAMPLE_MAX_RATE;
+  }
+
+  if (queue) {
+    s->slots = (GMT_InputEventSlot*)GMT_Alloc(GMT_INPUT_QUEUE_SLOTS * sizeof(GMT_InputEventSlot));
+    if (!s->slots) return false;
+    s->slot_count = GMT_INPUT_QUEUE_SLOTS;
+    for (size_t i = 0; i < s->slot_count; ++i) s->slots[i].sequence = i;
+  }
+
+  if (rate_hz > 0) {
+    s->period = 1.0 / (double)rate_hz;
+    s->wake = GMT_Platform_CreateEvent();
+    if (s->wake) s->thread = GMT_Platform_CreateThread(GMT__SamplerThread, s);
+    if (!s->thread) {
+      if (s->slots) GMT_Free(s->slots);
+      GMT_Platform_DestroyEvent(s->wake);
+      memset(s, 0, sizeof(*s));
+      return false;
+    }
+  }
+  return true;
+}
+
+bool GMT_InputSampler_Push(GMT_InputSampler* s, const GMT_InputEvent* ev) {
+  if (!s->slots) return false;
+  uint64_t pos = GMT_Atomic_Load64(&s->head);
+  for (;;) {
+    GMT_InputEventSlot* slot = &s->slots[(size_t)pos & (s->slot_count - 1)];
+    int64_t diff = (int64_t)(GMT_Atomic_Load64(&slot->sequence) - pos);
+    if (diff == 0) {
+      if (GMT_Atomic_CompareExchange64(&s->head, pos, pos + 1)) {
+        slot->event = *ev;
+        GMT_Atomic_Store64(&slot->sequence, pos + 1);
+        return true;
+      }
+    } else if (diff < 0) {
+      GMT_Atomic_Add64(&s->dropped, 1);
+      return false;
+    }
+    pos = GMT_Atomic_Load64(&s->head);
+  }
+}
+
+bool GMT_InputSampler_Pop(GMT_InputSampler* s, GMT_InputEvent* out) {
+  if (!s->slots) return false;
+  uint64_t tail = GMT_Atomic_Load64(&s->tail);
+  GMT_InputEventSlot* slot = &s->slots[(size_t)tail & (s->slot_count - 1)];
+  if (GMT_Atomic_Load64(&slot->sequence) != tail + 1) return false;
+  *out = slot->event;
+  GMT_Atomic_Store64(&slot->sequence, tail + s->slot_count);
+  GMT_Atomic_Store64(&s->tail, tail + 1);
+  return true;
+}
+
+void GMT_InputSampler_Clear(GMT_InputSampler* s) {
+  GMT_InputEvent ev;
+  while (GMT_InputSampler_Pop(s, &ev)) {
+  }
+  GMT_Atomic_Store64(&s->dropped, 0);
+}
+
+void GMT_InputSampler_Stop(GMT_InputSampler* s) {
+  if (s->thread) {
+    GMT_Atomic_Store32(&s->stop, 1);
+    GMT_Platform_SignalEvent(s->wake);
+    GMT_Platform_JoinThread(s->thread);
+    GMT_Platform_DestroyEvent(s->wake);
+  }
+  if (s->slots) GMT_Free(s->slots);
+  memset(s, 0, sizeof(*s));
+}
+
+void GMT_InputEvent_Apply(const GMT_InputEvent* ev, GMT_InputState* state) {
+  switch ((GMT_InputEventKind)ev->kind) {
+    case GMT_InputEvent_KEY:
+      if (ev->index < GMT_KEY_COUNT) state->keys[ev->index] = ev->value.key;
+      break;
+    case GMT_InputEvent_MOUSE:
+      state->mouse_x = ev->value.mouse.x;
+      state->mouse_y = ev->value.mouse.y;
+      state->mouse_buttons = ev->value.mouse.buttons;
+      break;
+    case GMT_InputEvent_GAMEPAD:
+      if (ev->index < GMT_MAX_GAMEPADS) state->gamepads[ev->index] = ev->value.gamepad;
+      break;
+  }
+}
@@ -0,0 +1,116 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "GameTestInput.h"
+#include "Platform.h"
+
+// Input sampling (GMT_Setup.input_sample_rate).  During RECORD a dedicated
+// thread reads the mouse and the gamepads at a fixed rate and queues every
+// change as a compact timestamped event; the keyboard hook queues key
+// transitions the same way instead of writing a record itself.  GMT_Update
+// turns the queued events into input records at the frame boundary.  During
+// REPLAY under the wall clock with SendInput injection the thread instead
+// injects the input records that came due since the last frame
+// (GMT_Record_DeliverInput).
+//
+// The queue is a lock-free multi-producer ring of fixed-size slots, as in
+// GMT_LogRing: producers claim a slot with a compare-exchange on head and
+// publish it through its sequence number.  It never blocks; an event that
+// finds it full is dropped and counted, and the next frame's full capture
+// restores whatever it carried.
+
+#define GMT_INPUT_QUEUE_SLOTS 4096  // Events the queue holds (power of two).
+#define GMT_INPUT_SAMPLE_MAX_RATE 1000
+
+typedef enum GMT_InputEventKind {
+  GMT_InputEvent_KEY,      // keys[index] = key.
+  GMT_InputEvent_MOUSE,    // Mouse position and buttons.
+  GMT_InputEvent_GAMEPAD,  // gamepads[index] = gamepad.
+} GMT_InputEventKind;
+
+// One change to part of the input state.
+typedef struct GMT_InputEvent {
+  double time;    // GMT_Platform_GetTime when it was observed.
+  uint8_t kind;   // GMT_InputEventKind.
+  uint8_t index;  // GMT_Key for KEY, gamepad slot for GAMEPAD.
+  union {
+    uint8_t key;  // 0x80 if pressed, 0 otherwise.
+    struct {
+      int32_t x;
+      int32_t y;
+      GMT_MouseButtons buttons;
+    } mouse;
+    GMT_GamepadState gamepad;
+  } value;
+} GMT_InputEvent;
+
+typedef struct GMT_InputEventSlot {
+  // Position the slot is free for (== position), or published for (== position + 1).
+  volatile uint64_t sequence;
+  GMT_InputEvent event;
+} GMT_InputEventSlot;
+
+typedef struct GMT_InputSampler {
+  GMT_InputEventSlot* slots;  // NULL when no queue runs.
+  size_t slot_count;          // Power of two.
+
+  // Monotonic slot positions; head is claimed by producers, tail advanced by the consumer.
+  volatile uint64_t head;
+  volatile uint64_t tail;
+  volatile uint64_t dropped;  // Events that found the queue full.
+
+  double period;  // Seconds between two ticks of the thread.
+  GMT_InputState last;  // Thread only: the previous sample.
+
+  GMT_Thread* thread;  // NULL when no thread runs.
+  GMT_Event* wake;     // Signalled by Stop.
+  volatile uint32_t stop;
+} GMT_InputSampler;
+
+// Allocates a queue of GMT_INPUT_QUEUE_SLOTS events if `queue` is set, and starts
+// the thread if rate_hz is non-zero (clamped to GMT_INPUT_SAMPLE_MAX_RATE).  The
+// thread runs the tick of the current state's mode.  Returns false (with *s
+// zeroed) if allocation or thread creation fails.
+bool GMT_InputSampler_Start(GMT_InputSampler* s, bool queue, uint32_t rate_hz);
+
+// Queues one event from any thread.  Returns false if it was dropped.
+bool GMT_InputSampler_Push(GMT_InputSampler* s, const GMT_InputEvent* ev);
+
+// Takes the oldest queued event.  Single consumer: called with the mutex held.
+bool GMT_InputSampler_Pop(GMT_InputSampler* s, GMT_InputEvent* out);
+
+// Discards every queued event and the drop count, for a new test.  Called with
+// the mutex held; the thread keeps running.
+void GMT_InputSampler_Clear(GMT_InputSampler* s);
+
+// Stops the thread and frees the queue.  Safe on a sampler that never started.
+void GMT_InputSampler_Stop(GMT_InputSampler* s);
+
+// Applies an event to *state.
+void GMT_InputEvent_Apply(const GMT_InputEvent* ev, GMT_InputState* state);
@@ -26,6 +26,17 @@ SOFTWARE.
 #include <stdbool.h>
 #include <string.h>
 
+// AVX2 is used only when the whole build targets it (/arch:AVX2, -mavx2);
+// SSE2 is part of every x64 target.
+#if defined(__AVX2__)
+#  include <immintrin.h>
+#  define GMT__KEY_MASK_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define GMT__KEY_MASK_SSE2 1
+#endif
+
 void GMT_InputState_Clear(GMT_InputState* s) {
   memset(s, 0, sizeof(*s));
 }
@@ -33,3 +44,294 @@ void GMT_InputState_Clear(GMT_InputState* s) {
 bool GMT_InputState_Compare(const GMT_InputState* a, const GMT_InputState* b) {
   return memcmp(a, b, sizeof(*a)) == 0;
 }
+
+bool GMT_InputState_IsAnalogStep(const GMT_InputState* prev, const GMT_InputState* cur) {
+  if (cur->mouse_wheel_x != 0 || cur->mouse_wheel_y != 0) return false;
+  GMT_KeyMask repeats;
+  GMT_InputState_RepeatingKeys(cur, &repeats);
+  if (GMT_KeyMask_Any(&repeats)) return false;
+
+  // Equal once the analog fields are taken from *prev.
+  GMT_InputState held = *cur;
+  held.mouse_x = prev->mouse_x;
+  held.mouse_y = prev->mouse_y;
+  for (int i = 0; i < GMT_MAX_GAMEPADS; ++i) {
+    GMT_GamepadState* gp = &held.gamepads[i];
+    gp->left_trigger = prev->gamepads[i].left_trigger;
+    gp->right_trigger = prev->gamepads[i].right_trigger;
+    gp->left_stick_x = prev->gamepads[i].left_stick_x;
+    gp->left_stick_y = prev->gamepads[i].left_stick_y;
+    gp->right_stick_x = prev->gamepads[i].right_stick_x;
+    gp->right_stick_y = prev->gamepads[i].right_stick_y;
+  }
+  return GMT_InputState_Compare(&held, prev);
+}
+
+// ===== Key masks =====
+
+// Blocks start at multiples of 16 keys, so a block's bits never straddle two words.
+#define GMT__KEY_MASK_OR(mask, first, block_bits) ((mask)->bits[(first) >> 6] |= (uint64_t)(block_bits) << ((first) & 63))
+
+// Collects the top bit of every byte.
+static void GMT__KeyMaskHighBits(const uint8_t* bytes, GMT_KeyMask* out) {
+  memset(out, 0, sizeof(*out));
+  size_t i = 0;
+#if GMT__KEY_MASK_AVX2
+  for (; i + 32 <= GMT_KEY_COUNT; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i*)(bytes + i));
+    GMT__KEY_MASK_OR(out, i, (uint32_t)_mm256_movemask_epi8(v));
+  }
+#endif
+#if GMT__KEY_MASK_SSE2
+  for (; i + 16 <= GMT_KEY_COUNT; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i*)(bytes + i));
+    GMT__KEY_MASK_OR(out, i, (uint32_t)_mm_movemask_epi8(v));
+  }
+#endif
+  for (; i < GMT_KEY_COUNT; i++) {
+    if (bytes[i] & 0x80u) out->bits[i >> 6] |= 1ull << (i & 63);
+  }
+}
+
+void GMT_KeyMask_Changed(const uint8_t* a, const uint8_t* b, GMT_KeyMask* out) {
+  memset(out, 0, sizeof(*out));
+  size_t i = 0;
+#if GMT__KEY_MASK_AVX2
+  for (; i + 32 <= GMT_KEY_COUNT; i += 32) {
+    __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+    __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+    GMT__KEY_MASK_OR(out, i, ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)));
+  }
+#endif
+#if GMT__KEY_MASK_SSE2
+  for (; i + 16 <= GMT_KEY_COUNT; i += 16) {
+    __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+    __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+    GMT__KEY_MASK_OR(out, i, ~(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) & 0xFFFFu);
+  }
+#endif
+  for (; i < GMT_KEY_COUNT; i++) {
+    if (a[i] != b[i]) out->bits[i >> 6] |= 1ull << (i & 63);
+  }
+}
+
+void GMT_InputState_PackKeys(const GMT_InputState* s, GMT_KeyMask* out) {
+  GMT__KeyMaskHighBits(s->keys, out);
+}
+
+void GMT_InputState_KeyTransitions(const GMT_InputState* prev, const GMT_InputState* cur, GMT_KeyMask* out) {
+  GMT_KeyMask held;
+  GMT__KeyMaskHighBits(prev->keys, &held);
+  GMT__KeyMaskHighBits(cur->keys, out);
+  for (int w = 0; w < GMT_KEY_MASK_WORDS; w++) out->bits[w] ^= held.bits[w];
+}
+
+void GMT_InputState_RepeatingKeys(const GMT_InputState* s, GMT_KeyMask* out) {
+  static const uint8_t k_zero[GMT_KEY_COUNT] = {0};
+  GMT_KeyMask_Changed(k_zero, s->key_repeats, out);
+}
+
+bool GMT_KeyMask_Any(const GMT_KeyMask* mask) {
+  uint64_t any = 0;
+  for (int w = 0; w < GMT_KEY_MASK_WORDS; w++) any |= mask->bits[w];
+  return any != 0;
+}
+
+// ===== Delta encoding =====
+
+static uint8_t* GMT__PutVarint(uint8_t* p, int32_t value) {
+  uint32_t z = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);  // zigzag
+  while (z >= 0x80u) {
+    *p++ = (uint8_t)(z | 0x80u);
+    z >>= 7;
+  }
+  *p++ = (uint8_t)z;
+  return p;
+}
+
+static bool GMT__GetVarint(const uint8_t** p, const uint8_t* end, int32_t* out) {
+  uint32_t z = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (*p >= end) return false;
+    uint8_t b = *(*p)++;
+    z |= (uint32_t)(b & 0x7Fu) << shift;
+    if (!(b & 0x80u)) {
+      *out = (int32_t)((z >> 1) ^ (0u - (z & 1u)));
+      return true;
+    }
+  }
+  return false;
+}
+
+// Writes a changed-byte bitmap plus the new values; returns NULL if nothing changed.
+static uint8_t* GMT__PutByteArrayDelta(uint8_t* p, const uint8_t* prev, const uint8_t* cur) {
+  GMT_KeyMask changed;
+  GMT_KeyMask_Changed(prev, cur, &changed);
+  if (!GMT_KeyMask_Any(&changed)) return NULL;
+
+  // The on-disk bitmap is the mask's words in little-endian byte order.
+  for (size_t i = 0; i < GMT_INPUT_DELTA_KEY_BITMAP_SIZE; i++) {
+    p[i] = (uint8_t)(changed.bits[i >> 3] >> ((i & 7) * 8));
+  }
+  uint8_t* values = p + GMT_INPUT_DELTA_KEY_BITMAP_SIZE;
+  for (int w = 0; w < GMT_KEY_MASK_WORDS; w++) {
+    for (uint64_t bits = changed.bits[w]; bits; bits &= bits - 1) {
+      *values++ = cur[w * 64 + GMT_KeyMask_LowestBit(bits)];
+    }
+  }
+  return values;
+}
+
+static bool GMT__GetByteArrayDelta(const uint8_t** p, const uint8_t* end, uint8_t* dst, size_t count) {
+  if ((size_t)(end - *p) < GMT_INPUT_DELTA_KEY_BITMAP_SIZE) return false;
+  const uint8_t* bitmap = *p;
+  const uint8_t* values = *p + GMT_INPUT_DELTA_KEY_BITMAP_SIZE;
+  for (size_t i = 0; i < count; i++) {
+    if (bitmap[i >> 3] & (1u << (i & 7))) {
+      if (values >= end) return false;
+      dst[i] = *values++;
+    }
+  }
+  *p = values;
+  return true;
+}
+
+size_t GMT_InputState_EncodeDelta(const GMT_InputState* prev, const GMT_InputState* cur, uint8_t* out) {
+  uint8_t flags = 0;
+  uint8_t* p = out + 1;
+
+  uint8_t* next = GMT__PutByteArrayDelta(p, prev->keys, cur->keys);
+  if (next) {
+    flags |= GMT_InputDelta_KEYS;
+    p = next;
+  }
+  next = GMT__PutByteArrayDelta(p, prev->key_repeats, cur->key_repeats);
+  if (next) {
+    flags |= GMT_InputDelta_KEY_REPEATS;
+    p = next;
+  }
+  if (cur->mouse_x != prev->mouse_x || cur->mouse_y != prev->mouse_y) {
+    flags |= GMT_InputDelta_MOUSE_POS;
+    p = GMT__PutVarint(p, (int32_t)((uint32_t)cur->mouse_x - (uint32_t)prev->mouse_x));
+    p = GMT__PutVarint(p, (int32_t)((uint32_t)cur->mouse_y - (uint32_t)prev->mouse_y));
+  }
+  if (cur->mouse_wheel_x != prev->mouse_wheel_x || cur->mouse_wheel_y != prev->mouse_wheel_y) {
+    flags |= GMT_InputDelta_MOUSE_WHEEL;
+    p = GMT__PutVarint(p, (int32_t)((uint32_t)cur->mouse_wheel_x - (uint32_t)prev->mouse_wheel_x));
+    p = GMT__PutVarint(p, (int32_t)((uint32_t)cur->mouse_wheel_y - (uint32_t)prev->mouse_wheel_y));
+  }
+  if (cur->mouse_buttons != prev->mouse_buttons) {
+    flags |= GMT_InputDelta_MOUSE_BUTTONS;
+    *p++ = cur->mouse_buttons;
+  }
+
+  uint8_t* pad_mask = p++;
+  *pad_mask = 0;
+  for (int i = 0; i < GMT_MAX_GAMEPADS; i++) {
+    const GMT_GamepadState* a = &prev->gamepads[i];
+    const GMT_GamepadState* b = &cur->gamepads[i];
+    uint8_t fields = 0;
+    if (a->connected != b->connected) fields |= GMT_InputDeltaPad_CONNECTED;
+    if (a->buttons != b->buttons) fields |= GMT_InputDeltaPad_BUTTONS;
+    if (a->left_trigger != b->left_trigger) fields |= GMT_InputDeltaPad_LEFT_TRIGGER;
+    if (a->right_trigger != b->right_trigger) fields |= GMT_InputDeltaPad_RIGHT_TRIGGER;
+    if (a->left_stick_x != b->left_stick_x) fields |= GMT_InputDeltaPad_LEFT_STICK_X;
+    if (a->left_stick_y != b->left_stick_y) fields |= GMT_InputDeltaPad_LEFT_STICK_Y;
+    if (a->right_stick_x != b->right_stick_x) fields |= GMT_InputDeltaPad_RIGHT_STICK_X;
+    if (a->right_stick_y != b->right_stick_y) fields |= GMT_InputDeltaPad_RIGHT_STICK_Y;
+    if (!fields) continue;
+
+    *pad_mask |= (uint8_t)(1u << i);
+    *p++ = fields;
+    if (fields & GMT_InputDeltaPad_CONNECTED) *p++ = b->connected;
+    if (fields & GMT_InputDeltaPad_BUTTONS) {
+      *p++ = (uint8_t)(b->buttons & 0xFFu);
+      *p++ = (uint8_t)(b->buttons >> 8);
+    }
+    if (fields & GMT_InputDeltaPad_LEFT_TRIGGER) *p++ = b->left_trigger;
+    if (fields & GMT_InputDeltaPad_RIGHT_TRIGGER) *p++ = b->right_trigger;
+    if (fields & GMT_InputDeltaPad_LEFT_STICK_X) p = GMT__PutVarint(p, (int32_t)b->left_stick_x - a->left_stick_x);
+    if (fields & GMT_InputDeltaPad_LEFT_STICK_Y) p = GMT__PutVarint(p, (int32_t)b->left_stick_y - a->left_stick_y);
+    if (fields & GMT_InputDeltaPad_RIGHT_STICK_X) p = GMT__PutVarint(p, (int32_t)b->right_stick_x - a->right_stick_x);
+    if (fields & GMT_InputDeltaPad_RIGHT_STICK_Y) p = GMT__PutVarint(p, (int32_t)b->right_stick_y - a->right_stick_y);
+  }
+  if (*pad_mask) {
+    flags |= GMT_InputDelta_GAMEPADS;
+  } else {
+    p--;  // Drop the unused pad mask.
+  }
+
+  if (!flags) return 0;
+  out[0] = flags;
+  return (size_t)(p - out);
+}
+
+bool GMT_InputState_ApplyDelta(GMT_InputState* state, const uint8_t* src, size_t size) {
+  const uint8_t* p = src;
+  const uint8_t* end = src + size;
+  if (p >= end) return false;
+  uint8_t flags = *p++;
+  int32_t dx, dy;
+
+  if ((flags & GMT_InputDelta_KEYS) && !GMT__GetByteArrayDelta(&p, end, state->keys, GMT_KEY_COUNT)) return false;
+  if ((flags & GMT_InputDelta_KEY_REPEATS) && !GMT__GetByteArrayDelta(&p, end, state->key_repeats, GMT_KEY_COUNT)) return false;
+  if (flags & GMT_InputDelta_MOUSE_POS) {
+    if (!GMT__GetVarint(&p, end, &dx) || !GMT__GetVarint(&p, end, &dy)) return false;
+    state->mouse_x = (int32_t)((uint32_t)state->mouse_x + (uint32_t)dx);
+    state->mouse_y = (int32_t)((uint32_t)state->mouse_y + (uint32_t)dy);
+  }
+  if (flags & GMT_InputDelta_MOUSE_WHEEL) {
+    if (!GMT__GetVarint(&p, end, &dx) || !GMT__GetVarint(&p, end, &dy)) return false;
+    state->mouse_wheel_x = (int32_t)((uint32_t)state->mouse_wheel_x + (uint32_t)dx);
+    state->mouse_wheel_y = (int32_t)((uint32_t)state->mouse_wheel_y + (uint32_t)dy);
+  }
+  if (flags & GMT_InputDelta_MOUSE_BUTTONS) {
+    if (p >= end) return false;
+    state->mouse_buttons = *p++;
+  }
+  if (flags & GMT_InputDelta_GAMEPADS) {
+    if (p >= end) return false;
+    uint8_t pad_mask = *p++;
+    for (int i = 0; i < GMT_MAX_GAMEPADS; i++) {
+      if (!(pad_mask & (1u << i))) continue;
+      GMT_GamepadState* gp = &state->gamepads[i];
+      if (p >= end) return false;
+      uint8_t fields = *p++;
+      int32_t d;
+      if (fields & GMT_InputDeltaPad_CONNECTED) {
+        if (p >= end) return false;
+        gp->connected = *p++;
+      }
+      if (fields & GMT_InputDeltaPad_BUTTONS) {
+        if (end - p < 2) return false;
+        gp->buttons = (uint16_t)(p[0] | (p[1] << 8));
+        p += 2;
+      }
+      if (fields & GMT_InputDeltaPad_LEFT_TRIGGER) {
+        if (p >= end) return false;
+        gp->left_trigger = *p++;
+      }
+      if (fields & GMT_InputDeltaPad_RIGHT_TRIGGER) {
+        if (p >= end) return false;
+        gp->right_trigger = *p++;
+      }
+      if (fields & GMT_InputDeltaPad_LEFT_STICK_X) {
+        if (!GMT__GetVarint(&p, end, &d)) return false;
+        gp->left_stick_x = (int16_t)(gp->left_stick_x + d);
+      }
+      if (fields & GMT_InputDeltaPad_LEFT_STICK_Y) {
+        if (!GMT__GetVarint(&p, end, &d)) return false;
+        gp->left_stick_y = (int16_t)(gp->left_stick_y + d);
+      }
+      if (fields & GMT_InputDeltaPad_RIGHT_STICK_X) {
+        if (!GMT__GetVarint(&p, end, &d)) return false;
+        gp->right_stick_x = (int16_t)(gp->right_stick_x + d);
+      }
+      if (fields & GMT_InputDeltaPad_RIGHT_STICK_Y) {
+        if (!GMT__GetVarint(&p, end, &d)) return false;
+        gp->right_stick_y = (int16_t)(gp->right_stick_y + d);
+      }
+    }
+  }
+  return p == end;
+}
@@ -27,32 +27,120 @@ SOFTWARE.
 #include <stdio.h>
 #include "GameTest.h"
 #include "Platform.h"
+#include "Writer.h"
+#include "RecordReader.h"
+#include "LogRing.h"
+#include "Arena.h"
+#include "ThreadData.h"
+#include "Profile.h"
+#include "Atomic.h"
+#include "InputSampler.h"
 
 // ===== Limits =====
 
-#define GMT_MAX_FAILED_ASSERTIONS   1024
-#define GMT_MAX_UNIQUE_ASSERTIONS   2048
-#define GMT_MAX_DATA_RECORD_PAYLOAD 256  // Maximum payload bytes for a single Pin/Track entry.
-#define GMT_KEY_COUNTER_SLOTS       512  // Hash-map slots for the per-frame sequential key counters.
+#define GMT_MAX_FAILED_ASSERTIONS       1024
+#define GMT_MAX_DATA_RECORD_PAYLOAD     (16u * 1024u * 1024u)  // Largest Pin/Track payload any setup or test file may use.
+#define GMT_DEFAULT_DATA_RECORD_PAYLOAD (64u * 1024u)          // GMT_Setup.max_payload_size when 0.
+#define GMT_KEY_COUNTER_SLOTS           4096                   // Hash-map slots for the per-frame sequential key counters.
+#define GMT_MAX_POOL_PATH               1024                   // Longest test or result path a --pool worker is sent.
 
 // ===== Record File Format =====
 //
 // Layout:
 //   [GMT_FileHeader]
 //   N × tagged record:
-//   TAG_INPUT  (0x01) → GMT_RawInputRecord
+//     TAG_INPUT  (0x01) → GMT_RawInputRecord
 //     TAG_SIGNAL (0x02) → GMT_RawSignalRecord
+//     TAG_PIN    (0x03) → GMT_RawDataRecordHeader + payload
+//     TAG_TRACK  (0x04) → GMT_RawDataRecordHeader + payload
+//     TAG_INPUT_DELTA (0x05) → GMT_RawInputDeltaHeader + delta bytes
+//     TAG_BLOCK  (0x06) → GMT_RawBlockHeader + block bytes
+//     TAG_FRAME  (0x07) → GMT_RawFrameRecord
+//     TAG_KEYFRAME (0x08) → GMT_RawKeyframeHeader + GMT_InputState + game state
 //   TAG_END (0xFF)       → (no body)
+//   [summary]            → GMT_RawRecordSummary
+//   [keyframe index]     → GMT_RawKeyframeIndexEntry × count + GMT_RawKeyframeIndexFooter
 //
 // All multi-byte integers are little-endian.
+//
+// Versions:
+//   0 — Pin/Track headers carry no frame number (GMT_RawDataRecordHeaderV0).
+//   1 — Pin/Track headers carry the frame they were recorded in.  Records staged
+//       by different threads may be stored slightly out of frame order.
+//   2 — Adds TAG_INPUT_DELTA and TAG_BLOCK.
+//   3 — Adds TAG_FRAME.
+//   4 — Adds TAG_KEYFRAME and the keyframe index.
+//
+// TAG_FRAME is written at the end of every GMT_Update and starts the given frame:
+// the input and signal records that follow, up to the next TAG_FRAME, belong to
+// it (records before the first TAG_FRAME belong to frame 0).  Its time is the
+// value GMT_GetTime returns during that frame.
+//
+// TAG_KEYFRAME directly follows the TAG_FRAME of every GMT_Setup.keyframe_interval-th
+// frame.  It holds everything replay needs to start at that frame instead of at
+// the beginning: the input state so far (the base of the next TAG_INPUT_DELTA),
+// how many input and signal records came before it, and the game state saved by
+// GMT_Setup.snapshot_callback.
+//
+// The keyframe index follows TAG_END, outside any TAG_BLOCK, and is only present
+// when the file has keyframes.  Each entry gives the offset of a TAG_KEYFRAME tag
+// in the record stream, counted from the start of the file with every TAG_BLOCK
+// expanded (for uncompressed files that is the file offset).  Readers find it
+// through the fixed-size footer at the very end of the file.
+//
+// The summary follows TAG_END of every file that was closed normally and gives
+// its length, so tools can weigh a test without walking the record stream.  It
+// sits directly before the keyframe index, or at the very end of the file when
+// there is none.  Files recorded before it was added simply lack it.
+//
+// TAG_INPUT_DELTA stores an input snapshot as the change from the previous input
+// record (TAG_INPUT or TAG_INPUT_DELTA; an all-zero state before the first one),
+// see GMT_InputState_EncodeDelta.  The writer falls back to TAG_INPUT whenever the
+// delta would not be smaller.
+//
+// TAG_BLOCK holds a slice of the record stream (never TAG_BLOCK or TAG_END),
+// compressed with GMT_Compress when GMT_Setup.compress_test_file is set.  A
+// record may continue in the next block; readers expand the blocks into one
+// contiguous record stream before decoding (all at once, or as they go when
+// streaming, see GMT_RecordReader).  A file stores either all of its records in
+// blocks or none.
 
 #define GMT_RECORD_MAGIC   0x5447u  // 'GT' in memory (little-endian)
-#define GMT_RECORD_VERSION 0u
+#define GMT_RECORD_VERSION 4u
+
+// Uncompressed capacity of one TAG_BLOCK.
+#define GMT_RECORD_BLOCK_SIZE (64u * 1024u)
+
+// Game-state capacity of a keyframe when GMT_Setup.snapshot_capacity is 0.
+#define GMT_RECORD_DEFAULT_SNAPSHOT_CAPACITY (64u * 1024u)
+
+// GMT_RawKeyframeIndexFooter.magic ('GKIX' in memory).
+#define GMT_RECORD_INDEX_MAGIC 0x58494B47u
+
+// GMT_RawRecordSummary.magic ('GSUM' in memory).
+#define GMT_RECORD_SUMMARY_MAGIC 0x4D555347u
+
+// Log ring size used when GMT_Setup.log_ring_size is 0.
+#define GMT_LOG_DEFAULT_RING_SIZE (256u * 1024u)
+
+// Frame arena size used when GMT_Setup.frame_arena_size is 0.
+#define GMT_FRAME_ARENA_DEFAULT_SIZE (64u * 1024u)
+
+// Writer-thread ring size used when GMT_Setup.record_buffer_size is 0.
+#define GMT_RECORD_DEFAULT_BUFFER_SIZE (1024u * 1024u)
+
+// Frame value given to Pin/Track records loaded from a version-0 file, and to
+// input/signal records loaded from files older than version 3.
+#define GMT_RECORD_FRAME_ANY 0xFFFFFFFFu
 
 #define GMT_RECORD_TAG_INPUT  ((uint8_t)0x01)
 #define GMT_RECORD_TAG_SIGNAL ((uint8_t)0x02)
 #define GMT_RECORD_TAG_PIN    ((uint8_t)0x03)
 #define GMT_RECORD_TAG_TRACK  ((uint8_t)0x04)
+#define GMT_RECORD_TAG_INPUT_DELTA ((uint8_t)0x05)
+#define GMT_RECORD_TAG_BLOCK  ((uint8_t)0x06)
+#define GMT_RECORD_TAG_FRAME  ((uint8_t)0x07)
+#define GMT_RECORD_TAG_KEYFRAME ((uint8_t)0x08)
 #define GMT_RECORD_TAG_END    ((uint8_t)0xFF)
 
 // Fixed-size file header written at the start of every test file.
@@ -76,83 +164,308 @@ typedef struct GMT_RawSignalRecord {
 
 // Header of a TAG_PIN / TAG_TRACK record (variable-length payload follows immediately).
 typedef struct GMT_RawDataRecordHeader {
+  uint32_t frame;  // Frame (GMT_Update count) the call was made in.
   uint32_t key;    // User-supplied key.
   uint32_t index;  // Sequential call index for this key within the current frame.
   uint32_t size;   // Byte length of the payload that follows.
 } GMT_RawDataRecordHeader;
+
+// Version-0 layout of GMT_RawDataRecordHeader (no frame number).
+typedef struct GMT_RawDataRecordHeaderV0 {
+  uint32_t key;
+  uint32_t index;
+  uint32_t size;
+} GMT_RawDataRecordHeaderV0;
+
+// TAG_TRACK payload written by GMT_TrackDigest in place of the tracked buffer.
+typedef struct GMT_RawDigest {
+  uint64_t size;  // Byte length of the buffer.
+  uint64_t hash;  // GMT_Hash64 of the buffer, seed 0.
+} GMT_RawDigest;
+
+// Header of a TAG_INPUT_DELTA record (delta bytes follow immediately).
+typedef struct GMT_RawInputDeltaHeader {
+  uint16_t size;     // Byte length of the encoded delta that follows.
+  double timestamp;  // Seconds since start of recording.
+} GMT_RawInputDeltaHeader;
+
+// Header of a TAG_BLOCK record (stored_size bytes follow immediately).
+typedef struct GMT_RawBlockHeader {
+  uint32_t raw_size;     // Size of the records once expanded.
+  uint32_t stored_size;  // Size as stored; equal to raw_size when left uncompressed.
+} GMT_RawBlockHeader;
+
+// Body of a TAG_FRAME record (written without the tag byte).
+typedef struct GMT_RawFrameRecord {
+  uint32_t frame;  // Frame being started (the value of the GMT_Update count).
+  double time;     // Virtual clock for the frame, in seconds since start of recording.
+} GMT_RawFrameRecord;
+
+// Header of a TAG_KEYFRAME record (GMT_InputState, then state_size bytes follow).
+typedef struct GMT_RawKeyframeHeader {
+  uint32_t frame;         // Frame the keyframe starts; equals the preceding TAG_FRAME.
+  double time;            // Virtual clock for that frame.
+  uint32_t input_count;   // Input records written before the keyframe.
+  uint32_t signal_count;  // Signal records written before the keyframe.
+  uint32_t state_size;    // Byte length of the game state saved by the snapshot callback.
+} GMT_RawKeyframeHeader;
+
+// One keyframe index entry.
+typedef struct GMT_RawKeyframeIndexEntry {
+  uint32_t frame;   // GMT_RawKeyframeHeader.frame of the keyframe.
+  uint64_t offset;  // Offset of its tag byte in the expanded record stream.
+} GMT_RawKeyframeIndexEntry;
+
+// Last bytes of a file that has a keyframe index; `count` entries precede it.
+typedef struct GMT_RawKeyframeIndexFooter {
+  uint32_t count;
+  uint32_t magic;  // GMT_RECORD_INDEX_MAGIC.
+} GMT_RawKeyframeIndexFooter;
+
+// Written after TAG_END when the recording is closed.
+typedef struct GMT_RawRecordSummary {
+  uint32_t frame_count;  // Number of GMT_Update calls in the recording.
+  double duration;       // Seconds from the start of recording to its close.
+  uint32_t magic;        // GMT_RECORD_SUMMARY_MAGIC.
+} GMT_RawRecordSummary;
 #pragma pack(pop)
 
 // ===== File metrics (used for logging after load/before close) =====
 
 typedef struct GMT_FileMetrics {
-  long file_size_bytes;  // File size in bytes (RECORD: incl. pending TAG_END; REPLAY: 0)
-  size_t input_count;    // Number of input records (RECORD: estimated from file size)
+  long file_size_bytes;  // File size in bytes (RECORD: incl. pending TAG_END)
+  size_t input_count;    // Number of input records
+  size_t input_delta_count;  // How many of them are TAG_INPUT_DELTA records
+  size_t input_event_count;    // Input records written from sampled events (RECORD only)
+  size_t input_event_dropped;  // Sampled events lost to a full queue (RECORD only)
+  size_t raw_size_bytes;     // Record bytes before block compression (RECORD only)
+  size_t buffer_high_water;      // Most bytes ever queued for the writer thread (RECORD only)
+  size_t buffer_overflow_count;  // Records that waited for room in the writer ring (RECORD only)
   size_t signal_count;   // Number of signal records (RECORD: not tracked, always 0)
   size_t pin_count;      // Number of pin records
   size_t track_count;    // Number of track records
   double duration;       // Recording length in seconds
   double input_density;  // Input records per second
   uint64_t frame_count;  // Frames processed (RECORD only; 0 for REPLAY)
+  size_t lookup_count;        // Pin/Track lookups performed (REPLAY only)
+  size_t lookup_cursor_hits;  // Lookups resolved by the per-frame cursor without hashing (REPLAY only)
+  size_t lookup_probes;       // Hash slots inspected by the remaining lookups (REPLAY only)
+  size_t keyframe_count;      // Keyframes written (RECORD) or indexed in the file (REPLAY)
+  uint32_t start_frame;       // Frame replay starts at: 0 or a keyframe's frame (REPLAY only)
 } GMT_FileMetrics;
 
 // ===== In-memory decoded records (used during REPLAY) =====
+//
+// Decoded records do not copy their payloads: `data` / `input` point into the
+// loaded file image (g_gmt.replay_file), which stays alive until
+// GMT_Record_FreeReplay.  Payloads are unaligned and must be read with memcpy.
+// When streaming (GMT_Setup.stream_replay) they point into the window's payload
+// chunks and into the readers' record buffers instead.
 
 // Decoded entry for a TAG_PIN or TAG_TRACK record.
 typedef struct GMT_DecodedDataRecord {
+  uint32_t frame;  // GMT_RECORD_FRAME_ANY for version-0 files.
   uint32_t key;
   uint32_t index;
   uint32_t size;
-  uint8_t data[GMT_MAX_DATA_RECORD_PAYLOAD];
+  const uint8_t* data;  // `size` payload bytes inside the file image.
 } GMT_DecodedDataRecord;
 
+#define GMT_PAYLOAD_CHUNK_SIZE (16u * 1024u)
+
+// Payload storage of a streaming pin/track window.  Chunks are filled in file
+// order and freed once every frame stored in them has left the window.  Each is
+// GMT_PAYLOAD_CHUNK_SIZE bytes, or exactly one payload's size if that is larger.
+typedef struct GMT_PayloadChunk {
+  struct GMT_PayloadChunk* next;
+  uint32_t last_frame;  // Highest frame of a payload stored here.
+  size_t used;
+  size_t capacity;  // Bytes of `data`.
+  uint8_t data[];
+} GMT_PayloadChunk;
+
+// Open-addressing hash index over the (frame, key, index) triples of a decoded
+// pin/track array, built once at the end of GMT_Record_LoadReplay so that lookups
+// do not scan the whole array.  Each slot holds 1 + the position of the record in
+// the array (0 = empty).  When several records share a triple (only possible in
+// version-0 files) the first one in file order is indexed.
+typedef struct GMT_DecodedDataIndex {
+  uint32_t* slots;
+  size_t capacity;  // Power of two, at least twice the record count; 0 if empty.
+} GMT_DecodedDataIndex;
+
+// Decoded pin or track records in frame order (file order within a frame), with their lookup index.
+//
+// A cursor is the position just past the last matched record.  Calls within a
+// frame normally arrive in the same order they were recorded, so the record at
+// the cursor is checked first and the hash index is only consulted on a miss.
+// Records of frames that have already passed are skipped as the cursor moves.
+// Each thread keeps its own cursors (GMT_ThreadData); `cursor` here is only used,
+// under the mutex, by a thread whose per-thread data could not be allocated.
+// Cursors count records from the start of the replay, so they survive records
+// leaving the front of a streaming window (`base`).
+//
+// The table is read-only after GMT_Record_LoadReplay, except when streaming:
+// then it only holds the frames around the one being replayed, is refilled by
+// GMT_Record_RefillReplayWindow, and is only accessed with the mutex held.
+typedef struct GMT_DecodedDataTable {
+  GMT_DecodedDataRecord* records;
+  size_t count;
+  size_t cursor;
+  GMT_DecodedDataIndex index;
+  // Streaming window only.
+  size_t base;      // Records dropped from the front so far.
+  size_t capacity;  // Allocated entries of `records`.
+  GMT_PayloadChunk* chunks;  // Oldest first.
+  GMT_PayloadChunk* chunks_tail;
+  GMT_PayloadChunk* spare_chunk;  // Last retired chunk, reused before allocating.
+} GMT_DecodedDataTable;
+
 // ===== Per-frame sequential key counter =====
 //
 // Tracks how many times each key has been seen in the current frame so that
 // repeated calls with the same key can be matched sequentially (call 0 → entry 0,
 // call 1 → entry 1, …).  Reset by GMT_Update_ and GMT_Reset_.
+//
+// Lock-free so that Pin/Track calls from several threads do not serialise on
+// the mutex.  Every slot word carries the generation it was written in; bumping
+// `generation` empties the whole table without touching the slots.
 
 typedef struct GMT_KeyCounter {
-  unsigned int keys[GMT_KEY_COUNTER_SLOTS];
-  unsigned int counts[GMT_KEY_COUNTER_SLOTS];
-  bool occupied[GMT_KEY_COUNTER_SLOTS];
+  volatile uint64_t keys[GMT_KEY_COUNTER_SLOTS];    // (generation << 32) | key
+  volatile uint64_t counts[GMT_KEY_COUNTER_SLOTS];  // (generation << 32) | count
+  volatile uint32_t generation;
+  volatile uint64_t overflows;  // Calls that found the table full this run; they all get index 0.
 } GMT_KeyCounter;
 
 // Returns the current sequential index for key and increments it.
-// Must be called with the mutex held.
+// Safe to call from any thread without the mutex.
 static inline unsigned int GMT_KeyCounter_Next(GMT_KeyCounter* kc, unsigned int key) {
+  // Stored generations are never 0 so the zeroed table reads as empty.
+  uint32_t gen = GMT_Atomic_Load32(&kc->generation) + 1u;
+  if (gen == 0) gen = 1;
+  uint64_t tag = ((uint64_t)gen << 32) | (uint64_t)key;
   unsigned int slot = key % (unsigned int)GMT_KEY_COUNTER_SLOTS;
   for (unsigned int i = 0; i < (unsigned int)GMT_KEY_COUNTER_SLOTS; i++) {
     unsigned int s = (slot + i) % (unsigned int)GMT_KEY_COUNTER_SLOTS;
-    if (!kc->occupied[s]) {
-      kc->keys[s] = key;
-      kc->counts[s] = 1;
-      kc->occupied[s] = true;
-      return 0;
+    uint64_t cur = GMT_Atomic_Load64(&kc->keys[s]);
+    if (cur != tag) {
+      if ((uint32_t)(cur >> 32) == gen) continue;  // Owned by another key this frame.
+      if (!GMT_Atomic_CompareExchange64(&kc->keys[s], cur, tag) && GMT_Atomic_Load64(&kc->keys[s]) != tag) continue;
     }
-    if (kc->keys[s] == key) return kc->counts[s]++;
+    for (;;) {
+      uint64_t c = GMT_Atomic_Load64(&kc->counts[s]);
+      uint64_t next = ((uint32_t)(c >> 32) == gen) ? c + 1 : (((uint64_t)gen << 32) | 1u);
+      if (GMT_Atomic_CompareExchange64(&kc->counts[s], c, next)) return (unsigned int)((uint32_t)next - 1u);
+    }
+  }
+  // Table full: more distinct keys this frame than slots.  Such calls all get
+  // index 0, so repeated calls with those keys no longer line up; say so once.
+  if (GMT_Atomic_Add64(&kc->overflows, 1) == 1) {
+    GMT_LogWarning("More than %d distinct Pin/Track keys in one frame; further keys share index 0.", GMT_KEY_COUNTER_SLOTS);
   }
-  return 0;  // Counter table full; saturate.
+  return 0;
 }
 
 static inline void GMT_KeyCounter_Reset(GMT_KeyCounter* kc) {
-  memset(kc, 0, sizeof(*kc));
+  GMT_Atomic_Add32(&kc->generation, 1);
 }
 
 typedef struct GMT_DecodedInput {
-  double timestamp;  // Seconds since start of recording.
-  GMT_InputState input;
+  double timestamp;      // Seconds since start of recording.
+  uint32_t frame;        // Frame it was recorded in; GMT_RECORD_FRAME_ANY before version 3.
+  const uint8_t* input;  // Packed GMT_InputState, or delta bytes, inside the file image.
+  uint32_t delta_size;   // 0 for a full TAG_INPUT state, else the TAG_INPUT_DELTA byte count.
 } GMT_DecodedInput;
 
 typedef struct GMT_DecodedSignal {
   double timestamp;  // Seconds since start of recording.
+  uint32_t frame;    // Frame it was recorded in; GMT_RECORD_FRAME_ANY before version 3.
   int32_t signal_id;
 } GMT_DecodedSignal;
 
+// A recorded keyframe GMT_Setup.verify_keyframes compares the live game state with.
+typedef struct GMT_KeyframeCheck {
+  uint32_t frame;       // GMT_RawKeyframeHeader.frame.
+  uint32_t state_size;  // Bytes of game state recorded.
+  uint64_t hash;        // GMT_Hash64 of the recorded game state, seed 0.
+} GMT_KeyframeCheck;
+
+// ===== Streaming replay =====
+//
+// With GMT_Setup.stream_replay the test file is never loaded whole.  Three
+// readers walk it side by side, each at its own pace: one yields the next input
+// record, one the next sync signal, and one keeps replay_pins / replay_tracks
+// filled with the frames from one before the replayed frame to
+// GMT_REPLAY_WINDOW_AHEAD after it, along with their frame times.
+
+#define GMT_REPLAY_WINDOW_AHEAD 4    // Frames of pins/tracks decoded ahead of the replayed one.
+#define GMT_REPLAY_WINDOW_TIMES 64   // Frame times kept (power of two).
+
+typedef struct GMT_ReplayStream {
+  GMT_RecordReader inputs;
+  GMT_RecordReader signals;
+  GMT_RecordReader data;
+  // Frame of the last TAG_FRAME each reader passed.
+  uint32_t input_frame;
+  uint32_t signal_frame;
+  uint32_t data_frame;
+  // Record read ahead of its turn; next_input.input points into inputs.record.
+  bool have_input;
+  GMT_DecodedInput next_input;
+  bool have_signal;
+  GMT_DecodedSignal next_signal;
+  // Pins/tracks of frames before this one have been dropped.
+  uint32_t window_frame;
+  // Recorded time of frame f at [f % GMT_REPLAY_WINDOW_TIMES], for frames up to data_frame.
+  double frame_times[GMT_REPLAY_WINDOW_TIMES];
+  // Copy of the start keyframe's game state (replay_keyframe_state).
+  uint8_t* keyframe_state;
+  long file_size;
+  // Records decoded so far.
+  size_t input_delta_count;
+  size_t pin_count;
+  size_t track_count;
+  // A reader met a malformed record; GMT_Update fails the test.
+  bool failed;
+} GMT_ReplayStream;
+
+// ===== Status Block =====
+//
+// Live progress of a test, published for GameTest-Tool in the shared memory it
+// names with --test-status (GMT_Setup.status_name).  GMT_Update rewrites it each
+// frame and bumps heartbeat last; the tool polls it to show progress and to stop
+// stalled replays.  tool/Tool.c mirrors this layout.
+
+#define GMT_STATUS_MAGIC   0x54534D47u  // "GMST"
+#define GMT_STATUS_VERSION 1u
+
+#define GMT_STATUS_FLAG_FAILED  0x1u  // The test has failed (GMT_Fail).
+#define GMT_STATUS_FLAG_WAITING 0x2u  // Replay is blocked on sync signal waiting_signal_id.
+
+typedef struct GMT_StatusBlock {
+  volatile uint32_t magic;      // GMT_STATUS_MAGIC once the process has attached.
+  uint32_t version;             // GMT_STATUS_VERSION.
+  volatile uint32_t heartbeat;  // Incremented by every GMT_Update.
+  volatile uint32_t flags;      // GMT_STATUS_FLAG_*.
+  uint64_t frame_index;
+  uint64_t input_cursor;  // Replay input records injected so far.
+  uint64_t input_count;   // Replay input records in the file; 0 when streamed.
+  int32_t waiting_signal_id;
+  uint32_t failed_assertions;  // Assertion failures this run.
+  double frame_time;           // GMT_GetTime for the current frame.
+} GMT_StatusBlock;
+
 // ===== Global framework state =====
 
 typedef struct GMT_State {
   bool initialized;
   GMT_Mode mode;
+  // Set for the state of a GMT_Context: it leaves the process-wide hooks,
+  // working directory and OS input alone and delivers input virtually.
+  bool context;
+  // Guards the state's frame-level work; see GMT_Platform_MutexLock.
+  GMT_Mutex* mutex;
 
   // Shallow copy of the user's GMT_Setup provided to GMT_Init.
   // Pointers inside (test_path, work_dir, directory_mappings) should remain
@@ -164,19 +477,61 @@ typedef struct GMT_State {
   size_t failed_assertion_count;
   // Running count of assertion failures this run (reset by GMT_Reset).
   int assertion_fire_count;
-  // Total number of GMT_Assert_ calls (pass + fail) this run.
-  size_t total_assertion_count;
-  // Number of distinct call-site locations seen this run.
-  size_t unique_assertion_count;
-  // Open-addressing hash set used to track unique assertion call sites.
-  int seen_assertion_hashes[GMT_MAX_UNIQUE_ASSERTIONS];
-  bool seen_assertion_occupied[GMT_MAX_UNIQUE_ASSERTIONS];
+  // Value a GMT_AssertSite holds once it has run in this run (GMT_Assert_ResetSites).
+  uint32_t assert_generation;
+  // Sites counted this run, keyed by address; guarded by the mutex (Assert.c).
+  uintptr_t* assert_sites;
+  size_t assert_site_capacity;
+  size_t assert_site_count;
+  // Total number of GMT_Assert_ calls (pass + fail) this run.  Updated atomically.
+  volatile uint64_t total_assertion_count;
+  // Number of distinct call sites seen this run.  Updated atomically.
+  volatile uint64_t unique_assertion_count;
   bool test_failed;
 
+  // ----- Logging -----
+  // Deferred-logging ring; log_ring.worker.thread is NULL while messages go out directly.
+  GMT_LogRing log_ring;
+
+  // ----- Profiling -----
+  // Framework overhead scopes and the optional Chrome trace (see Profile.h).
+  GMT_Profile profile;
+
+  // ----- Arenas -----
+  // Scratch memory for short-lived buffers; reset by GMT_Update.
+  GMT_Arena frame_arena;
+  // The decoded replay arrays of a fully loaded test file, in one block.
+  GMT_Arena replay_arena;
+
   // ----- Runtime -----
+  // Per-thread Pin/Track state of every thread that has called in (see ThreadData.h).
+  GMT_ThreadData* threads;
+
+  // ----- Test pool -----
+  // Connection to GameTest-Tool while running as a --pool worker (Pool.c).
+  GMT_Pipe* pool_pipe;
+  // Backing for setup.test_path / setup.result_path once GMT_ResetTo or the
+  // pool has switched to another test.
+  char test_path[GMT_MAX_POOL_PATH];
+  char result_path[GMT_MAX_POOL_PATH];
+
+  // ----- Status block -----
+  // View of GMT_Setup.status_name, or NULL (Status.c).
+  GMT_StatusBlock* status;
+
+  // Largest Pin/Track payload accepted, resolved from GMT_Setup.max_payload_size by GMT_Init.
+  size_t max_payload_size;
+  // Set by the GMT_TrackDigest mismatch that dumped its buffer to GMT_Setup.digest_dump_dir.
+  volatile uint32_t digest_dumped;
+
   // Monotonically increasing counter incremented by each GMT_Update call.
   uint64_t frame_index;
 
+  // ----- Input sampling -----
+  // GMT_Setup.input_sample_rate thread and, in RECORD, the queue of events it and
+  // the keyboard hook fill (see InputSampler.h).
+  GMT_InputSampler input_sampler;
+
   // ----- Timing -----
   // Platform time (seconds) when recording or replay started.
   // Used as the epoch for all recorded timestamps.
@@ -186,12 +541,32 @@ typedef struct GMT_State {
   double replay_time_offset;
   // Platform time when the current signal wait began (used to compute offset on unblock).
   double signal_wait_start;
+  // Value returned by GMT_GetTime for the current frame (seconds).  RECORD: time
+  // of the last GMT_Update; REPLAY: the recorded value or the replay clock.
+  double frame_time;
 
   // ----- RECORD mode -----
   FILE* record_file;  // Open for streaming write while recording.
+  // Background writer that owns record_file and the block buffers while its
+  // thread runs; record_writer.worker.thread is NULL when writing synchronously.
+  GMT_Writer record_writer;
 
-  // Previous input state written to disk; used to skip duplicate frames.
+  // Previous input state written to disk; used to skip duplicate frames and as
+  // the base of the next TAG_INPUT_DELTA.
   GMT_InputState record_prev_input;
+  // Timestamp of the last input record written.  Queued events older than it are
+  // superseded by that record's capture.
+  double record_last_input_time;
+  // Input records written from events of input_sampler.
+  size_t record_input_event_count;
+  // Pending TAG_BLOCK contents (NULL unless setup.compress_test_file is set).
+  uint8_t* record_block;
+  size_t record_block_used;
+  uint8_t* record_block_out;  // Compression output, GMT_COMPRESS_BOUND(GMT_RECORD_BLOCK_SIZE) bytes.
+  // Uncompressed record bytes emitted so far (excluding the header and TAG_END).
+  size_t record_raw_bytes;
+  // Number of input records written as TAG_INPUT_DELTA.
+  size_t record_input_delta_count;
   // Exact count of input records written during this recording session.
   size_t record_input_count;
   // Exact count of signal records written during this recording session.
@@ -200,26 +575,92 @@ typedef struct GMT_State {
   size_t record_pin_count;
   // Exact count of track records written during this recording session.
   size_t record_track_count;
+  // Keyframe index collected while recording; written after TAG_END.
+  GMT_RawKeyframeIndexEntry* record_keyframes;
+  size_t record_keyframe_count;
+  size_t record_keyframe_capacity;
+  // Body of the next TAG_KEYFRAME: a GMT_InputState followed by room for
+  // record_snapshot_capacity bytes of game state.  NULL if keyframes are off.
+  uint8_t* record_keyframe_body;
+  size_t record_snapshot_capacity;
 
   // ----- REPLAY mode -----
+  // Whole test file.  Memory-mapped when the platform allows it, otherwise read
+  // into a GMT_Alloc'd buffer (replay_file_mapped == false).
+  GMT_MappedFile replay_file;
+  bool replay_file_mapped;
+  // Set instead when the file is streamed (GMT_Setup.stream_replay); replay_inputs
+  // and replay_signals are then unused and their counts stay 0.
+  bool replay_streaming;
+  GMT_ReplayStream replay_stream;
+
   GMT_DecodedInput* replay_inputs;
   size_t replay_input_count;
-  size_t replay_input_cursor;  // Index of next input record to inject.
+  size_t replay_input_cursor;  // Index of next input record to inject (records consumed when streaming).
 
   GMT_DecodedSignal* replay_signals;
   size_t replay_signal_count;
-  size_t replay_signal_cursor;  // Index of next expected signal.
+  size_t replay_signal_cursor;  // Index of next expected signal (signals consumed when streaming).
 
   // Previous per-frame input state, used to compute deltas for injection.
   GMT_InputState replay_prev_input;
-
-  // ----- PIN replay data -----
-  GMT_DecodedDataRecord* replay_pins;
-  size_t replay_pin_count;
-
-  // ----- TRACK replay data -----
-  GMT_DecodedDataRecord* replay_tracks;
-  size_t replay_track_count;
+  // State of the input record before replay_input_cursor; TAG_INPUT_DELTA
+  // records are applied on top of it.
+  GMT_InputState replay_decode_state;
+  // Number of replay input records stored as TAG_INPUT_DELTA.
+  size_t replay_input_delta_count;
+
+  // Format version of the loaded test file.
+  uint16_t replay_version;
+
+  // Keyframe replay starts from (GMT_Setup.replay_start_frame), applied by the
+  // first GMT_Update in place of input injection.  Only records after it are
+  // decoded.  replay_keyframe.state_size bytes of game state are at
+  // replay_keyframe_state, and its input state is replay_decode_state.
+  bool replay_keyframe_pending;
+  bool replay_from_keyframe;
+  GMT_RawKeyframeHeader replay_keyframe;
+  const uint8_t* replay_keyframe_state;  // Inside the file image, or replay_stream.keyframe_state.
+  size_t replay_keyframe_count;          // Keyframes listed in the file's index.
+
+  // GMT_Setup.verify_keyframes: keyframes after the start one still to be checked,
+  // in frame order from replay_check_cursor.  Collected by the load, or by the
+  // streaming window as it passes them.  The live state is saved to replay_check_state.
+  GMT_KeyframeCheck* replay_checks;
+  size_t replay_check_count;
+  size_t replay_check_capacity;
+  size_t replay_check_cursor;
+  uint8_t* replay_check_state;
+  size_t replay_check_state_capacity;
+  // Replay has reached GMT_Setup.replay_end_frame; GMT_ShouldQuit reports it.
+  bool replay_end_reached;
+
+  // True when inputs are released by frame number (GMT_ReplayTiming_FRAME and a
+  // version-3 file) rather than by timestamp.
+  bool replay_by_frame;
+  // Frames spent waiting for sync signals, less the frames skipped by starting
+  // at a keyframe (two's complement; negative when the game ran ahead).
+  // Subtracted from frame_index to get the recorded frame being replayed, see
+  // GMT_ReplayFrame.  Updated atomically: Pin/Track read it unlocked.
+  volatile uint64_t replay_frame_offset;
+  // Recorded frame minus frame_index once replay started at a keyframe (two's
+  // complement), for the Pin/Track frame under the wall clock.  Updated atomically.
+  volatile uint64_t replay_keyframe_shift;
+  // frame_index when the current signal wait began.
+  uint64_t signal_wait_frame;
+  // Recorded frame_time for each frame, indexed by frame (TAG_FRAME records).
+  double* replay_frame_times;
+  size_t replay_frame_count;
+
+  // ----- PIN / TRACK replay data -----
+  GMT_DecodedDataTable replay_pins;
+  GMT_DecodedDataTable replay_tracks;
+
+  // Bumped by every successful load so per-thread cursors know to restart.
+  uint32_t replay_generation;
+
+  // Lookup cost counters for calls made without per-thread data (reset on load).
+  GMT_LookupStats replay_lookup;
 
   // Per-key sequential counters; reset at the start of each frame (GMT_Update_) and on GMT_Reset_.
   GMT_KeyCounter pin_counter;
@@ -230,6 +671,11 @@ typedef struct GMT_State {
   // so that polling-based games see the replayed state instead of real hardware.
   GMT_InputState replay_current_input;
 
+  // GMT_InputInjection_VIRTUAL: the input GMT_GetVirtualInput returns for the
+  // current frame.  GMT_InputCapture_VIRTUAL: the input GMT_SetVirtualInput gave
+  // for the next GMT_Update to record.
+  GMT_InputState virtual_input;
+
   // True while the IAT hooks should return replayed state instead of calling
   // through to the original Win32 functions.
   bool replay_hooks_active;
@@ -240,5 +686,63 @@ typedef struct GMT_State {
 
 } GMT_State;
 
-// Defined in GameTest.c.
-extern GMT_State g_gmt;
+#if defined(_MSC_VER)
+#  define GMT_THREAD_LOCAL __declspec(thread)
+#else
+#  define GMT_THREAD_LOCAL _Thread_local
+#endif
+
+// State the calling thread's framework calls act on: the default state that
+// GMT_Init starts, or the GMT_Context made current on this thread.  Threads
+// the framework starts inherit their creator's.  Defined in GameTest.c.
+extern GMT_THREAD_LOCAL GMT_State* g_gmt_current;
+#define g_gmt (*g_gmt_current)
+
+// Lock the current state's recursive mutex.
+static inline void GMT_Platform_MutexLock(void) {
+  GMT_Platform_LockMutex(g_gmt.mutex);
+}
+static inline void GMT_Platform_MutexUnlock(void) {
+  GMT_Platform_UnlockMutex(g_gmt.mutex);
+}
+
+// Deferred logging (Log.c).  Start and Stop run from GMT_Init / GMT_Quit; Flush
+// waits (bounded) until every queued message has been written.
+bool GMT_Log_StartDeferred(void);
+void GMT_Log_StopDeferred(void);
+void GMT_Log_Flush(void);
+
+// Short-lived scratch memory from the frame arena (Memory.c); any thread may
+// use it.  GMT_Update reclaims the arena once every block has been passed to
+// GMT_FrameFree.  Falls back to GMT_Alloc when the arena is full.
+void* GMT_FrameAlloc(size_t size);
+void GMT_FrameFree(void* ptr);
+
+// Starts a new assertion run: every GMT_AssertSite counts as unseen again.
+// FreeSites releases the state's table of seen sites (Assert.c).
+void GMT_Assert_ResetSites(void);
+void GMT_Assert_FreeSites(void);
+
+// Fails an assertion the framework checks on the caller's behalf (GMT_Track
+// mismatches); it counts as unique per caller location (Assert.c).
+void GMT_Assert_Location(const char* msg, GMT_CodeLocation loc);
+
+// Writes GMT_Setup.result_path, if set, from the current state (Util.c).
+void GMT_WriteResultFile(void);
+
+// Joins / leaves the GameTest-Tool pool named by GMT_Setup.pool_name (Pool.c).
+bool GMT_Pool_Connect(void);
+void GMT_Pool_Disconnect(void);
+
+// Attaches to / detaches from the status block named by GMT_Setup.status_name,
+// and publishes the current frame into it (Status.c).  Update is called with
+// the mutex held.
+void GMT_Status_Open(void);
+void GMT_Status_Close(void);
+void GMT_Status_Update(void);
+
+// Recorded frame that corresponds to the current frame_index during replay.
+// Safe to call from any thread.
+static inline int64_t GMT_ReplayFrame(void) {
+  return (int64_t)(GMT_Atomic_Load64(&g_gmt.frame_index) - GMT_Atomic_Load64(&g_gmt.replay_frame_offset));
+}
@@ -27,8 +27,10 @@ SOFTWARE.
 #include <stdarg.h>
 #include <stdlib.h>
 
-static void GMT_DefaultLogCallback(GMT_Severity severity, const char* msg, GMT_CodeLocation loc) {
-  FILE* out = (severity == GMT_Severity_ERROR) ? stderr : stdout;
+// Bounded so that a crash handler never hangs on a wedged log thread.
+#define GMT__LOG_FLUSH_TIMEOUT_MS 1000
+
+static void GMT__WriteDefault(GMT_Severity severity, GMT_Mode mode, const char* msg, GMT_CodeLocation loc, FILE* out) {
   const char* prefix = "";
   switch (severity) {
     case GMT_Severity_ERROR:   prefix = "ERROR"; break;
@@ -36,33 +38,84 @@ static void GMT_DefaultLogCallback(GMT_Severity severity, const char* msg, GMT_C
     case GMT_Severity_INFO:    prefix = "INFO"; break;
   }
 
-  const char* mode = "DISABLED";
-  switch (g_gmt.mode) {
-    case GMT_Mode_RECORD: mode = "RECORD"; break;
-    case GMT_Mode_REPLAY: mode = "REPLAY"; break;
+  const char* mode_str = "DISABLED";
+  switch (mode) {
+    case GMT_Mode_RECORD: mode_str = "RECORD"; break;
+    case GMT_Mode_REPLAY: mode_str = "REPLAY"; break;
     case GMT_Mode_DISABLED:
     default:
       break;
   }
 
 #ifdef GMT_VERBOSE
-  fprintf(out, "[GameTest-%s] [%s] %s  (%s:%d in %s)\n", mode, prefix, msg ? msg : "(null)", loc.file ? loc.file : "?", loc.line, loc.function ? loc.function : "?");
+  fprintf(out, "[GameTest-%s] [%s] %s  (%s:%d in %s)\n", mode_str, prefix, msg ? msg : "(null)", loc.file ? loc.file : "?", loc.line, loc.function ? loc.function : "?");
 #else
-  fprintf(out, "[GameTest-%s] [%s] %s\n", mode, prefix, msg ? msg : "(null)");
+  (void)loc;
+  fprintf(out, "[GameTest-%s] [%s] %s\n", mode_str, prefix, msg ? msg : "(null)");
 #endif
+}
 
+static void GMT_DefaultLogCallback(GMT_Severity severity, const char* msg, GMT_CodeLocation loc) {
+  FILE* out = (severity == GMT_Severity_ERROR) ? stderr : stdout;
+  GMT__WriteDefault(severity, g_gmt.mode, msg, loc, out);
   fflush(out);
 }
 
+// ===== Deferred logging =====
+
+// Runs on the log thread for every queued message.
+static void GMT__DeferredSink(GMT_Severity severity, GMT_Mode mode, const char* msg, GMT_CodeLocation loc) {
+  GMT_LogCallback cb = g_gmt.setup.log_callback;
+  if (cb) {
+    cb(severity, msg, loc);
+  } else {
+    GMT__WriteDefault(severity, mode, msg, loc, (severity == GMT_Severity_ERROR) ? stderr : stdout);
+  }
+}
+
+// The default output is flushed once per batch instead of once per line.
+static void GMT__DeferredBatch(void) {
+  if (g_gmt.setup.log_callback) return;
+  fflush(stdout);
+  fflush(stderr);
+}
+
+bool GMT_Log_StartDeferred(void) {
+  size_t size = g_gmt.setup.log_ring_size ? g_gmt.setup.log_ring_size : GMT_LOG_DEFAULT_RING_SIZE;
+  return GMT_LogRing_Start(&g_gmt.log_ring, size, GMT__DeferredSink, GMT__DeferredBatch);
+}
+
+void GMT_Log_StopDeferred(void) {
+  GMT_LogRing_Stop(&g_gmt.log_ring);
+}
+
+void GMT_Log_Flush(void) {
+  GMT_LogRing_Flush(&g_gmt.log_ring, GMT__LOG_FLUSH_TIMEOUT_MS);
+}
+
+// ===== Log entry point =====
+
 void GMT_Log_(GMT_Severity severity, GMT_CodeLocation loc, const char* fmt, ...) {
   const char* safe_fmt = fmt ? fmt : "(null)";
+  uint64_t profile_begin = GMT_Profile_Begin();
   va_list args;
 
+  // Deferred: store the format and arguments; the log thread does the rest.
+  if (g_gmt.log_ring.worker.thread) {
+    va_start(args, fmt);
+    bool queued = GMT_LogRing_Push(&g_gmt.log_ring, severity, g_gmt.mode, loc, safe_fmt, args);
+    va_end(args);
+    if (queued) {
+      GMT_Profile_End(GMT_ProfileScope_LOG, profile_begin);
+      return;
+    }
+  }
+
   va_start(args, fmt);
   int needed = vsnprintf(NULL, 0, safe_fmt, args);
   va_end(args);
 
-  char* buf = GMT_Alloc(needed + 1);
+  char* buf = GMT_FrameAlloc(needed + 1);
   if (buf) {
     va_start(args, fmt);
     vsnprintf(buf, (size_t)needed + 1, safe_fmt, args);
@@ -76,5 +129,6 @@ void GMT_Log_(GMT_Severity severity, GMT_CodeLocation loc, const char* fmt, ...)
     GMT_DefaultLogCallback(severity, buf ? buf : safe_fmt, loc);
   }
 
-  GMT_Free(buf);
+  GMT_FrameFree(buf);
+  GMT_Profile_End(GMT_ProfileScope_LOG, profile_begin);
 }
\ No newline at end of file
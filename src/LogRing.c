@@ -0,0 +1,406 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "LogRing.h"
+#include "Atomic.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#  define GMT_THREAD_LOCAL __declspec(thread)
+#else
+#  define GMT_THREAD_LOCAL _Thread_local
+#endif
+
+// Set on the log thread: messages the sink or the formatter log themselves
+// cannot be queued behind the record being drained, so they go out directly.
+static GMT_THREAD_LOCAL bool t_gmt_on_log_thread;
+
+// Start of every record.  `format` is NULL for a record that carries its
+// message as text rather than as packed arguments.
+typedef struct GMT__LogHeader {
+  uint32_t size;  // Header plus payload, in bytes.
+  uint8_t severity;
+  uint8_t mode;
+  const char* format;
+  GMT_CodeLocation loc;
+} GMT__LogHeader;
+
+// ===== Argument packing =====
+
+typedef enum GMT__ArgKind {
+  GMT__ARG_INVALID = 0,  // Unsupported conversion: the message is formatted up front.
+  GMT__ARG_LITERAL,      // "%%"
+  GMT__ARG_INT,
+  GMT__ARG_UINT,
+  GMT__ARG_LONG,
+  GMT__ARG_ULONG,
+  GMT__ARG_LLONG,
+  GMT__ARG_ULLONG,
+  GMT__ARG_SIZE,
+  GMT__ARG_PTRDIFF,
+  GMT__ARG_INTMAX,
+  GMT__ARG_UINTMAX,
+  GMT__ARG_DOUBLE,
+  GMT__ARG_POINTER,
+  GMT__ARG_STRING,
+} GMT__ArgKind;
+
+// Parses the conversion starting after a '%' and returns the character after
+// it.  Conversions that take extra arguments ('*') or that the formatter
+// cannot reproduce (%n, wide strings, long double) are reported as invalid.
+static const char* GMT__ParseConversion(const char* p, GMT__ArgKind* out_kind) {
+  *out_kind = GMT__ARG_INVALID;
+  if (*p == '%') {
+    *out_kind = GMT__ARG_LITERAL;
+    return p + 1;
+  }
+  while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0') p++;
+  while (*p >= '0' && *p <= '9') p++;
+  if (*p == '.') {
+    p++;
+    while (*p >= '0' && *p <= '9') p++;
+  }
+  if (*p == '*') return p;
+
+  enum { LEN_NONE, LEN_L, LEN_LL, LEN_Z, LEN_J, LEN_T, LEN_BIG_L } len = LEN_NONE;
+  if (p[0] == 'h') p += (p[1] == 'h') ? 2 : 1;
+  else if (p[0] == 'l' && p[1] == 'l') len = LEN_LL, p += 2;
+  else if (p[0] == 'l') len = LEN_L, p++;
+  else if (p[0] == 'z') len = LEN_Z, p++;
+  else if (p[0] == 'j') len = LEN_J, p++;
+  else if (p[0] == 't') len = LEN_T, p++;
+  else if (p[0] == 'L') len = LEN_BIG_L, p++;
+
+  const bool is_signed = (*p == 'd' || *p == 'i');
+  switch (*p) {
+    case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+      switch (len) {
+        case LEN_NONE:  *out_kind = is_signed ? GMT__ARG_INT : GMT__ARG_UINT; break;
+        case LEN_L:     *out_kind = is_signed ? GMT__ARG_LONG : GMT__ARG_ULONG; break;
+        case LEN_LL:    *out_kind = is_signed ? GMT__ARG_LLONG : GMT__ARG_ULLONG; break;
+        case LEN_Z:     *out_kind = is_signed ? GMT__ARG_PTRDIFF : GMT__ARG_SIZE; break;
+        case LEN_J:     *out_kind = is_signed ? GMT__ARG_INTMAX : GMT__ARG_UINTMAX; break;
+        case LEN_T:     *out_kind = GMT__ARG_PTRDIFF; break;
+        case LEN_BIG_L: break;
+      }
+      break;
+    case 'c':
+      if (len == LEN_NONE) *out_kind = GMT__ARG_INT;
+      break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+      if (len == LEN_NONE || len == LEN_L) *out_kind = GMT__ARG_DOUBLE;
+      break;
+    case 'p':
+      if (len == LEN_NONE) *out_kind = GMT__ARG_POINTER;
+      break;
+    case 's':
+      if (len == LEN_NONE) *out_kind = GMT__ARG_STRING;
+      break;
+    default:
+      return p;
+  }
+  return p + 1;
+}
+
+// Appends one va_arg of the given kind to out.  Returns false if it does not fit.
+#define GMT__PACK_ARG(type)                      \
+  do {                                           \
+    type value = va_arg(args, type);             \
+    if (cap - used < sizeof(value)) return false; \
+    memcpy(out + used, &value, sizeof(value));   \
+    used += sizeof(value);                       \
+  } while (0)
+
+// Stores the arguments fmt refers to in out.  Returns false if fmt holds a
+// conversion the formatter cannot reproduce or the arguments do not fit.
+static bool GMT__PackArgs(const char* fmt, va_list args, uint8_t* out, size_t cap, size_t* out_size) {
+  size_t used = 0;
+  for (const char* p = fmt; *p;) {
+    if (*p++ != '%') continue;
+    GMT__ArgKind kind;
+    p = GMT__ParseConversion(p, &kind);
+    switch (kind) {
+      case GMT__ARG_INVALID: return false;
+      case GMT__ARG_LITERAL: break;
+      case GMT__ARG_INT:     GMT__PACK_ARG(int); break;
+      case GMT__ARG_UINT:    GMT__PACK_ARG(unsigned int); break;
+      case GMT__ARG_LONG:    GMT__PACK_ARG(long); break;
+      case GMT__ARG_ULONG:   GMT__PACK_ARG(unsigned long); break;
+      case GMT__ARG_LLONG:   GMT__PACK_ARG(long long); break;
+      case GMT__ARG_ULLONG:  GMT__PACK_ARG(unsigned long long); break;
+      case GMT__ARG_SIZE:    GMT__PACK_ARG(size_t); break;
+      case GMT__ARG_PTRDIFF: GMT__PACK_ARG(ptrdiff_t); break;
+      case GMT__ARG_INTMAX:  GMT__PACK_ARG(intmax_t); break;
+      case GMT__ARG_UINTMAX: GMT__PACK_ARG(uintmax_t); break;
+      case GMT__ARG_DOUBLE:  GMT__PACK_ARG(double); break;
+      case GMT__ARG_POINTER: GMT__PACK_ARG(void*); break;
+      case GMT__ARG_STRING: {
+        // Strings are copied: the caller's buffer may be gone by the time the
+        // record is formatted.
+        const char* s = va_arg(args, const char*);
+        if (!s) s = "(null)";
+        size_t n = strlen(s) + 1;
+        if (cap - used < n) return false;
+        memcpy(out + used, s, n);
+        used += n;
+        break;
+      }
+    }
+  }
+  *out_size = used;
+  return true;
+}
+
+#undef GMT__PACK_ARG
+
+// Formats the next packed argument with `conversion` into dst.
+#define GMT__FORMAT_ARG(type)                             \
+  do {                                                    \
+    type value;                                           \
+    memcpy(&value, in, sizeof(value));                    \
+    in += sizeof(value);                                  \
+    written = snprintf(dst, dst_size, conversion, value); \
+  } while (0)
+
+// Rebuilds the message from a format string and the arguments packed by
+// GMT__PackArgs, truncating it to out_size - 1 characters.
+static void GMT__FormatPacked(const char* fmt, const uint8_t* in, char* out, size_t out_size) {
+  size_t pos = 0;
+  const char* p = fmt;
+  while (*p && pos + 1 < out_size) {
+    if (*p != '%') {
+      out[pos++] = *p++;
+      continue;
+    }
+    GMT__ArgKind kind;
+    const char* start = p;
+    p = GMT__ParseConversion(p + 1, &kind);
+    if (kind == GMT__ARG_LITERAL) {
+      out[pos++] = '%';
+      continue;
+    }
+
+    char conversion[32];
+    size_t length = (size_t)(p - start);
+    if (length >= sizeof(conversion)) length = sizeof(conversion) - 1;
+    memcpy(conversion, start, length);
+    conversion[length] = '\0';
+
+    char* dst = out + pos;
+    size_t dst_size = out_size - pos;
+    int written = 0;
+    switch (kind) {
+      case GMT__ARG_INT:     GMT__FORMAT_ARG(int); break;
+      case GMT__ARG_UINT:    GMT__FORMAT_ARG(unsigned int); break;
+      case GMT__ARG_LONG:    GMT__FORMAT_ARG(long); break;
+      case GMT__ARG_ULONG:   GMT__FORMAT_ARG(unsigned long); break;
+      case GMT__ARG_LLONG:   GMT__FORMAT_ARG(long long); break;
+      case GMT__ARG_ULLONG:  GMT__FORMAT_ARG(unsigned long long); break;
+      case GMT__ARG_SIZE:    GMT__FORMAT_ARG(size_t); break;
+      case GMT__ARG_PTRDIFF: GMT__FORMAT_ARG(ptrdiff_t); break;
+      case GMT__ARG_INTMAX:  GMT__FORMAT_ARG(intmax_t); break;
+      case GMT__ARG_UINTMAX: GMT__FORMAT_ARG(uintmax_t); break;
+      case GMT__ARG_DOUBLE:  GMT__FORMAT_ARG(double); break;
+      case GMT__ARG_POINTER: GMT__FORMAT_ARG(void*); break;
+      case GMT__ARG_STRING: {
+        const char* s = (const char*)in;
+        in += strlen(s) + 1;
+        written = snprintf(dst, dst_size, conversion, s);
+        break;
+      }
+      default:
+        break;  // Not produced for a packed record.
+    }
+    if (written < 0) written = 0;
+    pos += ((size_t)written < dst_size) ? (size_t)written : dst_size - 1;
+  }
+  out[pos] = '\0';
+}
+
+#undef GMT__FORMAT_ARG
+
+// ===== Ring =====
+
+// Copies size bytes into the data areas of the slots starting at position pos.
+static void GMT__LogWrite(GMT_LogRing* r, uint64_t pos, size_t offset, const uint8_t* src, size_t size) {
+  while (size > 0) {
+    GMT_LogSlot* slot = &r->slots[(size_t)(pos + offset / GMT_LOG_SLOT_DATA) & (r->slot_count - 1)];
+    size_t at = offset % GMT_LOG_SLOT_DATA;
+    size_t chunk = GMT_LOG_SLOT_DATA - at;
+    if (chunk > size) chunk = size;
+    memcpy(slot->data + at, src, chunk);
+    src += chunk;
+    offset += chunk;
+    size -= chunk;
+  }
+}
+
+static void GMT__LogRead(const GMT_LogRing* r, uint64_t pos, uint8_t* dst, size_t size) {
+  size_t offset = 0;
+  while (size > 0) {
+    const GMT_LogSlot* slot = &r->slots[(size_t)(pos + offset / GMT_LOG_SLOT_DATA) & (r->slot_count - 1)];
+    size_t chunk = GMT_LOG_SLOT_DATA;
+    if (chunk > size) chunk = size;
+    memcpy(dst, slot->data, chunk);
+    dst += chunk;
+    offset += chunk;
+    size -= chunk;
+  }
+}
+
+// Formats and sinks every published record, in order.  Arguments were packed
+// (and strings copied) when the message was logged, so formatting here sees
+// the values of that moment, whatever the caller did since.
+static void GMT__LogDrain(void* user, bool flushing) {
+  GMT_LogRing* r = (GMT_LogRing*)user;
+  (void)flushing;  // Every batch reaches the sink and the batch callback.
+  t_gmt_on_log_thread = true;
+
+  uint8_t record[GMT_LOG_MAX_RECORD];
+  char text[GMT_LOG_MAX_TEXT];
+  uint64_t tail = GMT_Atomic_Load64(&r->tail);
+  bool any = false;
+  for (;;) {
+    GMT_LogSlot* first = &r->slots[(size_t)tail & (r->slot_count - 1)];
+    if (GMT_Atomic_Load64(&first->sequence) != tail + 1) break;
+
+    GMT__LogHeader header;
+    GMT__LogRead(r, tail, (uint8_t*)&header, sizeof(header));
+    GMT__LogRead(r, tail, record, header.size);
+    const uint8_t* payload = record + sizeof(header);
+    const char* msg = (const char*)payload;
+    if (header.format) {
+      GMT__FormatPacked(header.format, payload, text, sizeof(text));
+      msg = text;
+    }
+    r->sink((GMT_Severity)header.severity, (GMT_Mode)header.mode, msg, header.loc);
+    any = true;
+
+    // Free the slots in order: a producer only checks the last slot it claims.
+    size_t slots = (header.size + GMT_LOG_SLOT_DATA - 1) / GMT_LOG_SLOT_DATA;
+    for (size_t i = 0; i < slots; ++i) {
+      GMT_Atomic_Store64(&r->slots[(size_t)(tail + i) & (r->slot_count - 1)].sequence, tail + i + r->slot_count);
+    }
+    tail += slots;
+    GMT_Atomic_Store64(&r->tail, tail);
+    GMT_Platform_SignalEvent(r->worker.progress);
+  }
+  if (any && r->batch) r->batch();
+}
+
+bool GMT_LogRing_Start(GMT_LogRing* r, size_t size, GMT_LogSinkCallback* sink, GMT_LogBatchCallback* batch) {
+  memset(r, 0, sizeof(*r));
+  // At least a few of the largest records must fit at once.
+  size_t count = 256;
+  while (count * GMT_LOG_SLOT_DATA < size) count *= 2;
+
+  r->slots = (GMT_LogSlot*)GMT_Alloc(count * sizeof(GMT_LogSlot));
+  r->slot_count = count;
+  r->sink = sink;
+  r->batch = batch;
+  if (r->slots) {
+    for (size_t i = 0; i < count; ++i) r->slots[i].sequence = i;
+  }
+  if (!r->slots || !GMT_Worker_Start(&r->worker, GMT__LogDrain, r)) {
+    if (r->slots) GMT_Free(r->slots);
+    memset(r, 0, sizeof(*r));
+    return false;
+  }
+  return true;
+}
+
+bool GMT_LogRing_Push(GMT_LogRing* r, GMT_Severity severity, GMT_Mode mode, GMT_CodeLocation loc, const char* fmt, va_list args) {
+  if (!r->worker.thread || t_gmt_on_log_thread || GMT_Atomic_Load32(&r->worker.stop)) return false;
+
+  uint8_t record[GMT_LOG_MAX_RECORD];
+  GMT__LogHeader header;
+  memset(&header, 0, sizeof(header));
+  header.severity = (uint8_t)severity;
+  header.mode = (uint8_t)mode;
+  header.format = fmt;
+  header.loc = loc;
+
+  uint8_t* payload = record + sizeof(header);
+  size_t payload_cap = sizeof(record) - sizeof(header);
+  size_t payload_size = 0;
+  va_list packed;
+  va_copy(packed, args);
+  bool ok = GMT__PackArgs(fmt, packed, payload, payload_cap, &payload_size);
+  va_end(packed);
+  if (!ok) {
+    // Fall back to formatting here, truncated to what a record holds.
+    int n = vsnprintf((char*)payload, payload_cap, fmt, args);
+    payload_size = (n < 0) ? 1 : ((size_t)n < payload_cap ? (size_t)n + 1 : payload_cap);
+    if (n < 0) payload[0] = '\0';
+    header.format = NULL;
+  }
+  header.size = (uint32_t)(sizeof(header) + payload_size);
+  memcpy(record, &header, sizeof(header));
+
+  // Claim enough consecutive slots: all are free once the last one is, since
+  // the thread frees slots in order.
+  uint64_t slots = (header.size + GMT_LOG_SLOT_DATA - 1) / GMT_LOG_SLOT_DATA;
+  uint64_t pos = GMT_Atomic_Load64(&r->head);
+  bool stalled = false;
+  for (;;) {
+    uint64_t last = pos + slots - 1;
+    uint64_t seq = GMT_Atomic_Load64(&r->slots[(size_t)last & (r->slot_count - 1)].sequence);
+    int64_t diff = (int64_t)(seq - last);
+    if (diff == 0) {
+      if (GMT_Atomic_CompareExchange64(&r->head, pos, pos + slots)) break;
+    } else if (diff < 0) {
+      // Ring full: wait for the thread to free slots.
+      stalled = true;
+      GMT_Platform_SignalEvent(r->worker.wake);
+      GMT_Platform_WaitEvent(r->worker.progress, 1);
+    }
+    pos = GMT_Atomic_Load64(&r->head);
+  }
+  if (stalled) GMT_Atomic_Add64(&r->stall_count, 1);
+
+  GMT__LogWrite(r, pos, 0, record, header.size);
+  for (uint64_t i = 1; i < slots; ++i) {
+    GMT_Atomic_Store64(&r->slots[(size_t)(pos + i) & (r->slot_count - 1)].sequence, pos + i + 1);
+  }
+  GMT_Atomic_Store64(&r->slots[(size_t)pos & (r->slot_count - 1)].sequence, pos + 1);
+
+  uint64_t pending = pos + slots - GMT_Atomic_Load64(&r->tail);
+  if (pending >= r->slot_count / 2) GMT_Platform_SignalEvent(r->worker.wake);
+  return true;
+}
+
+bool GMT_LogRing_Flush(GMT_LogRing* r, uint32_t timeout_ms) {
+  // The log thread would wait on itself.
+  if (t_gmt_on_log_thread) return false;
+  return GMT_Worker_Flush(&r->worker, timeout_ms);
+}
+
+void GMT_LogRing_Stop(GMT_LogRing* r) {
+  if (!r->worker.thread) return;
+  // Once the worker's stop flag is set, later messages go out directly.
+  GMT_Worker_Stop(&r->worker);
+  GMT_Free(r->slots);
+  memset(r, 0, sizeof(*r));
+}
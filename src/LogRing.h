@@ -0,0 +1,93 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "GameTest.h"
+#include "Platform.h"
+#include "Worker.h"
+
+// Deferred logging (GMT_LogMode_DEFERRED): a lock-free multi-producer ring of
+// fixed-size slots drained by a dedicated thread (GMT_Worker).  A message is stored as its
+// format pointer plus the packed argument values (strings copied), so the
+// calling thread neither formats nor touches the console; the thread formats
+// the records and hands them to the sink in batches.
+//
+// A record spans as many consecutive slots as it needs.  Producers claim slots
+// with a compare-exchange on head and publish them through the first slot's
+// sequence number; the thread consumes them strictly in claim order.
+
+#define GMT_LOG_SLOT_DATA  56    // Record bytes carried by one slot.
+#define GMT_LOG_MAX_RECORD 2048  // Largest record (header + arguments or text) in bytes.
+#define GMT_LOG_MAX_TEXT   4096  // Longest formatted message handed to the sink.
+
+typedef struct GMT_LogSlot {
+  // Position the slot is free for (== position), or published for (== position + 1).
+  volatile uint64_t sequence;
+  uint8_t data[GMT_LOG_SLOT_DATA];
+} GMT_LogSlot;
+
+// Receives each formatted message in order.  Called on the log thread.
+typedef void GMT_LogSinkCallback(GMT_Severity severity, GMT_Mode mode, const char* msg, GMT_CodeLocation loc);
+// Called on the log thread after every batch (e.g. to flush the output streams).
+typedef void GMT_LogBatchCallback(void);
+
+typedef struct GMT_LogRing {
+  GMT_LogSlot* slots;
+  size_t slot_count;  // Power of two.
+
+  // Monotonic slot positions; head is claimed by producers, tail advanced by the thread.
+  volatile uint64_t head;
+  volatile uint64_t tail;
+
+  GMT_LogSinkCallback* sink;
+  GMT_LogBatchCallback* batch;
+
+  // worker.thread is NULL while messages go out directly.  Its progress event
+  // also tells producers waiting on a full ring that slots were freed.
+  GMT_Worker worker;
+
+  volatile uint64_t stall_count;  // Pushes that had to wait for the thread to free slots.
+} GMT_LogRing;
+
+// Allocates a ring of about `size` bytes and starts the log thread.
+// Returns false (with *r zeroed) if allocation or thread creation fails.
+bool GMT_LogRing_Start(GMT_LogRing* r, size_t size, GMT_LogSinkCallback* sink, GMT_LogBatchCallback* batch);
+
+// Queues one message.  Arguments the packer does not understand (or that do not
+// fit in a record) are formatted right away instead and queued as text.
+// Returns false if the ring is not running or the caller is the log thread
+// itself; the caller must then output the message directly.
+bool GMT_LogRing_Push(GMT_LogRing* r, GMT_Severity severity, GMT_Mode mode, GMT_CodeLocation loc, const char* fmt, va_list args);
+
+// Waits up to timeout_ms until everything queued so far has reached the sink.
+// Returns false on timeout or if the ring is not running.
+bool GMT_LogRing_Flush(GMT_LogRing* r, uint32_t timeout_ms);
+
+// Flushes, stops the thread and frees the ring.  Safe on a ring that never started.
+void GMT_LogRing_Stop(GMT_LogRing* r);
@@ -48,3 +48,17 @@ void* GMT_Realloc_(void* ptr, size_t new_size, GMT_CodeLocation loc) {
   (void)loc;
   return realloc(ptr, new_size);
 }
+
+void* GMT_FrameAlloc(size_t size) {
+  void* p = GMT_Arena_Alloc(&g_gmt.frame_arena, size);
+  return p ? p : GMT_Alloc(size);
+}
+
+void GMT_FrameFree(void* ptr) {
+  if (!ptr) return;
+  if (GMT_Arena_Owns(&g_gmt.frame_arena, ptr)) {
+    GMT_Arena_Release(&g_gmt.frame_arena);
+  } else {
+    GMT_Free(ptr);
+  }
+}
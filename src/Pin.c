@@ -26,20 +26,82 @@ SOFTWARE.
 #include "Record.h"
 #include <string.h>
 
+// ===== Value types =====
+
+typedef enum {
+  GMT_PIN_INT,
+  GMT_PIN_UINT,
+  GMT_PIN_FLOAT,
+  GMT_PIN_DOUBLE,
+  GMT_PIN_BOOL,
+  GMT_PIN_BYTES,
+  GMT_PIN_ARRAY,
+} GMT_PinType;
+
+static const char* GMT_PinTypeName(GMT_PinType type) {
+  switch (type) {
+    case GMT_PIN_INT:    return "int";
+    case GMT_PIN_UINT:   return "uint";
+    case GMT_PIN_FLOAT:  return "float";
+    case GMT_PIN_DOUBLE: return "double";
+    case GMT_PIN_BOOL:   return "bool";
+    case GMT_PIN_ARRAY:  return "array";
+    default:             return "bytes";
+  }
+}
+
+// Formats the current value for a diagnostic.  Only called when a message is
+// actually logged, so the common path never pays for it.
+static void GMT__FormatPinValue(GMT_PinType type, const void* data, char* buf, size_t buf_size) {
+  switch (type) {
+    case GMT_PIN_INT: {
+      int v;
+      memcpy(&v, data, sizeof(v));
+      snprintf(buf, buf_size, "%d", v);
+      break;
+    }
+    case GMT_PIN_UINT: {
+      unsigned int v;
+      memcpy(&v, data, sizeof(v));
+      snprintf(buf, buf_size, "%u", v);
+      break;
+    }
+    case GMT_PIN_FLOAT: {
+      float v;
+      memcpy(&v, data, sizeof(v));
+      snprintf(buf, buf_size, "%.9g", (double)v);
+      break;
+    }
+    case GMT_PIN_DOUBLE: {
+      double v;
+      memcpy(&v, data, sizeof(v));
+      snprintf(buf, buf_size, "%.17g", v);
+      break;
+    }
+    case GMT_PIN_BOOL:
+      snprintf(buf, buf_size, "%s", *(const bool*)data ? "true" : "false");
+      break;
+    default:
+      snprintf(buf, buf_size, "(blob)");
+      break;
+  }
+}
+
 // ===== Shared helper =====
 
-static void GMT_Pin_(unsigned int key, void* data, size_t size, const char* type_name, const char* value_str, GMT_CodeLocation loc) {
+static void GMT_Pin_(unsigned int key, void* data, size_t size, GMT_PinType type, GMT_CodeLocation loc) {
   (void)loc;  // Available for future diagnostic use.
 
   if (!g_gmt.initialized || g_gmt.mode == GMT_Mode_DISABLED) return;
   if (!data || size == 0) return;
-  if (size > (size_t)GMT_MAX_DATA_RECORD_PAYLOAD) {
-    GMT_LogError("GMT_Pin<%s>: payload size %zu exceeds maximum %d; call ignored.", type_name, size, GMT_MAX_DATA_RECORD_PAYLOAD);
+  if (size > g_gmt.max_payload_size) {
+    GMT_LogError("GMT_Pin<%s>: payload size %zu exceeds maximum %zu; call ignored.", GMT_PinTypeName(type), size, g_gmt.max_payload_size);
     return;
   }
 
-  GMT_Platform_MutexLock();
+  uint64_t profile_begin = GMT_Profile_Begin();
 
+  // No mutex: the key counter is lock-free and the record paths use per-thread data.
   unsigned int index = GMT_KeyCounter_Next(&g_gmt.pin_counter, key);
 
   switch (g_gmt.mode) {
@@ -48,14 +110,15 @@ static void GMT_Pin_(unsigned int key, void* data, size_t size, const char* type
       break;
 
     case GMT_Mode_REPLAY: {
-      GMT_DecodedDataRecord* rec = GMT_Record_FindDecoded(g_gmt.replay_pins, g_gmt.replay_pin_count, key, index);
-      if (!rec) {
-        GMT_LogError("GMT_Pin<%s>: no recorded value for key %u index %u; keeping current value %s.", type_name, key, index, value_str);
-      } else if (rec->size != (uint32_t)size) {
+      // Copied straight into *value, and only when the recorded size matches.
+      uint32_t recorded_size;
+      if (!GMT_Record_FindDecoded(&g_gmt.replay_pins, key, index, data, (uint32_t)size, &recorded_size)) {
+        char value_str[32];
+        GMT__FormatPinValue(type, data, value_str, sizeof(value_str));
+        GMT_LogError("GMT_Pin<%s>: no recorded value for key %u index %u; keeping current value %s.", GMT_PinTypeName(type), key, index, value_str);
+      } else if (recorded_size != (uint32_t)size) {
         GMT_LogError("GMT_Pin<%s>: size mismatch for key %u index %u: recorded %u bytes, got %zu bytes; *value unchanged.",
-                     type_name, key, index, rec->size, size);
-      } else {
-        memcpy(data, rec->data, size);
+                     GMT_PinTypeName(type), key, index, recorded_size, size);
       }
       break;
     }
@@ -64,39 +127,39 @@ static void GMT_Pin_(unsigned int key, void* data, size_t size, const char* type
       break;
   }
 
-  GMT_Platform_MutexUnlock();
+  GMT_Profile_EndThread(GMT_ProfileScope_PIN, profile_begin);
 }
 
 // ===== Typed public functions =====
 
 void GMT_PinInt_(unsigned int key, int* value, GMT_CodeLocation loc) {
-  char buf[32];
-  snprintf(buf, sizeof(buf), "%d", *value);
-  GMT_Pin_(key, value, sizeof(*value), "int", buf, loc);
+  GMT_Pin_(key, value, sizeof(*value), GMT_PIN_INT, loc);
 }
 
 void GMT_PinUInt_(unsigned int key, unsigned int* value, GMT_CodeLocation loc) {
-  char buf[32];
-  snprintf(buf, sizeof(buf), "%u", *value);
-  GMT_Pin_(key, value, sizeof(*value), "uint", buf, loc);
+  GMT_Pin_(key, value, sizeof(*value), GMT_PIN_UINT, loc);
 }
 
 void GMT_PinFloat_(unsigned int key, float* value, GMT_CodeLocation loc) {
-  char buf[32];
-  snprintf(buf, sizeof(buf), "%.9g", (double)*value);
-  GMT_Pin_(key, value, sizeof(*value), "float", buf, loc);
+  GMT_Pin_(key, value, sizeof(*value), GMT_PIN_FLOAT, loc);
 }
 
 void GMT_PinDouble_(unsigned int key, double* value, GMT_CodeLocation loc) {
-  char buf[32];
-  snprintf(buf, sizeof(buf), "%.17g", *value);
-  GMT_Pin_(key, value, sizeof(*value), "double", buf, loc);
+  GMT_Pin_(key, value, sizeof(*value), GMT_PIN_DOUBLE, loc);
 }
 
 void GMT_PinBool_(unsigned int key, bool* value, GMT_CodeLocation loc) {
-  GMT_Pin_(key, value, sizeof(*value), "bool", *value ? "true" : "false", loc);
+  GMT_Pin_(key, value, sizeof(*value), GMT_PIN_BOOL, loc);
 }
 
 void GMT_PinBytes_(unsigned int key, void* data, size_t size, GMT_CodeLocation loc) {
-  GMT_Pin_(key, data, size, "bytes", "(blob)", loc);
+  GMT_Pin_(key, data, size, GMT_PIN_BYTES, loc);
+}
+
+void GMT_PinArray_(unsigned int key, void* data, size_t element_size, size_t count, GMT_CodeLocation loc) {
+  if (element_size != 0 && count > SIZE_MAX / element_size) {
+    GMT_LogError("GMT_Pin<array>: %zu elements of %zu bytes overflow; call ignored.", count, element_size);
+    return;
+  }
+  GMT_Pin_(key, data, element_size * count, GMT_PIN_ARRAY, loc);
 }
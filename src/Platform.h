@@ -39,7 +39,9 @@ void GMT_Platform_SetWorkDir(const char* path);
 // Returns true on success or if the directory already exists.
 bool GMT_Platform_CreateDirRecursive(const char* path);
 
-// Installs any platform-specific hooks or initializations required.
+// Installs any platform-specific hooks or initializations required.  Called by
+// GMT_Init for the default state only; GMT_Context states never touch the
+// process-wide hooks.
 void GMT_Platform_Init(void);
 
 // Removes the hooks installed by GMT_Platform_Init.
@@ -55,6 +57,11 @@ void GMT_Platform_Quit(void);
 // bitmask of currently pressed buttons.
 void GMT_Platform_CaptureInput(GMT_InputState* out);
 
+// Reads the mouse position and buttons and the gamepads into *out, leaving the
+// other fields alone.  Consumes none of CaptureInput's accumulators, so the
+// input sampling thread can call it between frames without the mutex.
+void GMT_Platform_SampleInput(GMT_InputState* out);
+
 // ===== Input Injection (REPLAY mode) =====
 
 // Injects a delta of input events for one frame.
@@ -88,14 +95,97 @@ void GMT_Platform_SetReplayHooksActive(bool active);
 
 // ===== High-Resolution Timer =====
 
-// Returns the current time in seconds relative to GMT_Platform_Init.
+// Starts the clock GMT_Platform_GetTime counts from.  The first call in the
+// process does the work; later ones (every GMT_Init / GMT_Context_Create) return.
+void GMT_Platform_InitTimer(void);
+
+// Returns the current time in seconds relative to GMT_Platform_InitTimer.
 // Used to stamp recorded frames and signals with floating-point timestamps
 // and to drive time-based replay.
 double GMT_Platform_GetTime(void);
 
+// Raw counter behind GMT_Platform_GetTime and its ticks per second.  Cheaper to
+// read; used by the overhead profiler's scopes and trace timestamps.
+uint64_t GMT_Platform_GetTicks(void);
+uint64_t GMT_Platform_GetTickFrequency(void);
+
+// Ids of the process and the calling thread, as external profilers show them.
+uint32_t GMT_Platform_GetProcessId(void);
+uint32_t GMT_Platform_GetThreadId(void);
+
 // ===== Mutex =====
 
-// Lock/unlock the single framework-wide recursive mutex.
-// The mutex is created in GMT_Platform_Init and destroyed in GMT_Platform_Quit.
-void GMT_Platform_MutexLock(void);
-void GMT_Platform_MutexUnlock(void);
+typedef struct GMT_Mutex GMT_Mutex;  // Opaque recursive mutex.
+
+// Every framework state owns one (GMT_State.mutex), created by GMT_Init or
+// GMT_Context_Create; GMT_Platform_MutexLock / MutexUnlock in Internal.h lock
+// the current state's.  Create returns NULL on failure; Lock and Unlock
+// ignore NULL.
+GMT_Mutex* GMT_Platform_CreateMutex(void);
+void GMT_Platform_DestroyMutex(GMT_Mutex* mutex);
+void GMT_Platform_LockMutex(GMT_Mutex* mutex);
+void GMT_Platform_UnlockMutex(GMT_Mutex* mutex);
+
+// ===== Threading =====
+
+typedef struct GMT_Thread GMT_Thread;  // Opaque platform thread.
+typedef struct GMT_Event GMT_Event;    // Opaque auto-reset event.
+
+typedef void GMT_ThreadProc(void* user);
+
+// Starts a thread running proc(user), with the creating thread's framework
+// state current on it (GMT_Context_MakeCurrent).  Returns NULL on failure.
+GMT_Thread* GMT_Platform_CreateThread(GMT_ThreadProc* proc, void* user);
+
+// Waits for the thread to return and releases it.
+void GMT_Platform_JoinThread(GMT_Thread* thread);
+
+// Creates an auto-reset event in the non-signalled state.  Returns NULL on failure.
+GMT_Event* GMT_Platform_CreateEvent(void);
+void GMT_Platform_DestroyEvent(GMT_Event* event);
+
+// Signals the event, releasing one waiter (or the next one to wait).
+void GMT_Platform_SignalEvent(GMT_Event* event);
+
+// Waits up to timeout_ms for the event.  Returns true if it was signalled.
+bool GMT_Platform_WaitEvent(GMT_Event* event, uint32_t timeout_ms);
+
+// Asks the OS for 1 ms timer resolution (enable) or drops the request, so that
+// WaitEvent honours timeouts of a few milliseconds.  Calls must pair.
+void GMT_Platform_SetFineTimer(bool enable);
+
+// ===== File Mapping =====
+
+// Read-only view of a whole file.
+typedef struct GMT_MappedFile {
+  const uint8_t* data;  // First byte of the view; NULL for an empty file.
+  size_t size;          // File size in bytes.
+} GMT_MappedFile;
+
+// Maps the file at `path` read-only into the address space.
+// Returns false if the file cannot be opened or mapped; *out is zeroed in that case.
+bool GMT_Platform_MapFile(const char* path, GMT_MappedFile* out);
+
+// Releases a view created by GMT_Platform_MapFile and zeroes *file.
+void GMT_Platform_UnmapFile(GMT_MappedFile* file);
+
+// ===== Pipe =====
+
+typedef struct GMT_Pipe GMT_Pipe;  // Opaque client end of a named pipe.
+
+// Connects to the named pipe `name`, as created by GameTest-Tool for each
+// --pool worker.  Waits briefly if the pipe is busy.  Returns NULL on failure.
+GMT_Pipe* GMT_Platform_ConnectPipe(const char* name);
+void GMT_Platform_ClosePipe(GMT_Pipe* pipe);
+
+// Blocking I/O.  Read returns the number of bytes read, or 0 once the other end
+// has closed the pipe.  Write returns true only if every byte was written.
+size_t GMT_Platform_ReadPipe(GMT_Pipe* pipe, void* buffer, size_t size);
+bool GMT_Platform_WritePipe(GMT_Pipe* pipe, const void* data, size_t size);
+
+// ===== Shared Memory =====
+
+// Maps `size` bytes of the named shared memory GameTest-Tool creates for each
+// test (--test-status) read-write.  Returns NULL if it does not exist.
+void* GMT_Platform_OpenSharedMemory(const char* name, size_t size);
+void GMT_Platform_CloseSharedMemory(void* view);
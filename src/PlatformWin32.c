@@ -26,7 +26,10 @@ SOFTWARE.
 #define NOMINMAX
 #include <windows.h>
 #include <psapi.h> /* EnumProcessModules */
+#include <mmsystem.h> /* timeBeginPeriod */
 #include <xinput.h>
+#include <intrin.h> /* _BitScanForward */
+#include <limits.h>
 #include <signal.h>
 #include <stdlib.h>
 #include <string.h>
@@ -48,12 +51,36 @@ static HHOOK g_mouse_hook = NULL;
 static volatile LONG g_wheel_x = 0;  // Horizontal wheel accumulator.
 static volatile LONG g_wheel_y = 0;  // Vertical wheel accumulator.
 
-static CRITICAL_SECTION g_mutex;
+// ===== Hook-maintained input state =====
+//
+// The LL hooks keep one bit per Win32 VK that is currently held (keys and mouse
+// buttons).  With GMT_InputCapture_HOOKS, CaptureInput reads these eight words
+// instead of calling GetAsyncKeyState for every key.  Bits change with
+// Interlocked operations because CaptureInput may run on a different thread
+// from the one pumping the hooks.  Injected events are not tracked.
+#define GMT__VK_WORDS (256 / 32)
+
+static volatile LONG g_hook_vk_bits[GMT__VK_WORDS];
+
+static bool GMT__HookVKDown(DWORD vk) {
+  return (g_hook_vk_bits[vk >> 5] & (LONG)(1u << (vk & 31))) != 0;
+}
+
+static void GMT__SetHookVK(DWORD vk, bool down) {
+  const LONG bit = (LONG)(1u << (vk & 31));
+  if (down) {
+    InterlockedOr(&g_hook_vk_bits[vk >> 5], bit);
+  } else {
+    InterlockedAnd(&g_hook_vk_bits[vk >> 5], ~bit);
+  }
+}
 
 // ===== High-Resolution Timer =====
 
 static double g_perf_freq_inv = 0.0;  // 1.0 / QueryPerformanceFrequency
-static LARGE_INTEGER g_perf_origin;   // QPC value at GMT_Platform_Init; used as epoch
+static LARGE_INTEGER g_perf_freq;     // QueryPerformanceFrequency
+static LARGE_INTEGER g_perf_origin;   // QPC value at GMT_Platform_InitTimer; used as epoch
+static volatile LONG g_perf_init_state = 0;  // 0 = not started, 1 = starting, 2 = ready
 
 // ===== Crash / abort safety net globals =====
 // Declared here so RemoveInputHooks (below) can reference them before the
@@ -86,6 +113,24 @@ static LRESULT CALLBACK GMT__MouseLLHook(int nCode, WPARAM wParam, LPARAM lParam
       SHORT delta = (SHORT)HIWORD(ms->mouseData);
       InterlockedExchangeAdd(&g_wheel_x, (LONG)delta);
     }
+
+    // Button state for GMT_InputCapture_HOOKS.
+    if (!(ms->flags & LLMHF_INJECTED)) {
+      switch (wParam) {
+        case WM_LBUTTONDOWN: GMT__SetHookVK(VK_LBUTTON, true); break;
+        case WM_LBUTTONUP:   GMT__SetHookVK(VK_LBUTTON, false); break;
+        case WM_RBUTTONDOWN: GMT__SetHookVK(VK_RBUTTON, true); break;
+        case WM_RBUTTONUP:   GMT__SetHookVK(VK_RBUTTON, false); break;
+        case WM_MBUTTONDOWN: GMT__SetHookVK(VK_MBUTTON, true); break;
+        case WM_MBUTTONUP:   GMT__SetHookVK(VK_MBUTTON, false); break;
+        case WM_XBUTTONDOWN:
+        case WM_XBUTTONUP:
+          GMT__SetHookVK(HIWORD(ms->mouseData) == XBUTTON1 ? VK_XBUTTON1 : VK_XBUTTON2, wParam == WM_XBUTTONDOWN);
+          break;
+        default:
+          break;
+      }
+    }
   }
   return CallNextHookEx(g_mouse_hook, nCode, wParam, lParam);
 }
@@ -226,6 +271,33 @@ static const int k_vk[GMT_KEY_COUNT] = {
 // Compile-time check: the table must cover every GMT_Key.
 typedef char GMT__VkTableSizeCheck[(sizeof(k_vk) / sizeof(k_vk[0]) == GMT_KEY_COUNT) ? 1 : -1];
 
+// Keys whose Win32 scan code carries the extended-key prefix (E0).  They need
+// KEYEVENTF_EXTENDEDKEY on SendInput and bit 24 set in a WM_KEY* lParam.
+static const int k_extended_keys[] = {
+    GMT_Key_RIGHT_CTRL, GMT_Key_RIGHT_ALT, GMT_Key_LEFT_SUPER, GMT_Key_RIGHT_SUPER,
+    GMT_Key_INSERT,     GMT_Key_DELETE,    GMT_Key_HOME,       GMT_Key_END,
+    GMT_Key_PAGE_UP,    GMT_Key_PAGE_DOWN, GMT_Key_UP,         GMT_Key_DOWN,
+    GMT_Key_LEFT,       GMT_Key_RIGHT,     GMT_Key_NUM_LOCK,   GMT_Key_KP_DIVIDE,
+};
+
+// Per-GMT_Key scan code and extended flag, filled once by GMT_Platform_Init so
+// injection never has to call MapVirtualKey per key event.
+static WORD g_key_scan[GMT_KEY_COUNT];
+static bool g_key_extended[GMT_KEY_COUNT];
+
+static void GMT__BuildScanCodeTable(void) {
+  memset(g_key_scan, 0, sizeof(g_key_scan));
+  memset(g_key_extended, 0, sizeof(g_key_extended));
+  for (int k = 1; k < GMT_KEY_COUNT; ++k) {
+    if (k_vk[k] != 0) {
+      g_key_scan[k] = (WORD)MapVirtualKeyA((UINT)k_vk[k], MAPVK_VK_TO_VSC);
+    }
+  }
+  for (size_t i = 0; i < sizeof(k_extended_keys) / sizeof(k_extended_keys[0]); ++i) {
+    g_key_extended[k_extended_keys[i]] = true;
+  }
+}
+
 // ===== Key Repeat Accumulator =====
 //
 // WH_KEYBOARD_LL hook counts auto-repeat key-down events between frames.
@@ -236,8 +308,10 @@ typedef char GMT__VkTableSizeCheck[(sizeof(k_vk) / sizeof(k_vk[0]) == GMT_KEY_CO
 
 static HHOOK g_keyboard_hook = NULL;
 static volatile LONG g_key_repeats[GMT_KEY_COUNT];  // Per-GMT_Key repeat accumulator.
+// One bit per GMT_Key whose accumulator may be non-zero, so CaptureInput only
+// exchanges the counters of keys that actually repeated.
+static volatile LONG g_key_repeat_pending[(GMT_KEY_COUNT + 31) / 32];
 static int g_vk_to_gmt_key[256];                    // Reverse map: Win32 VK → GMT_Key (0 = unmapped).
-static uint8_t g_hook_key_down[256];                // Per-VK "is currently down" state for the hook.
 
 static LRESULT CALLBACK GMT__KeyboardLLHook(int nCode, WPARAM wParam, LPARAM lParam) {
   if (nCode == HC_ACTION) {
@@ -261,24 +335,25 @@ static LRESULT CALLBACK GMT__KeyboardLLHook(int nCode, WPARAM wParam, LPARAM lPa
       if (vk < 256) {
         bool was_transition = false;
         if (wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN) {
-          if (g_hook_key_down[vk]) {
+          if (GMT__HookVKDown(vk)) {
             // Key was already down — this is an auto-repeat event.
             int gmt_key = g_vk_to_gmt_key[vk];
             if (gmt_key > 0) {
               InterlockedExchangeAdd(&g_key_repeats[gmt_key], 1);
+              InterlockedOr(&g_key_repeat_pending[gmt_key >> 5], (LONG)(1u << (gmt_key & 31)));
             }
           } else {
-            g_hook_key_down[vk] = 1;
+            GMT__SetHookVK(vk, true);
             was_transition = true;  // Key down transition
           }
         } else if (wParam == WM_KEYUP || wParam == WM_SYSKEYUP) {
-          g_hook_key_down[vk] = 0;
+          GMT__SetHookVK(vk, false);
           was_transition = true;  // Key up transition
         }
-        // Capture input immediately on key transitions so fast taps that occur
-        // between GMT_Update calls are not missed.
+        // Record key transitions with their own timestamps so fast taps that
+        // occur between GMT_Update calls are not missed.
         if (was_transition && g_gmt.initialized && g_gmt.mode == GMT_Mode_RECORD) {
-          GMT_Record_WriteInputFromKeyEvent();
+          GMT_Record_OnKeyEvent(g_vk_to_gmt_key[vk], wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN);
         }
       }
     }
@@ -401,6 +476,30 @@ static volatile LONG g_replay_hooks_active = 0;  // 1 while hooks should return
 
 // WH_GETMESSAGE hook handle (strips WM_INPUT during replay).
 static HHOOK g_getmessage_hook = NULL;
+static DWORD g_getmessage_hook_thread = 0;  // Thread the hook (and the game's windows) belong to.
+
+// ---- Window-message injection state ----
+//
+// GMT_InputInjection_WINDOW_MESSAGES posts every input message wrapped in the
+// registered g_posted_input_message, whose wParam is its ticket in this ring.
+// The WH_GETMESSAGE hook unwraps it, so the game can tell replayed messages
+// from real ones and real keyboard/mouse messages can be dropped.  The ring
+// only needs to outlive the messages still sitting in the queue.  A slot is
+// published through its sequence (ticket + 1, 0 while being written), so the
+// hook never reads a half-written slot, or one reused for a later ticket.
+#define GMT__POSTED_INPUT_COUNT 1024u
+
+typedef struct GMT__PostedInput {
+  volatile LONG sequence;
+  UINT message;
+  WPARAM wParam;
+  LPARAM lParam;
+} GMT__PostedInput;
+
+static UINT g_posted_input_message = 0;
+static GMT__PostedInput g_posted_inputs[GMT__POSTED_INPUT_COUNT];
+static volatile LONG g_posted_input_head = 0;
+static HWND g_inject_hwnd = NULL;  // Cached target window; re-resolved when destroyed.
 
 // ---- Hooked Win32 function implementations ----
 
@@ -1105,88 +1204,235 @@ static HRESULT WINAPI GMT_Hook_DirectInput8Create(HINSTANCE hinst, DWORD dwVersi
 // retrieves a message and nullifies any WM_INPUT so the game never processes
 // real raw-input events during replay.
 
+//
+// With GMT_InputInjection_WINDOW_MESSAGES it also unwraps the input messages
+// posted by GMT_Platform_InjectInput and drops every other keyboard and mouse
+// message, including the WM_CHARs TranslateMessage derives from real key state.
+
 static LRESULT CALLBACK GMT__GetMessageHook(int nCode, WPARAM wParam, LPARAM lParam) {
-  if (nCode >= 0 && InterlockedCompareExchange(&g_replay_hooks_active, 0, 0)) {
-    MSG* msg = (MSG*)lParam;
-    if (msg && msg->message == WM_INPUT) {
-      msg->message = WM_NULL;  // Neutralise the message.
+  MSG* msg = (MSG*)lParam;
+  if (nCode >= 0 && msg) {
+    if (g_posted_input_message && msg->message == g_posted_input_message) {
+      // Always unwrap, even once replay stopped, so no carrier leaks to the game.
+      LONG ticket = (LONG)msg->wParam;
+      GMT__PostedInput* posted = &g_posted_inputs[(uint32_t)ticket % GMT__POSTED_INPUT_COUNT];
+      UINT message = WM_NULL;
+      WPARAM wp = 0;
+      LPARAM lp = 0;
+      if (InterlockedCompareExchange(&posted->sequence, 0, 0) == ticket + 1) {
+        message = posted->message;
+        wp = posted->wParam;
+        lp = posted->lParam;
+        // Overwritten while reading: the message is long stale, drop it.
+        if (InterlockedCompareExchange(&posted->sequence, 0, 0) != ticket + 1) message = WM_NULL;
+      }
+      msg->message = message;
+      msg->wParam = wp;
+      msg->lParam = lp;
+    } else if (InterlockedCompareExchange(&g_replay_hooks_active, 0, 0)) {
+      if (msg->message == WM_INPUT) {
+        msg->message = WM_NULL;  // Neutralise the message.
+      } else if (g_gmt.setup.input_injection == GMT_InputInjection_WINDOW_MESSAGES && !g_gmt.test_failed &&
+                 ((msg->message >= WM_KEYFIRST && msg->message <= WM_KEYLAST) ||
+                  (msg->message >= WM_MOUSEFIRST && msg->message <= WM_MOUSELAST))) {
+        msg->message = WM_NULL;  // Real input: only replayed messages may reach the game.
+      }
     }
   }
   return CallNextHookEx(g_getmessage_hook, nCode, wParam, lParam);
 }
 
 // ---- IAT patching helpers ----
+//
+// Each loaded module's import directory is walked once per install or removal,
+// matching every entry against the whole hook table, instead of once per hooked
+// function.  DLLs loaded after GMT_Platform_InstallInputHooks are patched as
+// they arrive, from a loader notification, so they need no rescan either.
+
+// DLL an import descriptor names, as far as the hook table is concerned.
+typedef enum GMT_HookDll {
+  GMT_HookDll_NONE = 0,
+  GMT_HookDll_USER32,
+  GMT_HookDll_XINPUT,  // Any of the XInput versions.
+  GMT_HookDll_DINPUT8,
+} GMT_HookDll;
+
+// One hooked import.  `orig` is resolved before patching; entries whose
+// original is still NULL are skipped.
+typedef struct GMT_IATHook {
+  GMT_HookDll dll;
+  void** orig;
+  const void* hook;
+} GMT_IATHook;
+
+static const GMT_IATHook g_iat_hooks[] = {
+    {GMT_HookDll_USER32, (void**)&g_orig_GetAsyncKeyState, (const void*)GMT_Hook_GetAsyncKeyState},
+    {GMT_HookDll_USER32, (void**)&g_orig_GetKeyState, (const void*)GMT_Hook_GetKeyState},
+    {GMT_HookDll_USER32, (void**)&g_orig_GetKeyboardState, (const void*)GMT_Hook_GetKeyboardState},
+    {GMT_HookDll_USER32, (void**)&g_orig_GetCursorPos, (const void*)GMT_Hook_GetCursorPos},
+    {GMT_HookDll_USER32, (void**)&g_orig_GetRawInputData, (const void*)GMT_Hook_GetRawInputData},
+    {GMT_HookDll_XINPUT, (void**)&g_orig_XInputGetState, (const void*)GMT_Hook_XInputGetState},
+    {GMT_HookDll_XINPUT, (void**)&g_orig_XInputSetState, (const void*)GMT_Hook_XInputSetState},
+    {GMT_HookDll_XINPUT, (void**)&g_orig_XInputGetCapabilities, (const void*)GMT_Hook_XInputGetCapabilities},
+    {GMT_HookDll_XINPUT, (void**)&g_orig_XInputGetKeystroke, (const void*)GMT_Hook_XInputGetKeystroke},
+    {GMT_HookDll_DINPUT8, (void**)&g_orig_DirectInput8Create, (const void*)GMT_Hook_DirectInput8Create},
+};
+#define GMT_IAT_HOOK_COUNT (sizeof(g_iat_hooks) / sizeof(g_iat_hooks[0]))
+
+// Serializes patching between the installing thread and loader notifications.
+static SRWLOCK g_iat_lock = SRWLOCK_INIT;
 
-// Patches one IAT entry in a single PE module.  Returns true if the entry was
-// found and replaced.  `orig_func` receives the original function pointer if
-// it was not already saved (i.e. if *orig_func == NULL on entry).
-static bool GMT__PatchIATEntry(HMODULE hModule, const char* dll_name, const void* target_func, const void* new_func, void** orig_func) {
+static GMT_HookDll GMT__ClassifyImport(const char* dll_name) {
+  if (_stricmp(dll_name, "user32.dll") == 0) return GMT_HookDll_USER32;
+  if (_stricmp(dll_name, "xinput1_4.dll") == 0 || _stricmp(dll_name, "xinput1_3.dll") == 0 ||
+      _stricmp(dll_name, "xinput9_1_0.dll") == 0) {
+    return GMT_HookDll_XINPUT;
+  }
+  if (_stricmp(dll_name, "dinput8.dll") == 0) return GMT_HookDll_DINPUT8;
+  return GMT_HookDll_NONE;
+}
+
+// Points every IAT entry of one PE module that imports a hooked function at the
+// hook (`install`) or back at the original (!`install`).  Returns the number of
+// entries rewritten.
+static int GMT__PatchModule(HMODULE hModule, bool install) {
   // Walk the PE headers to find the import directory.
   PIMAGE_DOS_HEADER dos = (PIMAGE_DOS_HEADER)hModule;
-  if (dos->e_magic != IMAGE_DOS_SIGNATURE) return false;
+  if (dos->e_magic != IMAGE_DOS_SIGNATURE) return 0;
 
   PIMAGE_NT_HEADERS nt = (PIMAGE_NT_HEADERS)((BYTE*)hModule + dos->e_lfanew);
-  if (nt->Signature != IMAGE_NT_SIGNATURE) return false;
+  if (nt->Signature != IMAGE_NT_SIGNATURE) return 0;
 
   PIMAGE_DATA_DIRECTORY import_dir =
       &nt->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_IMPORT];
-  if (import_dir->Size == 0 || import_dir->VirtualAddress == 0) return false;
+  if (import_dir->Size == 0 || import_dir->VirtualAddress == 0) return 0;
 
   PIMAGE_IMPORT_DESCRIPTOR imp =
       (PIMAGE_IMPORT_DESCRIPTOR)((BYTE*)hModule + import_dir->VirtualAddress);
 
+  int patched = 0;
+  AcquireSRWLockExclusive(&g_iat_lock);
   for (; imp->Name != 0; ++imp) {
-    const char* name = (const char*)((BYTE*)hModule + imp->Name);
-    if (_stricmp(name, dll_name) != 0) continue;
+    GMT_HookDll dll = GMT__ClassifyImport((const char*)((BYTE*)hModule + imp->Name));
+    if (dll == GMT_HookDll_NONE) continue;
 
     PIMAGE_THUNK_DATA iat =
         (PIMAGE_THUNK_DATA)((BYTE*)hModule + imp->FirstThunk);
 
     for (; iat->u1.Function != 0; ++iat) {
-      if ((void*)(uintptr_t)iat->u1.Function == target_func) {
-        // Save original (only once).
-        if (orig_func && *orig_func == NULL) {
-          *orig_func = (void*)(uintptr_t)iat->u1.Function;
-        }
+      const void* current = (const void*)(uintptr_t)iat->u1.Function;
+      for (size_t h = 0; h < GMT_IAT_HOOK_COUNT; ++h) {
+        const GMT_IATHook* hook = &g_iat_hooks[h];
+        if (hook->dll != dll || !*hook->orig) continue;
+        const void* from = install ? (const void*)*hook->orig : hook->hook;
+        if (current != from) continue;
 
         // Make the IAT entry writable, patch it, then restore protection.
         DWORD old_protect;
         VirtualProtect(&iat->u1.Function, sizeof(iat->u1.Function), PAGE_READWRITE, &old_protect);
-        iat->u1.Function = (ULONG_PTR)new_func;
+        iat->u1.Function = (ULONG_PTR)(install ? hook->hook : (const void*)*hook->orig);
         VirtualProtect(&iat->u1.Function, sizeof(iat->u1.Function), old_protect, &old_protect);
-        return true;
+        patched++;
+        break;
       }
     }
   }
-  return false;
+  ReleaseSRWLockExclusive(&g_iat_lock);
+  return patched;
 }
 
-// Iterates all loaded modules and patches the IAT entry for a given function.
-static void GMT__PatchAllModules(const char* dll_name, const void* target_func, const void* new_func, void** orig_func) {
+// Patches (or restores) every module loaded right now.
+static void GMT__PatchAllModules(bool install) {
   HANDLE proc = GetCurrentProcess();
   HMODULE modules[1024];
   DWORD needed = 0;
   if (!EnumProcessModules(proc, modules, sizeof(modules), &needed)) return;
 
   DWORD count = needed / sizeof(HMODULE);
+  if (count > sizeof(modules) / sizeof(modules[0])) count = sizeof(modules) / sizeof(modules[0]);
   for (DWORD i = 0; i < count; ++i) {
-    GMT__PatchIATEntry(modules[i], dll_name, target_func, new_func, orig_func);
+    GMT__PatchModule(modules[i], install);
   }
 }
 
-// Restores a single IAT entry across all modules to the original function.
-static void GMT__UnpatchAllModules(const char* dll_name, const void* hooked_func, void* orig_func) {
-  if (!orig_func) return;
+// ---- DLL load notification ----
+//
+// LdrRegisterDllNotification (ntdll, Windows Vista and later) reports every DLL
+// the process loads.  Resolved at run time like CM_Register_Notification; if it
+// is missing, only the modules loaded at install time are patched.
+
+#define GMT_LDR_DLL_NOTIFICATION_REASON_LOADED 1
+
+typedef struct GMT_UnicodeString {
+  USHORT Length;
+  USHORT MaximumLength;
+  PWSTR Buffer;
+} GMT_UnicodeString;
+
+// LDR_DLL_LOADED_NOTIFICATION_DATA (the unloaded variant has the same layout).
+typedef struct GMT_DllNotificationData {
+  ULONG Flags;
+  const GMT_UnicodeString* FullDllName;
+  const GMT_UnicodeString* BaseDllName;
+  PVOID DllBase;
+  ULONG SizeOfImage;
+} GMT_DllNotificationData;
+
+typedef VOID(CALLBACK* PFN_GMT_DllNotification)(ULONG reason, const GMT_DllNotificationData* data, PVOID context);
+typedef LONG(NTAPI* PFN_LdrRegisterDllNotification)(ULONG flags, PFN_GMT_DllNotification callback, PVOID context, PVOID* out_cookie);
+typedef LONG(NTAPI* PFN_LdrUnregisterDllNotification)(PVOID cookie);
+
+static PVOID g_dll_notify_cookie = NULL;
+static PFN_LdrUnregisterDllNotification g_ldr_unregister = NULL;
+
+// Runs on the loading thread, under the loader lock, after the new DLL's
+// imports are bound and before its entry point runs.  Only touches that DLL.
+static VOID CALLBACK GMT__DllNotification(ULONG reason, const GMT_DllNotificationData* data, PVOID context) {
+  (void)context;
+  if (reason == GMT_LDR_DLL_NOTIFICATION_REASON_LOADED && data && data->DllBase) {
+    GMT__PatchModule((HMODULE)data->DllBase, true);
+  }
+}
 
-  HANDLE proc = GetCurrentProcess();
-  HMODULE modules[1024];
-  DWORD needed = 0;
-  if (!EnumProcessModules(proc, modules, sizeof(modules), &needed)) return;
+static void GMT__RegisterDllNotification(void) {
+  if (g_dll_notify_cookie) return;
+  HMODULE ntdll = GetModuleHandleA("ntdll.dll");
+  if (!ntdll) return;
 
-  DWORD count = needed / sizeof(HMODULE);
-  for (DWORD i = 0; i < count; ++i) {
-    // Reuse the same patcher but swap the direction.
-    GMT__PatchIATEntry(modules[i], dll_name, hooked_func, orig_func, NULL);
+  PFN_LdrRegisterDllNotification fn_register = (PFN_LdrRegisterDllNotification)GetProcAddress(ntdll, "LdrRegisterDllNotification");
+  g_ldr_unregister = (PFN_LdrUnregisterDllNotification)GetProcAddress(ntdll, "LdrUnregisterDllNotification");
+  if (!fn_register || !g_ldr_unregister) return;
+
+  if (fn_register(0, GMT__DllNotification, NULL, &g_dll_notify_cookie) != 0) {
+    g_dll_notify_cookie = NULL;
+  }
+}
+
+static void GMT__UnregisterDllNotification(void) {
+  // Waits for a callback that is still running.
+  if (g_dll_notify_cookie && g_ldr_unregister) g_ldr_unregister(g_dll_notify_cookie);
+  g_dll_notify_cookie = NULL;
+}
+
+// Resolves the XInput functions.  Tries versioned DLLs, then the generic name.
+static void GMT__ResolveXInput(void) {
+  const char* xinput_dlls[] = {"xinput1_4.dll", "xinput1_3.dll", "xinput9_1_0.dll", "XInput1_4.dll", NULL};
+  HMODULE xinput = NULL;
+  for (int i = 0; xinput_dlls[i]; ++i) {
+    xinput = GetModuleHandleA(xinput_dlls[i]);
+    if (xinput) break;
+  }
+  // If no module is loaded yet, try loading the preferred version.
+  if (!xinput) xinput = LoadLibraryA("xinput1_4.dll");
+  if (xinput) {
+    if (!g_orig_XInputGetState)
+      g_orig_XInputGetState = (PFN_XInputGetState)GetProcAddress(xinput, "XInputGetState");
+    if (!g_orig_XInputSetState)
+      g_orig_XInputSetState = (PFN_XInputSetState)GetProcAddress(xinput, "XInputSetState");
+    if (!g_orig_XInputGetCapabilities)
+      g_orig_XInputGetCapabilities = (PFN_XInputGetCapabilities)GetProcAddress(xinput, "XInputGetCapabilities");
+    if (!g_orig_XInputGetKeystroke)
+      g_orig_XInputGetKeystroke = (PFN_XInputGetKeystroke)GetProcAddress(xinput, "XInputGetKeystroke");
   }
 }
 
@@ -1208,27 +1454,7 @@ void GMT_Platform_InstallInputHooks(void) {
       g_orig_GetRawInputData = (PFN_GetRawInputData)GetProcAddress(user32, "GetRawInputData");
   }
 
-  // Resolve XInput functions.  Try versioned DLLs, then the generic name.
-  {
-    const char* xinput_dlls[] = {"xinput1_4.dll", "xinput1_3.dll", "xinput9_1_0.dll", "XInput1_4.dll", NULL};
-    HMODULE xinput = NULL;
-    for (int i = 0; xinput_dlls[i]; ++i) {
-      xinput = GetModuleHandleA(xinput_dlls[i]);
-      if (xinput) break;
-    }
-    // If no module is loaded yet, try loading the preferred version.
-    if (!xinput) xinput = LoadLibraryA("xinput1_4.dll");
-    if (xinput) {
-      if (!g_orig_XInputGetState)
-        g_orig_XInputGetState = (PFN_XInputGetState)GetProcAddress(xinput, "XInputGetState");
-      if (!g_orig_XInputSetState)
-        g_orig_XInputSetState = (PFN_XInputSetState)GetProcAddress(xinput, "XInputSetState");
-      if (!g_orig_XInputGetCapabilities)
-        g_orig_XInputGetCapabilities = (PFN_XInputGetCapabilities)GetProcAddress(xinput, "XInputGetCapabilities");
-      if (!g_orig_XInputGetKeystroke)
-        g_orig_XInputGetKeystroke = (PFN_XInputGetKeystroke)GetProcAddress(xinput, "XInputGetKeystroke");
-    }
-  }
+  GMT__ResolveXInput();
 
   // Resolve DirectInput8Create.
   {
@@ -1239,41 +1465,16 @@ void GMT_Platform_InstallInputHooks(void) {
     }
   }
 
-  // Patch IATs of all loaded modules — user32 functions.
-  if (g_orig_GetAsyncKeyState)
-    GMT__PatchAllModules("user32.dll", (const void*)g_orig_GetAsyncKeyState, (const void*)GMT_Hook_GetAsyncKeyState, (void**)&g_orig_GetAsyncKeyState);
-  if (g_orig_GetKeyState)
-    GMT__PatchAllModules("user32.dll", (const void*)g_orig_GetKeyState, (const void*)GMT_Hook_GetKeyState, (void**)&g_orig_GetKeyState);
-  if (g_orig_GetKeyboardState)
-    GMT__PatchAllModules("user32.dll", (const void*)g_orig_GetKeyboardState, (const void*)GMT_Hook_GetKeyboardState, (void**)&g_orig_GetKeyboardState);
-  if (g_orig_GetCursorPos)
-    GMT__PatchAllModules("user32.dll", (const void*)g_orig_GetCursorPos, (const void*)GMT_Hook_GetCursorPos, (void**)&g_orig_GetCursorPos);
-  if (g_orig_GetRawInputData)
-    GMT__PatchAllModules("user32.dll", (const void*)g_orig_GetRawInputData, (const void*)GMT_Hook_GetRawInputData, (void**)&g_orig_GetRawInputData);
-
-  // Patch IATs — XInput functions.
-  // XInput is imported under various DLL names; patch all variants.
-  {
-    const char* xinput_names[] = {"xinput1_4.dll", "xinput1_3.dll", "xinput9_1_0.dll", NULL};
-    for (int i = 0; xinput_names[i]; ++i) {
-      if (g_orig_XInputGetState)
-        GMT__PatchAllModules(xinput_names[i], (const void*)g_orig_XInputGetState, (const void*)GMT_Hook_XInputGetState, (void**)&g_orig_XInputGetState);
-      if (g_orig_XInputSetState)
-        GMT__PatchAllModules(xinput_names[i], (const void*)g_orig_XInputSetState, (const void*)GMT_Hook_XInputSetState, (void**)&g_orig_XInputSetState);
-      if (g_orig_XInputGetCapabilities)
-        GMT__PatchAllModules(xinput_names[i], (const void*)g_orig_XInputGetCapabilities, (const void*)GMT_Hook_XInputGetCapabilities, (void**)&g_orig_XInputGetCapabilities);
-      if (g_orig_XInputGetKeystroke)
-        GMT__PatchAllModules(xinput_names[i], (const void*)g_orig_XInputGetKeystroke, (const void*)GMT_Hook_XInputGetKeystroke, (void**)&g_orig_XInputGetKeystroke);
-    }
-  }
-
-  // Patch IATs — DirectInput8Create.
-  if (g_orig_DirectInput8Create)
-    GMT__PatchAllModules("dinput8.dll", (const void*)g_orig_DirectInput8Create, (const void*)GMT_Hook_DirectInput8Create, (void**)&g_orig_DirectInput8Create);
+  // Patch the IATs of all loaded modules in one pass, and of every module
+  // loaded from now on as it arrives.  Registering first leaves no gap; a
+  // module patched twice is left as is the second time.
+  GMT__RegisterDllNotification();
+  GMT__PatchAllModules(true);
 
   // Install WH_GETMESSAGE hook to strip WM_INPUT messages.
   if (!g_getmessage_hook) {
     g_getmessage_hook = SetWindowsHookExA(WH_GETMESSAGE, GMT__GetMessageHook, NULL, GetCurrentThreadId());
+    g_getmessage_hook_thread = GetCurrentThreadId();
   }
 
   // LL hooks (mouse wheel, keyboard repeat, real-input blocking) are already
@@ -1299,41 +1500,20 @@ void GMT_Platform_RemoveInputHooks(void) {
     g_exception_filter_installed = false;
   }
 
-  // Restore IAT entries — user32 functions.
-  GMT__UnpatchAllModules("user32.dll", (const void*)GMT_Hook_GetAsyncKeyState, (void*)g_orig_GetAsyncKeyState);
-  GMT__UnpatchAllModules("user32.dll", (const void*)GMT_Hook_GetKeyState, (void*)g_orig_GetKeyState);
-  GMT__UnpatchAllModules("user32.dll", (const void*)GMT_Hook_GetKeyboardState, (void*)g_orig_GetKeyboardState);
-  GMT__UnpatchAllModules("user32.dll", (const void*)GMT_Hook_GetCursorPos, (void*)g_orig_GetCursorPos);
-  GMT__UnpatchAllModules("user32.dll", (const void*)GMT_Hook_GetRawInputData, (void*)g_orig_GetRawInputData);
+  // Restore the IAT entries.  No module can be patched behind our back once the
+  // notification is gone.
+  GMT__UnregisterDllNotification();
+  GMT__PatchAllModules(false);
 
   g_orig_GetAsyncKeyState = NULL;
   g_orig_GetKeyState = NULL;
   g_orig_GetKeyboardState = NULL;
   g_orig_GetCursorPos = NULL;
   g_orig_GetRawInputData = NULL;
-
-  // Restore IAT entries — XInput functions.
-  {
-    const char* xinput_names[] = {"xinput1_4.dll", "xinput1_3.dll", "xinput9_1_0.dll", NULL};
-    for (int i = 0; xinput_names[i]; ++i) {
-      if (g_orig_XInputGetState)
-        GMT__UnpatchAllModules(xinput_names[i], (const void*)GMT_Hook_XInputGetState, (void*)g_orig_XInputGetState);
-      if (g_orig_XInputSetState)
-        GMT__UnpatchAllModules(xinput_names[i], (const void*)GMT_Hook_XInputSetState, (void*)g_orig_XInputSetState);
-      if (g_orig_XInputGetCapabilities)
-        GMT__UnpatchAllModules(xinput_names[i], (const void*)GMT_Hook_XInputGetCapabilities, (void*)g_orig_XInputGetCapabilities);
-      if (g_orig_XInputGetKeystroke)
-        GMT__UnpatchAllModules(xinput_names[i], (const void*)GMT_Hook_XInputGetKeystroke, (void*)g_orig_XInputGetKeystroke);
-    }
-  }
   g_orig_XInputGetState = NULL;
   g_orig_XInputSetState = NULL;
   g_orig_XInputGetCapabilities = NULL;
   g_orig_XInputGetKeystroke = NULL;
-
-  // Restore IAT entries — DirectInput8Create.
-  if (g_orig_DirectInput8Create)
-    GMT__UnpatchAllModules("dinput8.dll", (const void*)GMT_Hook_DirectInput8Create, (void*)g_orig_DirectInput8Create);
   g_orig_DirectInput8Create = NULL;
   g_di_gamepad_counter = 0;
 
@@ -1389,6 +1569,100 @@ void GMT_Platform_SetReplayHooksActive(bool active) {
   InterlockedExchange(&g_replay_hooks_active, active ? 1 : 0);
 }
 
+// ===== Gamepad connection tracking =====
+//
+// XInputGetState on an empty slot goes all the way to the driver and is far
+// slower than on a connected pad, and most slots are empty.  A slot that reports
+// ERROR_DEVICE_NOT_CONNECTED is skipped until a device interface arrives
+// (cfgmgr32's CM_Register_Notification, loaded at run time because it needs
+// Windows 8) or, as a fallback, until GMT__XINPUT_RESCAN_MS has passed.
+//
+// The CM_* declarations below mirror <cfgmgr32.h>, which only declares them
+// for _WIN32_WINNT >= 0x0602.
+
+#define GMT__XINPUT_RESCAN_MS 2000
+
+#define GMT_CM_NOTIFY_FILTER_FLAG_ALL_INTERFACE_CLASSES 0x00000001
+#define GMT_CM_NOTIFY_FILTER_TYPE_DEVICEINTERFACE 0
+#define GMT_CM_NOTIFY_ACTION_DEVICEINTERFACEARRIVAL 0
+
+typedef struct GMT_CMNotifyFilter {
+  DWORD cbSize;
+  DWORD Flags;
+  int FilterType;
+  DWORD Reserved;
+  union {
+    struct { GUID ClassGuid; } DeviceInterface;
+    struct { HANDLE hTarget; } DeviceHandle;
+    struct { WCHAR InstanceId[200]; } DeviceInstance;
+  } u;
+} GMT_CMNotifyFilter;
+
+typedef DWORD(CALLBACK* PFN_GMT_CMNotifyCallback)(HANDLE hNotify, PVOID context, int action, void* event_data, DWORD event_data_size);
+typedef DWORD(WINAPI* PFN_CM_Register_Notification)(GMT_CMNotifyFilter* filter, PVOID context, PFN_GMT_CMNotifyCallback callback, HANDLE* out_notify);
+typedef DWORD(WINAPI* PFN_CM_Unregister_Notification)(HANDLE notify);
+
+static HMODULE g_cfgmgr32 = NULL;
+static HANDLE g_device_notify = NULL;
+static PFN_CM_Unregister_Notification g_cm_unregister = NULL;
+static volatile LONG g_device_arrivals = 0;  // Bumped on every device interface arrival.
+
+// Slots known to be empty, and when to look at them again.  CaptureInput (under
+// the framework mutex) and SampleInput (on the input sampling thread) each
+// keep their own.
+typedef struct GMT__GamepadScan {
+  uint32_t empty_mask;
+  LONG seen_arrivals;
+  double next_rescan;
+} GMT__GamepadScan;
+
+static GMT__GamepadScan g_capture_scan;
+static GMT__GamepadScan g_sample_scan;
+
+// Runs on a system thread-pool thread.
+static DWORD CALLBACK GMT__DeviceNotifyCallback(HANDLE notify, PVOID context, int action, void* event_data, DWORD event_data_size) {
+  (void)notify;
+  (void)context;
+  (void)event_data;
+  (void)event_data_size;
+  if (action == GMT_CM_NOTIFY_ACTION_DEVICEINTERFACEARRIVAL) {
+    InterlockedIncrement(&g_device_arrivals);
+  }
+  return ERROR_SUCCESS;
+}
+
+static void GMT__RegisterDeviceNotification(void) {
+  if (g_device_notify) return;
+  if (!g_cfgmgr32) g_cfgmgr32 = LoadLibraryA("cfgmgr32.dll");
+  if (!g_cfgmgr32) return;
+
+  PFN_CM_Register_Notification fn_register = (PFN_CM_Register_Notification)GetProcAddress(g_cfgmgr32, "CM_Register_Notification");
+  g_cm_unregister = (PFN_CM_Unregister_Notification)GetProcAddress(g_cfgmgr32, "CM_Unregister_Notification");
+  if (!fn_register || !g_cm_unregister) return;
+
+  GMT_CMNotifyFilter filter;
+  memset(&filter, 0, sizeof(filter));
+  filter.cbSize = sizeof(filter);
+  filter.Flags = GMT_CM_NOTIFY_FILTER_FLAG_ALL_INTERFACE_CLASSES;
+  filter.FilterType = GMT_CM_NOTIFY_FILTER_TYPE_DEVICEINTERFACE;
+  if (fn_register(&filter, NULL, GMT__DeviceNotifyCallback, &g_device_notify) != 0) {
+    g_device_notify = NULL;
+  }
+}
+
+static void GMT__UnregisterDeviceNotification(void) {
+  // Waits for a callback that is still running.
+  if (g_device_notify && g_cm_unregister) g_cm_unregister(g_device_notify);
+  g_device_notify = NULL;
+}
+
+static void GMT__ResetGamepadTracking(void) {
+  g_capture_scan.empty_mask = 0;
+  g_capture_scan.seen_arrivals = g_device_arrivals;
+  g_capture_scan.next_rescan = 0.0;
+  g_sample_scan = g_capture_scan;
+}
+
 // ===== Crash / abort safety net for non-GMT assertions =====
 //
 // Any assertion outside the GMT framework (CRT assert(), third-party libs,
@@ -1402,6 +1676,8 @@ static void GMT__AbortSignalHandler(int sig) {
   (void)sig;
   // Unhook first (also restores the original SIGABRT handler and SEH filter).
   GMT_Platform_RemoveInputHooks();
+  // Get the queued log messages out before the process dies.
+  GMT_Log_Flush();
   // Re-raise with the default handler so the normal abort dialog / core dump
   // appears exactly as it would without GameTest.
   signal(SIGABRT, SIG_DFL);
@@ -1412,6 +1688,7 @@ static void GMT__AbortSignalHandler(int sig) {
 // no debugger attached, and similar crashes.
 static LONG WINAPI GMT__UnhandledExceptionFilter(EXCEPTION_POINTERS* ep) {
   GMT_Platform_RemoveInputHooks();
+  GMT_Log_Flush();
   // Pass control to whatever filter was installed before us (or the OS default).
   if (g_prev_exception_filter) {
     return g_prev_exception_filter(ep);
@@ -1425,19 +1702,40 @@ double GMT_Platform_GetTime(void) {
   return (double)(now.QuadPart - g_perf_origin.QuadPart) * g_perf_freq_inv;
 }
 
-void GMT_Platform_Init(void) {
-  InitializeCriticalSection(&g_mutex);
+uint64_t GMT_Platform_GetTicks(void) {
+  LARGE_INTEGER now;
+  QueryPerformanceCounter(&now);
+  return (uint64_t)now.QuadPart;
+}
 
-  // Initialize high-resolution timer.  Store the current counter as origin so
-  // that GMT_Platform_GetTime returns values relative to init, keeping the
-  // integer-to-double conversion small and maximizing floating-point precision.
-  {
-    LARGE_INTEGER freq;
-    QueryPerformanceFrequency(&freq);
-    g_perf_freq_inv = 1.0 / (double)freq.QuadPart;
-    QueryPerformanceCounter(&g_perf_origin);
-  }
+uint64_t GMT_Platform_GetTickFrequency(void) {
+  return (uint64_t)g_perf_freq.QuadPart;
+}
+
+uint32_t GMT_Platform_GetProcessId(void) {
+  return (uint32_t)GetCurrentProcessId();
+}
 
+uint32_t GMT_Platform_GetThreadId(void) {
+  return (uint32_t)GetCurrentThreadId();
+}
+
+void GMT_Platform_InitTimer(void) {
+  if (InterlockedCompareExchange(&g_perf_init_state, 1, 0) != 0) {
+    // Another thread got here first; wait until its values are stored.
+    while (InterlockedCompareExchange(&g_perf_init_state, 2, 2) != 2) Sleep(0);
+    return;
+  }
+  // Store the current counter as origin so that GMT_Platform_GetTime returns
+  // values relative to init, keeping the integer-to-double conversion small and
+  // maximizing floating-point precision.
+  QueryPerformanceFrequency(&g_perf_freq);
+  g_perf_freq_inv = 1.0 / (double)g_perf_freq.QuadPart;
+  QueryPerformanceCounter(&g_perf_origin);
+  InterlockedExchange(&g_perf_init_state, 2);
+}
+
+void GMT_Platform_Init(void) {
   // Build the VK → GMT_Key reverse map from the forward k_vk[] table.
   memset(g_vk_to_gmt_key, 0, sizeof(g_vk_to_gmt_key));
   for (int k = 1; k < GMT_KEY_COUNT; ++k) {
@@ -1446,8 +1744,15 @@ void GMT_Platform_Init(void) {
       g_vk_to_gmt_key[vk] = k;
     }
   }
-  memset(g_hook_key_down, 0, sizeof(g_hook_key_down));
+  memset((void*)g_hook_vk_bits, 0, sizeof(g_hook_vk_bits));
   memset((void*)g_key_repeats, 0, sizeof(g_key_repeats));
+  memset((void*)g_key_repeat_pending, 0, sizeof(g_key_repeat_pending));
+  GMT__BuildScanCodeTable();
+
+  // Carrier message for input posted by the window-message injection backend.
+  if (!g_posted_input_message) {
+    g_posted_input_message = RegisterWindowMessageA("GMT_PostedInput");
+  }
 
   // Install low-level mouse and keyboard hooks for wheel-delta and key-repeat
   // accumulation.  Needed in both RECORD and REPLAY modes: in REPLAY the hooks
@@ -1460,6 +1765,22 @@ void GMT_Platform_Init(void) {
     g_keyboard_hook = SetWindowsHookExA(WH_KEYBOARD_LL, GMT__KeyboardLLHook, NULL, 0);
   }
 
+  // The hooks only see transitions, so keys and buttons already held at this
+  // point are taken from the real state once.
+  {
+    PFN_GetAsyncKeyState fn_gaks = g_orig_GetAsyncKeyState ? g_orig_GetAsyncKeyState : GetAsyncKeyState;
+    for (DWORD vk = 1; vk < 256; ++vk) {
+      if (fn_gaks((int)vk) & 0x8000) GMT__SetHookVK(vk, true);
+    }
+  }
+
+  GMT__ResetGamepadTracking();
+  if (g_gmt.setup.mode == GMT_Mode_RECORD) {
+    // RECORD has no IAT hooks, but CaptureInput still needs the real XInput.
+    GMT__ResolveXInput();
+    GMT__RegisterDeviceNotification();
+  }
+
   // Install crash / abort safety nets so that non-GMT assertions (CRT assert(),
   // third-party libs, raw abort() calls, SEH crashes) still remove the
   // input-blocking hooks before any dialog is displayed.
@@ -1482,12 +1803,13 @@ void GMT_Platform_Quit(void) {
   // RemoveInputHooks also handles the LL hooks when they were installed for replay.
   GMT_Platform_RemoveInputHooks();
 
+  GMT__UnregisterDeviceNotification();
+
   g_wheel_x = 0;
   g_wheel_y = 0;
-  memset(g_hook_key_down, 0, sizeof(g_hook_key_down));
+  memset((void*)g_hook_vk_bits, 0, sizeof(g_hook_vk_bits));
   memset((void*)g_key_repeats, 0, sizeof(g_key_repeats));
-
-  DeleteCriticalSection(&g_mutex);
+  memset((void*)g_key_repeat_pending, 0, sizeof(g_key_repeat_pending));
 }
 
 // ===== Directory =====
@@ -1530,29 +1852,133 @@ bool GMT_Platform_CreateDirRecursive(const char* path) {
   return true;
 }
 
+// ===== File Mapping =====
+
+bool GMT_Platform_MapFile(const char* path, GMT_MappedFile* out) {
+  memset(out, 0, sizeof(*out));
+
+  HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  if (file == INVALID_HANDLE_VALUE) return false;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || (ULONGLONG)size.QuadPart > (ULONGLONG)(SIZE_T)-1) {
+    CloseHandle(file);
+    return false;
+  }
+
+  // CreateFileMapping rejects empty files; report them as an empty view.
+  if (size.QuadPart == 0) {
+    CloseHandle(file);
+    return true;
+  }
+
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  CloseHandle(file);  // The mapping keeps the file open.
+  if (!mapping) return false;
+
+  void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);  // The view keeps the mapping alive.
+  if (!view) return false;
+
+  out->data = (const uint8_t*)view;
+  out->size = (size_t)size.QuadPart;
+  return true;
+}
+
+void GMT_Platform_UnmapFile(GMT_MappedFile* file) {
+  if (file->data) UnmapViewOfFile((LPCVOID)file->data);
+  memset(file, 0, sizeof(*file));
+}
+
 // ===== Input Capture =====
 
+// Reads every gamepad slot through the real XInputGetState, skipping the slots
+// `scan` knows to be empty.
+static void GMT__ReadGamepads(GMT__GamepadScan* scan, GMT_GamepadState* out) {
+  PFN_XInputGetState fn_xgs = g_orig_XInputGetState;
+
+  // Look at the empty slots again after a device arrived or the fallback interval.
+  LONG arrivals = g_device_arrivals;
+  double now = GMT_Platform_GetTime();
+  if (arrivals != scan->seen_arrivals || now >= scan->next_rescan) {
+    scan->empty_mask = 0;
+    scan->seen_arrivals = arrivals;
+    scan->next_rescan = now + GMT__XINPUT_RESCAN_MS / 1000.0;
+  }
+
+  for (int i = 0; i < GMT_MAX_GAMEPADS; ++i) {
+    GMT_GamepadState* gp = &out[i];
+    memset(gp, 0, sizeof(*gp));
+    if (!fn_xgs || (scan->empty_mask & (1u << i))) continue;
+
+    XINPUT_STATE xs;
+    memset(&xs, 0, sizeof(xs));
+    DWORD res = fn_xgs((DWORD)i, &xs);
+    if (res == ERROR_SUCCESS) {
+      gp->connected = 1;
+      gp->buttons = xs.Gamepad.wButtons;
+      gp->left_trigger = xs.Gamepad.bLeftTrigger;
+      gp->right_trigger = xs.Gamepad.bRightTrigger;
+      gp->left_stick_x = xs.Gamepad.sThumbLX;
+      gp->left_stick_y = xs.Gamepad.sThumbLY;
+      gp->right_stick_x = xs.Gamepad.sThumbRX;
+      gp->right_stick_y = xs.Gamepad.sThumbRY;
+    } else if (res == ERROR_DEVICE_NOT_CONNECTED) {
+      scan->empty_mask |= 1u << i;
+    }
+  }
+}
+
 void GMT_Platform_CaptureInput(GMT_InputState* out) {
   // When IAT hooks are installed our own calls would be intercepted too.
   // Call through the saved original pointers to always get real hardware state.
   PFN_GetCursorPos fn_gcp = g_orig_GetCursorPos ? g_orig_GetCursorPos : GetCursorPos;
   PFN_GetAsyncKeyState fn_gaks = g_orig_GetAsyncKeyState ? g_orig_GetAsyncKeyState : GetAsyncKeyState;
 
-  // Use GetAsyncKeyState (physical hardware state) instead of GetKeyboardState
-  // (message-synchronised state) so that key presses are captured on the frame
-  // they physically occur, not delayed until the message queue is pumped.  This
-  // eliminates a one-frame recording lag that caused replay divergence.
-  out->keys[GMT_Key_UNKNOWN] = 0;
-  for (int k = 1; k < GMT_KEY_COUNT; ++k) {
-    int vk = k_vk[k];
-    out->keys[k] = (vk != 0 && (fn_gaks(vk) & 0x8000)) ? 0x80u : 0;
+  // Held keys and mouse buttons as one bit per VK.  The hook bitmap is only
+  // trusted while both LL hooks are actually installed.
+  LONG vk_bits[GMT__VK_WORDS];
+  if (g_gmt.setup.input_capture == GMT_InputCapture_HOOKS && g_keyboard_hook && g_mouse_hook) {
+    for (int w = 0; w < GMT__VK_WORDS; ++w) {
+      vk_bits[w] = InterlockedCompareExchange(&g_hook_vk_bits[w], 0, 0);
+    }
+  } else {
+    // Use GetAsyncKeyState (physical hardware state) instead of GetKeyboardState
+    // (message-synchronised state) so that key presses are captured on the frame
+    // they physically occur, not delayed until the message queue is pumped.  This
+    // eliminates a one-frame recording lag that caused replay divergence.
+    static const int k_mouse_vk[] = {VK_LBUTTON, VK_RBUTTON, VK_MBUTTON, VK_XBUTTON1, VK_XBUTTON2};
+    memset(vk_bits, 0, sizeof(vk_bits));
+    for (int k = 1; k < GMT_KEY_COUNT; ++k) {
+      int vk = k_vk[k];
+      if (vk != 0 && (fn_gaks(vk) & 0x8000)) vk_bits[vk >> 5] |= (LONG)(1u << (vk & 31));
+    }
+    for (size_t i = 0; i < sizeof(k_mouse_vk) / sizeof(k_mouse_vk[0]); ++i) {
+      int vk = k_mouse_vk[i];
+      if (fn_gaks(vk) & 0x8000) vk_bits[vk >> 5] |= (LONG)(1u << (vk & 31));
+    }
   }
+#define GMT__VK_BIT(vk) ((vk_bits[(vk) >> 5] & (LONG)(1u << ((vk) & 31))) != 0)
 
-  // Read and reset per-key repeat accumulators atomically, clamping to uint8_t.
-  out->key_repeats[GMT_Key_UNKNOWN] = 0;
+  out->keys[GMT_Key_UNKNOWN] = 0;
   for (int k = 1; k < GMT_KEY_COUNT; ++k) {
-    LONG r = InterlockedExchange(&g_key_repeats[k], 0);
-    out->key_repeats[k] = (r > 255) ? 255 : (uint8_t)r;
+    int vk = k_vk[k];
+    out->keys[k] = (vk != 0 && GMT__VK_BIT(vk)) ? 0x80u : 0;
+  }
+
+  // Read and reset the repeat accumulators of the keys flagged by the hook,
+  // clamping to uint8_t.
+  memset(out->key_repeats, 0, sizeof(out->key_repeats));
+  for (int w = 0; w < (int)(sizeof(g_key_repeat_pending) / sizeof(g_key_repeat_pending[0])); ++w) {
+    unsigned long pending = (unsigned long)InterlockedExchange(&g_key_repeat_pending[w], 0);
+    unsigned long bit;
+    while (_BitScanForward(&bit, pending)) {
+      pending &= pending - 1;
+      int k = w * 32 + (int)bit;
+      LONG r = InterlockedExchange(&g_key_repeats[k], 0);
+      out->key_repeats[k] = (r > 255) ? 255 : (uint8_t)r;
+    }
   }
 
   POINT pt = {0, 0};
@@ -1565,172 +1991,150 @@ void GMT_Platform_CaptureInput(GMT_InputState* out) {
   out->mouse_wheel_y = (int32_t)InterlockedExchange(&g_wheel_y, 0);
 
   GMT_MouseButtons buttons = 0;
-  if (fn_gaks(VK_LBUTTON) & 0x8000) buttons |= GMT_MouseButton_LEFT;
-  if (fn_gaks(VK_RBUTTON) & 0x8000) buttons |= GMT_MouseButton_RIGHT;
-  if (fn_gaks(VK_MBUTTON) & 0x8000) buttons |= GMT_MouseButton_MIDDLE;
-  if (fn_gaks(VK_XBUTTON1) & 0x8000) buttons |= GMT_MouseButton_X1;
-  if (fn_gaks(VK_XBUTTON2) & 0x8000) buttons |= GMT_MouseButton_X2;
+  if (GMT__VK_BIT(VK_LBUTTON)) buttons |= GMT_MouseButton_LEFT;
+  if (GMT__VK_BIT(VK_RBUTTON)) buttons |= GMT_MouseButton_RIGHT;
+  if (GMT__VK_BIT(VK_MBUTTON)) buttons |= GMT_MouseButton_MIDDLE;
+  if (GMT__VK_BIT(VK_XBUTTON1)) buttons |= GMT_MouseButton_X1;
+  if (GMT__VK_BIT(VK_XBUTTON2)) buttons |= GMT_MouseButton_X2;
   // Bits 5–7 (GMT_MouseButton_5/6/7) have no Win32 mapping; left as 0.
   out->mouse_buttons = buttons;
+#undef GMT__VK_BIT
 
-  // ---- Gamepad state (XInput) ----
-  {
-    PFN_XInputGetState fn_xgs = g_orig_XInputGetState;
-    for (int i = 0; i < GMT_MAX_GAMEPADS; ++i) {
-      GMT_GamepadState* gp = &out->gamepads[i];
-      if (fn_xgs) {
-        XINPUT_STATE xs;
-        memset(&xs, 0, sizeof(xs));
-        DWORD res = fn_xgs((DWORD)i, &xs);
-        if (res == ERROR_SUCCESS) {
-          gp->connected = 1;
-          gp->buttons = xs.Gamepad.wButtons;
-          gp->left_trigger = xs.Gamepad.bLeftTrigger;
-          gp->right_trigger = xs.Gamepad.bRightTrigger;
-          gp->left_stick_x = xs.Gamepad.sThumbLX;
-          gp->left_stick_y = xs.Gamepad.sThumbLY;
-          gp->right_stick_x = xs.Gamepad.sThumbRX;
-          gp->right_stick_y = xs.Gamepad.sThumbRY;
-        } else {
-          memset(gp, 0, sizeof(*gp));
-        }
-      } else {
-        memset(gp, 0, sizeof(*gp));
-      }
-    }
+  GMT__ReadGamepads(&g_capture_scan, out->gamepads);
+}
+
+void GMT_Platform_SampleInput(GMT_InputState* out) {
+  PFN_GetCursorPos fn_gcp = g_orig_GetCursorPos ? g_orig_GetCursorPos : GetCursorPos;
+  PFN_GetAsyncKeyState fn_gaks = g_orig_GetAsyncKeyState ? g_orig_GetAsyncKeyState : GetAsyncKeyState;
+
+  POINT pt = {0, 0};
+  fn_gcp(&pt);
+  out->mouse_x = (int32_t)pt.x;
+  out->mouse_y = (int32_t)pt.y;
+
+  // The buttons come from the same source CaptureInput uses.
+  static const int k_mouse_vk[] = {VK_LBUTTON, VK_RBUTTON, VK_MBUTTON, VK_XBUTTON1, VK_XBUTTON2};
+  static const GMT_MouseButtons k_mouse_bit[] = {GMT_MouseButton_LEFT, GMT_MouseButton_RIGHT, GMT_MouseButton_MIDDLE, GMT_MouseButton_X1, GMT_MouseButton_X2};
+  bool from_hooks = g_gmt.setup.input_capture == GMT_InputCapture_HOOKS && g_keyboard_hook && g_mouse_hook;
+  GMT_MouseButtons buttons = 0;
+  for (size_t i = 0; i < sizeof(k_mouse_vk) / sizeof(k_mouse_vk[0]); ++i) {
+    bool down = from_hooks ? GMT__HookVKDown((DWORD)k_mouse_vk[i]) : (fn_gaks(k_mouse_vk[i]) & 0x8000) != 0;
+    if (down) buttons |= k_mouse_bit[i];
   }
+  out->mouse_buttons = buttons;
+
+  GMT__ReadGamepads(&g_sample_scan, out->gamepads);
 }
 
 // ===== Input Injection =====
-
-void GMT_Platform_InjectInput(const GMT_InputState* new_input,
-                              const GMT_InputState* prev_input) {
-  // Count total repeat events to size the dynamic buffer.
-  int total_repeat_count = 0;
-  for (int k = 1; k < GMT_KEY_COUNT; ++k) {
-    total_repeat_count += new_input->key_repeats[k];
+//
+// Two backends, selected by GMT_Setup.input_injection:
+//   SEND_INPUT      — synthesizes events in the OS input queue.  Reaches every
+//                     input API, but the queue is shared by the whole desktop.
+//   WINDOW_MESSAGES — posts WM_KEY* / WM_CHAR / WM_MOUSE* straight to the
+//                     game's own window and leaves polled state (GetKeyState,
+//                     GetCursorPos, XInput, ...) to the input hooks.  No cursor
+//                     or keyboard state outside the process is touched, so
+//                     several replays can run side by side.
+
+// Events are staged here and flushed to SendInput in batches.  Injection runs
+// under the framework mutex, so a single static buffer is enough.
+#define GMT__SEND_INPUT_BATCH 128
+
+static INPUT g_send_inputs[GMT__SEND_INPUT_BATCH];
+static UINT g_send_input_count = 0;
+
+static void GMT__FlushSendInput(void) {
+  if (g_send_input_count > 0) {
+    SendInput(g_send_input_count, g_send_inputs, sizeof(INPUT));
+    g_send_input_count = 0;
   }
+}
 
-  // Allocate: key transitions + repeat key-downs + 5 mouse buttons.
-  int capacity = GMT_KEY_COUNT + total_repeat_count + 5;
-  INPUT* inputs = GMT_Alloc((size_t)capacity * sizeof(INPUT));
-  if (!inputs) return;
-  UINT count = 0;
+static INPUT* GMT__QueueSendInput(void) {
+  if (g_send_input_count == GMT__SEND_INPUT_BATCH) GMT__FlushSendInput();
+  INPUT* inp = &g_send_inputs[g_send_input_count++];
+  memset(inp, 0, sizeof(*inp));
+  return inp;
+}
 
-  // ---- Keyboard delta ----
-  for (int k = 1; k < GMT_KEY_COUNT; ++k) {
-    bool was = (prev_input->keys[k] & 0x80u) != 0;
-    bool is = (new_input->keys[k] & 0x80u) != 0;
-    if (was == is) continue;
+static void GMT__QueueKeyInput(int k, bool down) {
+  INPUT* inp = GMT__QueueSendInput();
+  inp->type = INPUT_KEYBOARD;
+  inp->ki.wVk = (WORD)k_vk[k];
+  inp->ki.wScan = g_key_scan[k];
+  inp->ki.dwFlags = (down ? 0 : KEYEVENTF_KEYUP) | (g_key_extended[k] ? KEYEVENTF_EXTENDEDKEY : 0);
+}
 
-    int vk = k_vk[k];
-    if (vk == 0) continue;
-
-    INPUT* inp = &inputs[count++];
-    inp->type = INPUT_KEYBOARD;
-    inp->ki.wVk = (WORD)vk;
-    inp->ki.wScan = (WORD)MapVirtualKeyA((UINT)vk, MAPVK_VK_TO_VSC);
-    inp->ki.dwFlags = is ? 0 : KEYEVENTF_KEYUP;
-    inp->ki.time = 0;
-    inp->ki.dwExtraInfo = 0;
-
-    // Keys that require KEYEVENTF_EXTENDEDKEY on Win32.
-    if (k == GMT_Key_RIGHT_CTRL || k == GMT_Key_RIGHT_ALT ||
-        k == GMT_Key_LEFT_SUPER || k == GMT_Key_RIGHT_SUPER ||
-        k == GMT_Key_INSERT || k == GMT_Key_DELETE ||
-        k == GMT_Key_HOME || k == GMT_Key_END ||
-        k == GMT_Key_PAGE_UP || k == GMT_Key_PAGE_DOWN ||
-        k == GMT_Key_UP || k == GMT_Key_DOWN ||
-        k == GMT_Key_LEFT || k == GMT_Key_RIGHT ||
-        k == GMT_Key_NUM_LOCK || k == GMT_Key_KP_DIVIDE) {
-      inp->ki.dwFlags |= KEYEVENTF_EXTENDEDKEY;
+// L / R / M use dedicated flags; X1 and X2 share XDOWN/XUP (WM_XBUTTON*) with
+// the XBUTTON value distinguishing them.  Bits 5–7 have no Win32 mapping and
+// are not injected.
+static const struct {
+  GMT_MouseButton flag;
+  DWORD down_flag;
+  DWORD up_flag;
+  UINT down_message;
+  UINT up_message;
+  DWORD mouse_data;  // Non-zero only for XBUTTON events.
+} k_button_map[] = {
+    {  GMT_MouseButton_LEFT,   MOUSEEVENTF_LEFTDOWN,   MOUSEEVENTF_LEFTUP, WM_LBUTTONDOWN, WM_LBUTTONUP,        0},
+    { GMT_MouseButton_RIGHT,  MOUSEEVENTF_RIGHTDOWN,  MOUSEEVENTF_RIGHTUP, WM_RBUTTONDOWN, WM_RBUTTONUP,        0},
+    {GMT_MouseButton_MIDDLE, MOUSEEVENTF_MIDDLEDOWN, MOUSEEVENTF_MIDDLEUP, WM_MBUTTONDOWN, WM_MBUTTONUP,        0},
+    {    GMT_MouseButton_X1,      MOUSEEVENTF_XDOWN,      MOUSEEVENTF_XUP, WM_XBUTTONDOWN, WM_XBUTTONUP, XBUTTON1},
+    {    GMT_MouseButton_X2,      MOUSEEVENTF_XDOWN,      MOUSEEVENTF_XUP, WM_XBUTTONDOWN, WM_XBUTTONUP, XBUTTON2},
+};
+static const int k_button_count = (int)(sizeof(k_button_map) / sizeof(k_button_map[0]));
+
+static void GMT__InjectSendInput(const GMT_InputState* new_input, const GMT_InputState* prev_input) {
+  // ---- Keyboard delta ----
+  GMT_KeyMask transitions;
+  GMT_InputState_KeyTransitions(prev_input, new_input, &transitions);
+  for (int w = 0; w < GMT_KEY_MASK_WORDS; ++w) {
+    for (uint64_t bits = transitions.bits[w]; bits; bits &= bits - 1) {
+      int k = w * 64 + GMT_KeyMask_LowestBit(bits);
+      if (k_vk[k] == 0) continue;
+      GMT__QueueKeyInput(k, (new_input->keys[k] & 0x80u) != 0);
     }
   }
 
   // ---- Keyboard repeats ----
   // Emit additional key-down events for keys that were held and generated auto-repeat events.
-  for (int k = 1; k < GMT_KEY_COUNT; ++k) {
-    int repeats = new_input->key_repeats[k];
-    if (repeats == 0) continue;
-
-    int vk = k_vk[k];
-    if (vk == 0) continue;
-
-    DWORD ext_flag = 0;
-    if (k == GMT_Key_RIGHT_CTRL || k == GMT_Key_RIGHT_ALT ||
-        k == GMT_Key_LEFT_SUPER || k == GMT_Key_RIGHT_SUPER ||
-        k == GMT_Key_INSERT || k == GMT_Key_DELETE ||
-        k == GMT_Key_HOME || k == GMT_Key_END ||
-        k == GMT_Key_PAGE_UP || k == GMT_Key_PAGE_DOWN ||
-        k == GMT_Key_UP || k == GMT_Key_DOWN ||
-        k == GMT_Key_LEFT || k == GMT_Key_RIGHT ||
-        k == GMT_Key_NUM_LOCK || k == GMT_Key_KP_DIVIDE) {
-      ext_flag = KEYEVENTF_EXTENDEDKEY;
-    }
-
-    WORD scan = (WORD)MapVirtualKeyA((UINT)vk, MAPVK_VK_TO_VSC);
-    for (int r = 0; r < repeats; ++r) {
-      INPUT* inp = &inputs[count++];
-      inp->type = INPUT_KEYBOARD;
-      inp->ki.wVk = (WORD)vk;
-      inp->ki.wScan = scan;
-      inp->ki.dwFlags = ext_flag;  // Key-down (no KEYEVENTF_KEYUP).
-      inp->ki.time = 0;
-      inp->ki.dwExtraInfo = 0;
+  GMT_KeyMask repeating;
+  GMT_InputState_RepeatingKeys(new_input, &repeating);
+  for (int w = 0; w < GMT_KEY_MASK_WORDS; ++w) {
+    for (uint64_t bits = repeating.bits[w]; bits; bits &= bits - 1) {
+      int k = w * 64 + GMT_KeyMask_LowestBit(bits);
+      if (k_vk[k] == 0) continue;
+      for (int r = 0; r < new_input->key_repeats[k]; ++r) {
+        GMT__QueueKeyInput(k, true);
+      }
     }
   }
 
   // ---- Mouse buttons delta ----
-  // L / R / M use dedicated flags; X1 and X2 share XDOWN/XUP with mouseData distinguishing them.
-  // Bits 5–7 have no Win32 mapping and are not injected.
-  static const struct {
-    GMT_MouseButton flag;
-    DWORD down_flag;
-    DWORD up_flag;
-    DWORD mouse_data;  // Non-zero only for XBUTTON events.
-  } k_button_map[] = {
-      {  GMT_MouseButton_LEFT,   MOUSEEVENTF_LEFTDOWN,   MOUSEEVENTF_LEFTUP,        0},
-      { GMT_MouseButton_RIGHT,  MOUSEEVENTF_RIGHTDOWN,  MOUSEEVENTF_RIGHTUP,        0},
-      {GMT_MouseButton_MIDDLE, MOUSEEVENTF_MIDDLEDOWN, MOUSEEVENTF_MIDDLEUP,        0},
-      {    GMT_MouseButton_X1,      MOUSEEVENTF_XDOWN,      MOUSEEVENTF_XUP, XBUTTON1},
-      {    GMT_MouseButton_X2,      MOUSEEVENTF_XDOWN,      MOUSEEVENTF_XUP, XBUTTON2},
-  };
-  static const int k_button_count = (int)(sizeof(k_button_map) / sizeof(k_button_map[0]));
-
   for (int b = 0; b < k_button_count; ++b) {
     bool was = (prev_input->mouse_buttons & k_button_map[b].flag) != 0;
     bool is = (new_input->mouse_buttons & k_button_map[b].flag) != 0;
     if (was == is) continue;
 
-    INPUT* inp = &inputs[count++];
+    INPUT* inp = GMT__QueueSendInput();
     inp->type = INPUT_MOUSE;
-    inp->mi.dx = 0;
-    inp->mi.dy = 0;
     inp->mi.mouseData = k_button_map[b].mouse_data;
     inp->mi.dwFlags = is ? k_button_map[b].down_flag : k_button_map[b].up_flag;
-    inp->mi.time = 0;
-    inp->mi.dwExtraInfo = 0;
   }
 
-  if (count > 0) {
-    SendInput(count, inputs, sizeof(INPUT));
-  }
-  GMT_Free(inputs);
-
   // ---- Mouse wheel ----
   if (new_input->mouse_wheel_y != 0) {
-    INPUT wi = {0};
-    wi.type = INPUT_MOUSE;
-    wi.mi.dwFlags = MOUSEEVENTF_WHEEL;
-    wi.mi.mouseData = (DWORD)(LONG)new_input->mouse_wheel_y;
-    SendInput(1, &wi, sizeof(INPUT));
+    INPUT* inp = GMT__QueueSendInput();
+    inp->type = INPUT_MOUSE;
+    inp->mi.dwFlags = MOUSEEVENTF_WHEEL;
+    inp->mi.mouseData = (DWORD)(LONG)new_input->mouse_wheel_y;
   }
   if (new_input->mouse_wheel_x != 0) {
-    INPUT wi = {0};
-    wi.type = INPUT_MOUSE;
-    wi.mi.dwFlags = MOUSEEVENTF_HWHEEL;
-    wi.mi.mouseData = (DWORD)(LONG)new_input->mouse_wheel_x;
-    SendInput(1, &wi, sizeof(INPUT));
+    INPUT* inp = GMT__QueueSendInput();
+    inp->type = INPUT_MOUSE;
+    inp->mi.dwFlags = MOUSEEVENTF_HWHEEL;
+    inp->mi.mouseData = (DWORD)(LONG)new_input->mouse_wheel_x;
   }
 
   // ---- Mouse position ----
@@ -1745,26 +2149,325 @@ void GMT_Platform_InjectInput(const GMT_InputState* new_input,
     int vsh = GetSystemMetrics(SM_CYVIRTUALSCREEN);  // Height.
 
     if (vsw > 0 && vsh > 0) {
-      INPUT mi = {0};
-      mi.type = INPUT_MOUSE;
-      mi.mi.dx = (LONG)((((double)new_input->mouse_x - vsx) / vsw) * 65535.0);
-      mi.mi.dy = (LONG)((((double)new_input->mouse_y - vsy) / vsh) * 65535.0);
-      mi.mi.dwFlags = MOUSEEVENTF_MOVE | MOUSEEVENTF_ABSOLUTE | MOUSEEVENTF_VIRTUALDESK;
-      mi.mi.time = 0;
-      mi.mi.dwExtraInfo = 0;
-      SendInput(1, &mi, sizeof(INPUT));
+      INPUT* inp = GMT__QueueSendInput();
+      inp->type = INPUT_MOUSE;
+      inp->mi.dx = (LONG)((((double)new_input->mouse_x - vsx) / vsw) * 65535.0);
+      inp->mi.dy = (LONG)((((double)new_input->mouse_y - vsy) / vsh) * 65535.0);
+      inp->mi.dwFlags = MOUSEEVENTF_MOVE | MOUSEEVENTF_ABSOLUTE | MOUSEEVENTF_VIRTUALDESK;
     }
   }
+
+  GMT__FlushSendInput();
+}
+
+// ---- Window-message backend ----
+
+static BOOL CALLBACK GMT__FindInjectWindowProc(HWND hwnd, LPARAM lParam) {
+  // First visible, unowned top-level window of the thread: the game window.
+  if (IsWindowVisible(hwnd) && !GetWindow(hwnd, GW_OWNER)) {
+    *(HWND*)lParam = hwnd;
+    return FALSE;
+  }
+  return TRUE;
+}
+
+// Keyboard messages go to the focus window when the game thread has one (in
+// or out of the foreground); otherwise, like mouse messages, to the game's
+// top-level window.
+static HWND GMT__InjectWindow(bool keyboard) {
+  if (keyboard) {
+    HWND focus = GetFocus();
+    if (focus) return focus;
+  }
+  if (g_inject_hwnd && IsWindow(g_inject_hwnd)) return g_inject_hwnd;
+  g_inject_hwnd = NULL;
+  DWORD thread = g_getmessage_hook_thread ? g_getmessage_hook_thread : GetCurrentThreadId();
+  EnumThreadWindows(thread, GMT__FindInjectWindowProc, (LPARAM)&g_inject_hwnd);
+  return g_inject_hwnd;
+}
+
+static void GMT__PostInput(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam) {
+  LONG ticket = InterlockedIncrement(&g_posted_input_head) - 1;
+  GMT__PostedInput* posted = &g_posted_inputs[(uint32_t)ticket % GMT__POSTED_INPUT_COUNT];
+  InterlockedExchange(&posted->sequence, 0);
+  posted->message = message;
+  posted->wParam = wParam;
+  posted->lParam = lParam;
+  InterlockedExchange(&posted->sequence, ticket + 1);  // Release: the hook reads the slot after this.
+  PostMessageA(hwnd, g_posted_input_message, (WPARAM)(uint32_t)ticket, 0);
+}
+
+static bool GMT__KeyDown(const GMT_InputState* input, GMT_Key key) {
+  return (input->keys[key] & 0x80u) != 0;
+}
+
+// WM_KEY* lParam: repeat count, scan code, extended bit, context (Alt held),
+// previous key state and transition state.
+static LPARAM GMT__KeyMessageLParam(int k, bool was_down, bool is_down, bool alt) {
+  DWORD lp = 1u | ((DWORD)(g_key_scan[k] & 0xFFu) << 16);
+  if (g_key_extended[k]) lp |= 1u << 24;
+  if (alt) lp |= 1u << 29;
+  if (was_down) lp |= 1u << 30;
+  if (!is_down) lp |= 1u << 31;
+  return (LPARAM)lp;
+}
+
+// Posts the WM_CHARs TranslateMessage would have produced for a key-down,
+// using the replayed keyboard state rather than the thread's real one.
+static void GMT__PostKeyChars(HWND hwnd, const GMT_InputState* input, int k, LPARAM key_lparam) {
+  BYTE state[256] = {0};
+  for (int i = 1; i < GMT_KEY_COUNT; ++i) {
+    if (k_vk[i] != 0 && (input->keys[i] & 0x80u)) state[k_vk[i]] = 0x80;
+  }
+  if (GMT__KeyDown(input, GMT_Key_LEFT_SHIFT) || GMT__KeyDown(input, GMT_Key_RIGHT_SHIFT)) state[VK_SHIFT] = 0x80;
+  if (GMT__KeyDown(input, GMT_Key_LEFT_CTRL) || GMT__KeyDown(input, GMT_Key_RIGHT_CTRL)) state[VK_CONTROL] = 0x80;
+  if (GMT__KeyDown(input, GMT_Key_LEFT_ALT) || GMT__KeyDown(input, GMT_Key_RIGHT_ALT)) state[VK_MENU] = 0x80;
+  state[VK_CAPITAL] |= (BYTE)(g_replayed_toggle_state[VK_CAPITAL] & 1u);
+  state[VK_NUMLOCK] |= (BYTE)(g_replayed_toggle_state[VK_NUMLOCK] & 1u);
+
+  WCHAR chars[4];
+  // Flag 0x4: leave the kernel-mode keyboard state (dead-key buffer) alone.
+  int n = ToUnicode((UINT)k_vk[k], g_key_scan[k], state, chars, 4, 0x4);
+  UINT message = (state[VK_MENU] && !state[VK_CONTROL]) ? WM_SYSCHAR : WM_CHAR;
+  for (int i = 0; i < n; ++i) {
+    GMT__PostInput(hwnd, message, (WPARAM)chars[i], key_lparam);
+  }
+}
+
+static void GMT__PostKey(HWND hwnd, const GMT_InputState* input, int k, bool was_down, bool is_down) {
+  bool alt = GMT__KeyDown(input, GMT_Key_LEFT_ALT) || GMT__KeyDown(input, GMT_Key_RIGHT_ALT);
+  bool ctrl = GMT__KeyDown(input, GMT_Key_LEFT_CTRL) || GMT__KeyDown(input, GMT_Key_RIGHT_CTRL);
+  bool is_alt_key = (k == GMT_Key_LEFT_ALT || k == GMT_Key_RIGHT_ALT);
+  // Alt combinations and F10 arrive as WM_SYSKEY*, as they do from the keyboard.
+  bool sys = ((alt || is_alt_key) && !ctrl) || k_vk[k] == VK_F10;
+  UINT message = is_down ? (sys ? WM_SYSKEYDOWN : WM_KEYDOWN) : (sys ? WM_SYSKEYUP : WM_KEYUP);
+  LPARAM lp = GMT__KeyMessageLParam(k, was_down, is_down, alt && sys);
+  GMT__PostInput(hwnd, message, (WPARAM)k_vk[k], lp);
+  if (is_down) GMT__PostKeyChars(hwnd, input, k, lp);
+}
+
+// MK_* flags carried by the wParam of every mouse message.
+static WPARAM GMT__MouseKeyFlags(const GMT_InputState* input) {
+  WPARAM mk = 0;
+  if (input->mouse_buttons & GMT_MouseButton_LEFT) mk |= MK_LBUTTON;
+  if (input->mouse_buttons & GMT_MouseButton_RIGHT) mk |= MK_RBUTTON;
+  if (input->mouse_buttons & GMT_MouseButton_MIDDLE) mk |= MK_MBUTTON;
+  if (input->mouse_buttons & GMT_MouseButton_X1) mk |= MK_XBUTTON1;
+  if (input->mouse_buttons & GMT_MouseButton_X2) mk |= MK_XBUTTON2;
+  if (GMT__KeyDown(input, GMT_Key_LEFT_SHIFT) || GMT__KeyDown(input, GMT_Key_RIGHT_SHIFT)) mk |= MK_SHIFT;
+  if (GMT__KeyDown(input, GMT_Key_LEFT_CTRL) || GMT__KeyDown(input, GMT_Key_RIGHT_CTRL)) mk |= MK_CONTROL;
+  return mk;
+}
+
+static LPARAM GMT__PointLParam(LONG x, LONG y) {
+  return MAKELPARAM((WORD)(SHORT)x, (WORD)(SHORT)y);
+}
+
+// Splits a recorded wheel delta into WM_MOUSEWHEEL / WM_MOUSEHWHEEL messages;
+// the delta travels in a SHORT.
+static void GMT__PostWheel(HWND hwnd, UINT message, int32_t delta, WPARAM mk, LPARAM screen_pos) {
+  while (delta != 0) {
+    int32_t step = delta > SHRT_MAX ? SHRT_MAX : (delta < SHRT_MIN ? SHRT_MIN : delta);
+    GMT__PostInput(hwnd, message, MAKEWPARAM((WORD)mk, (WORD)(SHORT)step), screen_pos);
+    delta -= step;
+  }
+}
+
+static void GMT__InjectWindowMessages(const GMT_InputState* new_input, const GMT_InputState* prev_input) {
+  if (!g_posted_input_message) return;
+
+  // ---- Keyboard delta and repeats ----
+  HWND key_hwnd = GMT__InjectWindow(true);
+  if (key_hwnd) {
+    GMT_KeyMask transitions, repeating;
+    GMT_InputState_KeyTransitions(prev_input, new_input, &transitions);
+    GMT_InputState_RepeatingKeys(new_input, &repeating);
+    for (int w = 0; w < GMT_KEY_MASK_WORDS; ++w) {
+      for (uint64_t bits = transitions.bits[w] | repeating.bits[w]; bits; bits &= bits - 1) {
+        int k = w * 64 + GMT_KeyMask_LowestBit(bits);
+        if (k_vk[k] == 0) continue;
+        bool was = (prev_input->keys[k] & 0x80u) != 0;
+        bool is = (new_input->keys[k] & 0x80u) != 0;
+        if (was != is) GMT__PostKey(key_hwnd, new_input, k, was, is);
+        for (int r = 0; r < new_input->key_repeats[k]; ++r) {
+          GMT__PostKey(key_hwnd, new_input, k, true, true);
+        }
+      }
+    }
+  }
+
+  HWND mouse_hwnd = GMT__InjectWindow(false);
+  if (!mouse_hwnd) return;
+
+  // The cursor itself is never moved: GetCursorPos is answered by the hook, and
+  // the messages carry the recorded position mapped into the window.
+  POINT client = {(LONG)new_input->mouse_x, (LONG)new_input->mouse_y};
+  ScreenToClient(mouse_hwnd, &client);
+  WPARAM mk = GMT__MouseKeyFlags(new_input);
+  LPARAM client_pos = GMT__PointLParam(client.x, client.y);
+
+  // ---- Mouse position ----
+  // Sent first so that button messages below report the new position.
+  if (new_input->mouse_x != prev_input->mouse_x || new_input->mouse_y != prev_input->mouse_y) {
+    GMT__PostInput(mouse_hwnd, WM_MOUSEMOVE, mk, client_pos);
+  }
+
+  // ---- Mouse buttons delta ----
+  for (int b = 0; b < k_button_count; ++b) {
+    bool was = (prev_input->mouse_buttons & k_button_map[b].flag) != 0;
+    bool is = (new_input->mouse_buttons & k_button_map[b].flag) != 0;
+    if (was == is) continue;
+    WPARAM wParam = mk;
+    if (k_button_map[b].mouse_data) wParam = MAKEWPARAM((WORD)mk, (WORD)k_button_map[b].mouse_data);
+    GMT__PostInput(mouse_hwnd, is ? k_button_map[b].down_message : k_button_map[b].up_message, wParam, client_pos);
+  }
+
+  // ---- Mouse wheel ----
+  // Wheel messages carry screen, not client, coordinates.
+  LPARAM screen_pos = GMT__PointLParam((LONG)new_input->mouse_x, (LONG)new_input->mouse_y);
+  GMT__PostWheel(mouse_hwnd, WM_MOUSEWHEEL, new_input->mouse_wheel_y, mk, screen_pos);
+  GMT__PostWheel(mouse_hwnd, WM_MOUSEHWHEEL, new_input->mouse_wheel_x, mk, screen_pos);
+}
+
+void GMT_Platform_InjectInput(const GMT_InputState* new_input,
+                              const GMT_InputState* prev_input) {
+  if (g_gmt.setup.input_injection == GMT_InputInjection_WINDOW_MESSAGES) {
+    GMT__InjectWindowMessages(new_input, prev_input);
+  } else {
+    GMT__InjectSendInput(new_input, prev_input);
+  }
 }
 
 // ===== Mutex =====
 
-void GMT_Platform_MutexLock(void) {
-  EnterCriticalSection(&g_mutex);
+struct GMT_Mutex {
+  CRITICAL_SECTION cs;
+};
+
+GMT_Mutex* GMT_Platform_CreateMutex(void) {
+  GMT_Mutex* m = (GMT_Mutex*)GMT_Alloc(sizeof(GMT_Mutex));
+  if (m) InitializeCriticalSection(&m->cs);
+  return m;
+}
+
+void GMT_Platform_DestroyMutex(GMT_Mutex* mutex) {
+  if (!mutex) return;
+  DeleteCriticalSection(&mutex->cs);
+  GMT_Free(mutex);
+}
+
+void GMT_Platform_LockMutex(GMT_Mutex* mutex) {
+  if (mutex) EnterCriticalSection(&mutex->cs);
 }
 
-void GMT_Platform_MutexUnlock(void) {
-  LeaveCriticalSection(&g_mutex);
+void GMT_Platform_UnlockMutex(GMT_Mutex* mutex) {
+  if (mutex) LeaveCriticalSection(&mutex->cs);
 }
 
 // ===== Threading =====
+
+struct GMT_Thread {
+  HANDLE handle;
+  GMT_ThreadProc* proc;
+  void* user;
+  GMT_State* state;  // Framework state of the creating thread.
+};
+
+static DWORD WINAPI GMT__ThreadMain(LPVOID param) {
+  GMT_Thread* t = (GMT_Thread*)param;
+  g_gmt_current = t->state;
+  t->proc(t->user);
+  return 0;
+}
+
+GMT_Thread* GMT_Platform_CreateThread(GMT_ThreadProc* proc, void* user) {
+  GMT_Thread* t = (GMT_Thread*)GMT_Alloc(sizeof(GMT_Thread));
+  if (!t) return NULL;
+  t->proc = proc;
+  t->user = user;
+  t->state = g_gmt_current;
+  t->handle = CreateThread(NULL, 0, GMT__ThreadMain, t, 0, NULL);
+  if (!t->handle) {
+    GMT_Free(t);
+    return NULL;
+  }
+  return t;
+}
+
+void GMT_Platform_JoinThread(GMT_Thread* thread) {
+  if (!thread) return;
+  WaitForSingleObject(thread->handle, INFINITE);
+  CloseHandle(thread->handle);
+  GMT_Free(thread);
+}
+
+GMT_Event* GMT_Platform_CreateEvent(void) {
+  return (GMT_Event*)CreateEventA(NULL, FALSE, FALSE, NULL);
+}
+
+void GMT_Platform_DestroyEvent(GMT_Event* event) {
+  if (event) CloseHandle((HANDLE)event);
+}
+
+void GMT_Platform_SetFineTimer(bool enable) {
+  if (enable) timeBeginPeriod(1);
+  else
+    timeEndPeriod(1);
+}
+
+void GMT_Platform_SignalEvent(GMT_Event* event) {
+  SetEvent((HANDLE)event);
+}
+
+bool GMT_Platform_WaitEvent(GMT_Event* event, uint32_t timeout_ms) {
+  return WaitForSingleObject((HANDLE)event, (DWORD)timeout_ms) == WAIT_OBJECT_0;
+}
+
+// ===== Pipe =====
+
+GMT_Pipe* GMT_Platform_ConnectPipe(const char* name) {
+  for (int attempt = 0; attempt < 50; ++attempt) {
+    HANDLE h = CreateFileA(name, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+    if (h != INVALID_HANDLE_VALUE) return (GMT_Pipe*)h;
+    if (GetLastError() != ERROR_PIPE_BUSY) return NULL;
+    WaitNamedPipeA(name, 100);
+  }
+  return NULL;
+}
+
+void GMT_Platform_ClosePipe(GMT_Pipe* pipe) {
+  if (pipe) CloseHandle((HANDLE)pipe);
+}
+
+size_t GMT_Platform_ReadPipe(GMT_Pipe* pipe, void* buffer, size_t size) {
+  DWORD read = 0;
+  if (!pipe || size == 0) return 0;
+  if (!ReadFile((HANDLE)pipe, buffer, (DWORD)(size > 0x10000 ? 0x10000 : size), &read, NULL)) return 0;
+  return (size_t)read;
+}
+
+bool GMT_Platform_WritePipe(GMT_Pipe* pipe, const void* data, size_t size) {
+  const char* p = (const char*)data;
+  if (!pipe) return false;
+  while (size > 0) {
+    DWORD written = 0;
+    if (!WriteFile((HANDLE)pipe, p, (DWORD)(size > 0x10000 ? 0x10000 : size), &written, NULL) || written == 0) return false;
+    p += written;
+    size -= written;
+  }
+  return true;
+}
+
+// ===== Shared Memory =====
+
+void* GMT_Platform_OpenSharedMemory(const char* name, size_t size) {
+  HANDLE mapping = OpenFileMappingA(FILE_MAP_WRITE, FALSE, name);
+  if (!mapping) return NULL;
+  void* view = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+  CloseHandle(mapping);  // The view keeps the mapping alive.
+  return view;
+}
+
+void GMT_Platform_CloseSharedMemory(void* view) {
+  if (view) UnmapViewOfFile(view);
+}
@@ -0,0 +1,109 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Internal.h"
+#include <string.h>
+
+// Wire protocol with GameTest-Tool --pool (tool/Tool.c), one line per message:
+//   worker -> tool  "done <status>"                   a test ended; 0 passed, 1 failed
+//   tool -> worker  "test\t<test path>\t<result path>" run this next; the result path may be empty
+//                   "quit"                            no tests left
+// A worker's first test comes on its command line, as for a single replay.
+
+bool GMT_Pool_Connect(void) {
+  const char* name = g_gmt.setup.pool_name;
+  g_gmt.pool_pipe = GMT_Platform_ConnectPipe(name);
+  if (!g_gmt.pool_pipe) {
+    GMT_LogError("Failed to join the test pool %s", name);
+    return false;
+  }
+  GMT_LogInfo("Joined the test pool %s", name);
+  return true;
+}
+
+void GMT_Pool_Disconnect(void) {
+  GMT_Platform_ClosePipe(g_gmt.pool_pipe);
+  g_gmt.pool_pipe = NULL;
+}
+
+// Reads one line without its terminator.  Returns false once the tool has gone
+// or if the line does not fit.  Messages are short, so byte reads are enough.
+static bool GMT__PoolReadLine(char* out, size_t size) {
+  size_t len = 0;
+  for (;;) {
+    char c;
+    if (GMT_Platform_ReadPipe(g_gmt.pool_pipe, &c, 1) != 1) return false;
+    if (c == '\n') break;
+    if (len + 1 >= size) return false;
+    out[len++] = c;
+  }
+  if (len > 0 && out[len - 1] == '\r') --len;
+  out[len] = '\0';
+  return true;
+}
+
+static bool GMT__PoolSendDone(bool passed) {
+  const char* msg = passed ? "done 0\n" : "done 1\n";
+  return GMT_Platform_WritePipe(g_gmt.pool_pipe, msg, strlen(msg));
+}
+
+bool GMT_PoolNextTest_(void) {
+  if (!g_gmt.initialized || !g_gmt.pool_pipe) return false;
+
+  // The tool reads the result file as soon as it sees "done".
+  bool passed = !g_gmt.test_failed;
+  GMT_WriteResultFile();
+
+  char line[2 * GMT_MAX_POOL_PATH + 16];
+  while (GMT__PoolSendDone(passed) && GMT__PoolReadLine(line, sizeof(line))) {
+    if (strncmp(line, "test\t", 5) != 0) break;  // "quit"
+
+    char* path = line + 5;
+    char* result = strchr(path, '\t');
+    if (result) *result++ = '\0';
+
+    GMT_PrintReport_();
+    if (result && result[0] != '\0' && strlen(result) < sizeof(g_gmt.result_path)) {
+      memcpy(g_gmt.result_path, result, strlen(result) + 1);
+      g_gmt.setup.result_path = g_gmt.result_path;
+    } else {
+      if (result && result[0] != '\0') GMT_LogWarning("Result path too long; writing none: %s", result);
+      g_gmt.setup.result_path = NULL;
+    }
+
+    GMT_LogInfo("Next pooled test: %s", path);
+    if (GMT_ResetTo_(path)) return true;
+
+    // A file that does not load fails its test; move on to the next one.
+    g_gmt.test_failed = true;
+    GMT_WriteResultFile();
+    passed = false;
+  }
+
+  // The pool is done (or the tool has gone).  The tool already has this test's
+  // result, so GMT_Quit must not write a second one.
+  GMT_Pool_Disconnect();
+  g_gmt.setup.result_path = NULL;
+  return false;
+}
@@ -0,0 +1,247 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Internal.h"
+#include "Profile.h"
+#include <inttypes.h>
+#include <string.h>
+
+static const char* const k_gmt_profile_scope_names[GMT_ProfileScope_COUNT] = {
+  "Update",
+  "Capture",
+  "Inject",
+  "Track",
+  "Pin",
+  "Log",
+};
+
+// ===== Histogram =====
+
+static unsigned GMT__BucketIndex(uint64_t ns) {
+  if (ns < 16) return (unsigned)ns;
+  unsigned e = 4;
+  while ((ns >> (e + 1)) != 0) e++;
+  return (e - 3) * 16 + (unsigned)((ns >> (e - 4)) & 15);
+}
+
+// Middle of the range of values that land in bucket `index`.
+static uint64_t GMT__BucketValue(unsigned index) {
+  if (index < 16) return index;
+  unsigned e = index / 16 + 3;
+  uint64_t width = (uint64_t)1 << (e - 4);
+  return (uint64_t)(16 + index % 16) * width + width / 2;
+}
+
+static void GMT__HistogramAdd(GMT_ProfileHistogram* h, uint64_t ns) {
+  h->counts[GMT__BucketIndex(ns)]++;
+  h->frames++;
+  if (ns > h->max_ns) h->max_ns = ns;
+}
+
+static uint64_t GMT__HistogramQuantile(const GMT_ProfileHistogram* h, double q) {
+  if (h->frames == 0) return 0;
+  uint64_t rank = (uint64_t)(q * (double)h->frames);
+  if (rank >= h->frames) rank = h->frames - 1;
+  uint64_t seen = 0;
+  for (unsigned i = 0; i < GMT_PROFILE_BUCKETS; i++) {
+    seen += h->counts[i];
+    if (seen > rank) {
+      uint64_t v = GMT__BucketValue(i);
+      return v < h->max_ns ? v : h->max_ns;
+    }
+  }
+  return h->max_ns;
+}
+
+static double GMT__TicksToNs(uint64_t ticks) {
+  return (double)ticks * 1e9 / (double)g_gmt.profile.ticks_per_second;
+}
+
+static double GMT__TicksToUs(uint64_t ticks) {
+  return (double)ticks * 1e6 / (double)g_gmt.profile.ticks_per_second;
+}
+
+// ===== Trace =====
+
+// Starts a trace event; the caller writes the remaining fields and the closing brace.
+static void GMT__TraceEventBegin(const char* name, const char* phase, uint64_t ts) {
+  GMT_Profile* p = &g_gmt.profile;
+  fprintf(p->trace, "%s{\"name\":\"%s\",\"cat\":\"GameTest\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":%u",
+          p->trace_has_events ? ",\n" : "", name, phase, GMT__TicksToUs(ts), (unsigned)p->pid);
+  p->trace_has_events = true;
+}
+
+static void GMT__TraceSpan(const char* name, uint64_t begin, uint64_t end, uint32_t tid, const char* args) {
+  FILE* f = g_gmt.profile.trace;
+  if (!f) return;
+  GMT__TraceEventBegin(name, "X", begin);
+  fprintf(f, ",\"tid\":%u,\"dur\":%.3f", (unsigned)tid, GMT__TicksToUs(end - begin));
+  if (args) fprintf(f, ",\"args\":{%s}", args);
+  fputc('}', f);
+}
+
+// ===== Lifetime =====
+
+void GMT_Profile_Init(void) {
+  GMT_Profile* p = &g_gmt.profile;
+  const char* path = g_gmt.setup.trace_path;
+  bool want_trace = path && path[0] != '\0';
+  if (!g_gmt.setup.profile_overhead && !want_trace) return;
+
+  memset(p, 0, sizeof(*p));
+  p->ticks_per_second = GMT_Platform_GetTickFrequency();
+  if (p->ticks_per_second == 0) {
+    GMT_LogWarning("GMT_Profile: no high-resolution counter; overhead profiling disabled.");
+    return;
+  }
+  p->pid = GMT_Platform_GetProcessId();
+
+  if (want_trace) {
+    // JSON array format: a trace cut short by a crash still loads.
+    p->trace = fopen(path, "wb");
+    if (!p->trace) GMT_LogError("GMT_Profile: failed to open trace file: %s", path);
+    else
+      fputs("[\n", p->trace);
+  }
+
+  p->frame_begin = GMT_Platform_GetTicks();
+  p->enabled = true;
+}
+
+void GMT_Profile_Quit(void) {
+  GMT_Profile* p = &g_gmt.profile;
+  if (!p->enabled) return;
+
+  GMT_Platform_MutexLock();
+  GMT_Profile_EndFrame();
+  p->enabled = false;
+  if (p->trace) {
+    fputs("\n]\n", p->trace);
+    fclose(p->trace);
+    p->trace = NULL;
+  }
+  GMT_Platform_MutexUnlock();
+}
+
+void GMT_Profile_FlushTrace(void) {
+  GMT_Platform_MutexLock();
+  if (g_gmt.profile.trace) fflush(g_gmt.profile.trace);
+  GMT_Platform_MutexUnlock();
+}
+
+// ===== Scopes =====
+
+uint64_t GMT_Profile_Begin(void) {
+  return g_gmt.profile.enabled ? GMT_Platform_GetTicks() : 0;
+}
+
+void GMT_Profile_End(GMT_ProfileScope scope, uint64_t begin) {
+  if (!begin) return;
+  GMT_Atomic_Add64(&g_gmt.profile.ticks[scope], GMT_Platform_GetTicks() - begin);
+}
+
+void GMT_Profile_EndThread(GMT_ProfileScope scope, uint64_t begin) {
+  if (!begin) return;
+  uint64_t ticks = GMT_Platform_GetTicks() - begin;
+  GMT_ThreadData* td = GMT_ThreadData_Get();
+  if (td) {
+    // Only the owning thread writes its totals.
+    GMT_Atomic_Store64(&td->profile_ticks[scope], td->profile_ticks[scope] + ticks);
+  } else {
+    GMT_Atomic_Add64(&g_gmt.profile.ticks[scope], ticks);
+  }
+}
+
+void GMT_Profile_EndSpan(GMT_ProfileScope scope, uint64_t begin, const char* name, const char* args) {
+  if (!begin) return;
+  uint64_t end = GMT_Platform_GetTicks();
+  GMT_Atomic_Add64(&g_gmt.profile.ticks[scope], end - begin);
+  if (name && g_gmt.profile.trace) GMT__TraceSpan(name, begin, end, GMT_Platform_GetThreadId(), args);
+}
+
+void GMT_Profile_EndFrame(void) {
+  GMT_Profile* p = &g_gmt.profile;
+  if (!p->enabled) return;
+
+  uint64_t frame[GMT_ProfileScope_COUNT];
+  for (int s = 0; s < GMT_ProfileScope_COUNT; s++) {
+    uint64_t total = GMT_Atomic_Load64(&p->ticks[s]);
+    frame[s] = total - p->folded[s];
+    p->folded[s] = total;
+  }
+  for (GMT_ThreadData* td = g_gmt.threads; td; td = td->next) {
+    for (int s = 0; s < GMT_ProfileScope_COUNT; s++) {
+      uint64_t total = GMT_Atomic_Load64(&td->profile_ticks[s]);
+      frame[s] += total - td->profile_folded[s];
+      td->profile_folded[s] = total;
+    }
+  }
+  for (int s = 0; s < GMT_ProfileScope_COUNT; s++) {
+    GMT__HistogramAdd(&p->histograms[s], (uint64_t)GMT__TicksToNs(frame[s]));
+  }
+
+  if (p->trace) {
+    // The calls spread over the frame's threads, so they are a counter rather than spans.
+    GMT__TraceEventBegin("GameTest overhead (us)", "C", p->frame_begin);
+    fprintf(p->trace, ",\"args\":{\"track\":%.3f,\"pin\":%.3f,\"log\":%.3f}}",
+            GMT__TicksToUs(frame[GMT_ProfileScope_TRACK]),
+            GMT__TicksToUs(frame[GMT_ProfileScope_PIN]),
+            GMT__TicksToUs(frame[GMT_ProfileScope_LOG]));
+  }
+  p->frame_begin = GMT_Platform_GetTicks();
+}
+
+void GMT_Profile_SignalWaitBegin(void) {
+  GMT_Profile* p = &g_gmt.profile;
+  if (!p->trace) return;
+  p->signal_wait_begin = GMT_Platform_GetTicks();
+  p->signal_wait_tid = GMT_Platform_GetThreadId();
+}
+
+void GMT_Profile_SignalWaitEnd(int32_t signal_id, uint64_t frames) {
+  GMT_Profile* p = &g_gmt.profile;
+  if (!p->trace || !p->signal_wait_begin) return;
+  char args[64];
+  snprintf(args, sizeof(args), "\"signal\":%d,\"frames\":%" PRIu64, (int)signal_id, frames);
+  GMT__TraceSpan("GMT_SignalWait", p->signal_wait_begin, GMT_Platform_GetTicks(), p->signal_wait_tid, args);
+  p->signal_wait_begin = 0;
+}
+
+// ===== Report =====
+
+void GMT_Profile_Report(void) {
+  const GMT_Profile* p = &g_gmt.profile;
+  uint64_t frames = p->histograms[GMT_ProfileScope_UPDATE].frames;
+  if (frames == 0) return;
+
+  GMT_LogInfo("  Overhead       : us per frame over %" PRIu64 " frames, p50 / p99 / max", frames);
+  for (int s = 0; s < GMT_ProfileScope_COUNT; s++) {
+    const GMT_ProfileHistogram* h = &p->histograms[s];
+    GMT_LogInfo("    %-8s : %10.2f / %10.2f / %10.2f",
+                k_gmt_profile_scope_names[s],
+                (double)GMT__HistogramQuantile(h, 0.50) / 1000.0,
+                (double)GMT__HistogramQuantile(h, 0.99) / 1000.0,
+                (double)h->max_ns / 1000.0);
+  }
+}
@@ -0,0 +1,120 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Framework overhead profiler, enabled by GMT_Setup.profile_overhead or
+// GMT_Setup.trace_path.  Scopes around the framework's own work add their
+// ticks to a per-scope total; every GMT_Update folds what each scope used since
+// the previous one into a histogram, and the final report prints the p50, p99
+// and max of those per-frame costs.  Scopes nest: UPDATE includes CAPTURE and
+// INJECT, and any log call made inside another scope.
+//
+// With a trace path, GMT_Update also writes Chrome trace_event spans for itself,
+// the input capture, each injection batch and each sync-signal wait, plus one
+// counter event per frame with the Track/Pin/Log cost.  Timestamps are the raw
+// platform counter in microseconds and pid/tid are the OS ids, so the file
+// lines up with engine profiler captures taken on the same clock.
+
+typedef enum GMT_ProfileScope {
+  GMT_ProfileScope_UPDATE,   // GMT_Update as a whole.
+  GMT_ProfileScope_CAPTURE,  // RECORD: capturing and encoding the frame's input.
+  GMT_ProfileScope_INJECT,   // REPLAY: collecting and injecting the due input records.
+  GMT_ProfileScope_TRACK,    // GMT_Track* calls, summed over all threads.
+  GMT_ProfileScope_PIN,      // GMT_Pin* calls, summed over all threads.
+  GMT_ProfileScope_LOG,      // GMT_Log calls (formatting or queueing), summed over all threads.
+  GMT_ProfileScope_COUNT
+} GMT_ProfileScope;
+
+// Log-linear buckets of nanoseconds: exact below 16 ns, then 16 per power of two
+// (about 6% resolution).
+#define GMT_PROFILE_BUCKETS 1024
+
+typedef struct GMT_ProfileHistogram {
+  uint32_t counts[GMT_PROFILE_BUCKETS];
+  uint64_t frames;  // Frames folded in.
+  uint64_t max_ns;  // Exact largest per-frame cost.
+} GMT_ProfileHistogram;
+
+typedef struct GMT_Profile {
+  bool enabled;
+  uint64_t ticks_per_second;
+  // Ticks used by scopes ended without per-thread data; monotonic, added atomically.
+  volatile uint64_t ticks[GMT_ProfileScope_COUNT];
+  // Part of ticks[] already folded into the histograms.  Mutex held.
+  uint64_t folded[GMT_ProfileScope_COUNT];
+  GMT_ProfileHistogram histograms[GMT_ProfileScope_COUNT];
+  // Counter value when the current frame's GMT_Update began.
+  uint64_t frame_begin;
+
+  // ----- Chrome trace -----
+  FILE* trace;               // NULL unless GMT_Setup.trace_path is set.
+  bool trace_has_events;     // A comma precedes the next event.
+  uint32_t pid;
+  uint64_t signal_wait_begin;  // Counter value when replay blocked on a signal.
+  uint32_t signal_wait_tid;
+} GMT_Profile;
+
+// Enables the profiler when the setup asks for it and opens the trace file.
+// Called by GMT_Init once the platform layer is up.
+void GMT_Profile_Init(void);
+
+// Folds the last partial frame and closes the trace.  Called by GMT_Quit.
+void GMT_Profile_Quit(void);
+
+// Pushes buffered trace events to disk; GMT_Fail calls it before the fail
+// callback, which may not return.
+void GMT_Profile_FlushTrace(void);
+
+// Returns the counter value for a scope's start, or 0 when profiling is off.
+uint64_t GMT_Profile_Begin(void);
+
+// Adds the ticks since `begin` to `scope`'s shared atomic total.  No-op when
+// begin is 0.
+void GMT_Profile_End(GMT_ProfileScope scope, uint64_t begin);
+
+// As GMT_Profile_End, but kept in the calling thread's GMT_ThreadData so the
+// Track/Pin paths share no cache line.  Falls back to the shared total.
+void GMT_Profile_EndThread(GMT_ProfileScope scope, uint64_t begin);
+
+// Frame boundary: folds every scope's cost since the previous call into the
+// histograms and writes the frame's counter event.  Mutex held.
+void GMT_Profile_EndFrame(void);
+
+// Ends a scope of the thread holding the mutex and, with a trace, writes it as a
+// complete ("X") span named `name` (NULL writes none).  `args` is the body of a
+// JSON object (without braces) or NULL.
+void GMT_Profile_EndSpan(GMT_ProfileScope scope, uint64_t begin, const char* name, const char* args);
+
+// Replay blocked on / released from a sync signal.  The release writes the wait
+// as a span on the thread that blocked.  Mutex held.
+void GMT_Profile_SignalWaitBegin(void);
+void GMT_Profile_SignalWaitEnd(int32_t signal_id, uint64_t frames);
+
+// Logs the per-frame p50 / p99 / max of every scope (part of GMT_PrintReport).
+void GMT_Profile_Report(void);
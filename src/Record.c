@@ -24,11 +24,150 @@ SOFTWARE.
 #include "Internal.h"
 #include "Record.h"
 #include "Platform.h"
+#include "Compress.h"
+#include "Hash.h"
+#include <stddef.h>
 #include <string.h>
 #include <stdlib.h>
 
 // ===== RECORD mode =====
 
+// Compresses and writes the pending TAG_BLOCK, if any.
+static void GMT__FlushBlock(void) {
+  if (!g_gmt.record_block || g_gmt.record_block_used == 0) return;
+
+  size_t raw_size = g_gmt.record_block_used;
+  size_t packed = GMT_Compress(g_gmt.record_block, raw_size, g_gmt.record_block_out,
+                               GMT_COMPRESS_BOUND(GMT_RECORD_BLOCK_SIZE));
+  bool compressed = packed > 0 && packed < raw_size;
+
+  GMT_RawBlockHeader hdr;
+  hdr.raw_size = (uint32_t)raw_size;
+  hdr.stored_size = (uint32_t)(compressed ? packed : raw_size);
+
+  uint8_t tag = GMT_RECORD_TAG_BLOCK;
+  fwrite(&tag, 1, 1, g_gmt.record_file);
+  fwrite(&hdr, sizeof(hdr), 1, g_gmt.record_file);
+  fwrite(compressed ? g_gmt.record_block_out : g_gmt.record_block, 1, hdr.stored_size, g_gmt.record_file);
+  g_gmt.record_block_used = 0;
+}
+
+// Passes record bytes on to the file, through the pending TAG_BLOCK when
+// compression is enabled.  Runs on the writer thread when it is active, so it
+// must not take the framework mutex.
+static void GMT__SinkBytes(const uint8_t* data, size_t size) {
+  if (!g_gmt.record_block) {
+    fwrite(data, 1, size, g_gmt.record_file);
+    return;
+  }
+  while (size > 0) {
+    size_t room = GMT_RECORD_BLOCK_SIZE - g_gmt.record_block_used;
+    size_t chunk = (size < room) ? size : room;
+    memcpy(g_gmt.record_block + g_gmt.record_block_used, data, chunk);
+    g_gmt.record_block_used += chunk;
+    data += chunk;
+    size -= chunk;
+    if (g_gmt.record_block_used == GMT_RECORD_BLOCK_SIZE) GMT__FlushBlock();
+  }
+}
+
+static void GMT__WriterSink(void* user, const uint8_t* data, size_t size) {
+  (void)user;
+  GMT__SinkBytes(data, size);
+}
+
+static void GMT__WriterFlush(void* user) {
+  (void)user;
+  GMT__FlushBlock();
+}
+
+// Makes everything emitted so far reach the FILE (including a partial block).
+static void GMT__FlushRecords(void) {
+  if (g_gmt.record_writer.worker.thread) GMT_Writer_Flush(&g_gmt.record_writer);
+  else
+    GMT__FlushBlock();
+}
+
+// Appends one record (tag + head + body).  Every record goes through here: with
+// the writer thread running this is only a copy into its ring.
+static void GMT__EmitRecord(uint8_t tag, const void* head, size_t head_size, const void* body, size_t body_size) {
+  uint8_t prefix[1 + sizeof(GMT_RawInputRecord)];
+  prefix[0] = tag;
+  memcpy(prefix + 1, head, head_size);
+  g_gmt.record_raw_bytes += 1 + head_size + body_size;
+
+  if (g_gmt.record_writer.worker.thread) {
+    GMT_Writer_Push(&g_gmt.record_writer, prefix, 1 + head_size, body, body_size);
+    return;
+  }
+  GMT__SinkBytes(prefix, 1 + head_size);
+  if (body_size > 0) GMT__SinkBytes((const uint8_t*)body, body_size);
+}
+
+static void GMT__FreeBlockBuffers(void) {
+  if (g_gmt.record_block) GMT_Free(g_gmt.record_block);
+  if (g_gmt.record_block_out) GMT_Free(g_gmt.record_block_out);
+  g_gmt.record_block = NULL;
+  g_gmt.record_block_out = NULL;
+  g_gmt.record_block_used = 0;
+}
+
+static void GMT__FreeKeyframeBuffers(void) {
+  if (g_gmt.record_keyframe_body) GMT_Free(g_gmt.record_keyframe_body);
+  if (g_gmt.record_keyframes) GMT_Free(g_gmt.record_keyframes);
+  g_gmt.record_keyframe_body = NULL;
+  g_gmt.record_keyframes = NULL;
+  g_gmt.record_keyframe_capacity = 0;
+}
+
+// Appends an input record holding *input, unless it equals the previous one.
+// Returns false if nothing was written.
+static bool GMT__EmitInput(const GMT_InputState* input, double timestamp) {
+  uint8_t delta[GMT_INPUT_DELTA_MAX_SIZE];
+  size_t delta_size = GMT_InputState_EncodeDelta(&g_gmt.record_prev_input, input, delta);
+  if (delta_size == 0) return false;
+  g_gmt.record_prev_input = *input;
+  g_gmt.record_last_input_time = timestamp;
+
+  if (delta_size + sizeof(GMT_RawInputDeltaHeader) < sizeof(GMT_RawInputRecord)) {
+    GMT_RawInputDeltaHeader hdr;
+    hdr.size = (uint16_t)delta_size;
+    hdr.timestamp = timestamp;
+    GMT__EmitRecord(GMT_RECORD_TAG_INPUT_DELTA, &hdr, sizeof(hdr), delta, delta_size);
+    g_gmt.record_input_delta_count++;
+  } else {
+    GMT_RawInputRecord rec;
+    rec.timestamp = timestamp;
+    rec.input = *input;
+    GMT__EmitRecord(GMT_RECORD_TAG_INPUT, &rec, sizeof(rec), NULL, 0);
+  }
+  g_gmt.record_input_count++;
+  return true;
+}
+
+// Writes an input record for every event queued since the last call, each
+// stamped with the time it was observed.  Wheel deltas and key repeats are left
+// to the frame's own capture.
+static void GMT__WriteInputEvents(void) {
+  if (!g_gmt.record_file) return;
+  GMT_InputEvent ev;
+  while (GMT_InputSampler_Pop(&g_gmt.input_sampler, &ev)) {
+    double timestamp = ev.time - g_gmt.record_start_time;
+    if (timestamp < g_gmt.record_last_input_time) {
+      // Observed before the last capture, which already holds newer state.  A
+      // key transition is kept anyway so a tap inside the gap is not lost.
+      if (ev.kind != GMT_InputEvent_KEY) continue;
+      timestamp = g_gmt.record_last_input_time;
+    }
+    GMT_InputState input = g_gmt.record_prev_input;
+    memset(input.key_repeats, 0, sizeof(input.key_repeats));
+    input.mouse_wheel_x = 0;
+    input.mouse_wheel_y = 0;
+    GMT_InputEvent_Apply(&ev, &input);
+    if (GMT__EmitInput(&input, timestamp)) g_gmt.record_input_event_count++;
+  }
+}
+
 bool GMT_Record_OpenForWrite(void) {
   // Ensure parent directory exists.
   const char* path = g_gmt.setup.test_path;
@@ -66,19 +205,83 @@ bool GMT_Record_OpenForWrite(void) {
     return false;
   }
 
+  if (g_gmt.setup.compress_test_file) {
+    g_gmt.record_block = (uint8_t*)GMT_Alloc(GMT_RECORD_BLOCK_SIZE);
+    g_gmt.record_block_out = (uint8_t*)GMT_Alloc(GMT_COMPRESS_BOUND(GMT_RECORD_BLOCK_SIZE));
+    if (!g_gmt.record_block || !g_gmt.record_block_out) {
+      GMT__FreeBlockBuffers();
+      fclose(fh);
+      GMT_LogError("GMT_Record: allocation failed for compression buffers.");
+      return false;
+    }
+  }
+
+  if (g_gmt.setup.keyframe_interval > 0) {
+    g_gmt.record_snapshot_capacity = g_gmt.setup.snapshot_capacity ? g_gmt.setup.snapshot_capacity : GMT_RECORD_DEFAULT_SNAPSHOT_CAPACITY;
+    g_gmt.record_keyframe_body = (uint8_t*)GMT_Alloc(sizeof(GMT_InputState) + g_gmt.record_snapshot_capacity);
+    if (!g_gmt.record_keyframe_body) {
+      GMT__FreeBlockBuffers();
+      fclose(fh);
+      GMT_LogError("GMT_Record: allocation failed for the keyframe buffer.");
+      return false;
+    }
+  }
+
   g_gmt.record_file = fh;
+
+  // Move file output off the calling threads.  If the thread cannot be started
+  // records are written synchronously instead.
+  size_t buffer_size = g_gmt.setup.record_buffer_size ? g_gmt.setup.record_buffer_size : GMT_RECORD_DEFAULT_BUFFER_SIZE;
+  if (!GMT_Writer_Start(&g_gmt.record_writer, buffer_size, GMT__WriterSink, GMT__WriterFlush, NULL)) {
+    GMT_LogWarning("GMT_Record: failed to start the writer thread; writing records synchronously.");
+  }
+
   g_gmt.record_input_count = 0;
+  g_gmt.record_input_delta_count = 0;
+  g_gmt.record_input_event_count = 0;
+  g_gmt.record_last_input_time = 0.0;
   g_gmt.record_signal_count = 0;
   g_gmt.record_pin_count = 0;
   g_gmt.record_track_count = 0;
+  g_gmt.record_raw_bytes = 0;
+  g_gmt.record_keyframe_count = 0;
+  // The first TAG_INPUT_DELTA of a file is relative to an all-zero state.
+  GMT_InputState_Clear(&g_gmt.record_prev_input);
   return true;
 }
 
 void GMT_Record_CloseWrite(void) {
   if (!g_gmt.record_file) return;
 
+  // Records still staged by game threads, and events still queued, go in before TAG_END.
+  GMT_Record_MergeThreadRecords();
+  GMT__WriteInputEvents();
+
+  // Drains the ring and the pending block, then joins the thread.
+  GMT_Writer_Stop(&g_gmt.record_writer);
+  GMT__FlushBlock();
+  GMT__FreeBlockBuffers();
+
   uint8_t end_tag = GMT_RECORD_TAG_END;
   fwrite(&end_tag, 1, 1, g_gmt.record_file);
+
+  // The summary and the keyframe index go after TAG_END, where older readers
+  // never look.
+  GMT_RawRecordSummary summary;
+  summary.frame_count = (uint32_t)GMT_Atomic_Load64(&g_gmt.frame_index);
+  summary.duration = GMT_Platform_GetTime() - g_gmt.record_start_time;
+  summary.magic = GMT_RECORD_SUMMARY_MAGIC;
+  fwrite(&summary, sizeof(summary), 1, g_gmt.record_file);
+
+  if (g_gmt.record_keyframe_count > 0) {
+    GMT_RawKeyframeIndexFooter footer;
+    footer.count = (uint32_t)g_gmt.record_keyframe_count;
+    footer.magic = GMT_RECORD_INDEX_MAGIC;
+    fwrite(g_gmt.record_keyframes, sizeof(GMT_RawKeyframeIndexEntry), g_gmt.record_keyframe_count, g_gmt.record_file);
+    fwrite(&footer, sizeof(footer), 1, g_gmt.record_file);
+  }
+  GMT__FreeKeyframeBuffers();
+
   fclose(g_gmt.record_file);
   g_gmt.record_file = NULL;
 }
@@ -86,31 +289,76 @@ void GMT_Record_CloseWrite(void) {
 static void GMT__WriteInputRecord(void) {
   if (!g_gmt.record_file) return;
 
-  GMT_RawInputRecord rec;
-  rec.timestamp = GMT_Platform_GetTime() - g_gmt.record_start_time;
-  GMT_Platform_CaptureInput(&rec.input);
+  // Events observed since the last frame go first, in the order they happened.
+  GMT__WriteInputEvents();
 
-  // Skip writing if the input state is identical to the previous frame.
-  if (GMT_InputState_Compare(&rec.input, &g_gmt.record_prev_input)) return;
-  g_gmt.record_prev_input = rec.input;
+  GMT_InputState input;
+  memset(&input, 0, sizeof(input));
+  double timestamp = GMT_Platform_GetTime() - g_gmt.record_start_time;
+  if (g_gmt.setup.input_capture == GMT_InputCapture_VIRTUAL) {
+    // Wheel deltas and repeats belong to the frame they were set for.
+    input = g_gmt.virtual_input;
+    memset(g_gmt.virtual_input.key_repeats, 0, sizeof(g_gmt.virtual_input.key_repeats));
+    g_gmt.virtual_input.mouse_wheel_x = 0;
+    g_gmt.virtual_input.mouse_wheel_y = 0;
+  } else {
+    GMT_Platform_CaptureInput(&input);
+  }
 
-  uint8_t tag = GMT_RECORD_TAG_INPUT;
-  fwrite(&tag, 1, 1, g_gmt.record_file);
-  fwrite(&rec, sizeof(rec), 1, g_gmt.record_file);
-  g_gmt.record_input_count++;
+  // Skipped if the input state is identical to the previous record.  A skipped
+  // capture still supersedes the events observed before it.
+  if (!GMT__EmitInput(&input, timestamp)) g_gmt.record_last_input_time = timestamp;
 }
 
 void GMT_Record_WriteInput(void) {
+  uint64_t profile_begin = GMT_Profile_Begin();
   GMT__WriteInputRecord();
+  GMT_Profile_EndSpan(GMT_ProfileScope_CAPTURE, profile_begin, "GMT_Capture", NULL);
 }
 
-void GMT_Record_WriteInputFromKeyEvent(void) {
+void GMT_Record_OnKeyEvent(int key, bool down) {
   if (!g_gmt.initialized || g_gmt.mode != GMT_Mode_RECORD || !g_gmt.record_file) return;
+  if (g_gmt.setup.input_capture == GMT_InputCapture_VIRTUAL) return;  // The OS input is not what is recorded.
+  if (g_gmt.input_sampler.slots) {
+    if (key <= GMT_Key_UNKNOWN || key >= GMT_KEY_COUNT) return;
+    GMT_InputEvent ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.time = GMT_Platform_GetTime();
+    ev.kind = GMT_InputEvent_KEY;
+    ev.index = (uint8_t)key;
+    ev.value.key = down ? 0x80u : 0;
+    GMT_InputSampler_Push(&g_gmt.input_sampler, &ev);
+    return;
+  }
+  // No queue: capture everything now.
   GMT_Platform_MutexLock();
   GMT__WriteInputRecord();
   GMT_Platform_MutexUnlock();
 }
 
+void GMT_Record_StartSampling(void) {
+  bool queue = false;
+  uint32_t rate = g_gmt.setup.input_sample_rate;
+  if (g_gmt.mode == GMT_Mode_RECORD) {
+    // The queue also carries the keyboard hook's transitions, so it runs at any rate.
+    if (g_gmt.setup.input_capture == GMT_InputCapture_VIRTUAL) return;
+    queue = true;
+  } else if (g_gmt.mode == GMT_Mode_REPLAY) {
+    // Injecting between frames only means something under the wall clock, and
+    // only SendInput works from another thread: window messages need the game
+    // thread's focus window, so they stay with GMT_Update.
+    if (g_gmt.setup.input_injection != GMT_InputInjection_SEND_INPUT || g_gmt.setup.replay_timing == GMT_ReplayTiming_FRAME) return;
+  }
+  if (!queue && rate == 0) return;
+  if (!GMT_InputSampler_Start(&g_gmt.input_sampler, queue, rate)) {
+    GMT_LogWarning("GMT_Record: failed to start input sampling; input is taken once per frame.");
+  }
+}
+
+void GMT_Record_StopSampling(void) {
+  GMT_InputSampler_Stop(&g_gmt.input_sampler);
+}
+
 void GMT_Record_WriteSignal(int32_t signal_id) {
   if (!g_gmt.record_file) return;
 
@@ -118,79 +366,790 @@ void GMT_Record_WriteSignal(int32_t signal_id) {
   rec.timestamp = GMT_Platform_GetTime() - g_gmt.record_start_time;
   rec.signal_id = signal_id;
 
-  uint8_t tag = GMT_RECORD_TAG_SIGNAL;
-  fwrite(&tag, 1, 1, g_gmt.record_file);
-  fwrite(&rec, sizeof(rec), 1, g_gmt.record_file);
+  GMT__EmitRecord(GMT_RECORD_TAG_SIGNAL, &rec, sizeof(rec), NULL, 0);
   g_gmt.record_signal_count++;
 }
 
+// Appends a TAG_KEYFRAME for the frame just started and adds it to the index.
+static void GMT__WriteKeyframe(uint32_t frame) {
+  if (g_gmt.record_keyframe_count == g_gmt.record_keyframe_capacity) {
+    size_t capacity = g_gmt.record_keyframe_capacity ? g_gmt.record_keyframe_capacity * 2 : 64;
+    GMT_RawKeyframeIndexEntry* grown = (GMT_RawKeyframeIndexEntry*)GMT_Realloc(g_gmt.record_keyframes, capacity * sizeof(GMT_RawKeyframeIndexEntry));
+    if (!grown) {
+      GMT_LogWarning("GMT_Record: allocation failed for the keyframe index; keyframe at frame %u skipped.", (unsigned)frame);
+      return;
+    }
+    g_gmt.record_keyframes = grown;
+    g_gmt.record_keyframe_capacity = capacity;
+  }
+
+  uint8_t* body = g_gmt.record_keyframe_body;
+  size_t state_size = 0;
+  if (g_gmt.setup.snapshot_callback && *g_gmt.setup.snapshot_callback) {
+    GMT_SnapshotCallback cb = *g_gmt.setup.snapshot_callback;
+    state_size = cb(GMT_Mode_RECORD, body + sizeof(GMT_InputState), g_gmt.record_snapshot_capacity);
+    if (state_size > g_gmt.record_snapshot_capacity) {
+      GMT_LogError("GMT_Record: snapshot callback returned %zu bytes, more than the %zu-byte capacity; game state not stored.",
+                   state_size, g_gmt.record_snapshot_capacity);
+      state_size = 0;
+    }
+  }
+  // The last state written is what replay has decoded at this point.
+  memcpy(body, &g_gmt.record_prev_input, sizeof(GMT_InputState));
+
+  GMT_RawKeyframeHeader hdr;
+  hdr.frame = frame;
+  hdr.time = g_gmt.frame_time;
+  hdr.input_count = (uint32_t)g_gmt.record_input_count;
+  hdr.signal_count = (uint32_t)g_gmt.record_signal_count;
+  hdr.state_size = (uint32_t)state_size;
+
+  GMT_RawKeyframeIndexEntry* entry = &g_gmt.record_keyframes[g_gmt.record_keyframe_count++];
+  entry->frame = frame;
+  entry->offset = sizeof(GMT_FileHeader) + (uint64_t)g_gmt.record_raw_bytes;
+  GMT__EmitRecord(GMT_RECORD_TAG_KEYFRAME, &hdr, sizeof(hdr), body, sizeof(GMT_InputState) + state_size);
+}
+
+void GMT_Record_WriteFrame(void) {
+  if (!g_gmt.record_file) return;
+
+  GMT_RawFrameRecord rec;
+  rec.frame = (uint32_t)g_gmt.frame_index;
+  rec.time = g_gmt.frame_time;
+
+  GMT__EmitRecord(GMT_RECORD_TAG_FRAME, &rec, sizeof(rec), NULL, 0);
+
+  if (g_gmt.record_keyframe_body && rec.frame % g_gmt.setup.keyframe_interval == 0) GMT__WriteKeyframe(rec.frame);
+}
+
+// ----- Per-thread staging -----
+
+// Copies n bytes into a thread ring at monotonic position pos, wrapping at the end.
+static void GMT__RingWrite(uint8_t* ring, uint64_t pos, const void* src, size_t n) {
+  size_t offset = (size_t)(pos & (GMT_THREAD_RING_SIZE - 1));
+  size_t first = GMT_THREAD_RING_SIZE - offset;
+  if (first > n) first = n;
+  memcpy(ring + offset, src, first);
+  memcpy(ring, (const uint8_t*)src + first, n - first);
+}
+
+static void GMT__RingRead(const uint8_t* ring, uint64_t pos, void* dst, size_t n) {
+  size_t offset = (size_t)(pos & (GMT_THREAD_RING_SIZE - 1));
+  size_t first = GMT_THREAD_RING_SIZE - offset;
+  if (first > n) first = n;
+  memcpy(dst, ring + offset, first);
+  memcpy((uint8_t*)dst + first, ring, n - first);
+}
+
+static void GMT__CountDataRecord(uint8_t tag) {
+  if (tag == GMT_RECORD_TAG_PIN) g_gmt.record_pin_count++;
+  else if (tag == GMT_RECORD_TAG_TRACK)
+    g_gmt.record_track_count++;
+}
+
+// Moves everything one thread has staged into the record stream.  Mutex held.
+// Payloads are emitted straight from the ring; only one that wraps around its
+// end is first gathered into frame-arena scratch memory.
+static void GMT__MergeThreadRecords(GMT_ThreadData* td) {
+  uint64_t tail = GMT_Atomic_Load64(&td->ring_tail);
+  uint64_t head = GMT_Atomic_Load64(&td->ring_head);
+  while (tail != head) {
+    uint8_t tag;
+    GMT_RawDataRecordHeader hdr;
+    GMT__RingRead(td->ring, tail, &tag, 1);
+    GMT__RingRead(td->ring, tail + 1, &hdr, sizeof(hdr));
+    uint64_t pos = tail + 1 + sizeof(hdr);
+    size_t offset = (size_t)(pos & (GMT_THREAD_RING_SIZE - 1));
+    tail = pos + hdr.size;
+    if (GMT_THREAD_RING_SIZE - offset >= hdr.size) {
+      GMT__EmitRecord(tag, &hdr, sizeof(hdr), td->ring + offset, hdr.size);
+    } else {
+      uint8_t* payload = (uint8_t*)GMT_FrameAlloc(hdr.size);
+      if (!payload) {
+        GMT_LogError("GMT_Record: allocation failed while merging thread records; record skipped.");
+        continue;
+      }
+      GMT__RingRead(td->ring, pos, payload, hdr.size);
+      GMT__EmitRecord(tag, &hdr, sizeof(hdr), payload, hdr.size);
+      GMT_FrameFree(payload);
+    }
+    GMT__CountDataRecord(tag);
+  }
+  GMT_Atomic_Store64(&td->ring_tail, tail);
+}
+
+void GMT_Record_MergeThreadRecords(void) {
+  if (!g_gmt.record_file) return;
+  for (GMT_ThreadData* td = g_gmt.threads; td; td = td->next) GMT__MergeThreadRecords(td);
+}
+
 void GMT_Record_WriteDataRecord(uint8_t tag, unsigned int key, unsigned int index, const void* data, size_t size) {
   if (!g_gmt.record_file) return;
-  if (size > GMT_MAX_DATA_RECORD_PAYLOAD) {
-    GMT_LogError("GMT_Record_WriteDataRecord: payload %zu exceeds maximum %d; record skipped.", size, GMT_MAX_DATA_RECORD_PAYLOAD);
+  if (size > g_gmt.max_payload_size) {
+    GMT_LogError("GMT_Record_WriteDataRecord: payload %zu exceeds maximum %zu; record skipped.", size, g_gmt.max_payload_size);
     return;
   }
 
   GMT_RawDataRecordHeader hdr;
+  hdr.frame = (uint32_t)GMT_Atomic_Load64(&g_gmt.frame_index);
   hdr.key = (uint32_t)key;
   hdr.index = (uint32_t)index;
   hdr.size = (uint32_t)size;
 
-  fwrite(&tag, 1, 1, g_gmt.record_file);
-  fwrite(&hdr, sizeof(hdr), 1, g_gmt.record_file);
-  fwrite(data, 1, size, g_gmt.record_file);
+  size_t need = 1 + sizeof(hdr) + size;
+  GMT_ThreadData* td = GMT_ThreadData_Get();
+  if (!td || need > GMT_THREAD_RING_SIZE) {
+    // No ring, or too large to stage: emit it directly, after what this thread staged before it.
+    GMT_Platform_MutexLock();
+    if (td) GMT_Record_MergeThreadRecords();
+    GMT__EmitRecord(tag, &hdr, sizeof(hdr), data, size);
+    GMT__CountDataRecord(tag);
+    GMT_Platform_MutexUnlock();
+    return;
+  }
 
-  if (tag == GMT_RECORD_TAG_PIN) g_gmt.record_pin_count++;
-  else if (tag == GMT_RECORD_TAG_TRACK)
-    g_gmt.record_track_count++;
+  uint64_t head = td->ring_head;
+  if (head + need - GMT_Atomic_Load64(&td->ring_tail) > GMT_THREAD_RING_SIZE) {
+    // Ring full before the frame boundary: merge now instead of waiting for GMT_Update.
+    GMT_Platform_MutexLock();
+    GMT_Record_MergeThreadRecords();
+    GMT_Platform_MutexUnlock();
+  }
+  GMT__RingWrite(td->ring, head, &tag, 1);
+  GMT__RingWrite(td->ring, head + 1, &hdr, sizeof(hdr));
+  GMT__RingWrite(td->ring, head + 1 + sizeof(hdr), data, size);
+  GMT_Atomic_Store64(&td->ring_head, head + need);
+}
+
+// ===== Pin/Track lookup index =====
+
+// Mixes (frame, key, index) into a 32-bit slot hash (murmur3 finalizer).
+static uint32_t GMT__HashDataKey(uint32_t frame, uint32_t key, uint32_t index) {
+  uint32_t h = key ^ (index * 0x9E3779B1u) ^ (frame * 0x85EBCA77u);
+  h ^= h >> 16;
+  h *= 0x85EBCA6Bu;
+  h ^= h >> 13;
+  h *= 0xC2B2AE35u;
+  h ^= h >> 16;
+  return h;
+}
+
+static bool GMT__DataRecordMatches(const GMT_DecodedDataRecord* rec, uint32_t frame, uint32_t key, uint32_t index) {
+  return rec->frame == frame && rec->key == key && rec->index == index;
 }
 
-GMT_DecodedDataRecord* GMT_Record_FindDecoded(GMT_DecodedDataRecord* arr, size_t count, unsigned int key, unsigned int index) {
+// Builds the (frame, key, index) hash index for a decoded pin/track table.
+// A streaming window rebuilds it on every refill and keeps its slots while they
+// are large enough.  Returns false only if the slot allocation fails.
+static bool GMT__BuildDataIndex(GMT_DecodedDataTable* table) {
+  GMT_DecodedDataIndex* out = &table->index;
+  const GMT_DecodedDataRecord* arr = table->records;
+  size_t count = table->count;
+  if (count == 0 && !out->slots) return true;
+  if (count >= (size_t)UINT32_MAX) return false;
+
+  size_t capacity = 16;
+  while (capacity < count * 2) capacity *= 2;
+
+  if (capacity > out->capacity) {
+    uint32_t* slots = (uint32_t*)GMT_Alloc(capacity * sizeof(uint32_t));
+    if (!slots) return false;
+    if (out->slots) GMT_Free(out->slots);
+    out->slots = slots;
+    out->capacity = capacity;
+  }
+  uint32_t* slots = out->slots;
+  memset(slots, 0, out->capacity * sizeof(uint32_t));
+
+  size_t mask = out->capacity - 1;
   for (size_t i = 0; i < count; i++) {
-    if (arr[i].key == (uint32_t)key && arr[i].index == (uint32_t)index) return &arr[i];
+    size_t s = GMT__HashDataKey(arr[i].frame, arr[i].key, arr[i].index) & mask;
+    for (;;) {
+      if (slots[s] == 0) {
+        slots[s] = (uint32_t)(i + 1);
+        break;
+      }
+      if (GMT__DataRecordMatches(&arr[slots[s] - 1], arr[i].frame, arr[i].key, arr[i].index)) break;  // Keep the first occurrence.
+      s = (s + 1) & mask;
+    }
+  }
+  return true;
+}
+
+// Stable-sorts a table by frame, keeping call order within a frame.  Files are at
+// most a frame or two out of order (see GMT_Record_MergeThreadRecords), so an
+// insertion sort stays close to linear.
+static void GMT__SortDataTableByFrame(GMT_DecodedDataTable* table) {
+  GMT_DecodedDataRecord* arr = table->records;
+  for (size_t i = 1; i < table->count; i++) {
+    if (arr[i].frame >= arr[i - 1].frame) continue;
+    GMT_DecodedDataRecord rec = arr[i];
+    size_t j = i;
+    while (j > 0 && arr[j - 1].frame > rec.frame) {
+      arr[j] = arr[j - 1];
+      j--;
+    }
+    arr[j] = rec;
   }
-  return NULL;
+}
+
+static void GMT__FreeDataTable(GMT_DecodedDataTable* table) {
+  if (table->records) GMT_Free(table->records);
+  if (table->index.slots) GMT_Free(table->index.slots);
+  while (table->chunks) {
+    GMT_PayloadChunk* next = table->chunks->next;
+    GMT_Free(table->chunks);
+    table->chunks = next;
+  }
+  if (table->spare_chunk) GMT_Free(table->spare_chunk);
+  memset(table, 0, sizeof(*table));
+}
+
+// ===== Streaming pin/track window =====
+
+// Copies a payload into the window's chunks.  Returns NULL if allocation fails.
+static const uint8_t* GMT__WindowStore(GMT_DecodedDataTable* table, const uint8_t* data, size_t size, uint32_t frame) {
+  GMT_PayloadChunk* c = table->chunks_tail;
+  if (!c || c->capacity - c->used < size) {
+    // A payload larger than a chunk gets a chunk of its own size.
+    size_t capacity = (size > GMT_PAYLOAD_CHUNK_SIZE) ? size : GMT_PAYLOAD_CHUNK_SIZE;
+    c = table->spare_chunk;
+    if (c && c->capacity < capacity) {
+      GMT_Free(c);
+      c = NULL;
+    }
+    if (!c) {
+      c = (GMT_PayloadChunk*)GMT_Alloc(sizeof(GMT_PayloadChunk) + capacity);
+      if (!c) return NULL;
+      c->capacity = capacity;
+    }
+    table->spare_chunk = NULL;
+    c->next = NULL;
+    c->used = 0;
+    c->last_frame = frame;
+    if (table->chunks_tail) table->chunks_tail->next = c;
+    else
+      table->chunks = c;
+    table->chunks_tail = c;
+  }
+  uint8_t* p = c->data + c->used;
+  memcpy(p, data, size);
+  c->used += size;
+  if (frame > c->last_frame) c->last_frame = frame;
+  return p;
+}
+
+static bool GMT__WindowAppend(GMT_DecodedDataTable* table, const GMT_RawDataRecordHeader* hdr, const uint8_t* payload) {
+  if (table->count == table->capacity) {
+    size_t capacity = table->capacity ? table->capacity * 2 : 256;
+    GMT_DecodedDataRecord* grown = (GMT_DecodedDataRecord*)GMT_Realloc(table->records, capacity * sizeof(GMT_DecodedDataRecord));
+    if (!grown) return false;
+    table->records = grown;
+    table->capacity = capacity;
+  }
+  const uint8_t* data = GMT__WindowStore(table, payload, hdr->size, hdr->frame);
+  if (!data) return false;
+  GMT_DecodedDataRecord* dr = &table->records[table->count++];
+  dr->frame = hdr->frame;
+  dr->key = hdr->key;
+  dr->index = hdr->index;
+  dr->size = hdr->size;
+  dr->data = data;
+  return true;
+}
+
+// Drops the records of frames before `frame` (a prefix: the window is sorted)
+// and the chunks that held only their payloads.
+static void GMT__WindowRetire(GMT_DecodedDataTable* table, uint32_t frame) {
+  size_t n = 0;
+  while (n < table->count && table->records[n].frame < frame) n++;
+  if (n > 0) {
+    memmove(table->records, table->records + n, (table->count - n) * sizeof(GMT_DecodedDataRecord));
+    table->count -= n;
+    table->base += n;
+  }
+  while (table->chunks && table->chunks->last_frame < frame) {
+    GMT_PayloadChunk* c = table->chunks;
+    if (c == table->chunks_tail) {
+      c->used = 0;  // Keep the chunk being filled.
+      break;
+    }
+    table->chunks = c->next;
+    if (table->spare_chunk) GMT_Free(table->spare_chunk);
+    table->spare_chunk = c;
+  }
+}
+
+// Recorded frame the window is centred on.  While GMT_ReplayTiming_FRAME waits
+// for a late sync signal the replay frame runs on, then jumps back to the frame
+// the wait started in; the window stays there meanwhile.
+static uint32_t GMT__WindowFrame(void) {
+  int64_t frame;
+  if (!g_gmt.replay_by_frame) {
+    frame = (int64_t)(GMT_Atomic_Load64(&g_gmt.frame_index) + GMT_Atomic_Load64(&g_gmt.replay_keyframe_shift));
+  } else if (g_gmt.waiting_for_signal) {
+    frame = (int64_t)(g_gmt.signal_wait_frame - GMT_Atomic_Load64(&g_gmt.replay_frame_offset));
+  } else {
+    frame = GMT_ReplayFrame();
+  }
+  if (frame < 0) return 0;
+  return (frame > (int64_t)UINT32_MAX) ? UINT32_MAX : (uint32_t)frame;
+}
+
+// Queues the TAG_KEYFRAME body `body` for GMT_Setup.verify_keyframes.  Keyframes
+// that hold no game state have nothing to compare and are left out.
+static void GMT__AddKeyframeCheck(const uint8_t* body) {
+  GMT_RawKeyframeHeader kh;
+  memcpy(&kh, body, sizeof(kh));
+  if (kh.state_size == 0) return;
+  if (g_gmt.replay_check_count == g_gmt.replay_check_capacity) {
+    size_t capacity = g_gmt.replay_check_capacity ? g_gmt.replay_check_capacity * 2 : 64;
+    GMT_KeyframeCheck* grown = (GMT_KeyframeCheck*)GMT_Realloc(g_gmt.replay_checks, capacity * sizeof(GMT_KeyframeCheck));
+    if (!grown) {
+      GMT_LogWarning("GMT_Record: allocation failed for keyframe checks; keyframe at frame %u not verified.", (unsigned)kh.frame);
+      return;
+    }
+    g_gmt.replay_checks = grown;
+    g_gmt.replay_check_capacity = capacity;
+  }
+  GMT_KeyframeCheck* check = &g_gmt.replay_checks[g_gmt.replay_check_count++];
+  check->frame = kh.frame;
+  check->state_size = kh.state_size;
+  check->hash = GMT_Hash64(body + sizeof(GMT_RawKeyframeHeader) + sizeof(GMT_InputState), kh.state_size, 0);
+}
+
+// Moves the streaming window to GMT__WindowFrame: drops the frames that fell
+// behind it and decodes the pins, tracks and frame times up to
+// GMT_REPLAY_WINDOW_AHEAD frames ahead.  Does nothing if it is already there.
+static void GMT__RefillWindow(void) {
+  GMT_ReplayStream* s = &g_gmt.replay_stream;
+  uint32_t frame = GMT__WindowFrame();
+  uint32_t low = (frame > 0) ? frame - 1 : 0;  // Calls made just before a GMT_Update still find their frame.
+  uint64_t high = (uint64_t)frame + GMT_REPLAY_WINDOW_AHEAD;
+  bool retire = low > s->window_frame;
+  bool read = !s->data.ended && !s->data.failed && (uint64_t)s->data_frame <= high;
+  if (!retire && !read) return;
+
+  if (retire) {
+    s->window_frame = low;
+    GMT__WindowRetire(&g_gmt.replay_pins, low);
+    GMT__WindowRetire(&g_gmt.replay_tracks, low);
+  }
+
+  // A frame's pins/tracks can trail its TAG_FRAME by a frame or two (see
+  // GMT_Record_MergeThreadRecords), so read on until a frame past `high` starts.
+  uint8_t tag;
+  const uint8_t* body;
+  size_t size;
+  while (read && GMT_RecordReader_Next(&s->data, &tag, &body, &size)) {
+    if (tag == GMT_RECORD_TAG_FRAME) {
+      GMT_RawFrameRecord fr;
+      memcpy(&fr, body, sizeof(fr));
+      if (fr.frame <= s->data_frame) {
+        GMT_LogError("GMT_Record: frame records out of order.");
+        s->failed = true;
+        return;
+      }
+      // Frames without a record (not written by this version) keep the previous time.
+      double prev = s->frame_times[s->data_frame % GMT_REPLAY_WINDOW_TIMES];
+      for (uint32_t f = s->data_frame + 1; f < fr.frame && f - s->data_frame <= GMT_REPLAY_WINDOW_TIMES; f++)
+        s->frame_times[f % GMT_REPLAY_WINDOW_TIMES] = prev;
+      s->frame_times[fr.frame % GMT_REPLAY_WINDOW_TIMES] = fr.time;
+      s->data_frame = fr.frame;
+      read = (uint64_t)s->data_frame <= high;
+    } else if (tag == GMT_RECORD_TAG_PIN || tag == GMT_RECORD_TAG_TRACK) {
+      GMT_RawDataRecordHeader drh;
+      memcpy(&drh, body, sizeof(drh));  // Streaming needs version 3, so always this layout.
+      if (drh.size > GMT_MAX_DATA_RECORD_PAYLOAD) {
+        GMT_LogError("GMT_Record: pin/track payload exceeds maximum size.");
+        s->failed = true;
+        return;
+      }
+      if (drh.frame < s->window_frame) continue;
+      bool pin = (tag == GMT_RECORD_TAG_PIN);
+      if (!GMT__WindowAppend(pin ? &g_gmt.replay_pins : &g_gmt.replay_tracks, &drh, body + sizeof(drh))) {
+        GMT_LogError("GMT_Record: allocation failed for the replay window.");
+        s->failed = true;
+        return;
+      }
+      if (pin) s->pin_count++;
+      else
+        s->track_count++;
+    } else if (tag == GMT_RECORD_TAG_KEYFRAME && g_gmt.setup.verify_keyframes) {
+      GMT__AddKeyframeCheck(body);
+    }
+  }
+  if (s->data.failed) s->failed = true;
+
+  GMT__SortDataTableByFrame(&g_gmt.replay_pins);
+  GMT__SortDataTableByFrame(&g_gmt.replay_tracks);
+  if (!GMT__BuildDataIndex(&g_gmt.replay_pins) || !GMT__BuildDataIndex(&g_gmt.replay_tracks)) {
+    GMT_LogError("GMT_Record: allocation failed for pin/track lookup index.");
+    s->failed = true;
+  }
+}
+
+void GMT_Record_RefillReplayWindow(void) {
+  if (g_gmt.replay_streaming) GMT__RefillWindow();
+}
+
+// ===== Pin/Track lookup =====
+
+// Frames a wall-clock replay may run ahead of or behind the recording and
+// still find a pin/track record (GMT__FindNearest).
+#define GMT__WALL_CLOCK_FRAME_SLACK 120
+
+// A wall-clock replay does not step the same frames as the recording, so when
+// no record of (key, index) has the current frame exactly, the one with the
+// nearest frame within GMT__WALL_CLOCK_FRAME_SLACK is taken instead.  A
+// streaming window only holds the frames around the replayed one.
+static GMT_DecodedDataRecord* GMT__FindNearest(GMT_DecodedDataTable* table, uint32_t frame, uint32_t key, uint32_t index) {
+  uint32_t low = (frame > GMT__WALL_CLOCK_FRAME_SLACK) ? frame - GMT__WALL_CLOCK_FRAME_SLACK : 0;
+  uint64_t high = (uint64_t)frame + GMT__WALL_CLOCK_FRAME_SLACK;
+
+  // Records are stored in frame order: find the first one at or after `low`.
+  size_t lo = 0, hi = table->count;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (table->records[mid].frame < low) lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  GMT_DecodedDataRecord* best = NULL;
+  uint32_t best_distance = 0;
+  for (size_t i = lo; i < table->count && table->records[i].frame <= high; ++i) {
+    GMT_DecodedDataRecord* rec = &table->records[i];
+    uint32_t distance = (rec->frame > frame) ? rec->frame - frame : frame - rec->frame;
+    if (best && rec->frame > frame && distance >= best_distance) break;  // Only farther ones follow.
+    if (rec->key != key || rec->index != index) continue;
+    if (!best || distance < best_distance) {
+      best = rec;
+      best_distance = distance;
+    }
+  }
+  return best;
+}
+
+static GMT_DecodedDataRecord* GMT__FindDecodedAt(GMT_DecodedDataTable* table, size_t* cursor, GMT_LookupStats* stats, unsigned int key, unsigned int index) {
+  // Version-0 files carry no frame numbers; every record is tagged GMT_RECORD_FRAME_ANY.
+  // Frame-driven replay skips the frames spent waiting for sync signals.
+  uint32_t frame = GMT_RECORD_FRAME_ANY;
+  if (g_gmt.replay_by_frame) frame = (uint32_t)GMT_ReplayFrame();
+  else if (g_gmt.replay_version >= 1)
+    frame = (uint32_t)(GMT_Atomic_Load64(&g_gmt.frame_index) + GMT_Atomic_Load64(&g_gmt.replay_keyframe_shift));
+  stats->count++;
+  if (table->count == 0 || table->index.capacity == 0) return NULL;
+
+  size_t pos = (*cursor > table->base) ? *cursor - table->base : 0;
+
+  // Skip records of frames that have already passed (records are stored in frame order).
+  if (frame != GMT_RECORD_FRAME_ANY) {
+    while (pos < table->count && table->records[pos].frame < frame)
+      pos++;
+  }
+  *cursor = table->base + pos;
+
+  // Fast path: calls arrive in recording order, so the next record is usually the one.
+  if (pos < table->count) {
+    GMT_DecodedDataRecord* rec = &table->records[pos];
+    if (GMT__DataRecordMatches(rec, frame, (uint32_t)key, (uint32_t)index)) {
+      (*cursor)++;
+      stats->cursor_hits++;
+      return rec;
+    }
+  }
+
+  // Out-of-order call: fall back to the hash index.
+  size_t mask = table->index.capacity - 1;
+  size_t s = GMT__HashDataKey(frame, (uint32_t)key, (uint32_t)index) & mask;
+  for (;;) {
+    stats->probes++;
+    uint32_t entry = table->index.slots[s];
+    if (entry == 0) break;
+    GMT_DecodedDataRecord* rec = &table->records[entry - 1];
+    if (GMT__DataRecordMatches(rec, frame, (uint32_t)key, (uint32_t)index)) {
+      if ((size_t)entry > pos) *cursor = table->base + (size_t)entry;
+      return rec;
+    }
+    s = (s + 1) & mask;
+  }
+
+  // Exact frames only line up under frame-driven timing.
+  if (frame == GMT_RECORD_FRAME_ANY || g_gmt.replay_by_frame) return NULL;
+  return GMT__FindNearest(table, frame, (uint32_t)key, (uint32_t)index);
+}
+
+// Copies a found record out of the table if it has the size the caller expects.
+static bool GMT__CopyDecoded(const GMT_DecodedDataRecord* rec, void* out_data, uint32_t size, uint32_t* out_size) {
+  if (!rec) return false;
+  if (rec->size == size) memcpy(out_data, rec->data, size);
+  *out_size = rec->size;
+  return true;
+}
+
+// The calling thread's cursor into a table, restarted after a reload.
+static size_t* GMT__ThreadCursor(GMT_ThreadData* td, const GMT_DecodedDataTable* table) {
+  if (td->replay_generation != g_gmt.replay_generation) {
+    td->replay_generation = g_gmt.replay_generation;
+    td->pin_cursor = 0;
+    td->track_cursor = 0;
+  }
+  return (table == &g_gmt.replay_pins) ? &td->pin_cursor : &td->track_cursor;
+}
+
+bool GMT_Record_FindDecoded(GMT_DecodedDataTable* table, unsigned int key, unsigned int index, void* out_data, uint32_t size, uint32_t* out_size) {
+  if (!table) return false;
+
+  GMT_ThreadData* td = GMT_ThreadData_Get();
+  size_t* cursor = td ? GMT__ThreadCursor(td, table) : &table->cursor;
+  GMT_LookupStats* stats = td ? &td->lookup : &g_gmt.replay_lookup;
+  if (td && !g_gmt.replay_streaming) {
+    if (table->count == 0) return false;
+    return GMT__CopyDecoded(GMT__FindDecodedAt(table, cursor, stats, key, index), out_data, size, out_size);
+  }
+
+  // The shared cursor, and a streaming window (which GMT_Update moves), are only
+  // touched with the mutex held.
+  GMT_Platform_MutexLock();
+  if (g_gmt.replay_streaming) GMT__RefillWindow();  // Catches up after a jump (keyframe, early signal).
+  bool found = GMT__CopyDecoded(GMT__FindDecodedAt(table, cursor, stats, key, index), out_data, size, out_size);
+  GMT_Platform_MutexUnlock();
+  return found;
 }
 
 // ===== REPLAY mode =====
 
-bool GMT_Record_LoadReplay(void) {
-  const char* path = g_gmt.setup.test_path;
-  if (!path || path[0] == '\0') {
-    GMT_LogError("GMT_Record: test_path is NULL or empty.");
+// Reads a pin/track header of the given file version.  Version-0 headers get
+// frame = GMT_RECORD_FRAME_ANY.
+static void GMT__ReadDataRecordHeader(const uint8_t* src, uint16_t version, GMT_RawDataRecordHeader* out) {
+  if (version >= 1) {
+    memcpy(out, src, sizeof(*out));
+    return;
+  }
+  GMT_RawDataRecordHeaderV0 v0;
+  memcpy(&v0, src, sizeof(v0));
+  out->frame = GMT_RECORD_FRAME_ANY;
+  out->key = v0.key;
+  out->index = v0.index;
+  out->size = v0.size;
+}
+
+// Size of the pin/track header for a file version.
+static size_t GMT__DataRecordHeaderSize(uint16_t version) {
+  return (version >= 1) ? sizeof(GMT_RawDataRecordHeader) : sizeof(GMT_RawDataRecordHeaderV0);
+}
+
+// Computes the byte length of the record body at p (just past its tag) and checks
+// that it fits before `end`.  Logs and returns false for truncated records and for
+// tags the file version does not define.
+static bool GMT__RecordBodySize(uint8_t tag, const uint8_t* p, const uint8_t* end, uint16_t version, size_t* out) {
+  size_t avail = (size_t)(end - p);
+  size_t head = GMT_Record_HeadSize(tag, version);
+  if (head == 0) {
+    GMT_LogError("GMT_Record: unknown tag in test file.");
     return false;
   }
-  FILE* f = fopen(path, "rb");
-  if (!f) {
-    GMT_LogError("GMT_Record: test file does not exist.");
+  if (avail < head || GMT_Record_BodySize(tag, p, version) > avail) {
+    GMT_LogError("GMT_Record: truncated %s record.", GMT_Record_TagName(tag));
     return false;
   }
+  *out = GMT_Record_BodySize(tag, p, version);
+  return true;
+}
+
+// Reads the whole file into a GMT_Alloc'd buffer.  Used when mapping fails.
+static bool GMT__ReadWholeFile(const char* path, GMT_MappedFile* out) {
+  memset(out, 0, sizeof(*out));
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
   if (fseek(f, 0, SEEK_END) != 0) {
     fclose(f);
-    GMT_LogError("GMT_Record: failed to read test file.");
     return false;
   }
   long file_sz = ftell(f);
   rewind(f);
   if (file_sz < 0) {
     fclose(f);
-    GMT_LogError("GMT_Record: failed to read test file.");
     return false;
   }
   size_t total = (size_t)file_sz;
-  uint8_t* data = GMT_Alloc(total);
-  if (!data) {
-    fclose(f);
-    GMT_LogError("GMT_Record: failed to read test file.");
+  uint8_t* data = NULL;
+  if (total > 0) {
+    data = GMT_Alloc(total);
+    if (!data || fread(data, 1, total, f) != total) {
+      if (data) GMT_Free(data);
+      fclose(f);
+      return false;
+    }
+  }
+  fclose(f);
+  out->data = data;
+  out->size = total;
+  return true;
+}
+
+// Releases the file image loaded by GMT_Record_LoadReplay.
+static void GMT__ReleaseReplayFile(void) {
+  if (g_gmt.replay_file_mapped) {
+    GMT_Platform_UnmapFile(&g_gmt.replay_file);
+  } else if (g_gmt.replay_file.data) {
+    GMT_Free((void*)g_gmt.replay_file.data);
+  }
+  memset(&g_gmt.replay_file, 0, sizeof(g_gmt.replay_file));
+  g_gmt.replay_file_mapped = false;
+}
+
+// If the loaded file contains TAG_BLOCK records, replaces g_gmt.replay_file with
+// a GMT_Alloc'd copy in which every block is expanded in place, so the decode
+// passes only ever see ordinary records.  The header is copied unchanged.
+static bool GMT__ExpandBlocks(uint16_t version) {
+  const uint8_t* begin = g_gmt.replay_file.data;
+  const uint8_t* end = begin + g_gmt.replay_file.size;
+  const uint8_t* p = begin + sizeof(GMT_FileHeader);
+
+  // Measure the expanded stream.
+  size_t expanded = sizeof(GMT_FileHeader) + 1;  // + TAG_END
+  size_t block_count = 0;
+  while (p < end) {
+    uint8_t tag = *p++;
+    if (tag == GMT_RECORD_TAG_END) break;
+    size_t body;
+    if (!GMT__RecordBodySize(tag, p, end, version, &body)) return false;
+    if (tag == GMT_RECORD_TAG_BLOCK) {
+      GMT_RawBlockHeader bh;
+      memcpy(&bh, p, sizeof(bh));
+      if (bh.raw_size > GMT_RECORD_BLOCK_SIZE || bh.stored_size > bh.raw_size) {
+        GMT_LogError("GMT_Record: invalid block record.");
+        return false;
+      }
+      expanded += bh.raw_size;
+      block_count++;
+    } else {
+      expanded += 1 + body;
+    }
+    p += body;
+  }
+  if (block_count == 0) return true;
+
+  uint8_t* out = (uint8_t*)GMT_Alloc(expanded);
+  if (!out) {
+    GMT_LogError("GMT_Record: allocation failed for expanded test file.");
     return false;
   }
-  if (fread(data, 1, total, f) != total) {
-    GMT_Free(data);
-    fclose(f);
+  memcpy(out, begin, sizeof(GMT_FileHeader));
+  uint8_t* op = out + sizeof(GMT_FileHeader);
+
+  p = begin + sizeof(GMT_FileHeader);
+  while (p < end) {
+    uint8_t tag = *p++;
+    if (tag == GMT_RECORD_TAG_END) break;
+    size_t body;
+    GMT__RecordBodySize(tag, p, end, version, &body);  // Validated above.
+    if (tag == GMT_RECORD_TAG_BLOCK) {
+      GMT_RawBlockHeader bh;
+      memcpy(&bh, p, sizeof(bh));
+      const uint8_t* stored = p + sizeof(bh);
+      if (bh.stored_size == bh.raw_size) {
+        memcpy(op, stored, bh.raw_size);
+      } else if (!GMT_Decompress(stored, bh.stored_size, op, bh.raw_size)) {
+        GMT_Free(out);
+        GMT_LogError("GMT_Record: corrupt compressed block.");
+        return false;
+      }
+      op += bh.raw_size;
+    } else {
+      *op++ = tag;
+      memcpy(op, p, body);
+      op += body;
+    }
+    p += body;
+  }
+  *op++ = GMT_RECORD_TAG_END;
+
+  GMT__ReleaseReplayFile();
+  g_gmt.replay_file.data = out;
+  g_gmt.replay_file.size = (size_t)(op - out);
+  g_gmt.replay_file_mapped = false;
+  return true;
+}
+
+// Reads the keyframe index at the end of the file image, if there is one, and
+// returns the stream offset of the last keyframe at or before `start_frame`
+// (0 if none).  Sets replay_keyframe_count.  A damaged index is ignored.
+static uint64_t GMT__FindIndexedKeyframe(const uint8_t* data, size_t total, uint32_t start_frame) {
+  g_gmt.replay_keyframe_count = 0;
+  GMT_RawKeyframeIndexFooter footer;
+  size_t min_size = sizeof(GMT_FileHeader) + 1 + sizeof(footer);  // + TAG_END
+  if (total < min_size) return 0;
+  memcpy(&footer, data + total - sizeof(footer), sizeof(footer));
+  if (footer.magic != GMT_RECORD_INDEX_MAGIC) return 0;
+  if (footer.count > (total - min_size) / sizeof(GMT_RawKeyframeIndexEntry)) {
+    GMT_LogWarning("GMT_Record: keyframe index is damaged; ignored.");
+    return 0;
+  }
+
+  const uint8_t* entries = data + total - sizeof(footer) - (size_t)footer.count * sizeof(GMT_RawKeyframeIndexEntry);
+  uint64_t offset = 0;
+  for (uint32_t i = 0; i < footer.count; i++) {
+    GMT_RawKeyframeIndexEntry e;
+    memcpy(&e, entries + (size_t)i * sizeof(e), sizeof(e));
+    if (e.frame > start_frame) break;  // Entries are in frame order.
+    offset = e.offset;
+  }
+  g_gmt.replay_keyframe_count = footer.count;
+  return offset;
+}
+
+// Without an index (the recording was not closed) keyframes are found by walking
+// the record stream.  Same result as GMT__FindIndexedKeyframe.
+static uint64_t GMT__ScanForKeyframe(const uint8_t* data, size_t total, uint16_t version, uint32_t start_frame) {
+  const uint8_t* end = data + total;
+  const uint8_t* p = data + sizeof(GMT_FileHeader);
+  uint64_t offset = 0;
+  while (p < end) {
+    const uint8_t* rec = p;
+    uint8_t tag = *p++;
+    if (tag == GMT_RECORD_TAG_END) break;
+    size_t body;
+    if (!GMT__RecordBodySize(tag, p, end, version, &body)) break;  // Reported again by the load itself.
+    if (tag == GMT_RECORD_TAG_KEYFRAME) {
+      GMT_RawKeyframeHeader kh;
+      memcpy(&kh, p, sizeof(kh));
+      if (kh.frame > start_frame) break;
+      offset = (uint64_t)(rec - data);
+    }
+    p += body;
+  }
+  return offset;
+}
+
+// Common end of a successful load: the replay position starts at the beginning
+// (or at the keyframe, once applied).
+static void GMT__StartReplay(uint16_t version) {
+  g_gmt.replay_keyframe_pending = g_gmt.replay_from_keyframe;
+  g_gmt.replay_by_frame = (g_gmt.setup.replay_timing == GMT_ReplayTiming_FRAME) && version >= 3;
+  if (g_gmt.setup.replay_timing == GMT_ReplayTiming_FRAME && !g_gmt.replay_by_frame) {
+    GMT_LogWarning("GMT_Record: test file version %u has no frame records; replaying by wall clock.", (unsigned)version);
+  }
+  GMT_Atomic_Store64(&g_gmt.replay_frame_offset, 0);
+  GMT_Atomic_Store64(&g_gmt.replay_keyframe_shift, 0);
+  g_gmt.signal_wait_frame = 0;
+  memset(&g_gmt.replay_lookup, 0, sizeof(g_gmt.replay_lookup));
+  for (GMT_ThreadData* td = g_gmt.threads; td; td = td->next) memset(&td->lookup, 0, sizeof(td->lookup));
+  g_gmt.replay_generation++;
+}
+
+// Loads the whole file image and decodes every record (the default).
+static bool GMT__LoadReplayImage(const char* path) {
+  // Map the file so records can be decoded in place; fall back to reading it.
+  g_gmt.replay_file_mapped = GMT_Platform_MapFile(path, &g_gmt.replay_file);
+  if (!g_gmt.replay_file_mapped && !GMT__ReadWholeFile(path, &g_gmt.replay_file)) {
     GMT_LogError("GMT_Record: failed to read test file.");
     return false;
   }
-  fclose(f);
+  const uint8_t* data = g_gmt.replay_file.data;
+  size_t total = g_gmt.replay_file.size;
 
   bool ok = false;
 
@@ -210,102 +1169,214 @@ bool GMT_Record_LoadReplay(void) {
     GMT_LogError("GMT_Record: invalid file magic.");
     goto cleanup;
   }
-  if (hdr.version != GMT_RECORD_VERSION) {
+  if (hdr.version > GMT_RECORD_VERSION) {
     GMT_LogError("GMT_Record: unsupported file version.");
     goto cleanup;
   }
+  g_gmt.replay_version = hdr.version;
+
+  // Keyframe to start at.  The index lives outside the blocks, so read it first.
+  uint32_t start_frame = g_gmt.setup.replay_start_frame;
+  uint64_t keyframe_offset = 0;
+  bool have_index = false;
+  if (hdr.version >= 4) {
+    keyframe_offset = GMT__FindIndexedKeyframe(data, total, start_frame);
+    have_index = g_gmt.replay_keyframe_count > 0;
+  }
+
+  // Compressed files are expanded up front; records then point into the copy.
+  if (hdr.version >= 2) {
+    if (!GMT__ExpandBlocks(hdr.version)) goto cleanup;
+    data = g_gmt.replay_file.data;
+    total = g_gmt.replay_file.size;
+    cursor = data + sizeof(GMT_FileHeader);
+    end = data + total;
+  }
+  const size_t data_hdr_size = GMT__DataRecordHeaderSize(hdr.version);
+
+  if (start_frame > 0 && hdr.version >= 4 && !have_index) keyframe_offset = GMT__ScanForKeyframe(data, total, hdr.version, start_frame);
+  if (start_frame > 0 && hdr.version < 4) {
+    GMT_LogWarning("GMT_Record: test file version %u has no keyframes; replaying from the beginning.", (unsigned)hdr.version);
+  } else if (start_frame > 0 && keyframe_offset == 0) {
+    GMT_LogWarning("GMT_Record: no keyframe at or before frame %u; replaying from the beginning.", (unsigned)start_frame);
+  }
 
-  // First pass: count records.
+  // Starting at a keyframe: decode only what follows it, on top of its input state.
+  GMT_InputState_Clear(&g_gmt.replay_decode_state);
+  uint32_t min_frame = 0;  // Pins/tracks of earlier frames can trail the keyframe; dropped.
+  if (keyframe_offset > 0) {
+    size_t body;
+    if (keyframe_offset >= total - 1 || data[keyframe_offset] != GMT_RECORD_TAG_KEYFRAME ||
+        !GMT__RecordBodySize(GMT_RECORD_TAG_KEYFRAME, data + keyframe_offset + 1, end, hdr.version, &body)) {
+      GMT_LogError("GMT_Record: keyframe index points at no keyframe.");
+      goto cleanup;
+    }
+    const uint8_t* kp = data + keyframe_offset + 1;
+    memcpy(&g_gmt.replay_keyframe, kp, sizeof(GMT_RawKeyframeHeader));
+    memcpy(&g_gmt.replay_decode_state, kp + sizeof(GMT_RawKeyframeHeader), sizeof(GMT_InputState));
+    g_gmt.replay_keyframe_state = kp + sizeof(GMT_RawKeyframeHeader) + sizeof(GMT_InputState);
+    g_gmt.replay_from_keyframe = true;
+    min_frame = g_gmt.replay_keyframe.frame;
+    cursor = kp + body;
+  }
+
+  // First pass: validate and count records.
   size_t input_count = 0;
+  size_t input_delta_count = 0;
   size_t signal_count = 0;
   size_t pin_count = 0;
   size_t track_count = 0;
+  bool pins_sorted = true;
+  bool tracks_sorted = true;
+  size_t frame_count = (size_t)min_frame + 1;  // Frame 0 (before the first GMT_Update) has no TAG_FRAME.
   {
+    uint32_t last_pin_frame = 0;
+    uint32_t last_track_frame = 0;
+    GMT_InputState state = g_gmt.replay_decode_state;  // Running input state, to validate deltas.
     const uint8_t* scan = cursor;
     while (scan < end) {
       uint8_t tag = *scan++;
       if (tag == GMT_RECORD_TAG_END) break;
+      size_t body;
+      if (!GMT__RecordBodySize(tag, scan, end, hdr.version, &body)) goto cleanup;
+
       if (tag == GMT_RECORD_TAG_INPUT) {
-        if (scan + sizeof(GMT_RawInputRecord) > end) {
-          GMT_LogError("GMT_Record: truncated input record.");
+        memcpy(&state, scan + offsetof(GMT_RawInputRecord, input), sizeof(state));
+        ++input_count;
+      } else if (tag == GMT_RECORD_TAG_INPUT_DELTA) {
+        if (!GMT_InputState_ApplyDelta(&state, scan + sizeof(GMT_RawInputDeltaHeader), body - sizeof(GMT_RawInputDeltaHeader))) {
+          GMT_LogError("GMT_Record: malformed input delta record.");
           goto cleanup;
         }
-        scan += sizeof(GMT_RawInputRecord);
         ++input_count;
+        ++input_delta_count;
       } else if (tag == GMT_RECORD_TAG_SIGNAL) {
-        if (scan + sizeof(GMT_RawSignalRecord) > end) {
-          GMT_LogError("GMT_Record: truncated signal record.");
+        ++signal_count;
+      } else if (tag == GMT_RECORD_TAG_FRAME) {
+        GMT_RawFrameRecord fr;
+        memcpy(&fr, scan, sizeof(fr));
+        if ((size_t)fr.frame < frame_count) {
+          GMT_LogError("GMT_Record: frame records out of order.");
           goto cleanup;
         }
-        scan += sizeof(GMT_RawSignalRecord);
-        ++signal_count;
-      } else if (tag == GMT_RECORD_TAG_PIN || tag == GMT_RECORD_TAG_TRACK) {
-        if (scan + sizeof(GMT_RawDataRecordHeader) > end) {
-          GMT_LogError("GMT_Record: truncated pin/track header.");
+        frame_count = (size_t)fr.frame + 1;
+      } else if (tag == GMT_RECORD_TAG_KEYFRAME) {
+        GMT_RawKeyframeHeader kh;
+        memcpy(&kh, scan, sizeof(kh));
+        if ((size_t)kh.frame + 1 != frame_count) {
+          GMT_LogError("GMT_Record: keyframe does not follow its frame record.");
           goto cleanup;
         }
+      } else if (tag == GMT_RECORD_TAG_PIN || tag == GMT_RECORD_TAG_TRACK) {
         GMT_RawDataRecordHeader drh;
-        memcpy(&drh, scan, sizeof(drh));
-        scan += sizeof(drh);
-        if ((size_t)drh.size > (size_t)(end - scan)) {
-          GMT_LogError("GMT_Record: truncated pin/track payload.");
+        GMT__ReadDataRecordHeader(scan, hdr.version, &drh);
+        if (drh.size > GMT_MAX_DATA_RECORD_PAYLOAD) {
+          GMT_LogError("GMT_Record: pin/track payload exceeds maximum size.");
           goto cleanup;
         }
-        scan += drh.size;
+        if (drh.frame < min_frame) {
+          scan += body;
+          continue;
+        }
+        // Records staged by different threads are merged at frame boundaries, so a
+        // thread's records can land behind those of a later frame; sorted below.
+        uint32_t* last_frame = (tag == GMT_RECORD_TAG_PIN) ? &last_pin_frame : &last_track_frame;
+        if (drh.frame < *last_frame) {
+          if (tag == GMT_RECORD_TAG_PIN) pins_sorted = false;
+          else
+            tracks_sorted = false;
+        }
+        *last_frame = drh.frame;
         if (tag == GMT_RECORD_TAG_PIN) ++pin_count;
         else
           ++track_count;
       } else {
-        GMT_LogError("GMT_Record: unknown tag in test file.");
+        GMT_LogError("GMT_Record: nested block record.");
         goto cleanup;
       }
+      scan += body;
     }
   }
 
-  // Allocate decoded arrays.
+  // Allocate decoded arrays, all from one replay arena block.
+  {
+    size_t total = 0;
+    if (input_count > 0) total += GMT_Arena_Footprint(input_count * sizeof(GMT_DecodedInput));
+    if (signal_count > 0) total += GMT_Arena_Footprint(signal_count * sizeof(GMT_DecodedSignal));
+    if (pin_count > 0) total += GMT_Arena_Footprint(pin_count * sizeof(GMT_DecodedDataRecord));
+    if (track_count > 0) total += GMT_Arena_Footprint(track_count * sizeof(GMT_DecodedDataRecord));
+    if (hdr.version >= 3) total += GMT_Arena_Footprint(frame_count * sizeof(double));
+    if (!GMT_Arena_Init(&g_gmt.replay_arena, total)) {
+      GMT_LogError("GMT_Record: allocation failed for replay data.");
+      goto cleanup;
+    }
+  }
   if (input_count > 0) {
-    g_gmt.replay_inputs = (GMT_DecodedInput*)GMT_Alloc(input_count * sizeof(GMT_DecodedInput));
+    g_gmt.replay_inputs = (GMT_DecodedInput*)GMT_Arena_Alloc(&g_gmt.replay_arena, input_count * sizeof(GMT_DecodedInput));
     if (!g_gmt.replay_inputs) {
       GMT_LogError("GMT_Record: allocation failed for replay inputs.");
       goto cleanup;
     }
   }
   if (signal_count > 0) {
-    g_gmt.replay_signals = (GMT_DecodedSignal*)GMT_Alloc(signal_count * sizeof(GMT_DecodedSignal));
+    g_gmt.replay_signals = (GMT_DecodedSignal*)GMT_Arena_Alloc(&g_gmt.replay_arena, signal_count * sizeof(GMT_DecodedSignal));
     if (!g_gmt.replay_signals) {
       GMT_LogError("GMT_Record: allocation failed for replay signals.");
       goto cleanup;
     }
   }
   if (pin_count > 0) {
-    g_gmt.replay_pins = (GMT_DecodedDataRecord*)GMT_Alloc(pin_count * sizeof(GMT_DecodedDataRecord));
-    if (!g_gmt.replay_pins) {
+    g_gmt.replay_pins.records = (GMT_DecodedDataRecord*)GMT_Arena_Alloc(&g_gmt.replay_arena, pin_count * sizeof(GMT_DecodedDataRecord));
+    if (!g_gmt.replay_pins.records) {
       GMT_LogError("GMT_Record: allocation failed for replay pins.");
       goto cleanup;
     }
   }
   if (track_count > 0) {
-    g_gmt.replay_tracks = (GMT_DecodedDataRecord*)GMT_Alloc(track_count * sizeof(GMT_DecodedDataRecord));
-    if (!g_gmt.replay_tracks) {
+    g_gmt.replay_tracks.records = (GMT_DecodedDataRecord*)GMT_Arena_Alloc(&g_gmt.replay_arena, track_count * sizeof(GMT_DecodedDataRecord));
+    if (!g_gmt.replay_tracks.records) {
       GMT_LogError("GMT_Record: allocation failed for replay tracks.");
       goto cleanup;
     }
   }
 
+  if (hdr.version >= 3) {
+    g_gmt.replay_frame_times = (double*)GMT_Arena_Alloc(&g_gmt.replay_arena, frame_count * sizeof(double));
+    if (!g_gmt.replay_frame_times) {
+      GMT_LogError("GMT_Record: allocation failed for replay frame times.");
+      goto cleanup;
+    }
+    // Frames before a start keyframe are never replayed; they read as its time.
+    double start_time = g_gmt.replay_from_keyframe ? g_gmt.replay_keyframe.time : 0.0;
+    for (uint32_t f = 0; f <= min_frame; f++) g_gmt.replay_frame_times[f] = start_time;
+    g_gmt.replay_frame_count = frame_count;
+  }
+
   // Second pass: decode.
   {
     size_t ii = 0, si = 0, pi = 0, ti = 0;
+    uint32_t frame = (hdr.version >= 3) ? min_frame : GMT_RECORD_FRAME_ANY;
     while (cursor < end) {
       uint8_t tag = *cursor++;
       if (tag == GMT_RECORD_TAG_END) break;
       if (tag == GMT_RECORD_TAG_INPUT) {
-        GMT_RawInputRecord raw;
-        memcpy(&raw, cursor, sizeof(raw));
-        cursor += sizeof(raw);
+        GMT_DecodedInput* di = &g_gmt.replay_inputs[ii++];
+        memcpy(&di->timestamp, cursor + offsetof(GMT_RawInputRecord, timestamp), sizeof(di->timestamp));
+        di->input = cursor + offsetof(GMT_RawInputRecord, input);
+        di->frame = frame;
+        di->delta_size = 0;
+        cursor += sizeof(GMT_RawInputRecord);
+      } else if (tag == GMT_RECORD_TAG_INPUT_DELTA) {
+        GMT_RawInputDeltaHeader dh;
+        memcpy(&dh, cursor, sizeof(dh));
+        cursor += sizeof(dh);
 
         GMT_DecodedInput* di = &g_gmt.replay_inputs[ii++];
-        di->timestamp = raw.timestamp;
-        di->input = raw.input;
+        di->timestamp = dh.timestamp;
+        di->frame = frame;
+        di->input = cursor;
+        di->delta_size = dh.size;
+        cursor += dh.size;
       } else if (tag == GMT_RECORD_TAG_SIGNAL) {
         GMT_RawSignalRecord raw;
         memcpy(&raw, cursor, sizeof(raw));
@@ -313,87 +1384,298 @@ bool GMT_Record_LoadReplay(void) {
 
         GMT_DecodedSignal* ds = &g_gmt.replay_signals[si++];
         ds->timestamp = raw.timestamp;
+        ds->frame = frame;
         ds->signal_id = raw.signal_id;
+      } else if (tag == GMT_RECORD_TAG_FRAME) {
+        GMT_RawFrameRecord fr;
+        memcpy(&fr, cursor, sizeof(fr));
+        cursor += sizeof(fr);
+
+        // Frames without a record (not written by this version) keep the previous time.
+        for (uint32_t f = frame + 1; f < fr.frame; f++) g_gmt.replay_frame_times[f] = g_gmt.replay_frame_times[frame];
+        g_gmt.replay_frame_times[fr.frame] = fr.time;
+        frame = fr.frame;
+      } else if (tag == GMT_RECORD_TAG_KEYFRAME) {
+        size_t body;
+        GMT__RecordBodySize(tag, cursor, end, g_gmt.replay_version, &body);  // Validated above.
+        if (g_gmt.setup.verify_keyframes) GMT__AddKeyframeCheck(cursor);
+        cursor += body;
       } else if (tag == GMT_RECORD_TAG_PIN || tag == GMT_RECORD_TAG_TRACK) {
         GMT_RawDataRecordHeader hdr;
-        memcpy(&hdr, cursor, sizeof(hdr));
-        cursor += sizeof(hdr);
+        GMT__ReadDataRecordHeader(cursor, g_gmt.replay_version, &hdr);
+        cursor += data_hdr_size;
+        if (hdr.frame < min_frame) {
+          cursor += hdr.size;
+          continue;
+        }
 
         GMT_DecodedDataRecord* dr = (tag == GMT_RECORD_TAG_PIN)
-                                        ? &g_gmt.replay_pins[pi++]
-                                        : &g_gmt.replay_tracks[ti++];
+                                        ? &g_gmt.replay_pins.records[pi++]
+                                        : &g_gmt.replay_tracks.records[ti++];
+        dr->frame = hdr.frame;
         dr->key = hdr.key;
         dr->index = hdr.index;
         dr->size = hdr.size;
-        if (hdr.size > 0) memcpy(dr->data, cursor, hdr.size);
+        dr->data = cursor;
         cursor += hdr.size;
       }
     }
   }
 
   g_gmt.replay_input_count = input_count;
+  g_gmt.replay_input_delta_count = input_delta_count;
   g_gmt.replay_signal_count = signal_count;
-  g_gmt.replay_pin_count = pin_count;
-  g_gmt.replay_track_count = track_count;
+  g_gmt.replay_pins.count = pin_count;
+  g_gmt.replay_tracks.count = track_count;
+  g_gmt.replay_pins.cursor = 0;
+  g_gmt.replay_tracks.cursor = 0;
+  if (!pins_sorted) GMT__SortDataTableByFrame(&g_gmt.replay_pins);
+  if (!tracks_sorted) GMT__SortDataTableByFrame(&g_gmt.replay_tracks);
+
+  // Index pins and tracks by (frame, key, index) for calls that miss the cursor.
+  if (!GMT__BuildDataIndex(&g_gmt.replay_pins) || !GMT__BuildDataIndex(&g_gmt.replay_tracks)) {
+    GMT_LogError("GMT_Record: allocation failed for pin/track lookup index.");
+    goto cleanup;
+  }
+  GMT__StartReplay(hdr.version);
   ok = true;
 
 cleanup:
-  GMT_Free(data);
+  // On success the file image stays loaded: decoded records point into it.
+  if (!ok) GMT_Record_FreeReplay();
   return ok;
 }
 
-void GMT_Record_FreeReplay(void) {
-  if (g_gmt.replay_inputs) {
-    GMT_Free(g_gmt.replay_inputs);
-    g_gmt.replay_inputs = NULL;
+// Reads the keyframe index at the end of an open file, like
+// GMT__FindIndexedKeyframe, without loading the file.
+static uint64_t GMT__ReadKeyframeIndex(FILE* f, long total, uint32_t start_frame) {
+  g_gmt.replay_keyframe_count = 0;
+  GMT_RawKeyframeIndexFooter footer;
+  long min_size = (long)(sizeof(GMT_FileHeader) + 1 + sizeof(footer));  // + TAG_END
+  if (total < min_size) return 0;
+  if (fseek(f, total - (long)sizeof(footer), SEEK_SET) != 0 || fread(&footer, sizeof(footer), 1, f) != 1) return 0;
+  if (footer.magic != GMT_RECORD_INDEX_MAGIC) return 0;
+  if (footer.count > (uint64_t)(total - min_size) / sizeof(GMT_RawKeyframeIndexEntry)) {
+    GMT_LogWarning("GMT_Record: keyframe index is damaged; ignored.");
+    return 0;
+  }
+
+  long entries = total - (long)sizeof(footer) - (long)((size_t)footer.count * sizeof(GMT_RawKeyframeIndexEntry));
+  if (fseek(f, entries, SEEK_SET) != 0) return 0;
+  uint64_t offset = 0;
+  for (uint32_t i = 0; i < footer.count; i++) {
+    GMT_RawKeyframeIndexEntry e;
+    if (fread(&e, sizeof(e), 1, f) != 1) return 0;
+    if (e.frame > start_frame) break;  // Entries are in frame order.
+    offset = e.offset;
+  }
+  g_gmt.replay_keyframe_count = footer.count;
+  return offset;
+}
+
+// Opens the streaming readers (GMT_Setup.stream_replay) and positions them at the
+// start keyframe, if there is one.  Nothing is decoded yet: injection pulls
+// records as they fall due and GMT__RefillWindow fills the pin/track window.
+static bool GMT__LoadReplayStream(const char* path) {
+  GMT_ReplayStream* s = &g_gmt.replay_stream;
+  if (!GMT_RecordReader_Open(&s->data, path)) return false;
+  uint16_t version = s->data.version;
+  if (version < 3) {
+    GMT_RecordReader_Close(&s->data);
+    GMT_LogWarning("GMT_Record: test file version %u has no frame records to stream by; loading it whole.", (unsigned)version);
+    return GMT__LoadReplayImage(path);
+  }
+  g_gmt.replay_version = version;
+  g_gmt.replay_streaming = true;
+
+  bool ok = false;
+  uint32_t start_frame = g_gmt.setup.replay_start_frame;
+  uint64_t keyframe_offset = 0;
+  {
+    FILE* f = fopen(path, "rb");
+    if (f && fseek(f, 0, SEEK_END) == 0) s->file_size = ftell(f);
+    if (f && version >= 4) keyframe_offset = GMT__ReadKeyframeIndex(f, s->file_size, start_frame);
+    if (f) fclose(f);
   }
-  if (g_gmt.replay_signals) {
-    GMT_Free(g_gmt.replay_signals);
-    g_gmt.replay_signals = NULL;
+
+  // Without an index, walk the file for the keyframe, then start over.
+  if (start_frame > 0 && version >= 4 && g_gmt.replay_keyframe_count == 0) {
+    uint8_t tag;
+    const uint8_t* body;
+    size_t size;
+    while (GMT_RecordReader_Next(&s->data, &tag, &body, &size)) {
+      if (tag != GMT_RECORD_TAG_KEYFRAME) continue;
+      GMT_RawKeyframeHeader kh;
+      memcpy(&kh, body, sizeof(kh));
+      if (kh.frame > start_frame) break;
+      keyframe_offset = s->data.record_offset;
+    }
+    GMT_RecordReader_Close(&s->data);
+    if (!GMT_RecordReader_Open(&s->data, path)) goto cleanup;
+  }
+  if (start_frame > 0 && version < 4) {
+    GMT_LogWarning("GMT_Record: test file version %u has no keyframes; replaying from the beginning.", (unsigned)version);
+  } else if (start_frame > 0 && keyframe_offset == 0) {
+    GMT_LogWarning("GMT_Record: no keyframe at or before frame %u; replaying from the beginning.", (unsigned)start_frame);
+  }
+
+  if (!GMT_RecordReader_Open(&s->inputs, path) || !GMT_RecordReader_Open(&s->signals, path)) goto cleanup;
+
+  GMT_InputState_Clear(&g_gmt.replay_decode_state);
+  double start_time = 0.0;
+  if (keyframe_offset > 0) {
+    uint8_t tag;
+    const uint8_t* body;
+    size_t size;
+    if (!GMT_RecordReader_Seek(&s->data, keyframe_offset) || !GMT_RecordReader_Next(&s->data, &tag, &body, &size) ||
+        tag != GMT_RECORD_TAG_KEYFRAME) {
+      GMT_LogError("GMT_Record: keyframe index points at no keyframe.");
+      goto cleanup;
+    }
+    memcpy(&g_gmt.replay_keyframe, body, sizeof(GMT_RawKeyframeHeader));
+    memcpy(&g_gmt.replay_decode_state, body + sizeof(GMT_RawKeyframeHeader), sizeof(GMT_InputState));
+    if (g_gmt.replay_keyframe.state_size > 0) {
+      s->keyframe_state = (uint8_t*)GMT_Alloc(g_gmt.replay_keyframe.state_size);
+      if (!s->keyframe_state) {
+        GMT_LogError("GMT_Record: allocation failed for the keyframe game state.");
+        goto cleanup;
+      }
+      memcpy(s->keyframe_state, body + sizeof(GMT_RawKeyframeHeader) + sizeof(GMT_InputState), g_gmt.replay_keyframe.state_size);
+    }
+    g_gmt.replay_keyframe_state = s->keyframe_state;
+    g_gmt.replay_from_keyframe = true;
+    s->input_frame = s->signal_frame = s->data_frame = s->window_frame = g_gmt.replay_keyframe.frame;
+    start_time = g_gmt.replay_keyframe.time;
+    if (!GMT_RecordReader_Seek(&s->inputs, s->data.offset) || !GMT_RecordReader_Seek(&s->signals, s->data.offset)) goto cleanup;
+  }
+  for (size_t f = 0; f < GMT_REPLAY_WINDOW_TIMES; f++) s->frame_times[f] = start_time;
+
+  GMT__StartReplay(version);
+  ok = true;
+
+cleanup:
+  if (!ok) GMT_Record_FreeReplay();
+  return ok;
+}
+
+bool GMT_Record_LoadReplay(void) {
+  const char* path = g_gmt.setup.test_path;
+  if (!path || path[0] == '\0') {
+    GMT_LogError("GMT_Record: test_path is NULL or empty.");
+    return false;
   }
-  if (g_gmt.replay_pins) {
-    GMT_Free(g_gmt.replay_pins);
-    g_gmt.replay_pins = NULL;
+  FILE* probe = fopen(path, "rb");
+  if (!probe) {
+    GMT_LogError("GMT_Record: test file does not exist.");
+    return false;
   }
-  if (g_gmt.replay_tracks) {
-    GMT_Free(g_gmt.replay_tracks);
-    g_gmt.replay_tracks = NULL;
+  fclose(probe);
+
+  if (g_gmt.setup.stream_replay) return GMT__LoadReplayStream(path);
+  return GMT__LoadReplayImage(path);
+}
+
+void GMT_Record_FreeReplay(void) {
+  // A file loaded whole keeps its decoded arrays in the replay arena; the
+  // streaming window's pin/track records are its own (freed below).
+  if (g_gmt.replay_arena.base) {
+    g_gmt.replay_pins.records = NULL;
+    g_gmt.replay_tracks.records = NULL;
   }
+  GMT_Arena_Free(&g_gmt.replay_arena);
+  g_gmt.replay_inputs = NULL;
+  g_gmt.replay_signals = NULL;
+  g_gmt.replay_frame_times = NULL;
+  g_gmt.replay_frame_count = 0;
+  GMT__FreeDataTable(&g_gmt.replay_pins);
+  GMT__FreeDataTable(&g_gmt.replay_tracks);
+  GMT__ReleaseReplayFile();
   g_gmt.replay_input_count = 0;
   g_gmt.replay_signal_count = 0;
-  g_gmt.replay_pin_count = 0;
-  g_gmt.replay_track_count = 0;
   g_gmt.replay_input_cursor = 0;
   g_gmt.replay_signal_cursor = 0;
+  g_gmt.replay_keyframe_pending = false;
+  g_gmt.replay_from_keyframe = false;
+  g_gmt.replay_keyframe_state = NULL;
+  g_gmt.replay_keyframe_count = 0;
+  if (g_gmt.replay_checks) GMT_Free(g_gmt.replay_checks);
+  if (g_gmt.replay_check_state) GMT_Free(g_gmt.replay_check_state);
+  g_gmt.replay_checks = NULL;
+  g_gmt.replay_check_count = 0;
+  g_gmt.replay_check_capacity = 0;
+  g_gmt.replay_check_cursor = 0;
+  g_gmt.replay_check_state = NULL;
+  g_gmt.replay_check_state_capacity = 0;
+
+  GMT_ReplayStream* s = &g_gmt.replay_stream;
+  GMT_RecordReader_Close(&s->inputs);
+  GMT_RecordReader_Close(&s->signals);
+  GMT_RecordReader_Close(&s->data);
+  if (s->keyframe_state) GMT_Free(s->keyframe_state);
+  memset(s, 0, sizeof(*s));
+  g_gmt.replay_streaming = false;
 }
 
 GMT_FileMetrics GMT_Record_GetReplayMetrics(void) {
   GMT_FileMetrics m;
   memset(&m, 0, sizeof(m));
   m.input_count = g_gmt.replay_input_count;
+  m.input_delta_count = g_gmt.replay_input_delta_count;
+  m.file_size_bytes = (long)g_gmt.replay_file.size;
   m.signal_count = g_gmt.replay_signal_count;
-  m.pin_count = g_gmt.replay_pin_count;
-  m.track_count = g_gmt.replay_track_count;
+  m.pin_count = g_gmt.replay_pins.count;
+  m.track_count = g_gmt.replay_tracks.count;
   m.duration = (g_gmt.replay_input_count > 0)
                    ? g_gmt.replay_inputs[g_gmt.replay_input_count - 1].timestamp
                    : 0.0;
   m.input_density = (m.duration > 0.0) ? (double)m.input_count / m.duration : 0.0;
+  m.lookup_count = g_gmt.replay_lookup.count;
+  m.lookup_cursor_hits = g_gmt.replay_lookup.cursor_hits;
+  m.lookup_probes = g_gmt.replay_lookup.probes;
+  m.keyframe_count = g_gmt.replay_keyframe_count;
+  m.start_frame = g_gmt.replay_from_keyframe ? g_gmt.replay_keyframe.frame : 0;
+  if (g_gmt.replay_streaming) {
+    // Only what has been decoded so far is known.
+    const GMT_ReplayStream* s = &g_gmt.replay_stream;
+    m.file_size_bytes = s->file_size;
+    m.input_count = g_gmt.replay_input_cursor;
+    m.input_delta_count = s->input_delta_count;
+    m.signal_count = g_gmt.replay_signal_cursor;
+    m.pin_count = s->pin_count;
+    m.track_count = s->track_count;
+  }
+  for (const GMT_ThreadData* td = g_gmt.threads; td; td = td->next) {
+    m.lookup_count += td->lookup.count;
+    m.lookup_cursor_hits += td->lookup.cursor_hits;
+    m.lookup_probes += td->lookup.probes;
+  }
   return m;
 }
 
 GMT_FileMetrics GMT_Record_GetRecordMetrics(void) {
   GMT_FileMetrics m;
   memset(&m, 0, sizeof(m));
+  // Write out staged, queued and buffered records so the file position is exact.
+  GMT_Record_MergeThreadRecords();
+  GMT__WriteInputEvents();
+  if (g_gmt.record_file) GMT__FlushRecords();
   long file_pos = g_gmt.record_file ? ftell(g_gmt.record_file) : 0;
-  /* +1 accounts for the TAG_END byte that CloseWrite is about to append. */
-  m.file_size_bytes = (file_pos >= 0) ? file_pos + 1 : 0;
+  /* Accounts for the TAG_END byte and summary that CloseWrite is about to append. */
+  m.file_size_bytes = (file_pos >= 0) ? file_pos + 1 + (long)sizeof(GMT_RawRecordSummary) : 0;
+  m.raw_size_bytes = g_gmt.record_raw_bytes;
+  m.buffer_high_water = g_gmt.record_writer.high_water;
+  m.buffer_overflow_count = g_gmt.record_writer.overflow_count;
   m.duration = GMT_Platform_GetTime() - g_gmt.record_start_time;
   m.frame_count = g_gmt.frame_index;
   m.input_count = g_gmt.record_input_count;
+  m.input_delta_count = g_gmt.record_input_delta_count;
+  m.input_event_count = g_gmt.record_input_event_count;
+  m.input_event_dropped = (size_t)GMT_Atomic_Load64(&g_gmt.input_sampler.dropped);
   m.signal_count = g_gmt.record_signal_count;
   m.pin_count = g_gmt.record_pin_count;
   m.track_count = g_gmt.record_track_count;
   m.input_density = (m.duration > 0.0) ? (double)m.input_count / m.duration : 0.0;
+  m.keyframe_count = g_gmt.record_keyframe_count;
   return m;
 }
 
@@ -404,7 +1686,87 @@ GMT_FileMetrics GMT_Record_GetRecordMetrics(void) {
 // in a single frame (e.g. rapid key taps), which could cause tick-boundary drift.
 #define GMT__MAX_INJECT_BATCH 64
 
-// Collects all pending input records whose timestamps have elapsed into
+// Whether a record is due at the current replay position: by frame number in
+// GMT_ReplayTiming_FRAME, otherwise by timestamp against the replay clock.
+static bool GMT__ReplayDue(double timestamp, uint32_t frame, double replay_time, int64_t replay_frame) {
+  if (g_gmt.replay_by_frame) return (int64_t)frame <= replay_frame;
+  return timestamp <= replay_time;
+}
+
+// Next input record to inject, or NULL once all have been.
+static const GMT_DecodedInput* GMT__PeekInput(void) {
+  if (!g_gmt.replay_streaming) {
+    return (g_gmt.replay_input_cursor < g_gmt.replay_input_count) ? &g_gmt.replay_inputs[g_gmt.replay_input_cursor] : NULL;
+  }
+  GMT_ReplayStream* s = &g_gmt.replay_stream;
+  uint8_t tag;
+  const uint8_t* body;
+  size_t size;
+  while (!s->have_input) {
+    if (!GMT_RecordReader_Next(&s->inputs, &tag, &body, &size)) {
+      if (s->inputs.failed) s->failed = true;
+      return NULL;
+    }
+    GMT_DecodedInput* di = &s->next_input;
+    if (tag == GMT_RECORD_TAG_FRAME) {
+      GMT_RawFrameRecord fr;
+      memcpy(&fr, body, sizeof(fr));
+      s->input_frame = fr.frame;
+    } else if (tag == GMT_RECORD_TAG_INPUT) {
+      memcpy(&di->timestamp, body + offsetof(GMT_RawInputRecord, timestamp), sizeof(di->timestamp));
+      di->frame = s->input_frame;
+      di->input = body + offsetof(GMT_RawInputRecord, input);
+      di->delta_size = 0;
+      s->have_input = true;
+    } else if (tag == GMT_RECORD_TAG_INPUT_DELTA) {
+      GMT_RawInputDeltaHeader dh;
+      memcpy(&dh, body, sizeof(dh));
+      di->timestamp = dh.timestamp;
+      di->frame = s->input_frame;
+      di->input = body + sizeof(dh);
+      di->delta_size = dh.size;
+      s->input_delta_count++;
+      s->have_input = true;
+    }
+  }
+  return &s->next_input;
+}
+
+const GMT_DecodedSignal* GMT_Record_PeekSignal(void) {
+  if (!g_gmt.replay_streaming) {
+    return (g_gmt.replay_signal_cursor < g_gmt.replay_signal_count) ? &g_gmt.replay_signals[g_gmt.replay_signal_cursor] : NULL;
+  }
+  GMT_ReplayStream* s = &g_gmt.replay_stream;
+  uint8_t tag;
+  const uint8_t* body;
+  size_t size;
+  while (!s->have_signal) {
+    if (!GMT_RecordReader_Next(&s->signals, &tag, &body, &size)) {
+      if (s->signals.failed) s->failed = true;
+      return NULL;
+    }
+    if (tag == GMT_RECORD_TAG_FRAME) {
+      GMT_RawFrameRecord fr;
+      memcpy(&fr, body, sizeof(fr));
+      s->signal_frame = fr.frame;
+    } else if (tag == GMT_RECORD_TAG_SIGNAL) {
+      GMT_RawSignalRecord raw;
+      memcpy(&raw, body, sizeof(raw));
+      s->next_signal.timestamp = raw.timestamp;
+      s->next_signal.frame = s->signal_frame;
+      s->next_signal.signal_id = raw.signal_id;
+      s->have_signal = true;
+    }
+  }
+  return &s->next_signal;
+}
+
+void GMT_Record_NextSignal(void) {
+  g_gmt.replay_stream.have_signal = false;
+  g_gmt.replay_signal_cursor++;
+}
+
+// Collects all pending input records that are due (see GMT__ReplayDue) into
 // out_new[]/out_prev[] pairs (up to GMT__MAX_INJECT_BATCH entries).
 // Advances g_gmt cursors and prev/current state, but does NOT call SendInput.
 // Must be called with the mutex held.  Returns the number of pairs collected.
@@ -413,56 +1775,234 @@ static int GMT__CollectPendingInjections(GMT_InputState* out_new, GMT_InputState
 
   double now = GMT_Platform_GetTime();
   double replay_time = (now - g_gmt.record_start_time) - g_gmt.replay_time_offset;
+  int64_t replay_frame = GMT_ReplayFrame();
   int count = 0;
 
   while (count < GMT__MAX_INJECT_BATCH) {
-    bool have_input = g_gmt.replay_input_cursor < g_gmt.replay_input_count;
-    bool have_signal = g_gmt.replay_signal_cursor < g_gmt.replay_signal_count;
+    const GMT_DecodedInput* di = GMT__PeekInput();
+    const GMT_DecodedSignal* ds = GMT_Record_PeekSignal();
 
-    if (!have_input && !have_signal) break;
+    if (!di && !ds) break;
 
-    double it = have_input ? g_gmt.replay_inputs[g_gmt.replay_input_cursor].timestamp : 1e18;
-    double st = have_signal ? g_gmt.replay_signals[g_gmt.replay_signal_cursor].timestamp : 1e18;
+    double it = di ? di->timestamp : 1e18;
+    double st = ds ? ds->timestamp : 1e18;
 
     // Signal wins ties — it must gate before a same-timestamp input record.
-    bool signal_first = have_signal && st <= it;
+    // Timestamps also order records within a frame in GMT_ReplayTiming_FRAME.
+    bool signal_first = ds && st <= it;
 
     if (signal_first) {
-      if (st > replay_time) break;
+      if (!GMT__ReplayDue(ds->timestamp, ds->frame, replay_time, replay_frame)) break;
       g_gmt.waiting_for_signal = true;
-      g_gmt.waiting_signal_id = g_gmt.replay_signals[g_gmt.replay_signal_cursor].signal_id;
+      g_gmt.waiting_signal_id = ds->signal_id;
       g_gmt.signal_wait_start = now;
+      g_gmt.signal_wait_frame = g_gmt.frame_index;
+      GMT_Profile_SignalWaitBegin();
       break;
     }
 
-    if (it > replay_time) break;
+    if (!GMT__ReplayDue(di->timestamp, di->frame, replay_time, replay_frame)) break;
 
-    GMT_DecodedInput* di = &g_gmt.replay_inputs[g_gmt.replay_input_cursor];
     out_prev[count] = (count == 0) ? g_gmt.replay_prev_input : out_new[count - 1];
-    out_new[count] = di->input;
-    g_gmt.replay_prev_input = di->input;
-    g_gmt.replay_current_input = di->input;
+    if (di->delta_size == 0) {
+      memcpy(&g_gmt.replay_decode_state, di->input, sizeof(GMT_InputState));
+    } else if (!GMT_InputState_ApplyDelta(&g_gmt.replay_decode_state, di->input, di->delta_size)) {
+      // Only possible when streaming: GMT_Record_LoadReplay validates every delta.
+      GMT_LogError("GMT_Record: malformed input delta record.");
+      g_gmt.replay_stream.failed = true;
+    }
+    g_gmt.replay_stream.have_input = false;
     g_gmt.replay_input_cursor++;
+    // A record that only moves the mouse or the analog controls overwrites the
+    // previous one of the batch: only the final position would be seen.  Keeps
+    // the batch within its limit when sampled records arrive many per frame.
+    bool step = count > 0 && GMT_InputState_IsAnalogStep(&out_new[count - 1], &g_gmt.replay_decode_state);
+    if (step) count--;
+    out_new[count] = g_gmt.replay_decode_state;
+    g_gmt.replay_prev_input = out_new[count];
+    g_gmt.replay_current_input = out_new[count];
     count++;
   }
 
   // Warn if batch limit caused us to defer input records (may cause timing drift).
-  if (count == GMT__MAX_INJECT_BATCH &&
-      g_gmt.replay_input_cursor < g_gmt.replay_input_count &&
-      g_gmt.replay_inputs[g_gmt.replay_input_cursor].timestamp <= replay_time) {
-    GMT_LogWarning("GMT_Record: batch limit (%d) reached; input records deferred to next frame (may cause replay drift).",
-                   GMT__MAX_INJECT_BATCH);
+  if (count == GMT__MAX_INJECT_BATCH) {
+    const GMT_DecodedInput* di = GMT__PeekInput();
+    if (di && GMT__ReplayDue(di->timestamp, di->frame, replay_time, replay_frame)) {
+      GMT_LogWarning("GMT_Record: batch limit (%d) reached; input records deferred to next frame (may cause replay drift).",
+                     GMT__MAX_INJECT_BATCH);
+    }
   }
 
   return count;
 }
 
+// GMT_InputInjection_VIRTUAL: the frame's input is the held state of the last
+// due record, with the per-frame deltas and repeats of every due record summed.
+static void GMT__DeliverVirtualInput(const GMT_InputState* states, int count) {
+  GMT_InputState* v = &g_gmt.virtual_input;
+  if (count > 0) *v = states[count - 1];
+  memset(v->key_repeats, 0, sizeof(v->key_repeats));
+  v->mouse_wheel_x = 0;
+  v->mouse_wheel_y = 0;
+  for (int i = 0; i < count; i++) {
+    v->mouse_wheel_x += states[i].mouse_wheel_x;
+    v->mouse_wheel_y += states[i].mouse_wheel_y;
+    for (int k = 0; k < GMT_KEY_COUNT; k++) {
+      unsigned sum = (unsigned)v->key_repeats[k] + states[i].key_repeats[k];
+      v->key_repeats[k] = (uint8_t)(sum > 255 ? 255 : sum);
+    }
+  }
+}
+
 void GMT_Record_InjectInput(void) {
+  uint64_t profile_begin = GMT_Profile_Begin();
   GMT_InputState new_states[GMT__MAX_INJECT_BATCH];
   GMT_InputState prev_states[GMT__MAX_INJECT_BATCH];
   int count = GMT__CollectPendingInjections(new_states, prev_states);
-  for (int i = 0; i < count; i++) {
-    GMT_Platform_SetReplayedInput(&new_states[i]);
-    GMT_Platform_InjectInput(&new_states[i], &prev_states[i]);
+  if (g_gmt.setup.input_injection == GMT_InputInjection_VIRTUAL) {
+    GMT__DeliverVirtualInput(new_states, count);
+  } else {
+    for (int i = 0; i < count; i++) {
+      GMT_Platform_SetReplayedInput(&new_states[i]);
+      GMT_Platform_InjectInput(&new_states[i], &prev_states[i]);
+    }
+  }
+  if (profile_begin) {
+    // Frames with nothing due are timed but left out of the trace.
+    char args[32];
+    snprintf(args, sizeof(args), "\"records\":%d", count);
+    GMT_Profile_EndSpan(GMT_ProfileScope_INJECT, profile_begin, count > 0 ? "GMT_Inject" : NULL, args);
+  }
+}
+
+void GMT_Record_DeliverInput(void) {
+  GMT_Platform_MutexLock();
+  // The first GMT_Update of a run starts injection (or applies the start
+  // keyframe); a frame-timed replay only releases records at frame boundaries.
+  if (g_gmt.initialized && g_gmt.mode == GMT_Mode_REPLAY && !g_gmt.test_failed && !g_gmt.replay_by_frame &&
+      !g_gmt.replay_keyframe_pending && GMT_Atomic_Load64(&g_gmt.frame_index) > 0) {
+    GMT_Record_InjectInput();
+  }
+  GMT_Platform_MutexUnlock();
+}
+
+void GMT_Record_ApplyKeyframe(void) {
+  const GMT_RawKeyframeHeader* kf = &g_gmt.replay_keyframe;
+  g_gmt.replay_keyframe_pending = false;
+
+  if (kf->state_size > 0) {
+    if (g_gmt.setup.snapshot_callback && *g_gmt.setup.snapshot_callback) {
+      // The callback gets its own copy: the file image may be mapped read-only.
+      void* state = GMT_FrameAlloc(kf->state_size);
+      if (state) {
+        memcpy(state, g_gmt.replay_keyframe_state, kf->state_size);
+        GMT_SnapshotCallback cb = *g_gmt.setup.snapshot_callback;
+        cb(GMT_Mode_REPLAY, state, kf->state_size);
+        GMT_FrameFree(state);
+      } else {
+        GMT_LogError("GMT_Record: allocation failed for the keyframe game state; state not restored.");
+      }
+    } else {
+      GMT_LogWarning("GMT_Record: keyframe holds %u bytes of game state but no snapshot callback is set; state not restored.",
+                     (unsigned)kf->state_size);
+    }
+  }
+
+  // The frame this GMT_Update starts replays the keyframe's frame, and the
+  // replay clock continues from its time.
+  uint64_t next_frame = GMT_Atomic_Load64(&g_gmt.frame_index) + 1;
+  GMT_Atomic_Store64(&g_gmt.replay_frame_offset, next_frame - kf->frame);
+  GMT_Atomic_Store64(&g_gmt.replay_keyframe_shift, (uint64_t)kf->frame - next_frame);
+  g_gmt.replay_time_offset = (GMT_Platform_GetTime() - g_gmt.record_start_time) - kf->time;
+
+  // Press what was held at the keyframe.  Wheel deltas and repeats belong to the
+  // record they came from and have already happened.
+  GMT_InputState held = g_gmt.replay_decode_state;
+  memset(held.key_repeats, 0, sizeof(held.key_repeats));
+  held.mouse_wheel_x = 0;
+  held.mouse_wheel_y = 0;
+  GMT_InputState prev = g_gmt.replay_prev_input;
+  g_gmt.replay_prev_input = held;
+  g_gmt.replay_current_input = held;
+  if (g_gmt.setup.input_injection == GMT_InputInjection_VIRTUAL) {
+    g_gmt.virtual_input = held;
+  } else {
+    GMT_Platform_SetReplayedInput(&held);
+    GMT_Platform_InjectInput(&held, &prev);
+  }
+
+  GMT_LogInfo("GMT_Record: replay started at the keyframe of frame %u (%.2f s); skipped %u input and %u signal records.",
+              (unsigned)kf->frame, kf->time, (unsigned)kf->input_count, (unsigned)kf->signal_count);
+}
+
+bool GMT_Record_VerifyKeyframe(void) {
+  uint32_t frame = GMT__WindowFrame();
+  while (g_gmt.replay_check_cursor < g_gmt.replay_check_count && g_gmt.replay_checks[g_gmt.replay_check_cursor].frame < frame) {
+    g_gmt.replay_check_cursor++;  // Passed without reaching it (wall-clock replay); nothing to compare.
+  }
+  if (g_gmt.replay_check_cursor == g_gmt.replay_check_count) {
+    g_gmt.replay_check_cursor = g_gmt.replay_check_count = 0;  // Streaming appends the next ones from the start.
+    return true;
+  }
+  const GMT_KeyframeCheck* check = &g_gmt.replay_checks[g_gmt.replay_check_cursor];
+  if (check->frame != frame) return true;
+  g_gmt.replay_check_cursor++;
+
+  if (!g_gmt.setup.snapshot_callback || !*g_gmt.setup.snapshot_callback) {
+    GMT_LogWarning("GMT_Record: verify_keyframes needs a snapshot callback; keyframe at frame %u not verified.", (unsigned)frame);
+    return true;
+  }
+  if (!g_gmt.replay_check_state) {
+    size_t capacity = g_gmt.setup.snapshot_capacity ? g_gmt.setup.snapshot_capacity : GMT_RECORD_DEFAULT_SNAPSHOT_CAPACITY;
+    if (capacity < check->state_size) capacity = check->state_size;
+    g_gmt.replay_check_state = (uint8_t*)GMT_Alloc(capacity);
+    if (!g_gmt.replay_check_state) {
+      GMT_LogWarning("GMT_Record: allocation failed for the keyframe check; keyframe at frame %u not verified.", (unsigned)frame);
+      return true;
+    }
+    g_gmt.replay_check_state_capacity = capacity;
+  }
+
+  // Saved as recording saves it, into a buffer of our own.
+  GMT_SnapshotCallback cb = *g_gmt.setup.snapshot_callback;
+  size_t size = cb(GMT_Mode_RECORD, g_gmt.replay_check_state, g_gmt.replay_check_state_capacity);
+  bool same = size == check->state_size && size <= g_gmt.replay_check_state_capacity &&
+              GMT_Hash64(g_gmt.replay_check_state, size, 0) == check->hash;
+  if (!same) {
+    GMT_LogError("GMT_Record: game state differs from the keyframe at frame %u (%u bytes recorded, %zu saved now).",
+                 (unsigned)frame, (unsigned)check->state_size, size);
+  }
+  return same;
+}
+
+bool GMT_Record_AtEndFrame(void) {
+  return g_gmt.setup.replay_end_frame > 0 && GMT__WindowFrame() >= g_gmt.setup.replay_end_frame;
+}
+
+// Recorded GMT_GetTime value of a frame: from the decoded table, or when
+// streaming from the times the window has read (frames up to data_frame).
+static double GMT__RecordedFrameTime(size_t frame) {
+  if (g_gmt.replay_streaming) return g_gmt.replay_stream.frame_times[frame % GMT_REPLAY_WINDOW_TIMES];
+  return g_gmt.replay_frame_times[frame];
+}
+
+void GMT_Record_UpdateReplayClock(void) {
+  // The clock holds while replay is blocked on a sync signal, as if those frames never ran.
+  if (g_gmt.waiting_for_signal) return;
+
+  if (!g_gmt.replay_by_frame) {
+    g_gmt.frame_time = (GMT_Platform_GetTime() - g_gmt.record_start_time) - g_gmt.replay_time_offset;
+    return;
+  }
+
+  int64_t frame = GMT_ReplayFrame();
+  if (frame < 0) frame = 0;
+  size_t last = g_gmt.replay_streaming ? g_gmt.replay_stream.data_frame : g_gmt.replay_frame_count - 1;
+  if ((size_t)frame <= last) {
+    g_gmt.frame_time = GMT__RecordedFrameTime((size_t)frame);
+    return;
   }
+  // Past the end of the recording: keep stepping at the last recorded frame length.
+  double step = (last > 0) ? GMT__RecordedFrameTime(last) - GMT__RecordedFrameTime(last - 1) : 0.0;
+  g_gmt.frame_time = GMT__RecordedFrameTime(last) + step * (double)((size_t)frame - last);
 }
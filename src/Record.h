@@ -38,29 +38,60 @@ void GMT_Record_CloseWrite(void);
 // Called once per GMT_Update in RECORD mode.
 void GMT_Record_WriteInput(void);
 
-// Same as GMT_Record_WriteInput but can be called from platform hooks (e.g. keyboard
-// LL hook) to capture key events with sub-frame accuracy. Handles its own mutex.
-// Call when a real (non-injected) key down/up is observed to avoid missing fast taps.
-void GMT_Record_WriteInputFromKeyEvent(void);
+// Records a real (non-injected) key down/up seen by a platform hook (e.g. the
+// keyboard LL hook) with sub-frame accuracy, so fast taps are not missed.  The
+// transition is queued for the next GMT_Update without taking the mutex; if no
+// queue runs the whole input is captured right away, under the mutex.
+void GMT_Record_OnKeyEvent(int key, bool down);
+
+// Starts / stops GMT_Setup.input_sample_rate sampling (InputSampler.h) for the
+// current mode.  Start runs once the clock has started; Stop before the record
+// file is closed or the replay is freed.
+void GMT_Record_StartSampling(void);
+void GMT_Record_StopSampling(void);
+
+// Injects the replay input records that came due since the last injection.
+// Called by the input sampling thread between frames; takes the mutex.
+void GMT_Record_DeliverInput(void);
+
+// Appends a TAG_FRAME record starting frame_index, stamped with frame_time.
+// Called at the end of every GMT_Update in RECORD mode.
+void GMT_Record_WriteFrame(void);
 
 // Appends a TAG_SIGNAL record for the given signal id at the current timestamp.
 // Called from GMT_SyncSignal_ in RECORD mode.
 void GMT_Record_WriteSignal(int32_t signal_id);
 
-// Appends a TAG_PIN or TAG_TRACK record with the given key, sequential index, and raw payload.
-// Called from GMT_Pin_* and GMT_Track_* in RECORD mode.
+// Stages a TAG_PIN or TAG_TRACK record with the current frame, the given key, sequential index,
+// and raw payload in the calling thread's ring.  Called from GMT_Pin_* and GMT_Track_* in
+// RECORD mode, from any thread, without the mutex (it is taken only if the ring is full).
 void GMT_Record_WriteDataRecord(uint8_t tag, unsigned int key, unsigned int index, const void* data, size_t size);
 
-// Searches a decoded pin/track array for an entry matching (key, index).
-// Returns a pointer to the matching GMT_DecodedDataRecord, or NULL if not found.
-GMT_DecodedDataRecord* GMT_Record_FindDecoded(GMT_DecodedDataRecord* arr, size_t count, unsigned int key, unsigned int index);
-
-// Loads the test file and decodes all input and signal records into g_gmt arrays.
-// Allocates replay_inputs and replay_signals via GMT_Alloc.
+// Appends every record staged by GMT_Record_WriteDataRecord to the record stream, thread by
+// thread.  Called with the mutex held at frame boundaries (GMT_Update_) and before the file
+// is measured or closed.
+void GMT_Record_MergeThreadRecords(void);
+
+// Looks up the entry recorded in the current frame with the given (key, index) in a decoded
+// pin/track table: first at the calling thread's cursor, then through the table's hash index.
+// If found, sets *out_size to the recorded size, copies the payload to out_data when that
+// size equals `size` (out_data is left untouched otherwise) and returns true.
+// Safe to call from any thread.  Lock-free while the table is read-only; a streaming window
+// is looked up with the mutex held.
+bool GMT_Record_FindDecoded(GMT_DecodedDataTable* table, unsigned int key, unsigned int index, void* out_data, uint32_t size, uint32_t* out_size);
+
+// Memory-maps the test file (or reads it when mapping is unavailable) and indexes its records
+// in place: replay_inputs, replay_pins and replay_tracks hold offsets into the file image rather
+// than copies of the payloads.  Also builds the (frame, key, index) hash indices used by
+// GMT_Record_FindDecoded.  With GMT_Setup.stream_replay it only opens the file for streaming
+// instead (see GMT_ReplayStream); records are then decoded as replay reaches them.
+// On failure everything loaded so far is released.
+// Accepts the current format version and all older ones.
 // Called during GMT_Init when mode == GMT_Mode_REPLAY.
 bool GMT_Record_LoadReplay(void);
 
-// Frees replay_inputs and replay_signals if allocated.
+// Frees the decoded replay arrays and their indices and releases the file image
+// (or closes the streaming readers).
 // Called during GMT_Quit when mode == GMT_Mode_REPLAY.
 void GMT_Record_FreeReplay(void);
 
@@ -69,6 +100,37 @@ void GMT_Record_FreeReplay(void);
 // Called once per GMT_Update in REPLAY mode.
 void GMT_Record_InjectInput(void);
 
+// Next recorded sync signal the game is expected to fire, or NULL once all of them
+// have been.  GMT_Record_NextSignal consumes it.  Call with the mutex held.
+const GMT_DecodedSignal* GMT_Record_PeekSignal(void);
+void GMT_Record_NextSignal(void);
+
+// Streaming replay: drops the pins/tracks of frames replay has left behind and
+// decodes those of the next few frames.  No-op otherwise.
+// Called with the mutex held at the end of every GMT_Update in REPLAY mode.
+void GMT_Record_RefillReplayWindow(void);
+
+// Starts replay at the keyframe chosen by GMT_Record_LoadReplay: restores the game
+// state through the snapshot callback, injects the keyframe's input state and
+// moves the replay frame and clock to it.  Called by the first GMT_Update in
+// REPLAY mode, instead of GMT_Record_InjectInput, while replay_keyframe_pending.
+void GMT_Record_ApplyKeyframe(void);
+
+// GMT_Setup.verify_keyframes: when the frame about to run has a recorded keyframe,
+// saves the live game state through the snapshot callback and compares it with
+// the keyframe's.  Returns false (after logging) if they differ.
+// Called with the mutex held at the end of every GMT_Update in REPLAY mode.
+bool GMT_Record_VerifyKeyframe(void);
+
+// True once the frame about to run is at or past GMT_Setup.replay_end_frame (never
+// when it is 0).  Call with the mutex held.
+bool GMT_Record_AtEndFrame(void);
+
+// Sets frame_time for the frame about to run: the recorded frame time under
+// GMT_ReplayTiming_FRAME, else the replay clock.  Held while waiting for a sync signal.
+// Called at the end of every GMT_Update in REPLAY mode.
+void GMT_Record_UpdateReplayClock(void);
+
 // Returns metrics computed from the currently loaded replay data (g_gmt arrays).
 // Call only after a successful GMT_Record_LoadReplay.
 GMT_FileMetrics GMT_Record_GetReplayMetrics(void);
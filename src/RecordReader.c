@@ -0,0 +1,324 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "RecordReader.h"
+#include "Internal.h"
+#include "Compress.h"
+#include <string.h>
+
+// ===== Record framing =====
+
+size_t GMT_Record_HeadSize(uint8_t tag, uint16_t version) {
+  switch (tag) {
+    case GMT_RECORD_TAG_INPUT:
+      return sizeof(GMT_RawInputRecord);
+    case GMT_RECORD_TAG_SIGNAL:
+      return sizeof(GMT_RawSignalRecord);
+    case GMT_RECORD_TAG_PIN:
+    case GMT_RECORD_TAG_TRACK:
+      return (version >= 1) ? sizeof(GMT_RawDataRecordHeader) : sizeof(GMT_RawDataRecordHeaderV0);
+    case GMT_RECORD_TAG_INPUT_DELTA:
+      return (version >= 2) ? sizeof(GMT_RawInputDeltaHeader) : 0;
+    case GMT_RECORD_TAG_BLOCK:
+      return (version >= 2) ? sizeof(GMT_RawBlockHeader) : 0;
+    case GMT_RECORD_TAG_FRAME:
+      return (version >= 3) ? sizeof(GMT_RawFrameRecord) : 0;
+    case GMT_RECORD_TAG_KEYFRAME:
+      return (version >= 4) ? sizeof(GMT_RawKeyframeHeader) : 0;
+    default:
+      return 0;
+  }
+}
+
+size_t GMT_Record_BodySize(uint8_t tag, const uint8_t* head, uint16_t version) {
+  size_t head_size = GMT_Record_HeadSize(tag, version);
+  switch (tag) {
+    case GMT_RECORD_TAG_PIN:
+    case GMT_RECORD_TAG_TRACK: {
+      // `size` is the last field of both header layouts.
+      uint32_t size;
+      memcpy(&size, head + head_size - sizeof(size), sizeof(size));
+      return head_size + size;
+    }
+    case GMT_RECORD_TAG_INPUT_DELTA: {
+      GMT_RawInputDeltaHeader dh;
+      memcpy(&dh, head, sizeof(dh));
+      return head_size + dh.size;
+    }
+    case GMT_RECORD_TAG_BLOCK: {
+      GMT_RawBlockHeader bh;
+      memcpy(&bh, head, sizeof(bh));
+      return head_size + bh.stored_size;
+    }
+    case GMT_RECORD_TAG_KEYFRAME: {
+      GMT_RawKeyframeHeader kh;
+      memcpy(&kh, head, sizeof(kh));
+      return head_size + sizeof(GMT_InputState) + kh.state_size;
+    }
+    default:
+      return head_size;
+  }
+}
+
+const char* GMT_Record_TagName(uint8_t tag) {
+  switch (tag) {
+    case GMT_RECORD_TAG_INPUT:       return "input";
+    case GMT_RECORD_TAG_SIGNAL:      return "signal";
+    case GMT_RECORD_TAG_PIN:         return "pin";
+    case GMT_RECORD_TAG_TRACK:       return "track";
+    case GMT_RECORD_TAG_INPUT_DELTA: return "input delta";
+    case GMT_RECORD_TAG_BLOCK:       return "block";
+    case GMT_RECORD_TAG_FRAME:       return "frame";
+    case GMT_RECORD_TAG_KEYFRAME:    return "keyframe";
+    default:                         return "unknown";
+  }
+}
+
+// ===== Raw file bytes =====
+
+// Stream offsets past 2 GB need the 64-bit seek on Windows.
+#ifdef _WIN32
+#  define GMT__FSeek(f, off) _fseeki64((f), (__int64)(off), SEEK_SET)
+#else
+#  define GMT__FSeek(f, off) fseek((f), (long)(off), SEEK_SET)
+#endif
+
+static bool GMT__FillRaw(GMT_RecordReader* r) {
+  r->io_pos = 0;
+  r->io_len = fread(r->io, 1, GMT_RECORD_READER_BUFFER_SIZE, r->file);
+  return r->io_len > 0;
+}
+
+// Copies the next `n` raw file bytes to dst (skips them if dst is NULL).
+// Returns false if the file ends first.
+static bool GMT__ReadRaw(GMT_RecordReader* r, void* dst, size_t n) {
+  uint8_t* out = (uint8_t*)dst;
+  while (n > 0) {
+    if (r->io_pos == r->io_len && !GMT__FillRaw(r)) return false;
+    size_t chunk = r->io_len - r->io_pos;
+    if (chunk > n) chunk = n;
+    if (out) {
+      memcpy(out, r->io + r->io_pos, chunk);
+      out += chunk;
+    }
+    r->io_pos += chunk;
+    n -= chunk;
+  }
+  return true;
+}
+
+// Next raw byte without consuming it; false at the end of the file.
+static bool GMT__PeekRaw(GMT_RecordReader* r, uint8_t* out) {
+  if (r->io_pos == r->io_len && !GMT__FillRaw(r)) return false;
+  *out = r->io[r->io_pos];
+  return true;
+}
+
+// ===== Blocks =====
+
+// Reads the TAG_BLOCK at the raw position, if there is one, into r->block.
+// Returns false at the end of the stream and on errors (`failed` set).
+static bool GMT__LoadBlock(GMT_RecordReader* r) {
+  uint8_t tag;
+  if (!GMT__PeekRaw(r, &tag) || tag != GMT_RECORD_TAG_BLOCK) return false;  // TAG_END, or an unclosed file.
+  GMT__ReadRaw(r, NULL, 1);
+
+  GMT_RawBlockHeader bh;
+  if (!GMT__ReadRaw(r, &bh, sizeof(bh))) goto truncated;
+  if (bh.raw_size > GMT_RECORD_BLOCK_SIZE || bh.stored_size > bh.raw_size) {
+    GMT_LogError("GMT_Record: invalid block record.");
+    r->failed = true;
+    return false;
+  }
+  if (bh.stored_size == bh.raw_size) {
+    if (!GMT__ReadRaw(r, r->block, bh.raw_size)) goto truncated;
+  } else {
+    if (!GMT__ReadRaw(r, r->block_stored, bh.stored_size)) goto truncated;
+    if (!GMT_Decompress(r->block_stored, bh.stored_size, r->block, bh.raw_size)) {
+      GMT_LogError("GMT_Record: corrupt compressed block.");
+      r->failed = true;
+      return false;
+    }
+  }
+  r->block_pos = 0;
+  r->block_len = bh.raw_size;
+  return true;
+
+truncated:
+  GMT_LogError("GMT_Record: truncated block record.");
+  r->failed = true;
+  return false;
+}
+
+// Copies the next `n` bytes of the record stream to dst (skips them if dst is NULL).
+// Returns false if the stream ends first or a block cannot be read.
+static bool GMT__ReadStream(GMT_RecordReader* r, void* dst, size_t n) {
+  if (!r->blocks) {
+    if (!GMT__ReadRaw(r, dst, n)) return false;
+    r->offset += n;
+    return true;
+  }
+  uint8_t* out = (uint8_t*)dst;
+  while (n > 0) {
+    if (r->block_pos == r->block_len && !GMT__LoadBlock(r)) return false;
+    size_t chunk = r->block_len - r->block_pos;
+    if (chunk > n) chunk = n;
+    if (out) {
+      memcpy(out, r->block + r->block_pos, chunk);
+      out += chunk;
+    }
+    r->block_pos += chunk;
+    r->offset += chunk;
+    n -= chunk;
+  }
+  return true;
+}
+
+// ===== Reader =====
+
+bool GMT_RecordReader_Open(GMT_RecordReader* r, const char* path) {
+  memset(r, 0, sizeof(*r));
+  r->file = fopen(path, "rb");
+  if (!r->file) {
+    GMT_LogError("GMT_Record: failed to open test file.");
+    return false;
+  }
+  r->io = (uint8_t*)GMT_Alloc(GMT_RECORD_READER_BUFFER_SIZE);
+  if (!r->io) {
+    GMT_LogError("GMT_Record: allocation failed for the test file reader.");
+    goto fail;
+  }
+
+  GMT_FileHeader hdr;
+  if (!GMT__ReadRaw(r, &hdr, sizeof(hdr))) {
+    GMT_LogError("GMT_Record: test file is too small to contain a valid header.");
+    goto fail;
+  }
+  if (hdr.magic != GMT_RECORD_MAGIC) {
+    GMT_LogError("GMT_Record: invalid file magic.");
+    goto fail;
+  }
+  if (hdr.version > GMT_RECORD_VERSION) {
+    GMT_LogError("GMT_Record: unsupported file version.");
+    goto fail;
+  }
+  r->version = hdr.version;
+  r->offset = sizeof(hdr);
+
+  // The writer puts either every record in blocks or none.
+  uint8_t first;
+  r->blocks = hdr.version >= 2 && GMT__PeekRaw(r, &first) && first == GMT_RECORD_TAG_BLOCK;
+  if (r->blocks) {
+    r->block = (uint8_t*)GMT_Alloc(GMT_RECORD_BLOCK_SIZE);
+    r->block_stored = (uint8_t*)GMT_Alloc(GMT_RECORD_BLOCK_SIZE);
+    if (!r->block || !r->block_stored) {
+      GMT_LogError("GMT_Record: allocation failed for the test file reader.");
+      goto fail;
+    }
+  }
+  return true;
+
+fail:
+  GMT_RecordReader_Close(r);
+  return false;
+}
+
+void GMT_RecordReader_Close(GMT_RecordReader* r) {
+  if (r->file) fclose(r->file);
+  if (r->io) GMT_Free(r->io);
+  if (r->block) GMT_Free(r->block);
+  if (r->block_stored) GMT_Free(r->block_stored);
+  if (r->record) GMT_Free(r->record);
+  memset(r, 0, sizeof(*r));
+}
+
+bool GMT_RecordReader_Seek(GMT_RecordReader* r, uint64_t offset) {
+  if (!r->blocks) {
+    if (GMT__FSeek(r->file, offset) != 0) {
+      GMT_LogError("GMT_Record: failed to seek in test file.");
+      r->failed = true;
+      return false;
+    }
+    r->io_pos = 0;
+    r->io_len = 0;
+    r->offset = offset;
+    r->ended = false;
+    return true;
+  }
+  if (offset < r->offset || !GMT__ReadStream(r, NULL, (size_t)(offset - r->offset))) {
+    GMT_LogError("GMT_Record: seek target outside the record stream.");
+    r->failed = true;
+    return false;
+  }
+  return true;
+}
+
+bool GMT_RecordReader_Next(GMT_RecordReader* r, uint8_t* out_tag, const uint8_t** out_body, size_t* out_size) {
+  if (r->failed || r->ended) return false;
+  r->record_offset = r->offset;
+
+  uint8_t tag;
+  if (!GMT__ReadStream(r, &tag, 1) || tag == GMT_RECORD_TAG_END) {
+    r->ended = !r->failed;
+    return false;
+  }
+  size_t head = GMT_Record_HeadSize(tag, r->version);
+  if (head == 0 || tag == GMT_RECORD_TAG_BLOCK) {
+    GMT_LogError(tag == GMT_RECORD_TAG_BLOCK ? "GMT_Record: nested block record." : "GMT_Record: unknown tag in test file.");
+    r->failed = true;
+    return false;
+  }
+
+  // Head first, then the rest once its length is known.
+  if (r->record_capacity < head) {
+    uint8_t* grown = (uint8_t*)GMT_Realloc(r->record, head);
+    if (!grown) goto no_memory;
+    r->record = grown;
+    r->record_capacity = head;
+  }
+  if (!GMT__ReadStream(r, r->record, head)) goto truncated;
+  size_t size = GMT_Record_BodySize(tag, r->record, r->version);
+  if (r->record_capacity < size) {
+    uint8_t* grown = (uint8_t*)GMT_Realloc(r->record, size);
+    if (!grown) goto no_memory;
+    r->record = grown;
+    r->record_capacity = size;
+  }
+  if (!GMT__ReadStream(r, r->record + head, size - head)) goto truncated;
+
+  *out_tag = tag;
+  *out_body = r->record;
+  *out_size = size;
+  return true;
+
+truncated:
+  if (!r->failed) GMT_LogError("GMT_Record: truncated %s record.", GMT_Record_TagName(tag));
+  r->failed = true;
+  return false;
+
+no_memory:
+  GMT_LogError("GMT_Record: allocation failed for a %s record.", GMT_Record_TagName(tag));
+  r->failed = true;
+  return false;
+}
@@ -0,0 +1,93 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Sequential reader over the record stream of a test file, holding only a few
+// fixed-size buffers however long the file is.  TAG_BLOCKs are expanded as they
+// are reached, so callers see the same records, at the same stream offsets, as
+// GMT_Record_LoadReplay does after expanding the whole file.  Used by streaming
+// replay (GMT_Setup.stream_replay), which keeps several readers on one file.
+
+#define GMT_RECORD_READER_BUFFER_SIZE (64u * 1024u)  // Bytes read from the file at a time.
+
+typedef struct GMT_RecordReader {
+  FILE* file;
+  uint16_t version;  // From the file header.
+  bool blocks;       // The record stream is stored in TAG_BLOCKs.
+  bool ended;        // TAG_END or the end of the file was reached.
+  bool failed;       // A read error or malformed record was reported; Next returns false.
+
+  // Raw file bytes.
+  uint8_t* io;
+  size_t io_pos;
+  size_t io_len;
+
+  // Expanded contents of the TAG_BLOCK being read (block mode only).
+  uint8_t* block;
+  uint8_t* block_stored;  // Compressed bytes of the block.
+  size_t block_pos;
+  size_t block_len;
+
+  uint64_t offset;         // Stream offset of the next byte, counted from the start of the file.
+  uint64_t record_offset;  // Stream offset of the tag of the record last returned.
+
+  // Body of the record last returned, grown to the largest record read.
+  uint8_t* record;
+  size_t record_capacity;
+} GMT_RecordReader;
+
+// Opens `path`, checks its header and positions the reader at the first record.
+// Logs and returns false (with *r zeroed) on failure.
+bool GMT_RecordReader_Open(GMT_RecordReader* r, const char* path);
+
+// Closes the file and frees the buffers.  Safe on a zeroed reader.
+void GMT_RecordReader_Close(GMT_RecordReader* r);
+
+// Moves to the record whose tag is at stream offset `offset`.  Uncompressed files
+// seek directly; compressed ones can only move forward, by expanding the blocks
+// in between.  Logs and returns false on failure.
+bool GMT_RecordReader_Seek(GMT_RecordReader* r, uint64_t offset);
+
+// Reads the next record.  *out_body points at its `*out_size` body bytes (no tag)
+// and stays valid until the next call.  Returns false at TAG_END or at the end of
+// the file, and on errors, which are logged and set `failed`.
+bool GMT_RecordReader_Next(GMT_RecordReader* r, uint8_t* out_tag, const uint8_t** out_body, size_t* out_size);
+
+// ===== Record framing, shared with the in-memory loader =====
+
+// Length of the fixed part of a record body, which holds everything needed to
+// know its full length.  0 for tags the file version does not define.
+size_t GMT_Record_HeadSize(uint8_t tag, uint16_t version);
+
+// Full body length of a record whose first GMT_Record_HeadSize bytes are at `head`.
+size_t GMT_Record_BodySize(uint8_t tag, const uint8_t* head, uint16_t version);
+
+// Record kind for log messages ("input", "pin", ...).
+const char* GMT_Record_TagName(uint8_t tag);
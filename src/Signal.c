@@ -37,30 +37,40 @@ void GMT_SyncSignal_(int id, GMT_CodeLocation loc) {
       GMT_Record_WriteSignal((int32_t)id);
       break;
 
-    case GMT_Mode_REPLAY:
+    case GMT_Mode_REPLAY: {
       // Advance the signal cursor whenever the game emits the next expected signal,
       // regardless of whether the injection gate has been set yet.  This handles
       // signals that fire before the first GMT_Update call (e.g. an "Init" signal
       // placed before the main loop), where waiting_for_signal would never be set
       // when the game fires it, causing a permanent deadlock.
-      if (g_gmt.replay_signal_cursor >= g_gmt.replay_signal_count) {
+      const GMT_DecodedSignal* next = g_gmt.replay_keyframe_pending ? NULL : GMT_Record_PeekSignal();
+      if (g_gmt.replay_keyframe_pending) {
+        // Replay starts at a keyframe on the first GMT_Update; signals recorded
+        // before it were skipped, so startup signals have nothing to match.
+        GMT_LogInfo("GMT_SyncSignal: signal id %d fired before replay reached its start keyframe; ignored.", id);
+
+      } else if (!next) {
         GMT_LogWarning("GMT_SyncSignal: signal id %d has no corresponding recorded entry (all %zu recorded signals already consumed); ignored.",
                        id,
-                       g_gmt.replay_signal_count);
+                       g_gmt.replay_signal_cursor);
 
-      } else if (g_gmt.replay_signals[g_gmt.replay_signal_cursor].signal_id != id) {
+      } else if (next->signal_id != id) {
         GMT_LogWarning("GMT_SyncSignal: signal id %d does not match next expected id %d at cursor %zu; ignored.",
                        id,
-                       g_gmt.replay_signals[g_gmt.replay_signal_cursor].signal_id,
+                       next->signal_id,
                        g_gmt.replay_signal_cursor);
       } else {
         double now = GMT_Platform_GetTime();
-        double st = g_gmt.replay_signals[g_gmt.replay_signal_cursor].timestamp;
+        double st = next->timestamp;
+        uint32_t sf = next->frame;
         if (g_gmt.waiting_for_signal && g_gmt.waiting_signal_id == id) {
           // Normal (late) case: the injection gate was set because the replay engine
           // already reached the signal's timestamp, and the game is now catching up.
           // Offset by how long we waited so subsequent timestamps stay consistent.
           g_gmt.replay_time_offset += (now - g_gmt.signal_wait_start);
+          GMT_Atomic_Add64(&g_gmt.replay_frame_offset, g_gmt.frame_index - g_gmt.signal_wait_frame);
+          GMT_Profile_SignalWaitEnd(id, g_gmt.frame_index - g_gmt.signal_wait_frame);
+          g_gmt.waiting_for_signal = false;
         } else {
           // Early case: game fired the signal before replay reached its recorded
           // timestamp (e.g. an "Init" signal before the main loop).  Align the
@@ -68,11 +78,16 @@ void GMT_SyncSignal_(int id, GMT_CodeLocation loc) {
           // input records inject at the correct time relative to this sync point.
           double replay_time_now = (now - g_gmt.record_start_time) - g_gmt.replay_time_offset;
           g_gmt.replay_time_offset += (replay_time_now - st);
+          // Same for the frame position used by GMT_ReplayTiming_FRAME.
+          if (sf != GMT_RECORD_FRAME_ANY) {
+            GMT_Atomic_Add64(&g_gmt.replay_frame_offset, (uint64_t)(GMT_ReplayFrame() - (int64_t)sf));
+          }
         }
 
-        g_gmt.replay_signal_cursor++;
+        GMT_Record_NextSignal();
       }
       break;
+    }
   }
 
   // Fire user callback (pointer to function pointer; read through it).
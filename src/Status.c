@@ -0,0 +1,75 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Internal.h"
+#include <string.h>
+
+// Field meanings are documented on GMT_StatusBlock (Internal.h).
+
+void GMT_Status_Open(void) {
+  const char* name = g_gmt.setup.status_name;
+  if (!name || name[0] == '\0') return;
+  if (g_gmt.context) {
+    GMT_LogWarning("status_name is per process; ignored for a context.");
+    return;
+  }
+
+  GMT_StatusBlock* status = (GMT_StatusBlock*)GMT_Platform_OpenSharedMemory(name, sizeof(GMT_StatusBlock));
+  if (!status) {
+    // Only the tool's progress display and stall checks depend on it.
+    GMT_LogWarning("Failed to open the status block %s; progress is not published.", name);
+    return;
+  }
+  memset(status, 0, sizeof(*status));
+  status->version = GMT_STATUS_VERSION;
+  GMT_Atomic_Store32(&status->magic, GMT_STATUS_MAGIC);
+  g_gmt.status = status;
+  GMT_LogInfo("Publishing status to %s", name);
+}
+
+void GMT_Status_Close(void) {
+  if (!g_gmt.status) return;
+  GMT_Status_Update();
+  GMT_Platform_CloseSharedMemory(g_gmt.status);
+  g_gmt.status = NULL;
+}
+
+void GMT_Status_Update(void) {
+  GMT_StatusBlock* status = g_gmt.status;
+  if (!status) return;
+
+  // GMT_Fail sets GMT_STATUS_FLAG_FAILED and GMT_ResetTo clears it.
+  uint32_t flags = GMT_Atomic_Load32(&status->flags) & GMT_STATUS_FLAG_FAILED;
+  if (g_gmt.waiting_for_signal) flags |= GMT_STATUS_FLAG_WAITING;
+
+  status->frame_index = g_gmt.frame_index;
+  status->input_cursor = g_gmt.replay_input_cursor;
+  status->input_count = g_gmt.replay_input_count;
+  status->waiting_signal_id = g_gmt.waiting_signal_id;
+  status->failed_assertions = (uint32_t)g_gmt.assertion_fire_count;
+  status->frame_time = g_gmt.frame_time;
+  GMT_Atomic_Store32(&status->flags, flags);
+  // The tool takes a heartbeat that stops moving for a hung frame.
+  GMT_Atomic_Add32(&status->heartbeat, 1);
+}
@@ -0,0 +1,447 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "Internal.h"
+#include "Compress.h"
+#include <string.h>
+
+// ===== Trailer =====
+
+typedef struct GMT__Trailer {
+  uint64_t file_size;
+  uint64_t size;  // Summary and keyframe index.
+  bool has_summary;
+  GMT_RawRecordSummary summary;
+  uint32_t keyframe_count;  // Entries in the keyframe index; 0 without one.
+} GMT__Trailer;
+
+// Finds the keyframe index and the summary from the end of the file, as
+// GameTest-Tool does.  A damaged index is treated as absent.
+static bool GMT__ReadTrailer(const char* path, GMT__Trailer* t) {
+  memset(t, 0, sizeof(*t));
+  FILE* f = fopen(path, "rb");
+  if (!f) {
+    GMT_LogError("GMT_TestFile: failed to open %s.", path);
+    return false;
+  }
+  long total = (fseek(f, 0, SEEK_END) == 0) ? ftell(f) : -1;
+  if (total < 0) total = 0;
+  t->file_size = (uint64_t)total;
+
+  long end = total;
+  long min_size = (long)(sizeof(GMT_FileHeader) + 1);  // + TAG_END
+  GMT_RawKeyframeIndexFooter footer;
+  if (end >= min_size + (long)sizeof(footer) && fseek(f, end - (long)sizeof(footer), SEEK_SET) == 0 &&
+      fread(&footer, sizeof(footer), 1, f) == 1 && footer.magic == GMT_RECORD_INDEX_MAGIC &&
+      footer.count <= (uint64_t)(end - min_size - (long)sizeof(footer)) / sizeof(GMT_RawKeyframeIndexEntry)) {
+    t->keyframe_count = footer.count;
+    end -= (long)(sizeof(footer) + (size_t)footer.count * sizeof(GMT_RawKeyframeIndexEntry));
+  }
+
+  GMT_RawRecordSummary summary;
+  if (end >= min_size + (long)sizeof(summary) && fseek(f, end - (long)sizeof(summary), SEEK_SET) == 0 &&
+      fread(&summary, sizeof(summary), 1, f) == 1 && summary.magic == GMT_RECORD_SUMMARY_MAGIC) {
+    t->has_summary = true;
+    t->summary = summary;
+    end -= (long)sizeof(summary);
+  }
+  t->size = (uint64_t)(total - end);
+  fclose(f);
+  return true;
+}
+
+// ===== Record walking =====
+
+static bool GMT__RecordKind(uint8_t tag, GMT_TestFileRecord* out_kind) {
+  switch (tag) {
+    case GMT_RECORD_TAG_INPUT:       *out_kind = GMT_TestFileRecord_INPUT; return true;
+    case GMT_RECORD_TAG_INPUT_DELTA: *out_kind = GMT_TestFileRecord_INPUT_DELTA; return true;
+    case GMT_RECORD_TAG_SIGNAL:      *out_kind = GMT_TestFileRecord_SIGNAL; return true;
+    case GMT_RECORD_TAG_PIN:         *out_kind = GMT_TestFileRecord_PIN; return true;
+    case GMT_RECORD_TAG_TRACK:       *out_kind = GMT_TestFileRecord_TRACK; return true;
+    case GMT_RECORD_TAG_FRAME:       *out_kind = GMT_TestFileRecord_FRAME; return true;
+    case GMT_RECORD_TAG_KEYFRAME:    *out_kind = GMT_TestFileRecord_KEYFRAME; return true;
+    default:                         return false;
+  }
+}
+
+// Running state of a pass over the records of one file.
+typedef struct GMT__Walk {
+  GMT_InputState input;  // State after the last input record, as replay rebuilds it.
+  GMT_InputState prev;   // State before it.
+  bool redundant;        // The last input record repeats `prev`.
+  double time;           // Timestamp or frame time of the last record that has one.
+  double timestamp;      // Latest such time seen.
+  uint32_t frame;        // Last TAG_FRAME.
+} GMT__Walk;
+
+// Tracks the input state and clock through one record.  Logs and returns false
+// for a malformed input delta.
+static bool GMT__WalkRecord(GMT__Walk* walk, uint8_t tag, const uint8_t* body, size_t size) {
+  double time = walk->timestamp;
+  if (tag == GMT_RECORD_TAG_INPUT || tag == GMT_RECORD_TAG_INPUT_DELTA) {
+    walk->prev = walk->input;
+    if (tag == GMT_RECORD_TAG_INPUT) {
+      GMT_RawInputRecord rec;
+      memcpy(&rec, body, sizeof(rec));
+      walk->input = rec.input;
+      time = rec.timestamp;
+    } else {
+      GMT_RawInputDeltaHeader hdr;
+      memcpy(&hdr, body, sizeof(hdr));
+      if (!GMT_InputState_ApplyDelta(&walk->input, body + sizeof(hdr), size - sizeof(hdr))) {
+        GMT_LogError("GMT_TestFile: corrupt input delta record.");
+        return false;
+      }
+      time = hdr.timestamp;
+    }
+    // Wheel deltas and key repeats are injected again by every record that
+    // carries them, so such a record is never a plain repeat.
+    GMT_KeyMask repeats;
+    GMT_InputState_RepeatingKeys(&walk->input, &repeats);
+    walk->redundant = GMT_InputState_Compare(&walk->prev, &walk->input) && walk->input.mouse_wheel_x == 0 &&
+                      walk->input.mouse_wheel_y == 0 && !GMT_KeyMask_Any(&repeats);
+  } else if (tag == GMT_RECORD_TAG_SIGNAL) {
+    GMT_RawSignalRecord rec;
+    memcpy(&rec, body, sizeof(rec));
+    time = rec.timestamp;
+  } else if (tag == GMT_RECORD_TAG_FRAME) {
+    GMT_RawFrameRecord rec;
+    memcpy(&rec, body, sizeof(rec));
+    walk->frame = rec.frame;
+    time = rec.time;
+  }
+  walk->time = time;
+  if (time > walk->timestamp) walk->timestamp = time;
+  return true;
+}
+
+const char* GMT_TestFileRecordName(GMT_TestFileRecord kind) {
+  switch (kind) {
+    case GMT_TestFileRecord_INPUT:       return "input";
+    case GMT_TestFileRecord_INPUT_DELTA: return "input delta";
+    case GMT_TestFileRecord_SIGNAL:      return "signal";
+    case GMT_TestFileRecord_PIN:         return "pin";
+    case GMT_TestFileRecord_TRACK:       return "track";
+    case GMT_TestFileRecord_FRAME:       return "frame";
+    case GMT_TestFileRecord_KEYFRAME:    return "keyframe";
+    default:                             return "unknown";
+  }
+}
+
+bool GMT_ReadTestFileStats(const char* path, GMT_TestFileStats* out_stats) {
+  if (!out_stats) return false;
+  memset(out_stats, 0, sizeof(*out_stats));
+  if (!path || path[0] == '\0') return false;
+
+  GMT__Trailer trailer;
+  if (!GMT__ReadTrailer(path, &trailer)) return false;
+
+  GMT_RecordReader r;
+  if (!GMT_RecordReader_Open(&r, path)) {
+    GMT_LogError("GMT_TestFile: failed to read %s.", path);
+    return false;
+  }
+
+  GMT__Walk walk;
+  memset(&walk, 0, sizeof(walk));
+  bool ok = true;
+  uint8_t tag;
+  const uint8_t* body;
+  size_t size;
+  while (GMT_RecordReader_Next(&r, &tag, &body, &size)) {
+    if (!GMT__WalkRecord(&walk, tag, body, size)) {
+      ok = false;
+      break;
+    }
+    GMT_TestFileRecord kind;
+    if (GMT__RecordKind(tag, &kind)) {
+      out_stats->records[kind].count++;
+      out_stats->records[kind].bytes += 1 + size;
+    }
+    if ((tag == GMT_RECORD_TAG_INPUT || tag == GMT_RECORD_TAG_INPUT_DELTA) && walk.redundant) out_stats->redundant_inputs++;
+  }
+  if (r.failed) ok = false;
+
+  out_stats->version = r.version;
+  out_stats->compressed = r.blocks;
+  out_stats->has_summary = trailer.has_summary;
+  out_stats->has_keyframe_index = trailer.keyframe_count > 0;
+  out_stats->frame_count = trailer.has_summary ? trailer.summary.frame_count : walk.frame;
+  out_stats->duration = trailer.has_summary ? trailer.summary.duration : walk.timestamp;
+  out_stats->file_size = trailer.file_size;
+  out_stats->stream_size = r.record_offset + 1;  // Through TAG_END.
+  out_stats->trailer_size = trailer.size;
+  GMT_RecordReader_Close(&r);
+
+  if (!ok) GMT_LogError("GMT_TestFile: failed to read %s.", path);
+  return ok;
+}
+
+bool GMT_ReadTestFileKeyframes(const char* path, uint32_t* out_frames, size_t max_frames, size_t* out_count) {
+  if (!out_count) return false;
+  *out_count = 0;
+  if (!path || path[0] == '\0') return false;
+
+  // Walked rather than taken from the index, which a file that was not closed lacks.
+  GMT_RecordReader r;
+  if (!GMT_RecordReader_Open(&r, path)) {
+    GMT_LogError("GMT_TestFile: failed to read %s.", path);
+    return false;
+  }
+  uint8_t tag;
+  const uint8_t* body;
+  size_t size;
+  while (GMT_RecordReader_Next(&r, &tag, &body, &size)) {
+    if (tag != GMT_RECORD_TAG_KEYFRAME) continue;
+    GMT_RawKeyframeHeader kh;
+    memcpy(&kh, body, sizeof(kh));
+    if (out_frames && *out_count < max_frames) out_frames[*out_count] = kh.frame;
+    (*out_count)++;
+  }
+  bool ok = !r.failed;
+  GMT_RecordReader_Close(&r);
+
+  if (!ok) GMT_LogError("GMT_TestFile: failed to read %s.", path);
+  return ok;
+}
+
+// ===== Rewriting =====
+
+// Output side of GMT_RewriteTestFile: the TAG_BLOCK packing of GMT_Record,
+// without the writer thread.
+typedef struct GMT__FileWriter {
+  FILE* file;
+  uint8_t* block;      // Pending TAG_BLOCK contents; NULL when records are written directly.
+  uint8_t* block_out;  // Compressed copy of `block`.
+  size_t block_used;
+  uint64_t offset;  // Stream offset of the next byte, counted from the start of the file.
+
+  GMT_RawKeyframeIndexEntry* keyframes;
+  size_t keyframe_count;
+  size_t keyframe_capacity;
+} GMT__FileWriter;
+
+static void GMT__FileWriter_FlushBlock(GMT__FileWriter* w) {
+  if (!w->block || w->block_used == 0) return;
+
+  size_t raw_size = w->block_used;
+  size_t packed = GMT_Compress(w->block, raw_size, w->block_out, GMT_COMPRESS_BOUND(GMT_RECORD_BLOCK_SIZE));
+  bool compressed = packed > 0 && packed < raw_size;
+
+  GMT_RawBlockHeader hdr;
+  hdr.raw_size = (uint32_t)raw_size;
+  hdr.stored_size = (uint32_t)(compressed ? packed : raw_size);
+
+  uint8_t tag = GMT_RECORD_TAG_BLOCK;
+  fwrite(&tag, 1, 1, w->file);
+  fwrite(&hdr, sizeof(hdr), 1, w->file);
+  fwrite(compressed ? w->block_out : w->block, 1, hdr.stored_size, w->file);
+  w->block_used = 0;
+}
+
+static void GMT__FileWriter_Sink(GMT__FileWriter* w, const void* data, size_t size) {
+  const uint8_t* bytes = (const uint8_t*)data;
+  w->offset += size;
+  if (!w->block) {
+    fwrite(bytes, 1, size, w->file);
+    return;
+  }
+  while (size > 0) {
+    size_t room = GMT_RECORD_BLOCK_SIZE - w->block_used;
+    size_t chunk = (size < room) ? size : room;
+    memcpy(w->block + w->block_used, bytes, chunk);
+    w->block_used += chunk;
+    bytes += chunk;
+    size -= chunk;
+    if (w->block_used == GMT_RECORD_BLOCK_SIZE) GMT__FileWriter_FlushBlock(w);
+  }
+}
+
+static void GMT__FileWriter_Emit(GMT__FileWriter* w, uint8_t tag, const void* head, size_t head_size, const void* body, size_t body_size) {
+  GMT__FileWriter_Sink(w, &tag, 1);
+  GMT__FileWriter_Sink(w, head, head_size);
+  if (body_size > 0) GMT__FileWriter_Sink(w, body, body_size);
+}
+
+// Writes an input state the way GMT_Record does: as a TAG_INPUT_DELTA against
+// `prev` when the version has them and that is smaller, else as a TAG_INPUT.
+static void GMT__FileWriter_EmitInput(GMT__FileWriter* w, uint16_t version, const GMT_InputState* prev, const GMT_InputState* input, double timestamp) {
+  if (version >= 2) {
+    uint8_t delta[GMT_INPUT_DELTA_MAX_SIZE];
+    size_t delta_size = GMT_InputState_EncodeDelta(prev, input, delta);
+    if (delta_size > 0 && delta_size + sizeof(GMT_RawInputDeltaHeader) < sizeof(GMT_RawInputRecord)) {
+      GMT_RawInputDeltaHeader hdr;
+      hdr.size = (uint16_t)delta_size;
+      hdr.timestamp = timestamp;
+      GMT__FileWriter_Emit(w, GMT_RECORD_TAG_INPUT_DELTA, &hdr, sizeof(hdr), delta, delta_size);
+      return;
+    }
+  }
+  GMT_RawInputRecord rec;
+  memset(&rec, 0, sizeof(rec));
+  rec.timestamp = timestamp;
+  rec.input = *input;
+  GMT__FileWriter_Emit(w, GMT_RECORD_TAG_INPUT, &rec, sizeof(rec), NULL, 0);
+}
+
+static bool GMT__FileWriter_AddKeyframe(GMT__FileWriter* w, uint32_t frame) {
+  if (w->keyframe_count == w->keyframe_capacity) {
+    size_t capacity = w->keyframe_capacity ? w->keyframe_capacity * 2 : 64;
+    GMT_RawKeyframeIndexEntry* grown = (GMT_RawKeyframeIndexEntry*)GMT_Realloc(w->keyframes, capacity * sizeof(*grown));
+    if (!grown) {
+      GMT_LogError("GMT_TestFile: allocation failed for the keyframe index.");
+      return false;
+    }
+    w->keyframes = grown;
+    w->keyframe_capacity = capacity;
+  }
+  w->keyframes[w->keyframe_count].frame = frame;
+  w->keyframes[w->keyframe_count].offset = w->offset;
+  w->keyframe_count++;
+  return true;
+}
+
+bool GMT_RewriteTestFile(const char* path, const char* out_path, const GMT_TestFileRewrite* options, GMT_TestFileStats* out_stats) {
+  GMT_TestFileRewrite defaults;
+  memset(&defaults, 0, sizeof(defaults));
+  if (!options) options = &defaults;
+  if (out_stats) memset(out_stats, 0, sizeof(*out_stats));
+  if (!path || !out_path || path[0] == '\0' || out_path[0] == '\0') return false;
+  if (strcmp(path, out_path) == 0) {
+    GMT_LogError("GMT_TestFile: %s cannot be rewritten onto itself.", path);
+    return false;
+  }
+
+  bool ok = false;
+  GMT_RecordReader r;
+  GMT__FileWriter w;
+  memset(&r, 0, sizeof(r));
+  memset(&w, 0, sizeof(w));
+
+  GMT__Trailer trailer;
+  if (!GMT__ReadTrailer(path, &trailer)) return false;
+  if (!GMT_RecordReader_Open(&r, path)) {
+    GMT_LogError("GMT_TestFile: failed to read %s.", path);
+    return false;
+  }
+
+  // Versions 2 and 4 only add records, so 1 and 3 are upgraded as they are.
+  // Version 0 lacks the frame numbers of later Pin/Track headers.
+  uint16_t version = r.version;
+  if (version == 1 || version == 3) version++;
+  bool blocks = (options->compression == GMT_TestFileCompression_KEEP) ? r.blocks : (options->compression == GMT_TestFileCompression_ON);
+  if (blocks && version < 2) {
+    GMT_LogWarning("GMT_TestFile: %s is a version-0 file, which cannot be compressed; left uncompressed.", path);
+    blocks = false;
+  }
+
+  w.file = fopen(out_path, "wb");
+  if (!w.file) {
+    GMT_LogError("GMT_TestFile: failed to open %s for write.", out_path);
+    goto cleanup;
+  }
+  if (blocks) {
+    w.block = (uint8_t*)GMT_Alloc(GMT_RECORD_BLOCK_SIZE);
+    w.block_out = (uint8_t*)GMT_Alloc(GMT_COMPRESS_BOUND(GMT_RECORD_BLOCK_SIZE));
+    if (!w.block || !w.block_out) {
+      GMT_LogError("GMT_TestFile: allocation failed for compression buffers.");
+      goto cleanup;
+    }
+  }
+
+  GMT_FileHeader hdr;
+  hdr.magic = GMT_RECORD_MAGIC;
+  hdr.version = version;
+  fwrite(&hdr, sizeof(hdr), 1, w.file);
+  w.offset = sizeof(hdr);
+
+  GMT__Walk walk;
+  memset(&walk, 0, sizeof(walk));
+  uint32_t input_count = 0;
+  uint8_t tag;
+  const uint8_t* body;
+  size_t size;
+  while (GMT_RecordReader_Next(&r, &tag, &body, &size)) {
+    if (!GMT__WalkRecord(&walk, tag, body, size)) goto cleanup;
+    switch (tag) {
+      case GMT_RECORD_TAG_INPUT:
+      case GMT_RECORD_TAG_INPUT_DELTA:
+        // Leaving a record out keeps the following deltas valid: the state
+        // before the next one is the same either way.
+        if (walk.redundant && options->drop_redundant_inputs) break;
+        GMT__FileWriter_EmitInput(&w, version, &walk.prev, &walk.input, walk.time);
+        input_count++;
+        break;
+      case GMT_RECORD_TAG_KEYFRAME: {
+        GMT_RawKeyframeHeader kh;
+        memcpy(&kh, body, sizeof(kh));
+        kh.input_count = input_count;
+        if (!GMT__FileWriter_AddKeyframe(&w, kh.frame)) goto cleanup;
+        GMT__FileWriter_Emit(&w, tag, &kh, sizeof(kh), body + sizeof(kh), size - sizeof(kh));
+        break;
+      }
+      default:
+        GMT__FileWriter_Emit(&w, tag, body, size, NULL, 0);
+        break;
+    }
+  }
+  if (r.failed) goto cleanup;
+
+  GMT__FileWriter_FlushBlock(&w);
+  uint8_t end_tag = GMT_RECORD_TAG_END;
+  fwrite(&end_tag, 1, 1, w.file);
+
+  // Files without a summary get one when their records give the frame count.
+  if (trailer.has_summary || version >= 3) {
+    GMT_RawRecordSummary summary;
+    summary.frame_count = trailer.has_summary ? trailer.summary.frame_count : walk.frame;
+    summary.duration = trailer.has_summary ? trailer.summary.duration : walk.timestamp;
+    summary.magic = GMT_RECORD_SUMMARY_MAGIC;
+    fwrite(&summary, sizeof(summary), 1, w.file);
+  }
+  if (w.keyframe_count > 0) {
+    GMT_RawKeyframeIndexFooter footer;
+    footer.count = (uint32_t)w.keyframe_count;
+    footer.magic = GMT_RECORD_INDEX_MAGIC;
+    fwrite(w.keyframes, sizeof(GMT_RawKeyframeIndexEntry), w.keyframe_count, w.file);
+    fwrite(&footer, sizeof(footer), 1, w.file);
+  }
+  ok = true;
+
+cleanup:
+  if (w.file) {
+    if (ferror(w.file)) ok = false;
+    if (fclose(w.file) != 0) ok = false;
+  }
+  if (w.block) GMT_Free(w.block);
+  if (w.block_out) GMT_Free(w.block_out);
+  if (w.keyframes) GMT_Free(w.keyframes);
+  GMT_RecordReader_Close(&r);
+
+  if (!ok) {
+    GMT_LogError("GMT_TestFile: failed to rewrite %s.", path);
+    return false;
+  }
+  return out_stats ? GMT_ReadTestFileStats(out_path, out_stats) : true;
+}
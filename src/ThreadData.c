@@ -0,0 +1,90 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Internal.h"
+#include "Atomic.h"
+#include <string.h>
+
+// Bumped by every GMT_ThreadData_FreeAll.  Lives outside g_gmt (which GMT_Quit
+// clears) so that a thread-local pointer left over from an earlier session is
+// recognised as stale instead of being dereferenced.
+static volatile uint32_t s_gmt_thread_session = 1;
+
+static GMT_THREAD_LOCAL GMT_ThreadData* t_gmt_thread;
+static GMT_THREAD_LOCAL uint32_t t_gmt_thread_session;
+static GMT_THREAD_LOCAL GMT_State* t_gmt_thread_state;  // State t_gmt_thread belongs to.
+
+GMT_ThreadData* GMT_ThreadData_Get(void) {
+  uint32_t session = GMT_Atomic_Load32(&s_gmt_thread_session);
+  if (t_gmt_thread && t_gmt_thread_session == session && t_gmt_thread_state == g_gmt_current) return t_gmt_thread;
+
+  // A thread moving between contexts keeps its entry in each of them.
+  uint32_t thread_id = GMT_Platform_GetThreadId();
+  GMT_Platform_MutexLock();
+  GMT_ThreadData* found = g_gmt.threads;
+  while (found && found->thread_id != thread_id) found = found->next;
+  GMT_Platform_MutexUnlock();
+  if (found) {
+    t_gmt_thread = found;
+    t_gmt_thread_session = session;
+    t_gmt_thread_state = g_gmt_current;
+    return found;
+  }
+
+  GMT_ThreadData* td = (GMT_ThreadData*)GMT_Alloc(sizeof(GMT_ThreadData));
+  uint8_t* ring = (uint8_t*)GMT_Alloc(GMT_THREAD_RING_SIZE);
+  if (!td || !ring) {
+    if (td) GMT_Free(td);
+    if (ring) GMT_Free(ring);
+    GMT_LogError("GMT_ThreadData: allocation failed; this thread falls back to the shared path.");
+    return NULL;
+  }
+  memset(td, 0, sizeof(*td));
+  td->ring = ring;
+  td->thread_id = thread_id;
+
+  GMT_Platform_MutexLock();
+  td->next = g_gmt.threads;
+  g_gmt.threads = td;
+  GMT_Platform_MutexUnlock();
+
+  t_gmt_thread = td;
+  t_gmt_thread_session = session;
+  t_gmt_thread_state = g_gmt_current;
+  return td;
+}
+
+void GMT_ThreadData_FreeAll(void) {
+  GMT_Platform_MutexLock();
+  GMT_ThreadData* td = g_gmt.threads;
+  while (td) {
+    GMT_ThreadData* next = td->next;
+    GMT_Free(td->ring);
+    GMT_Free(td);
+    td = next;
+  }
+  g_gmt.threads = NULL;
+  GMT_Atomic_Add32(&s_gmt_thread_session, 1);
+  GMT_Platform_MutexUnlock();
+}
@@ -0,0 +1,81 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "Profile.h"
+
+// Per-thread framework state.  Every thread that calls GMT_Pin / GMT_Track gets
+// one on first use (one per framework state it calls into), so the hot path of
+// those calls touches only its own data:
+//   RECORD: records are staged in a private single-producer ring and merged into
+//           the record stream under the mutex at frame boundaries (GMT_Update_).
+//   REPLAY: each thread keeps its own cursors into the (read-only) decoded tables.
+// All entries are freed by GMT_Quit; a thread that calls in again after a later
+// GMT_Init registers a fresh one.
+
+#define GMT_THREAD_RING_SIZE (64 * 1024)  // Bytes of staged Pin/Track records per thread (power of two).
+
+// Pin/Track replay lookup cost counters.
+typedef struct GMT_LookupStats {
+  size_t count;        // Lookups performed.
+  size_t cursor_hits;  // Lookups resolved at the cursor without hashing.
+  size_t probes;       // Hash slots inspected by the lookups that missed the cursor.
+} GMT_LookupStats;
+
+typedef struct GMT_ThreadData {
+  struct GMT_ThreadData* next;  // Registry list rooted at g_gmt.threads; appended under the mutex.
+  uint32_t thread_id;           // GMT_Platform_GetThreadId of the owning thread.
+
+  // ----- RECORD mode -----
+  // Staged TAG_PIN / TAG_TRACK records, stored exactly as they go to disk.
+  // Written by the owning thread only; drained with the mutex held.
+  uint8_t* ring;
+  volatile uint64_t ring_head;  // Monotonic byte positions.
+  volatile uint64_t ring_tail;
+
+  // ----- REPLAY mode -----
+  // Value of g_gmt.replay_generation the cursors belong to; a reload resets them.
+  uint32_t replay_generation;
+  size_t pin_cursor;
+  size_t track_cursor;
+  // Summed over all threads by GMT_Record_GetReplayMetrics.
+  GMT_LookupStats lookup;
+
+  // ----- Profiling -----
+  // Ticks this thread's Track/Pin scopes used, by GMT_ProfileScope.  Written by
+  // the owning thread only; GMT_Profile_EndFrame folds the growth since profile_folded.
+  volatile uint64_t profile_ticks[GMT_ProfileScope_COUNT];
+  uint64_t profile_folded[GMT_ProfileScope_COUNT];
+} GMT_ThreadData;
+
+// Returns the calling thread's data, registering it on first use.
+// Returns NULL only if allocation fails.  Takes the mutex only when registering.
+GMT_ThreadData* GMT_ThreadData_Get(void);
+
+// Frees every registered entry.  Called by GMT_Quit with no other framework calls in flight.
+void GMT_ThreadData_FreeAll(void);
@@ -24,9 +24,20 @@ SOFTWARE.
 
 #include "Internal.h"
 #include "Record.h"
+#include "Hash.h"
+#include <inttypes.h>
+#include <stdio.h>
 #include <string.h>
 #include <math.h>
 
+// SSE2 is part of every x64 target.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define GMT__TRACK_SSE2 1
+#endif
+
+#define GMT__TRACK_REPORT_LIMIT 8  // Mismatching elements logged per batch call.
+
 // ===== Comparison modes =====
 
 typedef enum {
@@ -51,151 +62,165 @@ static const char* GMT_CmpModeName(GMT_CmpMode cmp) {
 
 // ===== Shared helper =====
 
-static void GMT_Track_(unsigned int key, const void* data, size_t size, GMT_CmpMode cmp, GMT_CodeLocation loc) {
-  if (!g_gmt.initialized || g_gmt.mode == GMT_Mode_DISABLED) return;
-  if (!data || size == 0) return;
-  if (size > (size_t)GMT_MAX_DATA_RECORD_PAYLOAD) {
-    GMT_LogError("GMT_Track<%s>: payload size %zu exceeds maximum %d; call ignored.", GMT_CmpModeName(cmp), size, GMT_MAX_DATA_RECORD_PAYLOAD);
-    return;
-  }
-
-  GMT_Platform_MutexLock();
-
-  unsigned int index = GMT_KeyCounter_Next(&g_gmt.track_counter, key);
-
-  switch (g_gmt.mode) {
-    case GMT_Mode_RECORD:
-      GMT_Record_WriteDataRecord(GMT_RECORD_TAG_TRACK, key, index, data, size);
-      GMT_Platform_MutexUnlock();
+// Compares a call against the snapshot recorded for it and fails the test on a mismatch.
+static void GMT__TrackCheck(unsigned int key, unsigned int index, const void* data, const uint8_t* rdata, size_t size, GMT_CmpMode cmp, GMT_CodeLocation loc) {
+  bool match;
+  switch (cmp) {
+    case GMT_CMP_FLOAT: {
+      float recorded, current;
+      memcpy(&recorded, rdata, sizeof(float));
+      memcpy(&current, data, sizeof(float));
+      match = (fabsf(recorded - current) < GMT_FLOAT_EPSILON);
       break;
+    }
+    case GMT_CMP_DOUBLE: {
+      double recorded, current;
+      memcpy(&recorded, rdata, sizeof(double));
+      memcpy(&current, data, sizeof(double));
+      match = (fabs(recorded - current) < (double)GMT_DOUBLE_EPSILON);
+      break;
+    }
+    default:
+      match = (memcmp(rdata, data, size) == 0);
+      break;
+  }
 
-    case GMT_Mode_REPLAY: {
-      // Snapshot the decoded record under the lock, then release before any
-      // assertion so the assertion subsystem can re-acquire cleanly.
-      GMT_DecodedDataRecord* rec = GMT_Record_FindDecoded(g_gmt.replay_tracks, g_gmt.replay_track_count, key, index);
-
-      bool found = (rec != NULL);
-      uint32_t rsz = found ? rec->size : 0;
-      uint8_t rdata[GMT_MAX_DATA_RECORD_PAYLOAD];
-      if (found && rsz > 0) memcpy(rdata, rec->data, rsz);
-
-      GMT_Platform_MutexUnlock();
-
-      if (!found) {
-        GMT_LogWarning("GMT_Track<%s>: no recorded snapshot for key %u index %u; skipping check.", GMT_CmpModeName(cmp), key, index);
-        return;
+  if (!match) {
+    // Log the actual values before asserting so the output is actionable.
+    char detail[512];
+    switch (cmp) {
+      case GMT_CMP_INT: {
+        int32_t recorded, current;
+        memcpy(&recorded, rdata, sizeof(int32_t));
+        memcpy(&current, data, sizeof(int32_t));
+        snprintf(detail, sizeof(detail),
+                 "GMT_Track<int>: value mismatch (key %u, index %u): %d != %d",
+                 key, index, (int)recorded, (int)current);
+        break;
       }
-      if (rsz != (uint32_t)size) {
-        GMT_LogWarning("GMT_Track<%s>: size mismatch for key %u index %u: recorded %u bytes, got %zu bytes; skipping check.",
-                       GMT_CmpModeName(cmp), key, index, rsz, size);
-        return;
+      case GMT_CMP_UINT: {
+        uint32_t recorded, current;
+        memcpy(&recorded, rdata, sizeof(uint32_t));
+        memcpy(&current, data, sizeof(uint32_t));
+        snprintf(detail, sizeof(detail),
+                 "GMT_Track<uint>: value mismatch (key %u, index %u): %u != %u",
+                 key, index, (unsigned)recorded, (unsigned)current);
+        break;
       }
-
-      bool match;
-      switch (cmp) {
-        case GMT_CMP_FLOAT: {
-          float recorded, current;
-          memcpy(&recorded, rdata, sizeof(float));
-          memcpy(&current, data, sizeof(float));
-          match = (fabsf(recorded - current) < GMT_FLOAT_EPSILON);
-          break;
-        }
-        case GMT_CMP_DOUBLE: {
-          double recorded, current;
-          memcpy(&recorded, rdata, sizeof(double));
-          memcpy(&current, data, sizeof(double));
-          match = (fabs(recorded - current) < (double)GMT_DOUBLE_EPSILON);
-          break;
-        }
-        default:
-          match = (memcmp(rdata, data, size) == 0);
-          break;
+      case GMT_CMP_BOOL: {
+        bool recorded = (rdata[0] != 0);
+        bool current = (((const uint8_t*)data)[0] != 0);
+        snprintf(detail, sizeof(detail),
+                 "GMT_Track<bool>: value mismatch (key %u, index %u): %s != %s",
+                 key, index,
+                 recorded ? "true" : "false",
+                 current ? "true" : "false");
+        break;
       }
-
-      if (!match) {
-        // Log the actual values before asserting so the output is actionable.
-        char detail[512];
-        switch (cmp) {
-          case GMT_CMP_INT: {
-            int32_t recorded, current;
-            memcpy(&recorded, rdata, sizeof(int32_t));
-            memcpy(&current, data, sizeof(int32_t));
-            snprintf(detail, sizeof(detail),
-                     "GMT_Track<int>: value mismatch (key %u, index %u): %d != %d",
-                     key, index, (int)recorded, (int)current);
-            break;
-          }
-          case GMT_CMP_UINT: {
-            uint32_t recorded, current;
-            memcpy(&recorded, rdata, sizeof(uint32_t));
-            memcpy(&current, data, sizeof(uint32_t));
-            snprintf(detail, sizeof(detail),
-                     "GMT_Track<uint>: value mismatch (key %u, index %u): %u != %u",
-                     key, index, (unsigned)recorded, (unsigned)current);
-            break;
-          }
-          case GMT_CMP_BOOL: {
-            bool recorded = (rdata[0] != 0);
-            bool current = (((const uint8_t*)data)[0] != 0);
-            snprintf(detail, sizeof(detail),
-                     "GMT_Track<bool>: value mismatch (key %u, index %u): %s != %s",
-                     key, index,
-                     recorded ? "true" : "false",
-                     current ? "true" : "false");
-            break;
-          }
-          case GMT_CMP_FLOAT: {
-            float recorded, current;
-            memcpy(&recorded, rdata, sizeof(float));
-            memcpy(&current, data, sizeof(float));
-            snprintf(detail, sizeof(detail),
-                     "GMT_Track<float>: value mismatch (key %u, index %u): %.9g != %.9g (diff %.9g)",
-                     key, index,
-                     (double)recorded, (double)current,
-                     (double)fabsf(recorded - current));
-            break;
-          }
-          case GMT_CMP_DOUBLE: {
-            double recorded, current;
-            memcpy(&recorded, rdata, sizeof(double));
-            memcpy(&current, data, sizeof(double));
-            snprintf(detail, sizeof(detail),
-                     "GMT_Track<double>: value mismatch (key %u, index %u): %.17g != %.17g (diff %.17g)",
-                     key, index, recorded, current, fabs(recorded - current));
-            break;
-          }
-          default: {
-            // Hex dump: up to 32 bytes shown.
-            const size_t dump_max = size < 32 ? size : 32;
-            const uint8_t* cur = (const uint8_t*)data;
-            int off = snprintf(detail, sizeof(detail),
-                               "GMT_Track<bytes>: value mismatch (key %u, index %u, %zu bytes): recorded [",
-                               key, index, size);
-            for (size_t i = 0; i < dump_max && off < (int)sizeof(detail) - 4; ++i)
-              off += snprintf(detail + off, sizeof(detail) - (size_t)off, "%02X", rdata[i]);
-            if (size > dump_max && off < (int)sizeof(detail) - 4)
-              off += snprintf(detail + off, sizeof(detail) - (size_t)off, "..");
-            off += snprintf(detail + off, sizeof(detail) - (size_t)off, "], current [");
-            for (size_t i = 0; i < dump_max && off < (int)sizeof(detail) - 4; ++i)
-              off += snprintf(detail + off, sizeof(detail) - (size_t)off, "%02X", cur[i]);
-            if (size > dump_max && off < (int)sizeof(detail) - 4)
-              off += snprintf(detail + off, sizeof(detail) - (size_t)off, "..");
-            snprintf(detail + off, sizeof(detail) - (size_t)off, "]");
-            break;
-          }
-        }
-        GMT_LogError("%s", detail);
-        GMT_Assert_(false,
-                    "GMT_Track: value mismatch between record and replay.",
-                    loc);
+      case GMT_CMP_FLOAT: {
+        float recorded, current;
+        memcpy(&recorded, rdata, sizeof(float));
+        memcpy(&current, data, sizeof(float));
+        snprintf(detail, sizeof(detail),
+                 "GMT_Track<float>: value mismatch (key %u, index %u): %.9g != %.9g (diff %.9g)",
+                 key, index,
+                 (double)recorded, (double)current,
+                 (double)fabsf(recorded - current));
+        break;
+      }
+      case GMT_CMP_DOUBLE: {
+        double recorded, current;
+        memcpy(&recorded, rdata, sizeof(double));
+        memcpy(&current, data, sizeof(double));
+        snprintf(detail, sizeof(detail),
+                 "GMT_Track<double>: value mismatch (key %u, index %u): %.17g != %.17g (diff %.17g)",
+                 key, index, recorded, current, fabs(recorded - current));
+        break;
+      }
+      default: {
+        // Hex dump: up to 32 bytes shown.
+        const size_t dump_max = size < 32 ? size : 32;
+        const uint8_t* cur = (const uint8_t*)data;
+        int off = snprintf(detail, sizeof(detail),
+                           "GMT_Track<bytes>: value mismatch (key %u, index %u, %zu bytes): recorded [",
+                           key, index, size);
+        for (size_t i = 0; i < dump_max && off < (int)sizeof(detail) - 4; ++i)
+          off += snprintf(detail + off, sizeof(detail) - (size_t)off, "%02X", rdata[i]);
+        if (size > dump_max && off < (int)sizeof(detail) - 4)
+          off += snprintf(detail + off, sizeof(detail) - (size_t)off, "..");
+        off += snprintf(detail + off, sizeof(detail) - (size_t)off, "], current [");
+        for (size_t i = 0; i < dump_max && off < (int)sizeof(detail) - 4; ++i)
+          off += snprintf(detail + off, sizeof(detail) - (size_t)off, "%02X", cur[i]);
+        if (size > dump_max && off < (int)sizeof(detail) - 4)
+          off += snprintf(detail + off, sizeof(detail) - (size_t)off, "..");
+        snprintf(detail + off, sizeof(detail) - (size_t)off, "]");
+        break;
       }
-      break;
     }
+    GMT_LogError("%s", detail);
+    GMT_Assert_Location("GMT_Track: value mismatch between record and replay.", loc);
+  }
+}
 
-    default:
-      GMT_Platform_MutexUnlock();
-      break;
+// Records `size` bytes for the next call with `key` (RECORD), or fetches what was
+// recorded for it (REPLAY).  Returns the recorded bytes, in frame-arena memory the
+// caller passes to GMT_FrameFree, only in REPLAY and only when they have the same
+// size; otherwise returns NULL, with the reason logged.  A file that tags its
+// records with frames has a record for every call the recording made, so a
+// missing one fails the check at `loc` rather than passing it silently.
+static uint8_t* GMT__TrackExchange(unsigned int key, const void* data, size_t size, const char* type_name, unsigned int* out_index, GMT_CodeLocation loc) {
+  if (size > g_gmt.max_payload_size) {
+    GMT_LogError("GMT_Track<%s>: payload size %zu exceeds maximum %zu; call ignored.", type_name, size, g_gmt.max_payload_size);
+    return NULL;
+  }
+
+  // No mutex: the key counter is lock-free and the record paths use per-thread data.
+  unsigned int index = GMT_KeyCounter_Next(&g_gmt.track_counter, key);
+  *out_index = index;
+
+  if (g_gmt.mode == GMT_Mode_RECORD) {
+    GMT_Record_WriteDataRecord(GMT_RECORD_TAG_TRACK, key, index, data, size);
+    return NULL;
+  }
+  if (g_gmt.mode != GMT_Mode_REPLAY) return NULL;
+
+  // Recorded payloads are copied out of the replay tables, so large ones come
+  // from the frame arena rather than the stack.
+  uint8_t* rdata = (uint8_t*)GMT_FrameAlloc(size);
+  if (!rdata) {
+    GMT_LogError("GMT_Track<%s>: allocation of %zu bytes failed; skipping check.", type_name, size);
+    return NULL;
+  }
+  uint32_t rsz = 0;
+  if (!GMT_Record_FindDecoded(&g_gmt.replay_tracks, key, index, rdata, (uint32_t)size, &rsz)) {
+    if (g_gmt.replay_version >= 1) {
+      GMT_LogError("GMT_Track<%s>: no recorded snapshot for key %u index %u near frame %" PRId64 ".", type_name, key, index, GMT_ReplayFrame());
+      GMT_Assert_Location("GMT_Track: no recorded value for this call.", loc);
+    } else {
+      GMT_LogWarning("GMT_Track<%s>: no recorded snapshot for key %u index %u; skipping check.", type_name, key, index);
+    }
+  } else if (rsz != (uint32_t)size) {
+    GMT_LogWarning("GMT_Track<%s>: size mismatch for key %u index %u: recorded %u bytes, got %zu bytes; skipping check.",
+                   type_name, key, index, rsz, size);
+  } else {
+    return rdata;
+  }
+  GMT_FrameFree(rdata);
+  return NULL;
+}
+
+static void GMT_Track_(unsigned int key, const void* data, size_t size, GMT_CmpMode cmp, GMT_CodeLocation loc) {
+  if (!g_gmt.initialized || g_gmt.mode == GMT_Mode_DISABLED) return;
+  if (!data || size == 0) return;
+
+  uint64_t profile_begin = GMT_Profile_Begin();
+  unsigned int index;
+  uint8_t* rdata = GMT__TrackExchange(key, data, size, GMT_CmpModeName(cmp), &index, loc);
+  if (rdata) {
+    GMT__TrackCheck(key, index, data, rdata, size, cmp, loc);
+    GMT_FrameFree(rdata);
   }
+  GMT_Profile_EndThread(GMT_ProfileScope_TRACK, profile_begin);
 }
 
 // ===== Typed public functions =====
@@ -223,3 +248,276 @@ void GMT_TrackBool_(unsigned int key, bool value, GMT_CodeLocation loc) {
 void GMT_TrackBytes_(unsigned int key, const void* data, size_t size, GMT_CodeLocation loc) {
   GMT_Track_(key, data, size, GMT_CMP_EXACT, loc);
 }
+
+// ===== Batches =====
+
+// Compares `count` floats within GMT_FLOAT_EPSILON.  Returns how many differ and
+// stores the positions of the first GMT__TRACK_REPORT_LIMIT of them in `first`.
+static size_t GMT__CompareFloats(const uint8_t* recorded, const float* current, size_t count, size_t* first) {
+  size_t mismatches = 0;
+  size_t i = 0;
+#ifdef GMT__TRACK_SSE2
+  const __m128 eps = _mm_set1_ps(GMT_FLOAT_EPSILON);
+  const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+  for (; i + 4 <= count; i += 4) {
+    __m128 diff = _mm_sub_ps(_mm_loadu_ps((const float*)(const void*)(recorded + i * sizeof(float))), _mm_loadu_ps(current + i));
+    // "Not less than" is also true for NaN, which fabsf(diff) < eps rejects too.
+    int bits = _mm_movemask_ps(_mm_cmpnlt_ps(_mm_and_ps(diff, abs_mask), eps));
+    if (bits == 0) continue;
+    for (int b = 0; b < 4; b++) {
+      if (!(bits & (1 << b))) continue;
+      if (mismatches < GMT__TRACK_REPORT_LIMIT) first[mismatches] = i + (size_t)b;
+      mismatches++;
+    }
+  }
+#endif
+  for (; i < count; i++) {
+    float r;
+    memcpy(&r, recorded + i * sizeof(float), sizeof(r));
+    if (fabsf(r - current[i]) < GMT_FLOAT_EPSILON) continue;
+    if (mismatches < GMT__TRACK_REPORT_LIMIT) first[mismatches] = i;
+    mismatches++;
+  }
+  return mismatches;
+}
+
+static void GMT__FailBatch(const char* type_name, unsigned int key, unsigned int index, size_t mismatches, size_t count, GMT_CodeLocation loc) {
+  if (mismatches > GMT__TRACK_REPORT_LIMIT) {
+    GMT_LogError("GMT_Track<%s>: ... and %zu more mismatches (key %u, index %u; %zu of %zu values differ).",
+                 type_name, mismatches - GMT__TRACK_REPORT_LIMIT, key, index, mismatches, count);
+  }
+  GMT_Assert_Location("GMT_Track: value mismatch between record and replay.", loc);
+}
+
+static void GMT__TrackFloatArray(unsigned int key, const float* values, size_t count, GMT_CodeLocation loc) {
+  if (!g_gmt.initialized || g_gmt.mode == GMT_Mode_DISABLED) return;
+  if (!values || count == 0) return;
+  if (count > SIZE_MAX / sizeof(float)) {
+    GMT_LogError("GMT_Track<float[]>: %zu elements overflow; call ignored.", count);
+    return;
+  }
+
+  unsigned int index;
+  uint8_t* rdata = GMT__TrackExchange(key, values, count * sizeof(float), "float[]", &index, loc);
+  if (!rdata) return;
+
+  size_t first[GMT__TRACK_REPORT_LIMIT];
+  size_t mismatches = GMT__CompareFloats(rdata, values, count, first);
+  for (size_t m = 0; m < mismatches && m < GMT__TRACK_REPORT_LIMIT; m++) {
+    size_t i = first[m];
+    float recorded;
+    memcpy(&recorded, rdata + i * sizeof(float), sizeof(recorded));
+    GMT_LogError("GMT_Track<float[]>: value mismatch (key %u, index %u, element %zu): %.9g != %.9g (diff %.9g)",
+                 key, index, i, (double)recorded, (double)values[i], (double)fabsf(recorded - values[i]));
+  }
+  if (mismatches > 0) GMT__FailBatch("float[]", key, index, mismatches, count, loc);
+  GMT_FrameFree(rdata);
+}
+
+// Byte size a field of the given type must have; 0 for GMT_FieldType_BYTES (any size).
+static size_t GMT__FieldTypeSize(GMT_FieldType type) {
+  switch (type) {
+    case GMT_FieldType_INT:    return sizeof(int32_t);
+    case GMT_FieldType_UINT:   return sizeof(uint32_t);
+    case GMT_FieldType_FLOAT:  return sizeof(float);
+    case GMT_FieldType_DOUBLE: return sizeof(double);
+    case GMT_FieldType_BOOL:   return sizeof(bool);
+    default:                   return 0;
+  }
+}
+
+// Compares one packed field; on a mismatch formats "recorded != current" into `detail`.
+static bool GMT__FieldMatches(const GMT_Field* f, const uint8_t* recorded, const uint8_t* current, char* detail, size_t detail_size) {
+  switch (f->type) {
+    case GMT_FieldType_INT: {
+      int32_t r, c;
+      memcpy(&r, recorded, sizeof(r));
+      memcpy(&c, current, sizeof(c));
+      if (r == c) return true;
+      snprintf(detail, detail_size, "%d != %d", (int)r, (int)c);
+      return false;
+    }
+    case GMT_FieldType_UINT: {
+      uint32_t r, c;
+      memcpy(&r, recorded, sizeof(r));
+      memcpy(&c, current, sizeof(c));
+      if (r == c) return true;
+      snprintf(detail, detail_size, "%u != %u", (unsigned)r, (unsigned)c);
+      return false;
+    }
+    case GMT_FieldType_FLOAT: {
+      float r, c;
+      memcpy(&r, recorded, sizeof(r));
+      memcpy(&c, current, sizeof(c));
+      if (fabsf(r - c) < GMT_FLOAT_EPSILON) return true;
+      snprintf(detail, detail_size, "%.9g != %.9g (diff %.9g)", (double)r, (double)c, (double)fabsf(r - c));
+      return false;
+    }
+    case GMT_FieldType_DOUBLE: {
+      double r, c;
+      memcpy(&r, recorded, sizeof(r));
+      memcpy(&c, current, sizeof(c));
+      if (fabs(r - c) < (double)GMT_DOUBLE_EPSILON) return true;
+      snprintf(detail, detail_size, "%.17g != %.17g (diff %.17g)", r, c, fabs(r - c));
+      return false;
+    }
+    case GMT_FieldType_BOOL: {
+      if (memcmp(recorded, current, f->size) == 0) return true;
+      snprintf(detail, detail_size, "%s != %s", recorded[0] ? "true" : "false", current[0] ? "true" : "false");
+      return false;
+    }
+    default:
+      if (memcmp(recorded, current, f->size) == 0) return true;
+      snprintf(detail, detail_size, "%zu bytes differ", f->size);
+      return false;
+  }
+}
+
+static void GMT__TrackStruct(unsigned int key, const void* elements, size_t stride, size_t count, const GMT_Field* fields, size_t field_count, GMT_CodeLocation loc) {
+  if (!g_gmt.initialized || g_gmt.mode == GMT_Mode_DISABLED) return;
+  if (!elements || count == 0 || !fields || field_count == 0) return;
+
+  size_t row = 0;
+  for (size_t k = 0; k < field_count; k++) {
+    const GMT_Field* f = &fields[k];
+    size_t expected = GMT__FieldTypeSize(f->type);
+    if (f->size == 0 || (expected != 0 && f->size != expected) || f->offset > stride || f->size > stride - f->offset) {
+      GMT_LogError("GMT_Track<struct>: field '%s' does not match its type or lies outside the %zu-byte stride; call ignored.",
+                   f->name ? f->name : "?", stride);
+      return;
+    }
+    row += f->size;
+  }
+  if (count > SIZE_MAX / row) {
+    GMT_LogError("GMT_Track<struct>: %zu elements overflow; call ignored.", count);
+    return;
+  }
+
+  // Only the described fields are stored, packed, so padding never reaches the file.
+  size_t size = row * count;
+  uint8_t* packed = (uint8_t*)GMT_FrameAlloc(size);
+  if (!packed) {
+    GMT_LogError("GMT_Track<struct>: allocation of %zu bytes failed; call ignored.", size);
+    return;
+  }
+  uint8_t* out = packed;
+  for (size_t i = 0; i < count; i++) {
+    const uint8_t* element = (const uint8_t*)elements + i * stride;
+    for (size_t k = 0; k < field_count; k++) {
+      memcpy(out, element + fields[k].offset, fields[k].size);
+      out += fields[k].size;
+    }
+  }
+
+  unsigned int index;
+  uint8_t* rdata = GMT__TrackExchange(key, packed, size, "struct", &index, loc);
+  if (rdata && memcmp(rdata, packed, size) != 0) {
+    // Bitwise different; float fields may still be within tolerance.
+    size_t mismatches = 0;
+    size_t pos = 0;
+    for (size_t i = 0; i < count; i++) {
+      for (size_t k = 0; k < field_count; k++) {
+        const GMT_Field* f = &fields[k];
+        char detail[128];
+        if (!GMT__FieldMatches(f, rdata + pos, packed + pos, detail, sizeof(detail))) {
+          if (mismatches < GMT__TRACK_REPORT_LIMIT) {
+            GMT_LogError("GMT_Track<struct>: value mismatch (key %u, index %u, element %zu, field '%s'): %s",
+                         key, index, i, f->name ? f->name : "?", detail);
+          }
+          mismatches++;
+        }
+        pos += f->size;
+      }
+    }
+    if (mismatches > 0) GMT__FailBatch("struct", key, index, mismatches, count * field_count, loc);
+  }
+  if (rdata) GMT_FrameFree(rdata);
+  GMT_FrameFree(packed);
+}
+
+void GMT_TrackFloatArray_(unsigned int key, const float* values, size_t count, GMT_CodeLocation loc) {
+  uint64_t profile_begin = GMT_Profile_Begin();
+  GMT__TrackFloatArray(key, values, count, loc);
+  GMT_Profile_EndThread(GMT_ProfileScope_TRACK, profile_begin);
+}
+
+void GMT_TrackStruct_(unsigned int key, const void* elements, size_t stride, size_t count, const GMT_Field* fields, size_t field_count, GMT_CodeLocation loc) {
+  uint64_t profile_begin = GMT_Profile_Begin();
+  GMT__TrackStruct(key, elements, stride, count, fields, field_count, loc);
+  GMT_Profile_EndThread(GMT_ProfileScope_TRACK, profile_begin);
+}
+
+// ===== Digest =====
+
+// Writes the buffer of a mismatching GMT_TrackDigest call to GMT_Setup.digest_dump_dir,
+// once per run.
+static void GMT__DumpDigestBuffer(unsigned int key, unsigned int index, const void* data, size_t size) {
+  const char* dir = g_gmt.setup.digest_dump_dir;
+  if (!dir || dir[0] == '\0') return;
+  if (!GMT_Atomic_CompareExchange32(&g_gmt.digest_dumped, 0, 1)) return;
+
+  char path[1024];
+  snprintf(path, sizeof(path), "%s/digest_%u_%" PRIu64 "_%u.bin", dir, key, GMT_Atomic_Load64(&g_gmt.frame_index), index);
+  FILE* f = fopen(path, "wb");
+  if (!f) {
+    GMT_LogError("GMT_TrackDigest: failed to open dump file: %s", path);
+    return;
+  }
+  size_t written = (size > 0) ? fwrite(data, 1, size, f) : 0;
+  fclose(f);
+  if (written != size) GMT_LogError("GMT_TrackDigest: failed to write dump file: %s", path);
+  else
+    GMT_LogInfo("GMT_TrackDigest: live buffer written to %s", path);
+}
+
+static void GMT__TrackDigest(unsigned int key, const void* data, size_t size, GMT_CodeLocation loc) {
+  if (!g_gmt.initialized || g_gmt.mode == GMT_Mode_DISABLED) return;
+  if (!data && size > 0) return;
+
+  GMT_RawDigest digest;
+  digest.size = (uint64_t)size;
+  digest.hash = GMT_Hash64(data ? data : "", size, 0);
+
+  // No mutex: the key counter is lock-free and the record paths use per-thread data.
+  unsigned int index = GMT_KeyCounter_Next(&g_gmt.track_counter, key);
+
+  switch (g_gmt.mode) {
+    case GMT_Mode_RECORD:
+      GMT_Record_WriteDataRecord(GMT_RECORD_TAG_TRACK, key, index, &digest, sizeof(digest));
+      break;
+
+    case GMT_Mode_REPLAY: {
+      GMT_RawDigest recorded;
+      uint32_t rsz = 0;
+      if (!GMT_Record_FindDecoded(&g_gmt.replay_tracks, key, index, &recorded, (uint32_t)sizeof(recorded), &rsz)) {
+        if (g_gmt.replay_version >= 1) {
+          GMT_LogError("GMT_TrackDigest: no recorded digest for key %u index %u near frame %" PRId64 ".", key, index, GMT_ReplayFrame());
+          GMT_Assert_Location("GMT_TrackDigest: no recorded digest for this call.", loc);
+        } else {
+          GMT_LogWarning("GMT_TrackDigest: no recorded digest for key %u index %u; skipping check.", key, index);
+        }
+        return;
+      }
+      if (rsz != (uint32_t)sizeof(recorded)) {
+        GMT_LogWarning("GMT_TrackDigest: key %u index %u was not recorded by GMT_TrackDigest; skipping check.", key, index);
+        return;
+      }
+      if (recorded.size == digest.size && recorded.hash == digest.hash) return;
+
+      GMT_LogError("GMT_TrackDigest: digest mismatch (key %u, index %u): recorded %" PRIu64 " bytes, hash %016" PRIx64 "; current %" PRIu64 " bytes, hash %016" PRIx64,
+                   key, index, recorded.size, recorded.hash, digest.size, digest.hash);
+      GMT__DumpDigestBuffer(key, index, data, size);
+      GMT_Assert_Location("GMT_TrackDigest: digest mismatch between record and replay.", loc);
+      break;
+    }
+
+    default:
+      break;
+  }
+}
+
+void GMT_TrackDigest_(unsigned int key, const void* data, size_t size, GMT_CodeLocation loc) {
+  uint64_t profile_begin = GMT_Profile_Begin();
+  GMT__TrackDigest(key, data, size, loc);
+  GMT_Profile_EndThread(GMT_ProfileScope_TRACK, profile_begin);
+}
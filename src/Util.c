@@ -25,6 +25,7 @@ SOFTWARE.
 #include "Internal.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <inttypes.h>
 
 // ===== Hashing =====
@@ -96,6 +97,228 @@ bool GMT_ParseTestMode(const char** args, size_t arg_count, GMT_Mode* out_mode)
   return false;
 }
 
+// Parses --replay-timing=wall|frame from the given args array.
+bool GMT_ParseReplayTiming(const char** args, size_t arg_count, GMT_ReplayTiming* out_timing) {
+  if (!args || !out_timing) return false;
+  static const char prefix[] = "--replay-timing=";
+  const size_t prefix_len = sizeof(prefix) - 1;
+  for (size_t i = 0; i < arg_count; ++i) {
+    const char* arg = args[i];
+    if (!arg) continue;
+    if (strncmp(arg, prefix, prefix_len) == 0) {
+      const char* value = arg + prefix_len;
+      if (strcmp(value, "wall") == 0) {
+        *out_timing = GMT_ReplayTiming_WALL_CLOCK;
+        return true;
+      }
+      if (strcmp(value, "frame") == 0) {
+        *out_timing = GMT_ReplayTiming_FRAME;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Parses --input-injection=send-input|messages|virtual from the given args array.
+bool GMT_ParseInputInjection(const char** args, size_t arg_count, GMT_InputInjection* out_injection) {
+  if (!args || !out_injection) return false;
+  static const char prefix[] = "--input-injection=";
+  const size_t prefix_len = sizeof(prefix) - 1;
+  for (size_t i = 0; i < arg_count; ++i) {
+    const char* arg = args[i];
+    if (!arg) continue;
+    if (strncmp(arg, prefix, prefix_len) == 0) {
+      const char* value = arg + prefix_len;
+      if (strcmp(value, "send-input") == 0) {
+        *out_injection = GMT_InputInjection_SEND_INPUT;
+        return true;
+      }
+      if (strcmp(value, "messages") == 0) {
+        *out_injection = GMT_InputInjection_WINDOW_MESSAGES;
+        return true;
+      }
+      if (strcmp(value, "virtual") == 0) {
+        *out_injection = GMT_InputInjection_VIRTUAL;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Parses --input-capture=poll|hooks|virtual from the given args array.
+bool GMT_ParseInputCapture(const char** args, size_t arg_count, GMT_InputCapture* out_capture) {
+  if (!args || !out_capture) return false;
+  static const char prefix[] = "--input-capture=";
+  const size_t prefix_len = sizeof(prefix) - 1;
+  for (size_t i = 0; i < arg_count; ++i) {
+    const char* arg = args[i];
+    if (!arg) continue;
+    if (strncmp(arg, prefix, prefix_len) == 0) {
+      const char* value = arg + prefix_len;
+      if (strcmp(value, "poll") == 0) {
+        *out_capture = GMT_InputCapture_POLL;
+        return true;
+      }
+      if (strcmp(value, "hooks") == 0) {
+        *out_capture = GMT_InputCapture_HOOKS;
+        return true;
+      }
+      if (strcmp(value, "virtual") == 0) {
+        *out_capture = GMT_InputCapture_VIRTUAL;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Parses --input-sample-rate=<hz> from the given args array.
+bool GMT_ParseInputSampleRate(const char** args, size_t arg_count, uint32_t* out_rate) {
+  if (!args || !out_rate) return false;
+  static const char prefix[] = "--input-sample-rate=";
+  const size_t prefix_len = sizeof(prefix) - 1;
+  for (size_t i = 0; i < arg_count; ++i) {
+    const char* arg = args[i];
+    if (!arg) continue;
+    if (strncmp(arg, prefix, prefix_len) == 0) {
+      const char* value = arg + prefix_len;
+      char* parse_end = NULL;
+      unsigned long rate = strtoul(value, &parse_end, 10);
+      if (value[0] < '0' || value[0] > '9' || *parse_end != '\0' || rate > UINT32_MAX) return false;
+      *out_rate = (uint32_t)rate;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Parses --replay-start-frame=<frame> from the given args array.
+bool GMT_ParseReplayStartFrame(const char** args, size_t arg_count, uint32_t* out_frame) {
+  if (!args || !out_frame) return false;
+  static const char prefix[] = "--replay-start-frame=";
+  const size_t prefix_len = sizeof(prefix) - 1;
+  for (size_t i = 0; i < arg_count; ++i) {
+    const char* arg = args[i];
+    if (!arg) continue;
+    if (strncmp(arg, prefix, prefix_len) == 0) {
+      const char* value = arg + prefix_len;
+      char* parse_end = NULL;
+      unsigned long frame = strtoul(value, &parse_end, 10);
+      if (value[0] < '0' || value[0] > '9' || *parse_end != '\0' || frame > UINT32_MAX) return false;
+      *out_frame = (uint32_t)frame;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Parses --replay-end-frame=<frame> from the given args array.
+bool GMT_ParseReplayEndFrame(const char** args, size_t arg_count, uint32_t* out_frame) {
+  if (!args || !out_frame) return false;
+  static const char prefix[] = "--replay-end-frame=";
+  const size_t prefix_len = sizeof(prefix) - 1;
+  for (size_t i = 0; i < arg_count; ++i) {
+    const char* arg = args[i];
+    if (!arg) continue;
+    if (strncmp(arg, prefix, prefix_len) == 0) {
+      const char* value = arg + prefix_len;
+      char* parse_end = NULL;
+      unsigned long frame = strtoul(value, &parse_end, 10);
+      if (value[0] < '0' || value[0] > '9' || *parse_end != '\0' || frame > UINT32_MAX) return false;
+      *out_frame = (uint32_t)frame;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Parses --verify-keyframes from the given args array.
+bool GMT_ParseVerifyKeyframes(const char** args, size_t arg_count, bool* out_verify) {
+  if (!args || !out_verify) return false;
+  for (size_t i = 0; i < arg_count; ++i) {
+    const char* arg = args[i];
+    if (!arg) continue;
+    if (strcmp(arg, "--verify-keyframes") == 0) {
+      *out_verify = true;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Parses --stream-replay from the given args array.
+bool GMT_ParseStreamReplay(const char** args, size_t arg_count, bool* out_stream) {
+  if (!args || !out_stream) return false;
+  for (size_t i = 0; i < arg_count; ++i) {
+    const char* arg = args[i];
+    if (!arg) continue;
+    if (strcmp(arg, "--stream-replay") == 0) {
+      *out_stream = true;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Parses --test-result=<path> from the given args array.
+bool GMT_ParseResultPath(const char** args, size_t arg_count, char* out_path, size_t out_path_size) {
+  if (!args || !out_path || out_path_size == 0) return false;
+  static const char prefix[] = "--test-result=";
+  const size_t prefix_len = sizeof(prefix) - 1;
+  for (size_t i = 0; i < arg_count; ++i) {
+    const char* arg = args[i];
+    if (!arg) continue;
+    if (strncmp(arg, prefix, prefix_len) == 0) {
+      const char* value = arg + prefix_len;
+      size_t vlen = strlen(value);
+      if (vlen >= out_path_size) return false;  // Buffer too small.
+      memcpy(out_path, value, vlen + 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+// Parses --test-pool=<name> from the given args array.
+bool GMT_ParseTestPool(const char** args, size_t arg_count, char* out_name, size_t out_name_size) {
+  if (!args || !out_name || out_name_size == 0) return false;
+  static const char prefix[] = "--test-pool=";
+  const size_t prefix_len = sizeof(prefix) - 1;
+  for (size_t i = 0; i < arg_count; ++i) {
+    const char* arg = args[i];
+    if (!arg) continue;
+    if (strncmp(arg, prefix, prefix_len) == 0) {
+      const char* value = arg + prefix_len;
+      size_t vlen = strlen(value);
+      if (vlen >= out_name_size) return false;  // Buffer too small.
+      memcpy(out_name, value, vlen + 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+// Parses --test-status=<name> from the given args array.
+bool GMT_ParseTestStatus(const char** args, size_t arg_count, char* out_name, size_t out_name_size) {
+  if (!args || !out_name || out_name_size == 0) return false;
+  static const char prefix[] = "--test-status=";
+  const size_t prefix_len = sizeof(prefix) - 1;
+  for (size_t i = 0; i < arg_count; ++i) {
+    const char* arg = args[i];
+    if (!arg) continue;
+    if (strncmp(arg, prefix, prefix_len) == 0) {
+      const char* value = arg + prefix_len;
+      size_t vlen = strlen(value);
+      if (vlen >= out_name_size) return false;  // Buffer too small.
+      memcpy(out_name, value, vlen + 1);
+      return true;
+    }
+  }
+  return false;
+}
+
 // Parses --headless from the given args array.
 bool GMT_ParseHeadlessMode(const char** args, size_t arg_count, bool* out_headless) {
   if (!args || !out_headless) return false;
@@ -140,7 +363,7 @@ void GMT_PrintReport_(void) {
     return;
   }
 
-  GMT_Assertion* assertions = GMT_Alloc(sizeof(GMT_Assertion) * failures);
+  GMT_Assertion* assertions = GMT_FrameAlloc(sizeof(GMT_Assertion) * failures);
   if (!assertions) {
     GMT_LogError("Failed to allocate memory for failed assertions report");
     return;
@@ -148,15 +371,29 @@ void GMT_PrintReport_(void) {
 
   if (!GMT_GetFailedAssertions_(assertions, failures, &failures)) {
     GMT_LogError("Failed to get failed assertions for report");
-    GMT_Free(assertions);
+    GMT_FrameFree(assertions);
     return;
   }
 
   GMT_LogInfo("Report:");
   GMT_LogInfo("  Frames run     : %" PRIu64, g_gmt.frame_index);
-  GMT_LogInfo("  Total asserts  : %zu", g_gmt.total_assertion_count);
-  GMT_LogInfo("  Unique asserts : %zu", g_gmt.unique_assertion_count);
+  GMT_LogInfo("  Total asserts  : %" PRIu64, GMT_Atomic_Load64(&g_gmt.total_assertion_count));
+  GMT_LogInfo("  Unique asserts : %" PRIu64, GMT_Atomic_Load64(&g_gmt.unique_assertion_count));
   GMT_LogInfo("  Failed asserts : %zu", failures);
+  {
+    GMT_Arena* fa = &g_gmt.frame_arena;
+    GMT_LogInfo("  Frame arena    : %" PRIu64 " of %zu bytes peak, %" PRIu64 " allocations, %" PRIu64 " overflowed to the heap",
+                GMT_Atomic_Load64(&fa->peak), fa->capacity, GMT_Atomic_Load64(&fa->alloc_count), GMT_Atomic_Load64(&fa->overflow_count));
+    GMT_Arena* ra = &g_gmt.replay_arena;
+    if (ra->capacity > 0) {
+      GMT_LogInfo("  Replay arena   : %zu bytes, %" PRIu64 " allocations", ra->capacity, GMT_Atomic_Load64(&ra->alloc_count));
+    }
+  }
+  {
+    uint64_t overflows = GMT_Atomic_Load64(&g_gmt.pin_counter.overflows) + GMT_Atomic_Load64(&g_gmt.track_counter.overflows);
+    if (overflows > 0) GMT_LogInfo("  Key overflows  : %" PRIu64 " Pin/Track calls found the key counter full", overflows);
+  }
+  GMT_Profile_Report();
 
   if (failures > 0) {
     GMT_LogInfo("  Failed assertions:");
@@ -166,5 +403,55 @@ void GMT_PrintReport_(void) {
     }
   }
 
-  GMT_Free(assertions);
-}
\ No newline at end of file
+  GMT_FrameFree(assertions);
+}
+
+// Writes `str` as a JSON string literal.
+static void GMT__WriteJsonString(FILE* f, const char* str) {
+  fputc('"', f);
+  for (const char* p = str ? str : ""; *p; ++p) {
+    unsigned char c = (unsigned char)*p;
+    if (c == '"' || c == '\\') fprintf(f, "\\%c", c);
+    else if (c < 0x20) fprintf(f, "\\u%04x", c);
+    else
+      fputc(c, f);
+  }
+  fputc('"', f);
+}
+
+void GMT_WriteResultFile(void) {
+  if (g_gmt.mode == GMT_Mode_DISABLED) return;
+  const char* path = g_gmt.setup.result_path;
+  if (!path || path[0] == '\0') return;
+
+  FILE* f = fopen(path, "wb");
+  if (!f) {
+    GMT_LogError("Failed to open result file: %s", path);
+    return;
+  }
+
+  GMT_Platform_MutexLock();
+  fprintf(f, "{\n  \"test\": ");
+  GMT__WriteJsonString(f, g_gmt.setup.test_path);
+  fprintf(f, ",\n  \"mode\": \"%s\",\n", g_gmt.mode == GMT_Mode_RECORD ? "record" : "replay");
+  fprintf(f, "  \"passed\": %s,\n", g_gmt.test_failed ? "false" : "true");
+  fprintf(f, "  \"frames\": %" PRIu64 ",\n", GMT_Atomic_Load64(&g_gmt.frame_index));
+  fprintf(f, "  \"duration\": %.3f,\n", GMT_Platform_GetTime() - g_gmt.record_start_time);
+  fprintf(f, "  \"total_asserts\": %" PRIu64 ",\n", GMT_Atomic_Load64(&g_gmt.total_assertion_count));
+  fprintf(f, "  \"unique_asserts\": %" PRIu64 ",\n", GMT_Atomic_Load64(&g_gmt.unique_assertion_count));
+  fprintf(f, "  \"failed_assertions\": [");
+  for (size_t i = 0; i < g_gmt.failed_assertion_count; ++i) {
+    const GMT_Assertion* a = &g_gmt.failed_assertions[i];
+    fprintf(f, "%s\n    {\"message\": ", i > 0 ? "," : "");
+    GMT__WriteJsonString(f, a->msg);
+    fprintf(f, ", \"file\": ");
+    GMT__WriteJsonString(f, a->loc.file);
+    fprintf(f, ", \"line\": %d, \"function\": ", a->loc.line);
+    GMT__WriteJsonString(f, a->loc.function);
+    fprintf(f, "}");
+  }
+  fprintf(f, "%s]\n}\n", g_gmt.failed_assertion_count > 0 ? "\n  " : "");
+  GMT_Platform_MutexUnlock();
+
+  if (fclose(f) != 0) GMT_LogError("Failed to write result file: %s", path);
+}
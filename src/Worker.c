@@ -0,0 +1,85 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Worker.h"
+#include "Atomic.h"
+#include <string.h>
+
+static void GMT__WorkerThread(void* user) {
+  GMT_Worker* w = (GMT_Worker*)user;
+  for (;;) {
+    GMT_Platform_WaitEvent(w->wake, GMT_WORKER_IDLE_MS);
+
+    // Read the request before draining: the data it covers was pushed before it.
+    uint32_t requested = GMT_Atomic_Load32(&w->flush_requested);
+    bool stopping = GMT_Atomic_Load32(&w->stop) != 0;
+    bool flushing = requested != GMT_Atomic_Load32(&w->flush_completed);
+
+    w->drain(w->user, flushing);
+    if (flushing) {
+      GMT_Atomic_Store32(&w->flush_completed, requested);
+      GMT_Platform_SignalEvent(w->progress);
+    }
+    if (stopping) break;
+  }
+}
+
+bool GMT_Worker_Start(GMT_Worker* w, GMT_WorkerDrainCallback* drain, void* user) {
+  memset(w, 0, sizeof(*w));
+  w->drain = drain;
+  w->user = user;
+  w->wake = GMT_Platform_CreateEvent();
+  w->progress = GMT_Platform_CreateEvent();
+  if (w->wake && w->progress) w->thread = GMT_Platform_CreateThread(GMT__WorkerThread, w);
+  if (!w->thread) {
+    GMT_Platform_DestroyEvent(w->wake);
+    GMT_Platform_DestroyEvent(w->progress);
+    memset(w, 0, sizeof(*w));
+    return false;
+  }
+  return true;
+}
+
+bool GMT_Worker_Flush(GMT_Worker* w, uint32_t timeout_ms) {
+  if (!w->thread) return false;
+  uint32_t request = GMT_Atomic_Add32(&w->flush_requested, 1);
+  GMT_Platform_SignalEvent(w->wake);
+  double deadline = GMT_Platform_GetTime() + (double)timeout_ms / 1000.0;
+  while ((int32_t)(GMT_Atomic_Load32(&w->flush_completed) - request) < 0) {
+    if (timeout_ms != UINT32_MAX && GMT_Platform_GetTime() > deadline) return false;
+    GMT_Platform_WaitEvent(w->progress, GMT_WORKER_IDLE_MS);
+  }
+  return true;
+}
+
+void GMT_Worker_Stop(GMT_Worker* w) {
+  if (!w->thread) return;
+  GMT_Worker_Flush(w, UINT32_MAX);
+  GMT_Atomic_Store32(&w->stop, 1);
+  GMT_Platform_SignalEvent(w->wake);
+  GMT_Platform_JoinThread(w->thread);
+  GMT_Platform_DestroyEvent(w->wake);
+  GMT_Platform_DestroyEvent(w->progress);
+  memset(w, 0, sizeof(*w));
+}
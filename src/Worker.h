@@ -0,0 +1,66 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "Platform.h"
+
+// Background thread shared by GMT_Writer and GMT_LogRing: it wakes when
+// signalled or every GMT_WORKER_IDLE_MS, hands its owner's ring to a drain
+// callback, and answers flush and stop requests from producers.  The ring
+// itself, and what draining it means, stays with the owner.
+
+#define GMT_WORKER_IDLE_MS 10  // Producers only signal when the ring fills up or a request is pending.
+
+// Empties the owner's ring.  `flushing` is set when a flush request covers
+// what was drained, so the owner can push its output further (e.g. fflush).
+// Called on the worker thread.
+typedef void GMT_WorkerDrainCallback(void* user, bool flushing);
+
+typedef struct GMT_Worker {
+  // Flush handshake: a producer bumps flush_requested, the thread copies it
+  // into flush_completed once everything pushed before the request is drained.
+  volatile uint32_t flush_requested;
+  volatile uint32_t flush_completed;
+  volatile uint32_t stop;
+
+  GMT_WorkerDrainCallback* drain;
+  void* user;
+
+  GMT_Thread* thread;   // NULL when not running.
+  GMT_Event* wake;      // Producer → thread: data or a request is pending.
+  GMT_Event* progress;  // Thread → producer: room was freed or a flush completed.
+} GMT_Worker;
+
+// Starts the thread.  Returns false (with *w zeroed) if it could not be created.
+bool GMT_Worker_Start(GMT_Worker* w, GMT_WorkerDrainCallback* drain, void* user);
+
+// Waits up to timeout_ms (UINT32_MAX: forever) until everything pushed so far
+// has been drained.  Returns false on timeout or if the thread is not running.
+bool GMT_Worker_Flush(GMT_Worker* w, uint32_t timeout_ms);
+
+// Flushes and stops the thread.  Safe on a worker that never started.
+void GMT_Worker_Stop(GMT_Worker* w);
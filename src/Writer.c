@@ -0,0 +1,108 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Writer.h"
+#include "Atomic.h"
+#include "GameTest.h"
+#include <string.h>
+
+// Sinks everything pushed so far; a flush request then also runs the flush callback.
+static void GMT__WriterDrain(void* user, bool flushing) {
+  GMT_Writer* w = (GMT_Writer*)user;
+  uint64_t tail = GMT_Atomic_Load64(&w->tail);
+  uint64_t head = GMT_Atomic_Load64(&w->head);
+  while (tail != head) {
+    size_t offset = (size_t)(tail & (w->capacity - 1));
+    size_t chunk = (size_t)(head - tail);
+    if (chunk > w->capacity - offset) chunk = w->capacity - offset;
+    w->sink(w->user, w->ring + offset, chunk);
+    tail += chunk;
+    GMT_Atomic_Store64(&w->tail, tail);
+    GMT_Platform_SignalEvent(w->worker.progress);
+  }
+  if (flushing && w->flush) w->flush(w->user);
+}
+
+bool GMT_Writer_Start(GMT_Writer* w, size_t capacity, GMT_WriterSinkCallback* sink, GMT_WriterFlushCallback* flush, void* user) {
+  memset(w, 0, sizeof(*w));
+  size_t cap = 4096;
+  while (cap < capacity) cap *= 2;
+
+  w->ring = (uint8_t*)GMT_Alloc(cap);
+  w->capacity = cap;
+  w->sink = sink;
+  w->flush = flush;
+  w->user = user;
+  if (!w->ring || !GMT_Worker_Start(&w->worker, GMT__WriterDrain, w)) {
+    if (w->ring) GMT_Free(w->ring);
+    memset(w, 0, sizeof(*w));
+    return false;
+  }
+  return true;
+}
+
+// Copies size bytes into the ring at head, waiting for room as needed.
+static void GMT__WriterPushBytes(GMT_Writer* w, const uint8_t* src, size_t size, bool* waited) {
+  uint64_t head = GMT_Atomic_Load64(&w->head);
+  while (size > 0) {
+    size_t free_bytes = w->capacity - (size_t)(head - GMT_Atomic_Load64(&w->tail));
+    if (free_bytes == 0) {
+      *waited = true;
+      GMT_Platform_SignalEvent(w->worker.wake);
+      GMT_Platform_WaitEvent(w->worker.progress, GMT_WORKER_IDLE_MS);
+      continue;
+    }
+    size_t offset = (size_t)(head & (w->capacity - 1));
+    size_t chunk = size;
+    if (chunk > free_bytes) chunk = free_bytes;
+    if (chunk > w->capacity - offset) chunk = w->capacity - offset;
+    memcpy(w->ring + offset, src, chunk);
+    src += chunk;
+    size -= chunk;
+    head += chunk;
+    GMT_Atomic_Store64(&w->head, head);
+  }
+}
+
+void GMT_Writer_Push(GMT_Writer* w, const void* a, size_t a_size, const void* b, size_t b_size) {
+  bool waited = false;
+  GMT__WriterPushBytes(w, (const uint8_t*)a, a_size, &waited);
+  if (b_size > 0) GMT__WriterPushBytes(w, (const uint8_t*)b, b_size, &waited);
+  if (waited) w->overflow_count++;
+
+  size_t pending = (size_t)(GMT_Atomic_Load64(&w->head) - GMT_Atomic_Load64(&w->tail));
+  if (pending > w->high_water) w->high_water = pending;
+  if (pending >= w->capacity / 2) GMT_Platform_SignalEvent(w->worker.wake);
+}
+
+void GMT_Writer_Flush(GMT_Writer* w) {
+  GMT_Worker_Flush(&w->worker, UINT32_MAX);
+}
+
+void GMT_Writer_Stop(GMT_Writer* w) {
+  if (!w->worker.thread) return;
+  GMT_Worker_Stop(&w->worker);
+  GMT_Free(w->ring);
+  memset(w, 0, sizeof(*w));
+}
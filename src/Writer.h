@@ -0,0 +1,76 @@
+/*
+MIT License
+
+Copyright (c) 2026 Christian Luppi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "Platform.h"
+#include "Worker.h"
+
+// Background writer: a single-producer / single-consumer byte ring drained by a
+// dedicated thread (GMT_Worker).  The producer side only copies bytes into the ring; the
+// thread hands them to a sink (file output, block compression) in large chunks.
+//
+// Producers must be serialised by the caller (the framework mutex); the ring
+// itself is lock-free between that producer and the writer thread.
+
+// Receives ring contents in order.  Called on the writer thread.
+typedef void GMT_WriterSinkCallback(void* user, const uint8_t* data, size_t size);
+// Called on the writer thread when a flush request has drained the ring.
+typedef void GMT_WriterFlushCallback(void* user);
+
+typedef struct GMT_Writer {
+  uint8_t* ring;
+  size_t capacity;  // Power of two.
+
+  // Monotonic byte positions; head is written by the producer, tail by the thread.
+  volatile uint64_t head;
+  volatile uint64_t tail;
+
+  GMT_WriterSinkCallback* sink;
+  GMT_WriterFlushCallback* flush;
+  void* user;
+
+  GMT_Worker worker;  // worker.thread is NULL when the writer is not running.
+
+  // Statistics (producer side).
+  size_t high_water;      // Largest number of bytes ever pending in the ring.
+  size_t overflow_count;  // Pushes that had to wait for the thread to make room.
+} GMT_Writer;
+
+// Allocates a ring of at least `capacity` bytes and starts the writer thread.
+// Returns false (with *w zeroed) if allocation or thread creation fails.
+bool GMT_Writer_Start(GMT_Writer* w, size_t capacity, GMT_WriterSinkCallback* sink, GMT_WriterFlushCallback* flush, void* user);
+
+// Appends up to two byte ranges as one contiguous write.  Blocks only when the
+// ring is full (counted in overflow_count).
+void GMT_Writer_Push(GMT_Writer* w, const void* a, size_t a_size, const void* b, size_t b_size);
+
+// Waits until everything pushed so far has reached the sink and the flush callback ran.
+void GMT_Writer_Flush(GMT_Writer* w);
+
+// Flushes, stops the thread and frees the ring.  Safe on a writer that never started.
+void GMT_Writer_Stop(GMT_Writer* w);
@@ -26,28 +26,55 @@ SOFTWARE.
 #include <stdlib.h>
 #include <string.h>
 
+#include "GameTest.h"
 #include "ToolPlatform.h"
 
 /*
  * Usage:
  *   GameTest-Tool <mode> <executable> <test_name_or_path> [options] [-- arg ...]
  *   GameTest-Tool <mode> <executable> [test1.gmt ...]    [options] [-- arg ...]
+ *   GameTest-Tool <file command> [test1.gmt ...]         [--jobs N] [--compress | --no-compress]
  *
  * Modes:
  *   record   Record a single test (exactly one test path required).
  *   replay   Replay one or more tests (0 = auto-discover tests\*.gmt).
  *   disabled Run the game without test framework involvement.
+ *   bisect   Find the keyframe interval in which a replay first stops matching
+ *            its recording (exactly one test; see run_bisect).
+ *
+ * File commands (no executable; 0 tests = auto-discover tests\*.gmt):
+ *   stats    Print the per-record byte breakdown of each test file.
+ *   convert  Rewrite test files in place in the newest format they can take.
+ *   compact  convert, also dropping input records that repeat the previous
+ *            state and compressing the records (unless --no-compress).
  *
  * Options:
- *   --jobs N     Max concurrent replays (0 = all at once; replay only).
+ *   --jobs N     Max concurrent replays (0 = all at once; replay only), replays per
+ *                bisect round (0 = one per keyframe interval, up to 64), or threads for the
+ *                file commands (0 = one per logical processor).
+ *   --compress / --no-compress  Store the records of rewritten files compressed or
+ *                not (convert keeps what each file had).
+ *   --pool       Keep --jobs game processes running and hand each one test after
+ *                another over a pipe (replay only; the game must loop on
+ *                GMT_PoolNextTest).
  *   --headless   Append --headless to every test process.
  *   --isolated   Launch each child in its own Win32 window station (headless only).
+ *   --shard I/N  Run only shard I (1-based) of N duration-balanced shards.
+ *   --results F  Write per-test results as JSON to F (not for record).
+ *   --cache F    Skip tests that passed last time with the same inputs; results in F
+ *                (replay only).
+ *   --cache-dep P  Also key the cache on file or directory P (repeatable).
+ *   --no-cache   Run every test anyway; the cache is still updated.
+ *   --timeout S  Stop a test that runs longer than S seconds (replay and bisect).
+ *   --stall S    Stop a test that makes no progress for S seconds (replay and bisect).
+ *   --progress   Print the frame and replay position of running tests (replay and bisect).
  *   -- arg ...   Pass remaining arguments verbatim to every test process.
  *
  * Notes:
- *   - record requires exactly one test; it is an error to specify more.
+ *   - record and bisect require exactly one test; it is an error to specify more.
  *   - A bare test name maps to tests\<name>.gmt relative to the working directory.
  *   - replay with no tests auto-discovers tests\*.gmt recursively.
+ *   - Multiple tests are started longest first, by the duration recorded in each file.
  */
 
 typedef struct {
@@ -56,23 +83,145 @@ typedef struct {
   size_t capacity;
 } StringList;
 
+/* --timeout, --stall and --progress. */
+typedef struct {
+  double timeout; /* Seconds a test may run; 0 = no limit. */
+  double stall;   /* Seconds a test may go without progress; 0 = no limit. */
+  int progress;   /* Print the status of running tests every few seconds. */
+} WatchOptions;
+
+/* What the tool has seen of a running test's status block. */
+typedef struct {
+  GmtSharedMemory memory; /* A GmtStatusBlock; data is NULL without one. */
+  char flag[96];          /* --test-status=<name> for the process. */
+  int attached;           /* The process has opened the block. */
+  unsigned int heartbeat;
+  double heartbeat_time;  /* When heartbeat last moved. */
+  int waiting_signal_id;
+  double wait_time;       /* When the current sync wait began, 0 if none. */
+  double failed_time;     /* When the test reported failing, 0 if not. */
+  int stopped;            /* The tool has killed the process. */
+} TestWatch;
+
 typedef struct {
   GmtProcessHandle process;
   char* name;
+  size_t test_index;
+  double start_time;
+  char* result_file; /* --test-result path given to the process, or NULL. */
+  TestWatch watch;
 } RunningProcess;
 
+/* A long-lived --pool game process and the pipe it takes tests from. */
+typedef struct {
+  GmtProcessHandle process;
+  GmtPipeHandle pipe;
+  char line[8192];  /* Partial message read from the pipe. */
+  size_t line_len;
+  int busy;         /* A test has been handed out and has not reported yet. */
+  size_t test_index;
+  char* name;
+  double start_time;
+  char* result_file;
+  TestWatch watch;
+} PoolWorker;
+
+typedef struct {
+  char* path;
+  double cost;      /* Recorded duration, or file size when a test lacks one. */
+  double duration;  /* Recorded duration in seconds, -1 if unknown. */
+  size_t order;
+} ScheduledTest;
+
+typedef struct {
+  int exit_code;
+  double wall_time;
+  double recorded_duration; /* -1 if unknown. */
+  char* child_result;       /* JSON object written by the test process, or NULL. */
+  int cached;               /* Skipped: passed before with the same cache key. */
+  char stopped[128];        /* Why the tool stopped the test; empty if it ended by itself. */
+  int has_key;
+  unsigned long long cache_key;
+} TestResult;
+
+typedef struct {
+  unsigned long long key;
+  char* path;
+} CacheEntry;
+
+/* Last passing key of each test (see --cache). */
+typedef struct {
+  const char* file;         /* NULL when caching is off. */
+  int refresh;              /* --no-cache: look nothing up, record the passes. */
+  unsigned long long base;  /* Executable, --cache-dep paths and child arguments. */
+  CacheEntry* entries;
+  size_t count;
+  size_t capacity;
+} ResultCache;
+
+/* Layout of the .gmt trailer read by read_recorded_duration (see src/Internal.h). */
+#define GMT_FILE_MAGIC         0x5447u
+#define GMT_INDEX_MAGIC        0x58494B47u
+#define GMT_SUMMARY_MAGIC      0x4D555347u
+#define GMT_FILE_HEADER_SIZE   4
+#define GMT_INDEX_FOOTER_SIZE  8
+#define GMT_INDEX_ENTRY_SIZE   12
+#define GMT_SUMMARY_SIZE       16
+
+/* Live status a test process publishes with --test-status (GMT_StatusBlock in src/Internal.h). */
+#define GMT_STATUS_MAGIC        0x54534D47u
+#define GMT_STATUS_VERSION      1u
+#define GMT_STATUS_FLAG_FAILED  0x1u
+#define GMT_STATUS_FLAG_WAITING 0x2u
+
+typedef struct {
+  volatile unsigned int magic;
+  unsigned int version;
+  volatile unsigned int heartbeat;
+  volatile unsigned int flags;
+  unsigned long long frame_index;
+  unsigned long long input_cursor;
+  unsigned long long input_count;
+  int waiting_signal_id;
+  unsigned int failed_assertions;
+  double frame_time;
+} GmtStatusBlock;
+
+#define STOPPED_EXIT_CODE  124  /* Exit code of a test the tool stopped, as timeout(1) uses. */
+#define WATCH_POLL_MS      100  /* How often running tests are checked while watching. */
+#define PROGRESS_INTERVAL  5.0  /* Seconds between --progress reports. */
+
 static void print_usage(void) {
   fprintf(stderr,
           "Usage:\n"
           "  GameTest-Tool record   <executable> <test>         [--isolated] [--headless] [-- arg ...]\n"
-          "  GameTest-Tool replay   <executable> [test1.gmt ...]  [--jobs N] [--isolated] [--headless] [-- arg ...]\n"
+          "  GameTest-Tool replay   <executable> [test1.gmt ...]  [--jobs N] [--pool] [--shard I/N] [--results F]\n"
+          "                                                      [--cache F [--cache-dep P ...] [--no-cache]]\n"
+          "                                                      [--timeout S] [--stall S] [--progress]\n"
+          "                                                      [--isolated] [--headless] [-- arg ...]\n"
           "  GameTest-Tool disabled <executable> <test>         [--isolated] [--headless] [-- arg ...]\n"
+          "  GameTest-Tool bisect   <executable> <test>         [--jobs N] [--timeout S] [--stall S] [--progress]\n"
+          "                                                      [--isolated] [--headless] [-- arg ...]\n"
+          "  GameTest-Tool stats    [test1.gmt ...]             [--jobs N]\n"
+          "  GameTest-Tool convert  [test1.gmt ...]             [--jobs N] [--compress | --no-compress]\n"
+          "  GameTest-Tool compact  [test1.gmt ...]             [--jobs N] [--no-compress]\n"
           "\n"
           "Notes:\n"
-          "  - record requires exactly one test.\n"
+          "  - record and bisect require exactly one test.\n"
           "  - replay with no tests auto-discovers tests\\*.gmt recursively.\n"
           "  - A bare test name maps to tests\\<name>.gmt.\n"
-          "  - --jobs 1 runs tests sequentially.\n");
+          "  - --jobs 1 runs tests sequentially.\n"
+          "  - --pool starts the game once per job instead of once per test.\n"
+          "  - --cache skips tests whose executable, dependencies, arguments and .gmt are unchanged\n"
+          "    since they last passed.\n"
+          "  - --shard I/N splits the suite into N parts of about equal recorded duration.\n"
+          "  - --stall S stops a replay that stops updating, waits S seconds on one sync signal,\n"
+          "    keeps running S seconds after failing or S seconds past the end of its recording.\n"
+          "  - convert rewrites tests in place in the newest format they can take; compact also drops\n"
+          "    input records that repeat the previous state and compresses the records.\n"
+          "  - bisect replays the test from its keyframes side by side, checking the game state at each\n"
+          "    one, and narrows down the first interval that diverges; --jobs N replays per round\n"
+          "    (0 = one per interval, up to 64).\n");
 }
 
 /* ---- string helpers ---- */
@@ -96,7 +245,7 @@ static int str_ends_with_i(const char* str, const char* suffix) {
 }
 
 static int is_mode_name(const char* s) {
-  return str_ieq(s, "record") || str_ieq(s, "replay") || str_ieq(s, "disabled");
+  return str_ieq(s, "record") || str_ieq(s, "replay") || str_ieq(s, "disabled") || str_ieq(s, "bisect");
 }
 
 static void normalize_slashes(char* s) {
@@ -208,6 +357,560 @@ static char* file_stem(const char* path) {
   return out;
 }
 
+/* ---- test scheduling ---- */
+
+static unsigned long read_u32_le(const unsigned char* p) {
+  return (unsigned long)p[0] | ((unsigned long)p[1] << 8) | ((unsigned long)p[2] << 16) | ((unsigned long)p[3] << 24);
+}
+
+/* Reads the recorded duration (seconds) from the summary after TAG_END.  Returns 0 if
+ * the file has no summary (recorded by an older version or never closed). */
+static int read_recorded_duration(const char* path, double* out_duration, long* out_size) {
+  FILE* f = fopen(path, "rb");
+  unsigned char header[GMT_FILE_HEADER_SIZE];
+  unsigned char footer[GMT_INDEX_FOOTER_SIZE];
+  unsigned char summary[GMT_SUMMARY_SIZE];
+  long size;
+  long summary_pos;
+  int ok = 0;
+
+  *out_size = 0;
+  if (!f) return 0;
+  if (fseek(f, 0, SEEK_END) != 0 || (size = ftell(f)) < 0) goto done;
+  *out_size = size;
+  if (size < GMT_FILE_HEADER_SIZE + 1 + GMT_SUMMARY_SIZE) goto done;
+
+  if (fseek(f, 0, SEEK_SET) != 0 || fread(header, 1, sizeof(header), f) != sizeof(header)) goto done;
+  if ((header[0] | (header[1] << 8)) != GMT_FILE_MAGIC) goto done;
+
+  summary_pos = size - GMT_SUMMARY_SIZE;
+  if (fseek(f, size - GMT_INDEX_FOOTER_SIZE, SEEK_SET) != 0 || fread(footer, 1, sizeof(footer), f) != sizeof(footer)) goto done;
+  if (read_u32_le(footer + 4) == GMT_INDEX_MAGIC) {
+    unsigned long count = read_u32_le(footer);
+    long index_size = GMT_INDEX_FOOTER_SIZE;
+    if (count > (unsigned long)(size / GMT_INDEX_ENTRY_SIZE)) goto done;
+    index_size += (long)count * GMT_INDEX_ENTRY_SIZE;
+    summary_pos = size - index_size - GMT_SUMMARY_SIZE;
+    if (summary_pos < GMT_FILE_HEADER_SIZE + 1) goto done;
+  }
+
+  if (fseek(f, summary_pos, SEEK_SET) != 0 || fread(summary, 1, sizeof(summary), f) != sizeof(summary)) goto done;
+  if (read_u32_le(summary + 12) != GMT_SUMMARY_MAGIC) goto done;
+  memcpy(out_duration, summary + 4, sizeof(double));
+  ok = *out_duration >= 0.0;
+
+done:
+  fclose(f);
+  return ok;
+}
+
+static int compare_scheduled(const void* a, const void* b) {
+  const ScheduledTest* ta = (const ScheduledTest*)a;
+  const ScheduledTest* tb = (const ScheduledTest*)b;
+  if (ta->cost != tb->cost) return ta->cost > tb->cost ? -1 : 1;
+  return ta->order < tb->order ? -1 : (ta->order > tb->order ? 1 : 0);
+}
+
+static int compare_paths(const void* a, const void* b) {
+  return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/* Returns a malloc'd copy of the tests ordered longest first (ties keep list order),
+ * or NULL when out of memory.  Costs are the recorded durations when every test has
+ * one, file sizes otherwise. */
+static ScheduledTest* build_schedule(const StringList* tests) {
+  ScheduledTest* sched;
+  int all_timed = 1;
+  size_t i;
+
+  sched = (ScheduledTest*)malloc((tests->count ? tests->count : 1) * sizeof(ScheduledTest));
+  if (!sched) return NULL;
+  for (i = 0; i < tests->count; ++i) {
+    long size = 0;
+    sched[i].path = tests->items[i];
+    sched[i].order = i;
+    if (!read_recorded_duration(tests->items[i], &sched[i].duration, &size)) {
+      sched[i].duration = -1.0;
+      all_timed = 0;
+    }
+    sched[i].cost = (double)size;
+  }
+  if (all_timed) {
+    for (i = 0; i < tests->count; ++i) sched[i].cost = sched[i].duration;
+  }
+  qsort(sched, tests->count, sizeof(ScheduledTest), compare_scheduled);
+  return sched;
+}
+
+/* Reorders tests longest first so a long test never starts last and runs alone. */
+static void sort_tests_longest_first(StringList* tests) {
+  ScheduledTest* sched;
+  size_t i;
+
+  if (tests->count < 2) return;
+  sched = build_schedule(tests);
+  if (!sched) return;
+  for (i = 0; i < tests->count; ++i) tests->items[i] = sched[i].path;
+  free(sched);
+}
+
+/* Keeps only the tests of shard `index` (1-based) of `count`.  Every shard sees the
+ * same path-sorted list and hands each test, longest first, to the shard with the
+ * least total cost so far, so all shards agree on the split without talking to each
+ * other and finish at about the same time. */
+static int select_shard(StringList* tests, int index, int count) {
+  ScheduledTest* sched;
+  double* load;
+  size_t i, kept = 0;
+  int s;
+
+  qsort(tests->items, tests->count, sizeof(char*), compare_paths);
+  sched = build_schedule(tests);
+  load = (double*)calloc((size_t)count, sizeof(double));
+  if (!sched || !load) {
+    free(sched);
+    free(load);
+    return 0;
+  }
+
+  for (i = 0; i < tests->count; ++i) {
+    int target = 0;
+    for (s = 1; s < count; ++s) {
+      if (load[s] < load[target]) target = s;
+    }
+    load[target] += sched[i].cost;
+    if (target == index - 1) {
+      tests->items[kept++] = sched[i].path;
+    } else {
+      free(sched[i].path);
+    }
+  }
+  tests->count = kept;
+
+  free(load);
+  free(sched);
+  return 1;
+}
+
+/* Parses "I/N" with 1 <= I <= N. */
+static int parse_shard(const char* s, int* out_index, int* out_count) {
+  char* end = NULL;
+  long index = strtol(s, &end, 10);
+  long count;
+  if (end == s || *end != '/') return 0;
+  s = end + 1;
+  count = strtol(s, &end, 10);
+  if (end == s || *end != '\0') return 0;
+  if (count < 1 || count > 4096 || index < 1 || index > count) return 0;
+  *out_index = (int)index;
+  *out_count = (int)count;
+  return 1;
+}
+
+/* ---- results file ---- */
+
+static void write_json_string(FILE* f, const char* s) {
+  fputc('"', f);
+  for (; *s; ++s) {
+    unsigned char c = (unsigned char)*s;
+    if (c == '"' || c == '\\') fprintf(f, "\\%c", c);
+    else if (c < 0x20) fprintf(f, "\\u%04x", c);
+    else fputc(c, f);
+  }
+  fputc('"', f);
+}
+
+/* Reads the result file a test process wrote (see GMT_Setup.result_path) and deletes
+ * it.  Returns a malloc'd JSON object, or NULL if the process wrote none. */
+static char* take_child_result(const char* path) {
+  FILE* f = fopen(path, "rb");
+  char* text = NULL;
+  long size;
+
+  if (!f) return NULL;
+  if (fseek(f, 0, SEEK_END) == 0 && (size = ftell(f)) > 0 && fseek(f, 0, SEEK_SET) == 0) {
+    text = (char*)malloc((size_t)size + 1);
+    if (text && fread(text, 1, (size_t)size, f) == (size_t)size) {
+      text[size] = '\0';
+      while (size > 0 && (text[size - 1] == '\n' || text[size - 1] == '\r')) text[--size] = '\0';
+    } else {
+      free(text);
+      text = NULL;
+    }
+  }
+  fclose(f);
+  remove(path);
+
+  /* A process killed mid-write leaves a partial object; drop it. */
+  if (text && (text[0] != '{' || text[strlen(text) - 1] != '}')) {
+    free(text);
+    text = NULL;
+  }
+  return text;
+}
+
+/* Writes the merged results of a run.  Each shard writes its own file; a coordinator
+ * merges them by concatenating their "tests" arrays. */
+static int write_results(const char* path, const char* mode, int shard_index, int shard_count,
+                         const StringList* tests, const TestResult* results, double wall_time) {
+  FILE* f;
+  size_t i;
+  int passed = 0, failed = 0;
+
+  gmt_platform_ensure_parent_dirs(path);
+  f = fopen(path, "wb");
+  if (!f) {
+    fprintf(stderr, "Failed to open results file: %s\n", path);
+    return 0;
+  }
+  for (i = 0; i < tests->count; ++i) {
+    if (results[i].exit_code == 0) passed++;
+    else failed++;
+  }
+
+  fprintf(f, "{\n  \"mode\": ");
+  write_json_string(f, mode);
+  fprintf(f, ",\n  \"shard\": %d,\n  \"shard_count\": %d,\n", shard_index, shard_count);
+  fprintf(f, "  \"passed\": %d,\n  \"failed\": %d,\n  \"total\": %d,\n", passed, failed, passed + failed);
+  fprintf(f, "  \"wall_time\": %.3f,\n  \"tests\": [", wall_time);
+  for (i = 0; i < tests->count; ++i) {
+    const TestResult* r = &results[i];
+    char* name = file_stem(tests->items[i]);
+    fprintf(f, "%s\n    {\"name\": ", i > 0 ? "," : "");
+    write_json_string(f, name ? name : "");
+    fprintf(f, ", \"path\": ");
+    write_json_string(f, tests->items[i]);
+    fprintf(f, ", \"passed\": %s, \"cached\": %s, \"exit_code\": %d, \"wall_time\": %.3f",
+            r->exit_code == 0 ? "true" : "false", r->cached ? "true" : "false", r->exit_code, r->wall_time);
+    fprintf(f, ", \"stopped\": ");
+    if (r->stopped[0] != '\0') write_json_string(f, r->stopped);
+    else fprintf(f, "null");
+    if (r->recorded_duration >= 0.0) fprintf(f, ", \"recorded_duration\": %.3f", r->recorded_duration);
+    else fprintf(f, ", \"recorded_duration\": null");
+    fprintf(f, ",\n     \"result\": %s}", r->child_result ? r->child_result : "null");
+    free(name);
+  }
+  fprintf(f, "%s]\n}\n", tests->count > 0 ? "\n  " : "");
+
+  if (fclose(f) != 0) {
+    fprintf(stderr, "Failed to write results file: %s\n", path);
+    return 0;
+  }
+  fprintf(stdout, "Results written to %s\n", path);
+  return 1;
+}
+
+/* ---- result cache ---- */
+
+#define CACHE_HEADER "# GameTest-Tool result cache v1"
+
+/* 64-bit FNV-1a. */
+static unsigned long long hash_bytes(unsigned long long h, const void* data, size_t size) {
+  const unsigned char* p = (const unsigned char*)data;
+  size_t i;
+  for (i = 0; i < size; ++i) {
+    h ^= p[i];
+    h *= 0x100000001B3ull;
+  }
+  return h;
+}
+
+/* Hashes the string with its terminator, so consecutive strings stay distinct. */
+static unsigned long long hash_string(unsigned long long h, const char* s) {
+  return hash_bytes(h, s, strlen(s) + 1);
+}
+
+static int hash_file(unsigned long long* h, const char* path) {
+  FILE* f = fopen(path, "rb");
+  unsigned char buffer[65536];
+  size_t got;
+  if (!f) return 0;
+  while ((got = fread(buffer, 1, sizeof(buffer), f)) > 0) *h = hash_bytes(*h, buffer, got);
+  fclose(f);
+  return 1;
+}
+
+/* Hashes a file, or every file under a directory with its relative path. */
+static void hash_dependency(unsigned long long* h, const char* path) {
+  StringList files = {0};
+  size_t prefix = strlen(path);
+  size_t i;
+
+  *h = hash_string(*h, path);
+  if (!gmt_platform_directory_exists(path)) {
+    if (!hash_file(h, path)) {
+      fprintf(stderr, "Warning: cache dependency not found: %s\n", path);
+      *h = hash_string(*h, "<missing>");
+    }
+    return;
+  }
+  gmt_platform_list_files_recursive(path, &files, append_path_to_list);
+  qsort(files.items, files.count, sizeof(char*), compare_paths);
+  for (i = 0; i < files.count; ++i) {
+    *h = hash_string(*h, files.items[i] + prefix);
+    if (!hash_file(h, files.items[i])) *h = hash_string(*h, "<unreadable>");
+  }
+  list_free(&files);
+}
+
+static void cache_forget(ResultCache* cache, const char* path) {
+  size_t i;
+  for (i = 0; i < cache->count; ++i) {
+    if (strcmp(cache->entries[i].path, path) != 0) continue;
+    free(cache->entries[i].path);
+    cache->entries[i] = cache->entries[--cache->count];
+    return;
+  }
+}
+
+/* Records that the test at `path` passed with `key`, replacing its old entry. */
+static int cache_store(ResultCache* cache, const char* path, unsigned long long key) {
+  cache_forget(cache, path);
+  if (cache->count == cache->capacity) {
+    size_t next_cap = (cache->capacity == 0) ? 64 : cache->capacity * 2;
+    CacheEntry* next = (CacheEntry*)realloc(cache->entries, next_cap * sizeof(CacheEntry));
+    if (!next) return 0;
+    cache->entries = next;
+    cache->capacity = next_cap;
+  }
+  cache->entries[cache->count].path = xstrdup(path);
+  if (!cache->entries[cache->count].path) return 0;
+  cache->entries[cache->count].key = key;
+  cache->count++;
+  return 1;
+}
+
+static int cache_contains(const ResultCache* cache, unsigned long long key) {
+  size_t i;
+  for (i = 0; i < cache->count; ++i) {
+    if (cache->entries[i].key == key) return 1;
+  }
+  return 0;
+}
+
+/* Hashes what every test shares and loads the cache file, if there is one. */
+static int cache_open(ResultCache* cache, const char* exe_path, const StringList* deps, int headless,
+                      const char* const* extra_args, int extra_argc) {
+  FILE* f;
+  char line[8192];
+  size_t i;
+  int a;
+
+  cache->base = hash_string(0xCBF29CE484222325ull, CACHE_HEADER);
+  if (!hash_file(&cache->base, exe_path)) {
+    fprintf(stderr, "Failed to read executable for the cache key: %s\n", exe_path);
+    return 0;
+  }
+  for (i = 0; i < deps->count; ++i) hash_dependency(&cache->base, deps->items[i]);
+  cache->base = hash_string(cache->base, headless ? "--headless" : "");
+  for (a = 0; a < extra_argc; ++a) cache->base = hash_string(cache->base, extra_args[a]);
+
+  f = fopen(cache->file, "rb");
+  if (!f) return 1;
+  while (fgets(line, sizeof(line), f)) {
+    unsigned long long key;
+    char* end;
+    size_t len = strlen(line);
+    while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) line[--len] = '\0';
+    if (line[0] == '#' || len < 18) continue;
+    key = strtoull(line, &end, 16);
+    if (end != line + 16 || *end != ' ') continue;
+    if (!cache_store(cache, end + 1, key)) break;
+  }
+  fclose(f);
+  return 1;
+}
+
+static int cache_save(const ResultCache* cache) {
+  FILE* f;
+  size_t i;
+
+  gmt_platform_ensure_parent_dirs(cache->file);
+  f = fopen(cache->file, "wb");
+  if (!f) {
+    fprintf(stderr, "Failed to open cache file: %s\n", cache->file);
+    return 0;
+  }
+  fprintf(f, "%s\n", CACHE_HEADER);
+  for (i = 0; i < cache->count; ++i) fprintf(f, "%016llx %s\n", cache->entries[i].key, cache->entries[i].path);
+  if (fclose(f) != 0) {
+    fprintf(stderr, "Failed to write cache file: %s\n", cache->file);
+    return 0;
+  }
+  return 1;
+}
+
+static void cache_free(ResultCache* cache) {
+  size_t i;
+  for (i = 0; i < cache->count; ++i) free(cache->entries[i].path);
+  free(cache->entries);
+  cache->entries = NULL;
+  cache->count = 0;
+  cache->capacity = 0;
+}
+
+/* Keys every test and marks those that passed last time with the same key as
+ * cached passes.  Returns the number of tests marked. */
+static size_t cache_apply(ResultCache* cache, const StringList* tests, TestResult* results) {
+  size_t i, hits = 0;
+  if (!cache || !cache->file) return 0;
+  for (i = 0; i < tests->count; ++i) {
+    unsigned long long key = cache->base;
+    results[i].has_key = hash_file(&key, tests->items[i]);
+    results[i].cache_key = key;
+    if (!results[i].has_key || cache->refresh || !cache_contains(cache, key)) continue;
+    results[i].cached = 1;
+    results[i].exit_code = 0;
+    hits++;
+  }
+  if (hits == 0) return 0;
+  fprintf(stdout, "Skipping %zu unchanged test(s) that passed before (--no-cache runs them):\n", hits);
+  for (i = 0; i < tests->count; ++i) {
+    char* name;
+    if (!results[i].cached) continue;
+    name = file_stem(tests->items[i]);
+    fprintf(stdout, "  [CACHED] %s\n", name ? name : tests->items[i]);
+    free(name);
+  }
+  return hits;
+}
+
+/* Stores this run's passes, drops its failures and writes the cache file.
+ * Entries of tests outside this run are kept. */
+static int cache_update(ResultCache* cache, const StringList* tests, const TestResult* results) {
+  size_t i;
+  if (!cache || !cache->file) return 1;
+  for (i = 0; i < tests->count; ++i) {
+    if (results[i].exit_code == 0 && results[i].has_key) cache_store(cache, tests->items[i], results[i].cache_key);
+    else cache_forget(cache, tests->items[i]);
+  }
+  return cache_save(cache);
+}
+
+/* Returns the first test from `index` on that still has to run. */
+static size_t skip_cached(const TestResult* results, size_t count, size_t index) {
+  while (index < count && results[index].cached) index++;
+  return index;
+}
+
+/* ---- live status ---- */
+
+static int watch_enabled(const WatchOptions* options) {
+  return options->timeout > 0.0 || options->stall > 0.0 || options->progress;
+}
+
+/* Creates the status block of a process about to start.  Returns the argument
+ * that names it, or NULL when watching is off or the block could not be made
+ * (the test then runs under --timeout alone). */
+static const char* watch_open(TestWatch* w, const WatchOptions* options) {
+  static unsigned long serial = 0;
+  char name[64];
+
+  memset(w, 0, sizeof(*w));
+  if (!watch_enabled(options)) return NULL;
+  sprintf(name, "Local\\GameTest-Tool-%lu-%lu", gmt_platform_current_process_id(), serial++);
+  if (!gmt_platform_create_shared_memory(name, sizeof(GmtStatusBlock), &w->memory)) return NULL;
+  sprintf(w->flag, "--test-status=%s", name);
+  return w->flag;
+}
+
+static void watch_close(TestWatch* w) {
+  gmt_platform_close_shared_memory(&w->memory);
+  memset(w, 0, sizeof(*w));
+}
+
+/* A pooled process has moved on to its next test. */
+static void watch_restart(TestWatch* w) {
+  w->heartbeat_time = gmt_platform_time_seconds();
+  w->wait_time = 0.0;
+  w->failed_time = 0.0;
+  w->stopped = 0;
+}
+
+static const volatile GmtStatusBlock* watch_block(const TestWatch* w) {
+  const volatile GmtStatusBlock* s = (const volatile GmtStatusBlock*)w->memory.data;
+  if (!s || s->magic != GMT_STATUS_MAGIC || s->version != GMT_STATUS_VERSION) return NULL;
+  return s;
+}
+
+/* Takes in the latest status of a test that started at start_time and checks it
+ * against the limits.  Returns 1, with the reason, if the test should be stopped. */
+static int watch_check(TestWatch* w, const WatchOptions* options, double start_time, double recorded_duration,
+                       char* reason, size_t reason_size) {
+  const volatile GmtStatusBlock* s = watch_block(w);
+  double now = gmt_platform_time_seconds();
+  unsigned int flags;
+
+  if (options->timeout > 0.0 && now - start_time > options->timeout) {
+    snprintf(reason, reason_size, "timed out after %g s", options->timeout);
+    return 1;
+  }
+  /* Until the game has called GMT_Init there is nothing to judge progress by. */
+  if (!s) return 0;
+
+  if (!w->attached || s->heartbeat != w->heartbeat) {
+    w->attached = 1;
+    w->heartbeat = s->heartbeat;
+    w->heartbeat_time = now;
+  }
+  flags = s->flags;
+  if (!(flags & GMT_STATUS_FLAG_WAITING)) {
+    w->wait_time = 0.0;
+  } else if (w->wait_time == 0.0 || s->waiting_signal_id != w->waiting_signal_id) {
+    w->wait_time = now;
+    w->waiting_signal_id = s->waiting_signal_id;
+  }
+  if (!(flags & GMT_STATUS_FLAG_FAILED)) w->failed_time = 0.0;
+  else if (w->failed_time == 0.0) w->failed_time = now;
+
+  if (options->stall <= 0.0) return 0;
+  if (now - w->heartbeat_time > options->stall) {
+    snprintf(reason, reason_size, "stalled: no frame for %g s after frame %llu", options->stall, s->frame_index);
+  } else if (w->wait_time > 0.0 && now - w->wait_time > options->stall) {
+    snprintf(reason, reason_size, "stalled: waited %g s for sync signal %d", options->stall, w->waiting_signal_id);
+  } else if (w->failed_time > 0.0 && now - w->failed_time > options->stall) {
+    snprintf(reason, reason_size, "failed and still running after %g s", options->stall);
+  } else if (recorded_duration >= 0.0 && s->frame_time > recorded_duration + options->stall) {
+    snprintf(reason, reason_size, "ran %g s past the end of its %.1f s recording", options->stall, recorded_duration);
+  } else {
+    return 0;
+  }
+  return 1;
+}
+
+/* Prints one --progress line for a running test. */
+static void watch_print(const TestWatch* w, const char* name, double start_time, double recorded_duration) {
+  const volatile GmtStatusBlock* s = watch_block(w);
+  char line[256];
+  int len;
+
+  if (!s) {
+    fprintf(stdout, "  [....] %s: starting (%.0f s)\n", name, gmt_platform_time_seconds() - start_time);
+    return;
+  }
+  len = sprintf(line, "frame %llu", s->frame_index);
+  if (recorded_duration > 0.0) {
+    double pct = 100.0 * s->frame_time / recorded_duration;
+    len += sprintf(line + len, ", %.1f/%.1f s (%.0f%%)", s->frame_time, recorded_duration, pct > 100.0 ? 100.0 : pct);
+  } else {
+    len += sprintf(line + len, ", %.1f s", s->frame_time);
+  }
+  if (s->input_count > 0) len += sprintf(line + len, ", input %llu/%llu", s->input_cursor, s->input_count);
+  if (s->flags & GMT_STATUS_FLAG_WAITING) len += sprintf(line + len, ", waiting for signal %d", s->waiting_signal_id);
+  if (s->failed_assertions > 0) len += sprintf(line + len, ", %u assertion failure(s)", s->failed_assertions);
+  if (s->flags & GMT_STATUS_FLAG_FAILED) sprintf(line + len, ", FAILED");
+  fprintf(stdout, "  [....] %s: %s\n", name, line);
+}
+
+/* Kills a test that watch_check gave up on.  Returns 0 if it could not be killed. */
+static int watch_stop(TestWatch* w, GmtProcessHandle* process, TestResult* result, const char* name,
+                      const char* reason) {
+  fprintf(stderr, "  Stopping [%s]: %s\n", name, reason);
+  sprintf(result->stopped, "%.*s", (int)sizeof(result->stopped) - 1, reason);
+  w->stopped = 1;
+  return gmt_platform_kill_process(process, STOPPED_EXIT_CODE);
+}
+
 /* ---- child arg builder ---- */
 
 /* Returns a malloc'd array of const char* (caller must free). Pointers inside are NOT owned. */
@@ -232,6 +935,37 @@ static const char** build_child_args(const char* exe,
 
 /* ---- runners ---- */
 
+/* Returns the malloc'd path a test process writes its result to, next to the
+ * results file, or NULL without a results file. */
+static char* make_result_file(const char* results_path, size_t test_index) {
+  char* result_file;
+  if (!results_path) return NULL;
+  result_file = (char*)malloc(strlen(results_path) + 32);
+  if (!result_file) return NULL;
+  sprintf(result_file, "%s.%lu.tmp", results_path, (unsigned long)test_index);
+  remove(result_file);
+  return result_file;
+}
+
+/* Stores the outcome of a finished test and prints its line. */
+static void record_result(TestResult* result, const char* name, double start_time, const char* result_file,
+                          int exit_code, int* passed, int* failed) {
+  result->exit_code = exit_code;
+  result->wall_time = gmt_platform_time_seconds() - start_time;
+  if (result_file) result->child_result = take_child_result(result_file);
+
+  if (exit_code == 0) {
+    fprintf(stdout, "  [PASS] %s (%.2f s)\n", name, result->wall_time);
+    (*passed)++;
+  } else if (result->stopped[0] != '\0') {
+    fprintf(stderr, "  [FAIL] %s (stopped: %s)\n", name, result->stopped);
+    (*failed)++;
+  } else {
+    fprintf(stderr, "  [FAIL] %s (exit %d)\n", name, exit_code);
+    (*failed)++;
+  }
+}
+
 /* Runs a single test process and waits for it to finish. test_path must already be resolved. */
 static int run_single(const char* mode, const char* exe_path, const char* test_path, int isolated, int headless, const char* const* extra_args, int extra_argc) {
   char mode_flag[64];
@@ -274,21 +1008,57 @@ static int run_single(const char* mode, const char* exe_path, const char* test_p
   return exit_code;
 }
 
-/* Runs multiple tests, up to `jobs` in parallel. tests must already contain resolved paths. */
-static int run_multi(const char* mode, const char* exe_path, StringList* tests, int jobs, int isolated, int headless, const char* const* extra_args, int extra_argc) {
+/* Runs multiple tests, up to `jobs` in parallel. tests must already contain resolved paths.
+ * With a results path, also writes the per-test results there (see write_results). */
+static int run_multi(const char* mode, const char* exe_path, StringList* tests, int jobs, int isolated, int headless,
+                     const char* results_path, int shard_index, int shard_count, ResultCache* cache,
+                     const WatchOptions* watch, const char* const* extra_args, int extra_argc) {
   size_t queue_index = 0;
+  size_t cached;
   RunningProcess* running;
   size_t running_cap;
   size_t running_count = 0;
+  GmtProcessHandle** waiting;
+  size_t* waiting_slot;
+  TestResult* results;
+  double run_start;
+  double next_progress;
+  int watching = watch_enabled(watch);
   int failed = 0;
   int passed = 0;
+  size_t i;
 
   if (jobs <= 0 || jobs > (int)tests->count) jobs = (int)tests->count;
+  if (jobs <= 0) jobs = 1;
   running_cap = (size_t)jobs;
   running = (RunningProcess*)calloc(running_cap, sizeof(RunningProcess));
-  if (!running) return 1;
+  waiting = (GmtProcessHandle**)malloc(running_cap * sizeof(GmtProcessHandle*));
+  waiting_slot = (size_t*)malloc(running_cap * sizeof(size_t));
+  results = (TestResult*)calloc(tests->count ? tests->count : 1, sizeof(TestResult));
+  if (!running || !waiting || !waiting_slot || !results) {
+    free(running);
+    free(waiting);
+    free(waiting_slot);
+    free(results);
+    return 1;
+  }
 
-  fprintf(stdout, "Running %zu test(s) [%s] with up to %d parallel process(es)%s...\n", tests->count, mode, jobs, isolated ? " (isolated)" : "");
+  sort_tests_longest_first(tests);
+  for (i = 0; i < tests->count; ++i) {
+    long size = 0;
+    results[i].exit_code = 1;
+    if (!read_recorded_duration(tests->items[i], &results[i].recorded_duration, &size)) results[i].recorded_duration = -1.0;
+  }
+  cached = cache_apply(cache, tests, results);
+  passed = (int)cached;
+
+  if (shard_count > 1) {
+    fprintf(stdout, "Running %zu test(s) [%s] of shard %d/%d with up to %d parallel process(es)%s...\n", tests->count, mode, shard_index, shard_count, jobs, isolated ? " (isolated)" : "");
+  } else {
+    fprintf(stdout, "Running %zu test(s) [%s] with up to %d parallel process(es)%s...\n", tests->count, mode, jobs, isolated ? " (isolated)" : "");
+  }
+  run_start = gmt_platform_time_seconds();
+  next_progress = run_start + PROGRESS_INTERVAL;
 
   while (queue_index < tests->count || running_count > 0) {
     while (queue_index < tests->count && running_count < running_cap) {
@@ -296,11 +1066,21 @@ static int run_multi(const char* mode, const char* exe_path, StringList* tests,
       char* test_name = file_stem(test_path);
       char mode_flag[64];
       char* test_flag;
-      const char* fixed[2];
+      char* result_file = NULL;
+      char* result_flag = NULL;
+      const char* status_flag;
+      TestWatch test_watch;
+      const char* fixed[4];
+      int fixed_count = 2;
       const char** child_args;
       int child_argc;
       size_t slot;
 
+      if (results[queue_index].cached) {
+        free(test_name);
+        queue_index++;
+        continue;
+      }
       if (!test_name) break;
       test_flag = (char*)malloc(strlen(test_path) + 8);
       if (!test_flag) {
@@ -311,7 +1091,19 @@ static int run_multi(const char* mode, const char* exe_path, StringList* tests,
       sprintf(test_flag, "--test=%s", test_path);
       fixed[0] = mode_flag;
       fixed[1] = test_flag;
-      child_args = build_child_args(exe_path, fixed, 2, headless, extra_args, extra_argc, &child_argc);
+      /* Each process writes its own result next to the results file. */
+      result_file = make_result_file(results_path, queue_index);
+      result_flag = result_file ? (char*)malloc(strlen(result_file) + 16) : NULL;
+      if (result_flag) {
+        sprintf(result_flag, "--test-result=%s", result_file);
+        fixed[fixed_count++] = result_flag;
+      } else {
+        free(result_file);
+        result_file = NULL;
+      }
+      status_flag = watch_open(&test_watch, watch);
+      if (status_flag) fixed[fixed_count++] = status_flag;
+      child_args = build_child_args(exe_path, fixed, fixed_count, headless, extra_args, extra_argc, &child_argc);
 
       for (slot = 0; slot < running_cap; ++slot) {
         if (running[slot].process.process_handle == NULL) break;
@@ -320,52 +1112,845 @@ static int run_multi(const char* mode, const char* exe_path, StringList* tests,
       if (child_args && slot < running_cap &&
           gmt_platform_spawn_process(child_args, child_argc, isolated, &running[slot].process)) {
         running[slot].name = test_name;
+        running[slot].test_index = queue_index;
+        running[slot].start_time = gmt_platform_time_seconds();
+        running[slot].result_file = result_file;
+        running[slot].watch = test_watch;
         running_count++;
         fprintf(stdout, "  Started [%s] (pid %lu)\n", test_name, running[slot].process.process_id);
       } else {
         fprintf(stderr, "  [FAIL] %s (spawn setup error)\n", test_name);
         failed++;
         free(test_name);
+        free(result_file);
+        watch_close(&test_watch);
       }
       free(child_args);
+      free(result_flag);
       free(test_flag);
       queue_index++;
     }
 
     if (running_count == 0) break;
 
-    gmt_platform_sleep_ms(120);
-
+    /* Block until a process exits, then refill its slot straight away.  While
+     * watching, wake up every WATCH_POLL_MS to check on the running tests. */
     {
       size_t slot;
+      int waiting_count = 0;
+      int index = 0;
+      int exit_code = 1;
+      char reason[128];
       for (slot = 0; slot < running_cap; ++slot) {
-        int has_exited = 0;
-        int exit_code = 1;
         if (running[slot].process.process_handle == NULL) continue;
-        if (!gmt_platform_poll_process(&running[slot].process, &has_exited, &exit_code)) continue;
-        if (!has_exited) continue;
-
-        if (exit_code == 0) {
-          fprintf(stdout, "  [PASS] %s\n", running[slot].name);
-          passed++;
-        } else {
-          fprintf(stderr, "  [FAIL] %s (exit %d)\n", running[slot].name, exit_code);
-          failed++;
-        }
+        waiting[waiting_count] = &running[slot].process;
+        waiting_slot[waiting_count] = slot;
+        waiting_count++;
+      }
 
-        gmt_platform_close_process(&running[slot].process);
-        free(running[slot].name);
-        memset(&running[slot], 0, sizeof(running[slot]));
-        running_count--;
+      if (!gmt_platform_wait_any_process(waiting, waiting_count, watching ? WATCH_POLL_MS : GMT_PLATFORM_WAIT_FOREVER,
+                                         &index, &exit_code)) {
+        /* Waiting failed; fall back to reaping each process in turn. */
+        slot = waiting_slot[0];
+        if (!gmt_platform_wait_process(&running[slot].process, &exit_code)) exit_code = 1;
+      } else if (index < 0) {
+        /* Nothing exited: stop the first test over a limit, if any. */
+        double now = gmt_platform_time_seconds();
+        int report = watch->progress && now >= next_progress;
+        if (report) next_progress = now + PROGRESS_INTERVAL;
+        for (slot = 0; slot < running_cap; ++slot) {
+          RunningProcess* r = &running[slot];
+          if (r->process.process_handle == NULL) continue;
+          if (report) watch_print(&r->watch, r->name, r->start_time, results[r->test_index].recorded_duration);
+          if (!watch_check(&r->watch, watch, r->start_time, results[r->test_index].recorded_duration,
+                           reason, sizeof(reason))) {
+            continue;
+          }
+          exit_code = STOPPED_EXIT_CODE;
+          if (watch_stop(&r->watch, &r->process, &results[r->test_index], r->name, reason)) {
+            gmt_platform_wait_process(&r->process, &exit_code);
+          }
+          break;
+        }
+        if (slot == running_cap) continue;
+      } else {
+        slot = waiting_slot[index];
       }
+
+      record_result(&results[running[slot].test_index], running[slot].name, running[slot].start_time,
+                    running[slot].result_file, exit_code, &passed, &failed);
+
+      gmt_platform_close_process(&running[slot].process);
+      watch_close(&running[slot].watch);
+      free(running[slot].name);
+      free(running[slot].result_file);
+      memset(&running[slot], 0, sizeof(running[slot]));
+      running_count--;
     }
   }
 
-  fprintf(stdout, "\nFinished. Passed: %d  Failed: %d  Total: %zu\n", passed, failed, tests->count);
+  if (cached > 0) fprintf(stdout, "\nFinished. Passed: %d (%zu cached)  Failed: %d  Total: %zu\n", passed, cached, failed, tests->count);
+  else fprintf(stdout, "\nFinished. Passed: %d  Failed: %d  Total: %zu\n", passed, failed, tests->count);
+  cache_update(cache, tests, results);
+  if (results_path && !write_results(results_path, mode, shard_index, shard_count, tests, results,
+                                     gmt_platform_time_seconds() - run_start)) {
+    failed++;
+  }
+
+  for (i = 0; i < tests->count; ++i) free(results[i].child_result);
+  free(results);
+  free(waiting_slot);
+  free(waiting);
   free(running);
   return failed == 0 ? 0 : 1;
 }
 
+/* ---- pool runner ---- */
+
+/* Starts a pool worker on test `test_index`, passed on its command line like a
+ * single replay; later tests go over the pipe (see src/Pool.c for the protocol). */
+static int pool_start_worker(PoolWorker* w, const char* exe_path, const StringList* tests, size_t test_index,
+                             unsigned long serial, int isolated, int headless, const char* results_path,
+                             const WatchOptions* watch, const char* const* extra_args, int extra_argc) {
+  const char* test_path = tests->items[test_index];
+  char pipe_name[96];
+  char pool_flag[128];
+  char* test_flag;
+  char* result_file;
+  char* result_flag = NULL;
+  const char* status_flag;
+  const char* fixed[5];
+  int fixed_count = 0;
+  const char** child_args;
+  int child_argc;
+  int ok = 0;
+
+  memset(w, 0, sizeof(*w));
+  sprintf(pipe_name, "\\\\.\\pipe\\GameTest-Tool-%lu-%lu", gmt_platform_current_process_id(), serial);
+  sprintf(pool_flag, "--test-pool=%s", pipe_name);
+  test_flag = (char*)malloc(strlen(test_path) + 8);
+  result_file = make_result_file(results_path, test_index);
+  if (result_file) result_flag = (char*)malloc(strlen(result_file) + 16);
+  w->name = file_stem(test_path);
+  if (!test_flag || !w->name || (result_file && !result_flag)) goto cleanup;
+
+  sprintf(test_flag, "--test=%s", test_path);
+  fixed[fixed_count++] = "--test-mode=replay";
+  fixed[fixed_count++] = test_flag;
+  fixed[fixed_count++] = pool_flag;
+  if (result_flag) {
+    sprintf(result_flag, "--test-result=%s", result_file);
+    fixed[fixed_count++] = result_flag;
+  }
+  status_flag = watch_open(&w->watch, watch);
+  if (status_flag) fixed[fixed_count++] = status_flag;
+  child_args = build_child_args(exe_path, fixed, fixed_count, headless, extra_args, extra_argc, &child_argc);
+  if (!child_args) goto cleanup;
+
+  /* The pipe must exist before the game looks for it. */
+  if (gmt_platform_create_pipe(pipe_name, &w->pipe)) {
+    if (gmt_platform_spawn_process(child_args, child_argc, isolated, &w->process)) {
+      ok = 1;
+    } else {
+      gmt_platform_close_pipe(&w->pipe);
+    }
+  }
+  free(child_args);
+
+cleanup:
+  free(result_flag);
+  free(test_flag);
+  if (!ok) {
+    fprintf(stderr, "  [FAIL] %s (spawn setup error)\n", w->name ? w->name : test_path);
+    free(w->name);
+    free(result_file);
+    watch_close(&w->watch);
+    memset(w, 0, sizeof(*w));
+    return 0;
+  }
+  w->busy = 1;
+  w->test_index = test_index;
+  w->start_time = gmt_platform_time_seconds();
+  w->result_file = result_file;
+  fprintf(stdout, "  Started [%s] (pid %lu)\n", w->name, w->process.process_id);
+  return 1;
+}
+
+/* Hands test `test_index` to an idle worker.  Returns 0 if the worker cannot be
+ * reached, which means it has gone: the test stays queued for its replacement. */
+static int pool_assign(PoolWorker* w, const StringList* tests, size_t test_index, const char* results_path) {
+  const char* test_path = tests->items[test_index];
+  char* result_file = make_result_file(results_path, test_index);
+  char* msg = (char*)malloc(strlen(test_path) + (result_file ? strlen(result_file) : 0) + 8);
+  int ok;
+
+  w->name = file_stem(test_path);
+  ok = msg && w->name;
+  if (ok) {
+    sprintf(msg, "test\t%s\t%s\n", test_path, result_file ? result_file : "");
+    ok = gmt_platform_write_pipe(&w->pipe, msg, strlen(msg));
+  }
+  free(msg);
+  if (!ok) {
+    free(w->name);
+    w->name = NULL;
+    free(result_file);
+    return 0;
+  }
+  w->busy = 1;
+  w->test_index = test_index;
+  w->start_time = gmt_platform_time_seconds();
+  w->result_file = result_file;
+  watch_restart(&w->watch);
+  fprintf(stdout, "  Started [%s] (worker pid %lu)\n", w->name, w->process.process_id);
+  return 1;
+}
+
+/* Ends the worker's current test with `exit_code`. */
+static void pool_finish(PoolWorker* w, TestResult* results, int exit_code, int* passed, int* failed) {
+  record_result(&results[w->test_index], w->name, w->start_time, w->result_file, exit_code, passed, failed);
+  free(w->name);
+  free(w->result_file);
+  w->name = NULL;
+  w->result_file = NULL;
+  w->busy = 0;
+}
+
+/* Handles every complete message the worker has sent: each "done <status>" ends
+ * its test and is answered with the next test, or "quit" once none are left.
+ * Returns 1 if anything was read. */
+static int pool_pump(PoolWorker* w, const StringList* tests, size_t* queue_index, TestResult* results,
+                     const char* results_path, int* passed, int* failed) {
+  char buffer[1024];
+  size_t got = 0;
+  size_t i;
+  int progress = 0;
+
+  while (gmt_platform_read_pipe(&w->pipe, buffer, sizeof(buffer), &got) && got > 0) {
+    progress = 1;
+    for (i = 0; i < got; ++i) {
+      char c = buffer[i];
+      if (c != '\n') {
+        if (w->line_len + 1 < sizeof(w->line)) w->line[w->line_len++] = c;
+        continue;
+      }
+      w->line[w->line_len] = '\0';
+      w->line_len = 0;
+      if (strncmp(w->line, "done ", 5) != 0 || !w->busy) continue;
+
+      pool_finish(w, results, atoi(w->line + 5), passed, failed);
+      *queue_index = skip_cached(results, tests->count, *queue_index);
+      if (*queue_index >= tests->count) {
+        gmt_platform_write_pipe(&w->pipe, "quit\n", 5);
+      } else if (pool_assign(w, tests, *queue_index, results_path)) {
+        (*queue_index)++;
+      }
+    }
+  }
+  return progress;
+}
+
+/* Replays tests in `jobs` long-lived game processes, so each pays the game's
+ * startup once.  A worker that exits mid-test fails that test with its exit code
+ * and is replaced for the tests still queued. */
+static int run_pool(const char* exe_path, StringList* tests, int jobs, int isolated, int headless,
+                    const char* results_path, int shard_index, int shard_count, ResultCache* cache,
+                    const WatchOptions* watch, const char* const* extra_args, int extra_argc) {
+  size_t queue_index = 0;
+  size_t cached;
+  PoolWorker* workers;
+  size_t worker_count;
+  size_t active = 0;
+  unsigned long spawned = 0;
+  TestResult* results;
+  double run_start;
+  double next_progress;
+  int watching = watch_enabled(watch);
+  int failed = 0;
+  int passed = 0;
+  size_t i;
+
+  if (jobs <= 0 || jobs > (int)tests->count) jobs = (int)tests->count;
+  if (jobs <= 0) jobs = 1;
+  worker_count = (size_t)jobs;
+  workers = (PoolWorker*)calloc(worker_count, sizeof(PoolWorker));
+  results = (TestResult*)calloc(tests->count ? tests->count : 1, sizeof(TestResult));
+  if (!workers || !results) {
+    free(workers);
+    free(results);
+    return 1;
+  }
+
+  sort_tests_longest_first(tests);
+  for (i = 0; i < tests->count; ++i) {
+    long size = 0;
+    results[i].exit_code = 1;
+    if (!read_recorded_duration(tests->items[i], &results[i].recorded_duration, &size)) results[i].recorded_duration = -1.0;
+  }
+  cached = cache_apply(cache, tests, results);
+  passed = (int)cached;
+
+  if (shard_count > 1) {
+    fprintf(stdout, "Running %zu test(s) [replay] of shard %d/%d in a pool of %d process(es)%s...\n", tests->count, shard_index, shard_count, jobs, isolated ? " (isolated)" : "");
+  } else {
+    fprintf(stdout, "Running %zu test(s) [replay] in a pool of %d process(es)%s...\n", tests->count, jobs, isolated ? " (isolated)" : "");
+  }
+  run_start = gmt_platform_time_seconds();
+  next_progress = run_start + PROGRESS_INTERVAL;
+
+  while ((queue_index = skip_cached(results, tests->count, queue_index)) < tests->count || active > 0) {
+    int progress = 0;
+    int report = 0;
+    char reason[128];
+
+    if (watch->progress && gmt_platform_time_seconds() >= next_progress) {
+      report = 1;
+      next_progress = gmt_platform_time_seconds() + PROGRESS_INTERVAL;
+    }
+
+    /* Fill empty slots: at startup, and after a worker has exited. */
+    for (i = 0; i < worker_count && queue_index < tests->count; ++i) {
+      if (workers[i].process.process_handle != NULL) continue;
+      if (pool_start_worker(&workers[i], exe_path, tests, queue_index, spawned++, isolated, headless, results_path,
+                            watch, extra_args, extra_argc)) {
+        active++;
+      } else {
+        failed++;
+      }
+      queue_index = skip_cached(results, tests->count, queue_index + 1);
+      progress = 1;
+    }
+
+    for (i = 0; i < worker_count; ++i) {
+      PoolWorker* w = &workers[i];
+      int has_exited = 0;
+      int exit_code = 1;
+      if (w->process.process_handle == NULL) continue;
+
+      if (pool_pump(w, tests, &queue_index, results, results_path, &passed, &failed)) progress = 1;
+      /* A stopped worker is reaped below once it has exited, failing its test. */
+      if (watching && w->busy && !w->watch.stopped) {
+        if (report) watch_print(&w->watch, w->name, w->start_time, results[w->test_index].recorded_duration);
+        if (watch_check(&w->watch, watch, w->start_time, results[w->test_index].recorded_duration, reason,
+                        sizeof(reason))) {
+          watch_stop(&w->watch, &w->process, &results[w->test_index], w->name, reason);
+        }
+      }
+      if (!gmt_platform_poll_process(&w->process, &has_exited, &exit_code)) {
+        has_exited = 1;
+        exit_code = 1;
+      }
+      if (!has_exited) continue;
+
+      /* Results written just before exiting are still in the pipe. */
+      pool_pump(w, tests, &queue_index, results, results_path, &passed, &failed);
+      if (w->busy) pool_finish(w, results, exit_code, &passed, &failed);
+      gmt_platform_close_pipe(&w->pipe);
+      gmt_platform_close_process(&w->process);
+      watch_close(&w->watch);
+      memset(w, 0, sizeof(*w));
+      active--;
+      progress = 1;
+    }
+
+    if (!progress) gmt_platform_sleep_ms(2);
+  }
+
+  if (cached > 0) fprintf(stdout, "\nFinished. Passed: %d (%zu cached)  Failed: %d  Total: %zu  (%lu process(es) started)\n", passed, cached, failed, tests->count, spawned);
+  else fprintf(stdout, "\nFinished. Passed: %d  Failed: %d  Total: %zu  (%lu process(es) started)\n", passed, failed, tests->count, spawned);
+  cache_update(cache, tests, results);
+  if (results_path && !write_results(results_path, "replay", shard_index, shard_count, tests, results,
+                                     gmt_platform_time_seconds() - run_start)) {
+    failed++;
+  }
+
+  for (i = 0; i < tests->count; ++i) free(results[i].child_result);
+  free(results);
+  free(workers);
+  return failed == 0 ? 0 : 1;
+}
+
+/* ---- bisect ---- */
+
+#define BISECT_MAX_PIECES 64  /* Most replays in one bisect round. */
+
+/* One replay of a bisect round, from the keyframe at `start` to the one at `end`. */
+typedef struct {
+  GmtProcessHandle process;
+  unsigned long start;
+  unsigned long end;  /* 0 = to the end of the recording. */
+  char name[160];
+  double start_time;
+  int running;
+  int cancelled;      /* Stopped because an earlier segment failed. */
+  TestWatch watch;
+  TestResult result;
+} BisectRun;
+
+/* Starts `run` as a replay of test_path that restores its start keyframe, checks
+ * the game state at every later one and quits at its end keyframe. */
+static int bisect_start(BisectRun* run, const char* exe_path, const char* test_path, int isolated, int headless,
+                        const WatchOptions* watch, const char* const* extra_args, int extra_argc) {
+  char start_flag[64];
+  char end_flag[64];
+  char* test_flag;
+  const char* status_flag;
+  const char* fixed[7];
+  int fixed_count = 0;
+  const char** child_args;
+  int child_argc;
+  int ok;
+
+  test_flag = (char*)malloc(strlen(test_path) + 8);
+  if (!test_flag) return 0;
+  sprintf(test_flag, "--test=%s", test_path);
+  sprintf(start_flag, "--replay-start-frame=%lu", run->start);
+  sprintf(end_flag, "--replay-end-frame=%lu", run->end);
+  fixed[fixed_count++] = "--test-mode=replay";
+  fixed[fixed_count++] = test_flag;
+  fixed[fixed_count++] = "--replay-timing=frame";
+  fixed[fixed_count++] = "--verify-keyframes";
+  fixed[fixed_count++] = start_flag;
+  if (run->end > 0) fixed[fixed_count++] = end_flag;
+  status_flag = watch_open(&run->watch, watch);
+  if (status_flag) fixed[fixed_count++] = status_flag;
+
+  child_args = build_child_args(exe_path, fixed, fixed_count, headless, extra_args, extra_argc, &child_argc);
+  ok = child_args && gmt_platform_spawn_process(child_args, child_argc, isolated, &run->process);
+  free(child_args);
+  free(test_flag);
+  if (!ok) {
+    fprintf(stderr, "  [FAIL] %s (spawn setup error)\n", run->name);
+    watch_close(&run->watch);
+    return 0;
+  }
+  run->start_time = gmt_platform_time_seconds();
+  run->running = 1;
+  return 1;
+}
+
+/* Runs the replays of one round, up to `jobs` at a time (0 = all), in frame order.
+ * Once one fails, later ones are not started and those running are stopped.
+ * Returns the index of the earliest failing replay, `count` if all passed, or -1
+ * if a replay could not be started. */
+static int bisect_round(BisectRun* runs, int count, int jobs, const char* exe_path, const char* test_path,
+                        double recorded_duration, int isolated, int headless, const WatchOptions* watch,
+                        const char* const* extra_args, int extra_argc) {
+  GmtProcessHandle* waiting[BISECT_MAX_PIECES];
+  int waiting_index[BISECT_MAX_PIECES];
+  int watching = watch_enabled(watch);
+  int first_failed = count;
+  int next = 0;
+  int running = 0;
+  int broken = 0;
+  int passed = 0;
+  int failed = 0;
+  double next_progress = gmt_platform_time_seconds() + PROGRESS_INTERVAL;
+  int i;
+
+  if (jobs <= 0 || jobs > count) jobs = count;
+  while (next < first_failed || running > 0) {
+    int waiting_count = 0;
+    int index = 0;
+    int exit_code = 1;
+    char reason[128];
+    BisectRun* r;
+
+    while (!broken && next < first_failed && running < jobs) {
+      if (!bisect_start(&runs[next], exe_path, test_path, isolated, headless, watch, extra_args, extra_argc)) {
+        broken = 1;
+        break;
+      }
+      next++;
+      running++;
+    }
+    if (broken) first_failed = next;  /* Start nothing more; collect what runs. */
+    if (running == 0) break;
+
+    for (i = 0; i < count; ++i) {
+      if (!runs[i].running) continue;
+      waiting[waiting_count] = &runs[i].process;
+      waiting_index[waiting_count] = i;
+      waiting_count++;
+    }
+    if (!gmt_platform_wait_any_process(waiting, waiting_count, watching ? WATCH_POLL_MS : GMT_PLATFORM_WAIT_FOREVER,
+                                       &index, &exit_code)) {
+      index = 0;
+      if (!gmt_platform_wait_process(waiting[0], &exit_code)) exit_code = 1;
+    } else if (index < 0) {
+      double now = gmt_platform_time_seconds();
+      int report = watch->progress && now >= next_progress;
+      if (report) next_progress = now + PROGRESS_INTERVAL;
+      for (index = 0; index < waiting_count; ++index) {
+        r = &runs[waiting_index[index]];
+        if (report) watch_print(&r->watch, r->name, r->start_time, recorded_duration);
+        if (!watch_check(&r->watch, watch, r->start_time, recorded_duration, reason, sizeof(reason))) continue;
+        exit_code = STOPPED_EXIT_CODE;
+        if (watch_stop(&r->watch, &r->process, &r->result, r->name, reason)) gmt_platform_wait_process(&r->process, &exit_code);
+        break;
+      }
+      if (index == waiting_count) continue;
+    }
+
+    r = &runs[waiting_index[index]];
+    if (r->cancelled) {
+      r->result.exit_code = exit_code;
+    } else {
+      record_result(&r->result, r->name, r->start_time, NULL, exit_code, &passed, &failed);
+      if (exit_code != 0 && waiting_index[index] < first_failed) {
+        /* What comes after the earliest failure no longer matters. */
+        first_failed = waiting_index[index];
+        for (i = first_failed + 1; i < count; ++i) {
+          if (!runs[i].running || runs[i].cancelled) continue;
+          runs[i].cancelled = 1;
+          gmt_platform_kill_process(&runs[i].process, STOPPED_EXIT_CODE);
+        }
+      }
+    }
+    gmt_platform_close_process(&r->process);
+    watch_close(&r->watch);
+    r->running = 0;
+    running--;
+  }
+  return broken ? -1 : first_failed;
+}
+
+/* Formats the frame of bisect point `index`: a keyframe, or the end of the recording. */
+static const char* bisect_point_name(char* buffer, const unsigned long* points, size_t point_count, size_t index) {
+  if (index >= point_count) return "the end";
+  sprintf(buffer, "frame %lu", points[index]);
+  return buffer;
+}
+
+/* GameTest-Tool bisect <exe> <test>: finds the keyframe interval in which the
+ * replay first stops matching the recording.  Each round splits the interval
+ * still in question at its keyframes and replays the parts side by side, each
+ * restoring the game state of its first keyframe and checking it at every later
+ * one (GMT_Setup.verify_keyframes); the earliest part that fails is split next. */
+static int run_bisect(const char* exe_path, const char* test_path, int jobs, int isolated, int headless,
+                      const WatchOptions* watch, const char* const* extra_args, int extra_argc) {
+  uint32_t* frames;
+  unsigned long* points;
+  size_t keyframe_count = 0;
+  size_t point_count;
+  size_t lo;
+  size_t hi;
+  size_t i;
+  double recorded_duration;
+  long size = 0;
+  char lo_name[32];
+  char hi_name[32];
+  char* test_name;
+  int round = 1;
+  int result = 1;
+
+  if (!GMT_ReadTestFileKeyframes(test_path, NULL, 0, &keyframe_count)) {
+    fprintf(stderr, "Failed to read test file: %s\n", test_path);
+    return 1;
+  }
+  if (keyframe_count == 0) {
+    fprintf(stderr, "%s has no keyframes to bisect between; record it with GMT_Setup.keyframe_interval set.\n", test_path);
+    return 1;
+  }
+  frames = (uint32_t*)malloc(keyframe_count * sizeof(uint32_t));
+  points = (unsigned long*)malloc((keyframe_count + 1) * sizeof(unsigned long));
+  test_name = file_stem(test_path);
+  if (!frames || !points || !test_name ||
+      !GMT_ReadTestFileKeyframes(test_path, frames, keyframe_count, &keyframe_count)) {
+    free(frames);
+    free(points);
+    free(test_name);
+    return 1;
+  }
+  /* Point 0 is the start of the recording; the end is point point_count. */
+  points[0] = 0;
+  for (i = 0; i < keyframe_count; ++i) points[i + 1] = frames[i];
+  point_count = keyframe_count + 1;
+  free(frames);
+  if (!read_recorded_duration(test_path, &recorded_duration, &size)) recorded_duration = -1.0;
+
+  fprintf(stdout, "Bisecting [%s]: %zu keyframe(s)%s...\n", test_name, keyframe_count, isolated ? " (isolated)" : "");
+  lo = 0;
+  hi = point_count;
+  while (hi - lo > 1) {
+    int pieces = (jobs > 0) ? jobs : (int)(hi - lo);
+    size_t* bounds;
+    BisectRun* runs;
+    int failed_index;
+    int p;
+
+    if (pieces < 2) pieces = 2;
+    if (pieces > BISECT_MAX_PIECES) pieces = BISECT_MAX_PIECES;
+    if ((size_t)pieces > hi - lo) pieces = (int)(hi - lo);
+    bounds = (size_t*)malloc(((size_t)pieces + 1) * sizeof(size_t));
+    runs = (BisectRun*)calloc((size_t)pieces, sizeof(BisectRun));
+    if (!bounds || !runs) {
+      fprintf(stderr, "Out of memory.\n");
+      free(bounds);
+      free(runs);
+      break;
+    }
+    for (p = 0; p <= pieces; ++p) bounds[p] = lo + (hi - lo) * (size_t)p / (size_t)pieces;
+    for (p = 0; p < pieces; ++p) {
+      runs[p].start = points[bounds[p]];
+      runs[p].end = (bounds[p + 1] < point_count) ? points[bounds[p + 1]] : 0;
+      snprintf(runs[p].name, sizeof(runs[p].name), "%s %s..%s", test_name, bisect_point_name(lo_name, points, point_count, bounds[p]),
+              bisect_point_name(hi_name, points, point_count, bounds[p + 1]));
+    }
+
+    fprintf(stdout, "Round %d: %s to %s in %d replay(s)\n", round, bisect_point_name(lo_name, points, point_count, lo),
+            bisect_point_name(hi_name, points, point_count, hi), pieces);
+    failed_index = bisect_round(runs, pieces, jobs, exe_path, test_path, recorded_duration, isolated, headless, watch,
+                                extra_args, extra_argc);
+    if (failed_index >= 0 && failed_index < pieces) {
+      lo = bounds[failed_index];
+      hi = bounds[failed_index + 1];
+    }
+    free(bounds);
+    free(runs);
+
+    if (failed_index < 0) break;
+    if (failed_index == pieces) {
+      if (round == 1) {
+        fprintf(stdout, "\nNo divergence: every interval replays as recorded.\n");
+        result = 0;
+      } else {
+        /* The whole failed, none of its parts did: the state keyframes restore misses something. */
+        fprintf(stdout, "\nDiverges between %s and %s, but only when replayed from %s.\n",
+                bisect_point_name(lo_name, points, point_count, lo), bisect_point_name(hi_name, points, point_count, hi),
+                bisect_point_name(lo_name, points, point_count, lo));
+      }
+      hi = lo;
+      break;
+    }
+    round++;
+  }
+  if (hi - lo == 1) {
+    fprintf(stdout, "\nFirst divergence: between %s and %s.\n", bisect_point_name(lo_name, points, point_count, lo),
+            bisect_point_name(hi_name, points, point_count, hi));
+  }
+
+  free(points);
+  free(test_name);
+  return result;
+}
+
+/* ---- stats, convert and compact ---- */
+
+/* Outcome of one file for run_file_command. */
+typedef struct {
+  GMT_TestFileStats before;
+  GMT_TestFileStats after; /* Rewritten file (convert and compact). */
+  int ok;
+} FileReport;
+
+typedef struct {
+  const StringList* tests;
+  const GMT_TestFileRewrite* rewrite; /* NULL for stats. */
+  FileReport* reports;
+} FileCommand;
+
+static int is_file_command_name(const char* s) {
+  return str_ieq(s, "stats") || str_ieq(s, "convert") || str_ieq(s, "compact");
+}
+
+/* Runs on the gmt_platform_parallel_for threads, one file per call. */
+static void file_command_run(void* ctx, size_t index) {
+  FileCommand* cmd = (FileCommand*)ctx;
+  FileReport* report = &cmd->reports[index];
+  const char* path = cmd->tests->items[index];
+  char* temp;
+
+  if (!GMT_ReadTestFileStats(path, &report->before)) return;
+  if (!cmd->rewrite) {
+    report->ok = 1;
+    return;
+  }
+  /* Rewritten next to the original, which is only replaced once that succeeds. */
+  temp = (char*)malloc(strlen(path) + 5);
+  if (!temp) return;
+  sprintf(temp, "%s.tmp", path);
+  if (GMT_RewriteTestFile(path, temp, cmd->rewrite, &report->after) && gmt_platform_replace_file(temp, path)) {
+    report->ok = 1;
+  } else {
+    remove(temp);
+  }
+  free(temp);
+}
+
+static void add_file_stats(GMT_TestFileStats* total, const GMT_TestFileStats* s) {
+  int k;
+  total->frame_count += s->frame_count;
+  total->duration += s->duration;
+  total->file_size += s->file_size;
+  total->stream_size += s->stream_size;
+  total->trailer_size += s->trailer_size;
+  total->redundant_inputs += s->redundant_inputs;
+  for (k = 0; k < GMT_TestFileRecord_COUNT; ++k) {
+    total->records[k].count += s->records[k].count;
+    total->records[k].bytes += s->records[k].bytes;
+  }
+}
+
+/* Per-tag breakdown of the record stream; shares are of the expanded stream. */
+static void print_file_stats(const char* name, const GMT_TestFileStats* s, int header) {
+  double stream = s->stream_size ? (double)s->stream_size : 1.0;
+  int k;
+  if (header) {
+    fprintf(stdout, "%s: version %u, %s, %u frame(s), %.2f s%s%s\n", name, s->version,
+            s->compressed ? "compressed" : "uncompressed", s->frame_count, s->duration,
+            s->has_summary ? "" : ", no summary", s->has_keyframe_index ? ", keyframe index" : "");
+  } else {
+    fprintf(stdout, "%s: %u frame(s), %.2f s\n", name, s->frame_count, s->duration);
+  }
+  fprintf(stdout, "  %-12s %10s %12s %7s\n", "record", "count", "bytes", "share");
+  for (k = 0; k < GMT_TestFileRecord_COUNT; ++k) {
+    const GMT_TestFileRecordStats* r = &s->records[k];
+    if (r->count == 0) continue;
+    fprintf(stdout, "  %-12s %10llu %12llu %6.1f%%\n", GMT_TestFileRecordName((GMT_TestFileRecord)k),
+            (unsigned long long)r->count, (unsigned long long)r->bytes, 100.0 * (double)r->bytes / stream);
+  }
+  fprintf(stdout, "  %-12s %10s %12llu\n", "stream", "", (unsigned long long)s->stream_size);
+  fprintf(stdout, "  %-12s %10s %12llu\n", "trailer", "", (unsigned long long)s->trailer_size);
+  fprintf(stdout, "  %-12s %10s %12llu %6.1f%%\n", "on disk", "", (unsigned long long)s->file_size,
+          100.0 * (double)s->file_size / stream);
+  if (s->redundant_inputs > 0) {
+    fprintf(stdout, "  %llu input record(s) repeat the previous state; 'compact' drops them.\n",
+            (unsigned long long)s->redundant_inputs);
+  }
+}
+
+static void print_rewrite(const char* name, const FileReport* report) {
+  const GMT_TestFileStats* a = &report->before;
+  const GMT_TestFileStats* b = &report->after;
+  unsigned long long dropped = (a->records[GMT_TestFileRecord_INPUT].count + a->records[GMT_TestFileRecord_INPUT_DELTA].count) -
+                               (b->records[GMT_TestFileRecord_INPUT].count + b->records[GMT_TestFileRecord_INPUT_DELTA].count);
+  double change = a->file_size ? 100.0 * ((double)b->file_size - (double)a->file_size) / (double)a->file_size : 0.0;
+  fprintf(stdout, "[PASS] %s: version %u -> %u, %s, %llu -> %llu bytes (%+.1f%%)", name, a->version, b->version,
+          b->compressed ? "compressed" : "uncompressed", (unsigned long long)a->file_size,
+          (unsigned long long)b->file_size, change);
+  if (dropped > 0) fprintf(stdout, ", %llu input record(s) dropped", dropped);
+  fprintf(stdout, "\n");
+}
+
+/* GameTest-Tool stats|convert|compact [tests...] [options].  Works on the files
+ * through the library, without starting the game. */
+static int run_file_command(const char* command, int argc, char** argv, const char* repo_root) {
+  GMT_TestFileRewrite rewrite;
+  FileCommand cmd;
+  FileReport* reports;
+  StringList tests = {0};
+  GMT_TestFileStats total;
+  int is_stats = str_ieq(command, "stats");
+  int jobs = 0;
+  int compression_set = 0;
+  int failed = 0;
+  size_t i;
+  int a;
+
+  memset(&rewrite, 0, sizeof(rewrite));
+  rewrite.compression = GMT_TestFileCompression_KEEP;
+  if (str_ieq(command, "compact")) {
+    rewrite.compression = GMT_TestFileCompression_ON;
+    rewrite.drop_redundant_inputs = true;
+  }
+
+  for (a = 2; a < argc; ++a) {
+    if (strcmp(argv[a], "--jobs") == 0) {
+      if (a + 1 >= argc) {
+        fprintf(stderr, "--jobs requires a numeric value\n");
+        list_free(&tests);
+        return 1;
+      }
+      jobs = atoi(argv[++a]);
+      if (jobs < 0) jobs = 0;
+    } else if ((strcmp(argv[a], "--compress") == 0 || strcmp(argv[a], "--no-compress") == 0) && !is_stats) {
+      if (compression_set) {
+        fprintf(stderr, "Error: give only one of --compress and --no-compress.\n");
+        list_free(&tests);
+        return 1;
+      }
+      compression_set = 1;
+      rewrite.compression = (argv[a][2] == 'c') ? GMT_TestFileCompression_ON : GMT_TestFileCompression_OFF;
+    } else if (argv[a][0] == '-') {
+      fprintf(stderr, "Unknown option for '%s': %s\n", command, argv[a]);
+      list_free(&tests);
+      return 1;
+    } else {
+      char* path = resolve_test_path(repo_root, argv[a]);
+      if (!path || !list_push(&tests, path)) {
+        fprintf(stderr, "Out of memory while collecting test paths.\n");
+        free(path);
+        list_free(&tests);
+        return 1;
+      }
+      free(path);
+    }
+  }
+
+  if (tests.count == 0) {
+    char* tests_dir = join_path(repo_root, "tests");
+    if (!tests_dir) return 1;
+    if (!gmt_platform_directory_exists(tests_dir)) {
+      fprintf(stderr, "No tests provided and tests\\ not found: %s\n", tests_dir);
+      free(tests_dir);
+      return 1;
+    }
+    gmt_platform_discover_gmt_recursive(tests_dir, &tests, append_path_to_list);
+    free(tests_dir);
+    if (tests.count == 0) {
+      fprintf(stderr, "No .gmt test files found.\n");
+      return 1;
+    }
+  }
+
+  reports = (FileReport*)calloc(tests.count, sizeof(FileReport));
+  if (!reports) {
+    fprintf(stderr, "Out of memory.\n");
+    list_free(&tests);
+    return 1;
+  }
+  cmd.tests = &tests;
+  cmd.rewrite = is_stats ? NULL : &rewrite;
+  cmd.reports = reports;
+  gmt_platform_parallel_for(tests.count, jobs, file_command_run, &cmd);
+
+  /* Reported in argument order once every file is done. */
+  memset(&total, 0, sizeof(total));
+  for (i = 0; i < tests.count; ++i) {
+    char* name = file_stem(tests.items[i]);
+    const char* shown = name ? name : tests.items[i];
+    if (!reports[i].ok) {
+      fprintf(stdout, "[FAIL] %s: %s\n", shown, tests.items[i]);
+      failed++;
+    } else if (is_stats) {
+      print_file_stats(shown, &reports[i].before, 1);
+      add_file_stats(&total, &reports[i].before);
+    } else {
+      print_rewrite(shown, &reports[i]);
+      add_file_stats(&total, &reports[i].after);
+    }
+    free(name);
+  }
+
+  if (is_stats && tests.count - (size_t)failed > 1) {
+    fprintf(stdout, "\n");
+    print_file_stats("Total", &total, 0);
+  }
+  if (!is_stats) {
+    unsigned long long before = 0;
+    for (i = 0; i < tests.count; ++i) {
+      if (reports[i].ok) before += reports[i].before.file_size;
+    }
+    fprintf(stdout, "\nFinished. Rewritten: %zu  Failed: %d  Total: %zu  (%llu -> %llu bytes)\n",
+            tests.count - (size_t)failed, failed, tests.count, before, (unsigned long long)total.file_size);
+  }
+
+  free(reports);
+  list_free(&tests);
+  return failed == 0 ? 0 : 1;
+}
+
 /* ---- main ---- */
 
 int main(int argc, char** argv) {
@@ -376,6 +1961,16 @@ int main(int argc, char** argv) {
   int jobs = 0;
   int isolated = 0;
   int headless = 0;
+  int pool = 0;
+  int shard_index = 1;
+  int shard_count = 1;
+  const char* results_arg = NULL;
+  char* results_path = NULL;
+  const char* cache_arg = NULL;
+  char* cache_path = NULL;
+  StringList cache_deps = {0};
+  ResultCache cache = {0};
+  WatchOptions watch = {0};
   int tool_argc = argc;
   const char* const* extra_args = NULL;
   int extra_argc = 0;
@@ -393,6 +1988,19 @@ int main(int argc, char** argv) {
     }
   }
 
+  /* The file commands take no executable. */
+  if (argc >= 2 && is_file_command_name(argv[1])) {
+    if (tool_argc != argc) {
+      fprintf(stderr, "Error: '%s' does not take -- arguments.\n", argv[1]);
+      return 1;
+    }
+    if (!gmt_platform_get_current_dir(repo_root, sizeof(repo_root))) {
+      fprintf(stderr, "Failed to read current directory.\n");
+      return 1;
+    }
+    return run_file_command(argv[1], argc, argv, repo_root);
+  }
+
   if (tool_argc < 3) {
     print_usage();
     return 1;
@@ -402,7 +2010,7 @@ int main(int argc, char** argv) {
   exe_arg = argv[2];
 
   if (!is_mode_name(mode)) {
-    fprintf(stderr, "Unknown mode '%s'. Must be record, replay, or disabled.\n", mode);
+    fprintf(stderr, "Unknown mode '%s'. Must be record, replay, disabled, bisect, stats, convert or compact.\n", mode);
     print_usage();
     return 1;
   }
@@ -418,6 +2026,42 @@ int main(int argc, char** argv) {
       isolated = 1;
     } else if (strcmp(argv[i], "--headless") == 0) {
       headless = 1;
+    } else if (strcmp(argv[i], "--pool") == 0) {
+      pool = 1;
+    } else if (strcmp(argv[i], "--no-cache") == 0) {
+      cache.refresh = 1;
+    } else if (strcmp(argv[i], "--progress") == 0) {
+      watch.progress = 1;
+    } else if (strcmp(argv[i], "--timeout") == 0 || strcmp(argv[i], "--stall") == 0) {
+      double seconds;
+      if (i + 1 >= tool_argc || (seconds = atof(argv[i + 1])) <= 0.0) {
+        fprintf(stderr, "%s requires a number of seconds\n", argv[i]);
+        list_free(&cache_deps);
+        list_free(&tests);
+        return 1;
+      }
+      if (strcmp(argv[i], "--timeout") == 0) watch.timeout = seconds;
+      else watch.stall = seconds;
+      ++i;
+    } else if (strcmp(argv[i], "--cache") == 0 || strcmp(argv[i], "--cache-dep") == 0) {
+      if (i + 1 >= tool_argc) {
+        fprintf(stderr, "%s requires a path\n", argv[i]);
+        list_free(&cache_deps);
+        list_free(&tests);
+        return 1;
+      }
+      if (strcmp(argv[i], "--cache") == 0) {
+        cache_arg = argv[++i];
+      } else {
+        char* dep = resolve_from_repo(repo_root, argv[++i]);
+        if (!dep || !list_push(&cache_deps, dep)) {
+          free(dep);
+          list_free(&cache_deps);
+          list_free(&tests);
+          return 1;
+        }
+        free(dep);
+      }
     } else if (strcmp(argv[i], "--jobs") == 0) {
       if (i + 1 >= tool_argc) {
         fprintf(stderr, "--jobs requires a numeric value\n");
@@ -425,6 +2069,20 @@ int main(int argc, char** argv) {
       }
       jobs = atoi(argv[++i]);
       if (jobs < 0) jobs = 0;
+    } else if (strcmp(argv[i], "--shard") == 0) {
+      if (i + 1 >= tool_argc || !parse_shard(argv[i + 1], &shard_index, &shard_count)) {
+        fprintf(stderr, "--shard requires a value I/N with 1 <= I <= N\n");
+        list_free(&tests);
+        return 1;
+      }
+      ++i;
+    } else if (strcmp(argv[i], "--results") == 0) {
+      if (i + 1 >= tool_argc) {
+        fprintf(stderr, "--results requires a file path\n");
+        list_free(&tests);
+        return 1;
+      }
+      results_arg = argv[++i];
     } else if (argv[i][0] == '-') {
       fprintf(stderr, "Unknown option: %s\n", argv[i]);
       return 1;
@@ -446,14 +2104,43 @@ int main(int argc, char** argv) {
   }
 
   /* Validate mode-specific constraints. */
-  if (str_ieq(mode, "record")) {
+  if (pool && !str_ieq(mode, "replay")) {
+    fprintf(stderr, "Error: --pool is only available for 'replay'.\n");
+    list_free(&cache_deps);
+    list_free(&tests);
+    return 1;
+  }
+  if ((cache_arg || cache_deps.count > 0 || cache.refresh) && !str_ieq(mode, "replay")) {
+    fprintf(stderr, "Error: --cache, --cache-dep and --no-cache are only available for 'replay'.\n");
+    list_free(&cache_deps);
+    list_free(&tests);
+    return 1;
+  }
+  if (watch_enabled(&watch) && !str_ieq(mode, "replay") && !str_ieq(mode, "bisect")) {
+    fprintf(stderr, "Error: --timeout, --stall and --progress are only available for 'replay' and 'bisect'.\n");
+    list_free(&cache_deps);
+    list_free(&tests);
+    return 1;
+  }
+  if (cache_deps.count > 0 && !cache_arg) {
+    fprintf(stderr, "Error: --cache-dep needs --cache.\n");
+    list_free(&cache_deps);
+    list_free(&tests);
+    return 1;
+  }
+  if (str_ieq(mode, "record") || str_ieq(mode, "bisect")) {
     if (tests.count == 0) {
-      fprintf(stderr, "Error: 'record' requires a test name or path.\n");
+      fprintf(stderr, "Error: '%s' requires a test name or path.\n", mode);
       list_free(&tests);
       return 1;
     }
     if (tests.count > 1) {
-      fprintf(stderr, "Error: 'record' accepts only one test; %zu were given.\n", tests.count);
+      fprintf(stderr, "Error: '%s' accepts only one test; %zu were given.\n", mode, tests.count);
+      list_free(&tests);
+      return 1;
+    }
+    if (shard_count > 1 || results_arg) {
+      fprintf(stderr, "Error: --shard and --results are not available for '%s'.\n", mode);
       list_free(&tests);
       return 1;
     }
@@ -478,7 +2165,39 @@ int main(int argc, char** argv) {
     return 1;
   }
 
-  if (tests.count == 1) {
+  if (results_arg) {
+    results_path = resolve_from_repo(repo_root, results_arg);
+    if (!results_path) {
+      free(exe_path);
+      list_free(&cache_deps);
+      list_free(&tests);
+      return 1;
+    }
+  }
+
+  if (cache_arg) {
+    cache_path = resolve_from_repo(repo_root, cache_arg);
+    cache.file = cache_path;
+    if (!cache_path || !cache_open(&cache, exe_path, &cache_deps, headless, extra_args, extra_argc)) {
+      cache_free(&cache);
+      free(cache_path);
+      free(results_path);
+      free(exe_path);
+      list_free(&cache_deps);
+      list_free(&tests);
+      return 1;
+    }
+  }
+  list_free(&cache_deps);
+
+  if (str_ieq(mode, "bisect")) {
+    if (!gmt_platform_file_exists(tests.items[0])) {
+      fprintf(stderr, "Test file not found: %s\n", tests.items[0]);
+      result = 1;
+    } else {
+      result = run_bisect(exe_path, tests.items[0], jobs, isolated, headless, &watch, extra_args, extra_argc);
+    }
+  } else if (tests.count == 1 && shard_count == 1 && !results_path && !pool && !cache_path && !watch_enabled(&watch)) {
     /* Single test: record, replay, or disabled with exactly one path. */
     const char* test_path = tests.items[0];
     if (str_ieq(mode, "replay") && !gmt_platform_file_exists(test_path)) {
@@ -491,17 +2210,24 @@ int main(int argc, char** argv) {
     fprintf(stdout, "[%s] -> %s\n", mode, test_path);
     result = run_single(mode, exe_path, test_path, isolated, headless, extra_args, extra_argc);
   } else {
-    /* Multi-test path: replay or disabled with 0 or 2+ tests. */
+    /* Multi-test path: replay or disabled with 0 or 2+ tests, or any run that is
+     * sharded, pooled, cached, watched or writes a results file. */
     if (tests.count == 0) {
       /* Auto-discover. */
       char* tests_dir = join_path(repo_root, "tests");
       if (!tests_dir) {
+        cache_free(&cache);
+        free(cache_path);
+        free(results_path);
         free(exe_path);
         return 1;
       }
       if (!gmt_platform_directory_exists(tests_dir)) {
         fprintf(stderr, "No tests provided and tests\\ not found: %s\n", tests_dir);
         free(tests_dir);
+        cache_free(&cache);
+        free(cache_path);
+        free(results_path);
         free(exe_path);
         return 1;
       }
@@ -509,13 +2235,38 @@ int main(int argc, char** argv) {
       free(tests_dir);
       if (tests.count == 0) {
         fprintf(stderr, "No .gmt test files found.\n");
+        cache_free(&cache);
+        free(cache_path);
+        free(results_path);
         free(exe_path);
         return 1;
       }
     }
-    result = run_multi(mode, exe_path, &tests, jobs, isolated, headless, extra_args, extra_argc);
+    if (shard_count > 1) {
+      size_t total = tests.count;
+      if (!select_shard(&tests, shard_index, shard_count)) {
+        fprintf(stderr, "Out of memory while partitioning tests.\n");
+        cache_free(&cache);
+        free(cache_path);
+        free(results_path);
+        free(exe_path);
+        list_free(&tests);
+        return 1;
+      }
+      fprintf(stdout, "Shard %d/%d: %zu of %zu test(s)\n", shard_index, shard_count, tests.count, total);
+    }
+    if (pool) {
+      result = run_pool(exe_path, &tests, jobs, isolated, headless, results_path, shard_index, shard_count, &cache,
+                        &watch, extra_args, extra_argc);
+    } else {
+      result = run_multi(mode, exe_path, &tests, jobs, isolated, headless, results_path, shard_index, shard_count, &cache,
+                         &watch, extra_args, extra_argc);
+    }
   }
 
+  cache_free(&cache);
+  free(cache_path);
+  free(results_path);
   free(exe_path);
   list_free(&tests);
   return result;
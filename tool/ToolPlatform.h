@@ -35,6 +35,20 @@ typedef struct GmtProcessHandle {
   unsigned long process_id;
 } GmtProcessHandle;
 
+/* Server end of a named pipe, one per --pool worker. */
+typedef struct GmtPipeHandle {
+  void* handle;
+} GmtPipeHandle;
+
+/* Named memory shared with a test process, for its --test-status block. */
+typedef struct GmtSharedMemory {
+  void* handle;
+  void* data;
+} GmtSharedMemory;
+
+/* Timeout for gmt_platform_wait_any_process that never expires. */
+#define GMT_PLATFORM_WAIT_FOREVER 0xFFFFFFFFu
+
 int gmt_platform_is_absolute_path(const char* path);
 int gmt_platform_get_current_dir(char* out, size_t out_size);
 int gmt_platform_file_exists(const char* path);
@@ -42,10 +56,40 @@ int gmt_platform_is_executable(const char* path);
 int gmt_platform_directory_exists(const char* path);
 int gmt_platform_ensure_parent_dirs(const char* file_path);
 int gmt_platform_discover_gmt_recursive(const char* dir, void* ctx, GmtAppendPathFn append_path);
+int gmt_platform_list_files_recursive(const char* dir, void* ctx, GmtAppendPathFn append_path);
 
 int gmt_platform_spawn_process(const char* const* args, int arg_count, int isolated,
                                GmtProcessHandle* out_process);
 int gmt_platform_poll_process(GmtProcessHandle* process, int* has_exited, int* exit_code);
 int gmt_platform_wait_process(GmtProcessHandle* process, int* exit_code);
+/* Waits up to timeout_ms for any of the processes to exit.  On timeout returns 1
+ * with *out_index set to -1. */
+int gmt_platform_wait_any_process(GmtProcessHandle* const* processes, int count, unsigned int timeout_ms,
+                                  int* out_index, int* exit_code);
+/* Terminates the process with exit_code; wait for it as usual afterwards. */
+int gmt_platform_kill_process(GmtProcessHandle* process, int exit_code);
 void gmt_platform_close_process(GmtProcessHandle* process);
 void gmt_platform_sleep_ms(unsigned int milliseconds);
+double gmt_platform_time_seconds(void);
+unsigned long gmt_platform_current_process_id(void);
+
+/* Creates the pipe `name` for a single client.  The client may connect at any
+ * time afterwards; read reports no data until it has. */
+int gmt_platform_create_pipe(const char* name, GmtPipeHandle* out_pipe);
+/* Reads what is available without waiting.  Returns 0 once the client has closed
+ * its end and nothing is left, 1 otherwise (with *out_read possibly 0). */
+int gmt_platform_read_pipe(GmtPipeHandle* pipe, char* buffer, size_t size, size_t* out_read);
+int gmt_platform_write_pipe(GmtPipeHandle* pipe, const char* data, size_t size);
+void gmt_platform_close_pipe(GmtPipeHandle* pipe);
+
+/* Creates `size` bytes of zeroed shared memory named `name`, mapped read-write. */
+int gmt_platform_create_shared_memory(const char* name, size_t size, GmtSharedMemory* out_memory);
+void gmt_platform_close_shared_memory(GmtSharedMemory* memory);
+
+/* Replaces `to` with `from`, overwriting it if it exists. */
+int gmt_platform_replace_file(const char* from, const char* to);
+
+/* Calls fn(ctx, i) for every i below count on up to `threads` threads (0 = one
+ * per logical processor) and returns once all calls have. */
+typedef void (*GmtParallelFn)(void* ctx, size_t index);
+void gmt_platform_parallel_for(size_t count, int threads, GmtParallelFn fn, void* ctx);
@@ -232,7 +232,7 @@ static int ends_with_gmt_ci(const char* filename) {
           (filename[len - 1] == 't' || filename[len - 1] == 'T'));
 }
 
-int gmt_platform_discover_gmt_recursive(const char* dir, void* ctx, GmtAppendPathFn append_path) {
+static int find_files_recursive(const char* dir, int gmt_only, void* ctx, GmtAppendPathFn append_path) {
   WIN32_FIND_DATAA ffd;
   HANDLE h_find;
   char* pattern = join_path(dir, "*");
@@ -251,8 +251,8 @@ int gmt_platform_discover_gmt_recursive(const char* dir, void* ctx, GmtAppendPat
     if (!child) continue;
 
     if (ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
-      count += gmt_platform_discover_gmt_recursive(child, ctx, append_path);
-    } else if (ends_with_gmt_ci(ffd.cFileName)) {
+      count += find_files_recursive(child, gmt_only, ctx, append_path);
+    } else if (!gmt_only || ends_with_gmt_ci(ffd.cFileName)) {
       if (append_path(ctx, child)) count++;
     }
     free(child);
@@ -262,6 +262,14 @@ int gmt_platform_discover_gmt_recursive(const char* dir, void* ctx, GmtAppendPat
   return count;
 }
 
+int gmt_platform_discover_gmt_recursive(const char* dir, void* ctx, GmtAppendPathFn append_path) {
+  return find_files_recursive(dir, 1, ctx, append_path);
+}
+
+int gmt_platform_list_files_recursive(const char* dir, void* ctx, GmtAppendPathFn append_path) {
+  return find_files_recursive(dir, 0, ctx, append_path);
+}
+
 int gmt_platform_spawn_process(const char* const* args, int arg_count, int isolated, GmtProcessHandle* out_process) {
   STARTUPINFOW si;
   PROCESS_INFORMATION pi;
@@ -392,6 +400,55 @@ int gmt_platform_wait_process(GmtProcessHandle* process, int* exit_code) {
   return 1;
 }
 
+/* Blocks until one of the processes exits and reports which one.  A single
+ * WaitForMultipleObjects covers at most MAXIMUM_WAIT_OBJECTS handles; larger sets
+ * are checked group by group, blocking briefly on each. */
+int gmt_platform_wait_any_process(GmtProcessHandle* const* processes, int count, unsigned int timeout_ms,
+                                  int* out_index, int* exit_code) {
+  HANDLE handles[MAXIMUM_WAIT_OBJECTS];
+  /* More handles than one wait takes: poll each batch briefly in turn. */
+  DWORD timeout = (count <= MAXIMUM_WAIT_OBJECTS) ? (DWORD)timeout_ms : 10;
+  DWORD start = GetTickCount();
+  DWORD code = 1;
+  int base, i, n;
+
+  if (count <= 0) return 0;
+  for (;;) {
+    for (base = 0; base < count; base += MAXIMUM_WAIT_OBJECTS) {
+      DWORD wait_result;
+      n = count - base;
+      if (n > MAXIMUM_WAIT_OBJECTS) n = MAXIMUM_WAIT_OBJECTS;
+      for (i = 0; i < n; ++i) {
+        handles[i] = (HANDLE)processes[base + i]->process_handle;
+        if (!handles[i]) return 0;
+      }
+
+      wait_result = WaitForMultipleObjects((DWORD)n, handles, FALSE, timeout);
+      if (wait_result == WAIT_TIMEOUT) continue;
+      if (wait_result >= WAIT_OBJECT_0 + (DWORD)n) return 0;
+
+      i = (int)(wait_result - WAIT_OBJECT_0);
+      if (!GetExitCodeProcess(handles[i], &code)) return 0;
+      *out_index = base + i;
+      *exit_code = (int)code;
+      return 1;
+    }
+    if (timeout_ms != GMT_PLATFORM_WAIT_FOREVER && GetTickCount() - start >= (DWORD)timeout_ms) {
+      *out_index = -1;
+      return 1;
+    }
+  }
+}
+
+int gmt_platform_kill_process(GmtProcessHandle* process, int exit_code) {
+  if (!process->process_handle) return 0;
+  if (!TerminateProcess((HANDLE)process->process_handle, (UINT)exit_code)) {
+    fprintf(stderr, "TerminateProcess failed for pid %lu (error %lu)\n", process->process_id, (unsigned long)GetLastError());
+    return 0;
+  }
+  return 1;
+}
+
 void gmt_platform_close_process(GmtProcessHandle* process) {
   if (process->thread_handle) CloseHandle((HANDLE)process->thread_handle);
   if (process->process_handle) CloseHandle((HANDLE)process->process_handle);
@@ -403,3 +460,153 @@ void gmt_platform_close_process(GmtProcessHandle* process) {
 void gmt_platform_sleep_ms(unsigned int milliseconds) {
   Sleep(milliseconds);
 }
+
+double gmt_platform_time_seconds(void) {
+  static LARGE_INTEGER frequency;
+  LARGE_INTEGER counter;
+  if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  return (double)counter.QuadPart / (double)frequency.QuadPart;
+}
+
+unsigned long gmt_platform_current_process_id(void) {
+  return (unsigned long)GetCurrentProcessId();
+}
+
+int gmt_platform_create_pipe(const char* name, GmtPipeHandle* out_pipe) {
+  HANDLE h;
+  memset(out_pipe, 0, sizeof(*out_pipe));
+  /* A client opening the pipe with CreateFile connects it; no ConnectNamedPipe
+   * is needed, so nothing here ever blocks on a worker that fails to start. */
+  h = CreateNamedPipeA(name, PIPE_ACCESS_DUPLEX, PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT,
+                       1, 4096, 4096, 0, NULL);
+  if (h == INVALID_HANDLE_VALUE) {
+    fprintf(stderr, "CreateNamedPipe failed for %s (error %lu)\n", name, (unsigned long)GetLastError());
+    return 0;
+  }
+  out_pipe->handle = (void*)h;
+  return 1;
+}
+
+int gmt_platform_read_pipe(GmtPipeHandle* pipe, char* buffer, size_t size, size_t* out_read) {
+  HANDLE h = (HANDLE)pipe->handle;
+  DWORD available = 0;
+  DWORD read = 0;
+
+  *out_read = 0;
+  if (!h) return 0;
+  if (!PeekNamedPipe(h, NULL, 0, NULL, &available, NULL)) {
+    /* Not connected yet, or the client is gone and everything has been read. */
+    return GetLastError() == ERROR_BROKEN_PIPE ? 0 : 1;
+  }
+  if (available == 0) return 1;
+  if (available > size) available = (DWORD)size;
+  if (!ReadFile(h, buffer, available, &read, NULL)) return GetLastError() == ERROR_BROKEN_PIPE ? 0 : 1;
+  *out_read = (size_t)read;
+  return 1;
+}
+
+int gmt_platform_write_pipe(GmtPipeHandle* pipe, const char* data, size_t size) {
+  HANDLE h = (HANDLE)pipe->handle;
+  if (!h) return 0;
+  while (size > 0) {
+    DWORD written = 0;
+    if (!WriteFile(h, data, (DWORD)size, &written, NULL) || written == 0) return 0;
+    data += written;
+    size -= written;
+  }
+  return 1;
+}
+
+void gmt_platform_close_pipe(GmtPipeHandle* pipe) {
+  if (pipe->handle) CloseHandle((HANDLE)pipe->handle);
+  pipe->handle = NULL;
+}
+
+int gmt_platform_create_shared_memory(const char* name, size_t size, GmtSharedMemory* out_memory) {
+  HANDLE h;
+  void* view;
+  memset(out_memory, 0, sizeof(*out_memory));
+  /* Backed by the paging file; the test process opens it by name. */
+  h = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, (DWORD)size, name);
+  if (!h) {
+    fprintf(stderr, "CreateFileMapping failed for %s (error %lu)\n", name, (unsigned long)GetLastError());
+    return 0;
+  }
+  view = MapViewOfFile(h, FILE_MAP_ALL_ACCESS, 0, 0, size);
+  if (!view) {
+    fprintf(stderr, "MapViewOfFile failed for %s (error %lu)\n", name, (unsigned long)GetLastError());
+    CloseHandle(h);
+    return 0;
+  }
+  /* A leftover mapping of the same name keeps its contents. */
+  memset(view, 0, size);
+  out_memory->handle = (void*)h;
+  out_memory->data = view;
+  return 1;
+}
+
+void gmt_platform_close_shared_memory(GmtSharedMemory* memory) {
+  if (memory->data) UnmapViewOfFile(memory->data);
+  if (memory->handle) CloseHandle((HANDLE)memory->handle);
+  memset(memory, 0, sizeof(*memory));
+}
+
+int gmt_platform_replace_file(const char* from, const char* to) {
+  if (MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) return 1;
+  fprintf(stderr, "MoveFileEx failed for %s (error %lu)\n", to, (unsigned long)GetLastError());
+  return 0;
+}
+
+typedef struct {
+  volatile LONG next; /* Next index to hand out. */
+  LONG count;
+  GmtParallelFn fn;
+  void* ctx;
+} ParallelFor;
+
+static DWORD WINAPI parallel_for_thread(LPVOID param) {
+  ParallelFor* job = (ParallelFor*)param;
+  LONG index;
+  while ((index = InterlockedIncrement(&job->next) - 1) < job->count) {
+    job->fn(job->ctx, (size_t)index);
+  }
+  return 0;
+}
+
+void gmt_platform_parallel_for(size_t count, int threads, GmtParallelFn fn, void* ctx) {
+  ParallelFor job;
+  HANDLE* handles;
+  DWORD started = 0;
+  int i;
+
+  if (count == 0) return;
+  if (threads <= 0) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    threads = (int)info.dwNumberOfProcessors;
+  }
+  if ((size_t)threads > count) threads = (int)count;
+
+  job.next = 0;
+  job.count = (LONG)count;
+  job.fn = fn;
+  job.ctx = ctx;
+
+  /* The calling thread is one of the workers. */
+  handles = (threads > 1) ? (HANDLE*)calloc((size_t)threads - 1, sizeof(HANDLE)) : NULL;
+  if (handles) {
+    for (i = 0; i < threads - 1; ++i) {
+      HANDLE h = CreateThread(NULL, 0, parallel_for_thread, &job, 0, NULL);
+      if (!h) break;
+      handles[started++] = h;
+    }
+  }
+  parallel_for_thread(&job);
+  /* WaitForMultipleObjects takes at most MAXIMUM_WAIT_OBJECTS handles. */
+  for (i = 0; i < (int)started; ++i) {
+    WaitForSingleObject(handles[i], INFINITE);
+    CloseHandle(handles[i]);
+  }
+  free(handles);
+}